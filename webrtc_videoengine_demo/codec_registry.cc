@@ -0,0 +1,177 @@
+#include "codec_registry.h"
+
+#include <string.h>
+
+#include "h264.h"
+
+namespace webrtc {
+
+static VideoEncoder* CreateX264Encoder() {
+	return H264Encoder::CreateX264();
+}
+
+static VideoDecoder* CreateFFmpegDecoder() {
+	return H264Decoder::CreateFFmpeg();
+}
+
+static VideoEncoder* CreateOpenH264Encoder() {
+	return H264Encoder::CreateOpenH264();
+}
+
+static VideoDecoder* CreateOpenH264Decoder() {
+	return H264Decoder::CreateOpenH264();
+}
+
+// The H264 implementations get their own payload types so a receiver can
+// tell which one its peer uses.
+static const CodecInfo kCodecs[] = {
+	{ "vp8", kVideoCodecVP8, 100, NULL, NULL },
+	{ "x264", kVideoCodecH264, 127, CreateX264Encoder, CreateFFmpegDecoder },
+	{ "openh264", kVideoCodecH264, 126, CreateOpenH264Encoder,
+		CreateOpenH264Decoder },
+};
+
+static const int kNumCodecs = sizeof(kCodecs) / sizeof(kCodecs[0]);
+
+int CodecRegistry::NumberOfCodecs() {
+	return kNumCodecs;
+}
+
+const CodecInfo* CodecRegistry::GetCodec(int index) {
+	if (index < 0 || index >= kNumCodecs) {
+		return NULL;
+	}
+	return &kCodecs[index];
+}
+
+const CodecInfo* CodecRegistry::FindCodec(const char* name) {
+	for (int i = 0; i < kNumCodecs; i++) {
+		if (strcmp(kCodecs[i].name, name) == 0) {
+			return &kCodecs[i];
+		}
+	}
+	return NULL;
+}
+
+const CodecInfo* CodecRegistry::CheaperCodec(const CodecInfo* codec) {
+	return GetCodec(static_cast<int>(codec - kCodecs) + 1);
+}
+
+bool CodecRegistry::GetSettings(ViECodec* vie_codec, const CodecInfo* codec,
+	const VideoCodec& user_settings, VideoCodec* settings) {
+	bool found = false;
+	for (int i = 0; i < vie_codec->NumberOfCodecs() && !found; i++) {
+		found = vie_codec->GetCodec(i, *settings) != -1 &&
+			settings->codecType == codec->type;
+	}
+	if (!found) {
+		return false;
+	}
+	settings->plType = codec->payload_type;
+	if (user_settings.width > 0 && user_settings.height > 0) {
+		settings->width = user_settings.width;
+		settings->height = user_settings.height;
+	}
+	if (user_settings.maxFramerate > 0) {
+		settings->maxFramerate = user_settings.maxFramerate;
+	}
+	if (user_settings.startBitrate > 0) {
+		settings->startBitrate = user_settings.startBitrate;
+	}
+	if (user_settings.targetBitrate > 0) {
+		settings->targetBitrate = user_settings.targetBitrate;
+	}
+	if (user_settings.minBitrate > 0) {
+		settings->minBitrate = user_settings.minBitrate;
+	}
+	if (user_settings.maxBitrate > 0) {
+		settings->maxBitrate = user_settings.maxBitrate;
+	}
+	return true;
+}
+
+ChannelCodecs::ChannelCodecs(ViECodec* vie_codec,
+	ViEExternalCodec* external_codec, int channel)
+	: vie_codec_(vie_codec),
+	external_codec_(external_codec),
+	channel_(channel),
+	send_codec_(NULL),
+	encoder_(NULL),
+	decoders_(kNumCodecs, static_cast<VideoDecoder*>(NULL)) {}
+
+ChannelCodecs::~ChannelCodecs() {
+	if (encoder_ != NULL) {
+		external_codec_->DeRegisterExternalSendCodec(channel_,
+			send_codec_->payload_type);
+		delete encoder_;
+	}
+	for (int i = 0; i < kNumCodecs; i++) {
+		if (decoders_[i] != NULL) {
+			external_codec_->DeRegisterExternalReceiveCodec(channel_,
+				kCodecs[i].payload_type);
+			delete decoders_[i];
+		}
+	}
+}
+
+int ChannelCodecs::SetUpReceiveCodecs(const VideoCodec& user_settings) {
+	for (int i = 0; i < kNumCodecs; i++) {
+		const CodecInfo* codec = &kCodecs[i];
+		VideoCodec settings;
+		if (!CodecRegistry::GetSettings(vie_codec_, codec, user_settings,
+			&settings)) {
+			return -1;
+		}
+		if (codec->create_decoder != NULL && decoders_[i] == NULL) {
+			decoders_[i] = codec->create_decoder();
+			if (external_codec_->RegisterExternalReceiveCodec(channel_,
+				codec->payload_type, decoders_[i], false) == -1) {
+				return -1;
+			}
+		}
+		if (vie_codec_->SetReceiveCodec(channel_, settings) == -1) {
+			return -1;
+		}
+	}
+	return 0;
+}
+
+int ChannelCodecs::SetSendCodec(const CodecInfo* codec,
+	const VideoCodec& user_settings) {
+	VideoCodec settings;
+	if (!CodecRegistry::GetSettings(vie_codec_, codec, user_settings,
+		&settings)) {
+		return -1;
+	}
+	if (codec == send_codec_) {
+		return vie_codec_->SetSendCodec(channel_, settings);
+	}
+	VideoEncoder* encoder = NULL;
+	if (codec->create_encoder != NULL) {
+		encoder = codec->create_encoder();
+		if (external_codec_->RegisterExternalSendCodec(channel_,
+			codec->payload_type, encoder, false) == -1) {
+			delete encoder;
+			return -1;
+		}
+	}
+	if (vie_codec_->SetSendCodec(channel_, settings) == -1) {
+		if (encoder != NULL) {
+			external_codec_->DeRegisterExternalSendCodec(channel_,
+				codec->payload_type);
+			delete encoder;
+		}
+		return -1;
+	}
+	// VideoEngine has stopped using the previous encoder.
+	if (encoder_ != NULL) {
+		external_codec_->DeRegisterExternalSendCodec(channel_,
+			send_codec_->payload_type);
+		delete encoder_;
+	}
+	encoder_ = encoder;
+	send_codec_ = codec;
+	return 0;
+}
+
+}  // namespace webrtc
@@ -0,0 +1,80 @@
+/*
+ * Video codecs the demo links in, selectable per channel at runtime.
+ */
+#ifndef WEBRTC_VIDEOENGINE_DEMO_CODEC_REGISTRY_H_
+#define WEBRTC_VIDEOENGINE_DEMO_CODEC_REGISTRY_H_
+
+#include <vector>
+
+#include "webrtc/common_types.h"
+#include "webrtc/video_engine/vie_codec.h"
+#include "webrtc/video_engine/vie_external_codec.h"
+
+namespace webrtc {
+
+class VideoDecoder;
+class VideoEncoder;
+
+struct CodecInfo {
+	// Name used to select the codec, e.g. on the command line.
+	const char* name;
+	VideoCodecType type;
+	// RTP payload type the codec is sent and received with.
+	unsigned char payload_type;
+	// Factories for codecs registered as external codecs; NULL for the codecs
+	// built into VideoEngine.
+	VideoEncoder* (*create_encoder)();
+	VideoDecoder* (*create_decoder)();
+};
+
+class CodecRegistry {
+public:
+	// Codecs are listed from the most to the least CPU hungry encoder at
+	// their default settings.
+	static int NumberOfCodecs();
+	static const CodecInfo* GetCodec(int index);
+
+	// Returns NULL if there is no codec called |name|.
+	static const CodecInfo* FindCodec(const char* name);
+
+	// Returns the next cheaper codec to fall back to, or NULL.
+	static const CodecInfo* CheaperCodec(const CodecInfo* codec);
+
+	// Fills |settings| with VideoEngine's defaults for |codec|, overridden by
+	// the resolution, frame rate and bit rates set (non-zero) in
+	// |user_settings|.
+	static bool GetSettings(ViECodec* vie_codec, const CodecInfo* codec,
+		const VideoCodec& user_settings, VideoCodec* settings);
+};
+
+// The codecs of one channel. Every codec in the registry is registered for
+// receiving, so the channel decodes whatever its peer picks, and the send
+// codec can be switched while the channel is running.
+class ChannelCodecs {
+public:
+	ChannelCodecs(ViECodec* vie_codec, ViEExternalCodec* external_codec,
+		int channel);
+	~ChannelCodecs();
+
+	// Registers every codec for receiving with the resolution, frame rate and
+	// bit rates of |user_settings|.
+	int SetUpReceiveCodecs(const VideoCodec& user_settings);
+
+	// Sends with |codec| from now on.
+	int SetSendCodec(const CodecInfo* codec, const VideoCodec& user_settings);
+
+	const CodecInfo* send_codec() const { return send_codec_; }
+
+private:
+	ViECodec* vie_codec_;
+	ViEExternalCodec* external_codec_;
+	int channel_;
+	const CodecInfo* send_codec_;
+	VideoEncoder* encoder_;
+	// Indexed like the registry; NULL for VideoEngine's own codecs.
+	std::vector<VideoDecoder*> decoders_;
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_VIDEOENGINE_DEMO_CODEC_REGISTRY_H_
@@ -2,13 +2,15 @@
 #define WEBRTC_MODULES_VIDEO_CODING_CODECS_H264_INCLUDE_H264_H_
 
 #include "webrtc/modules/video_coding/codecs/interface/video_codec_interface.h"
-#include "main.h"
 
 namespace webrtc {
 
 class H264Encoder : public VideoEncoder {
  public:
-  static H264Encoder* Create();
+  // Encoder backed by Cisco's OpenH264.
+  static H264Encoder* CreateOpenH264();
+  // Encoder backed by x264.
+  static H264Encoder* CreateX264();
 
   virtual ~H264Encoder() {};
 };  // end of H264Encoder class
@@ -16,7 +18,10 @@ class H264Encoder : public VideoEncoder {
 
 class H264Decoder : public VideoDecoder {
  public:
-  static H264Decoder* Create();
+  // Decoder backed by Cisco's OpenH264.
+  static H264Decoder* CreateOpenH264();
+  // Decoder backed by FFmpeg's libavcodec.
+  static H264Decoder* CreateFFmpeg();
 
   virtual ~H264Decoder() {};
 };  // end of H264Decoder class
@@ -0,0 +1,507 @@
+/*
+ *  Copyright (c) 2012 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ *
+ * Unit tests and micro benchmarks for the WEBRTC H264 wrapper
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "h264.h"
+#include "webrtc/common_video/libyuv/include/webrtc_libyuv.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+
+// Counts C++ heap allocations so the benchmarks can show that steady-state
+// decoding does not allocate.
+static bool g_count_allocations = false;
+static int g_allocation_count = 0;
+
+void* operator new(size_t size) {
+	if (g_count_allocations) {
+		++g_allocation_count;
+	}
+	void* p = malloc(size ? size : 1);
+	if (p == NULL) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+void* operator new[](size_t size) {
+	return operator new(size);
+}
+
+void operator delete(void* p) throw() {
+	free(p);
+}
+
+void operator delete[](void* p) throw() {
+	free(p);
+}
+
+namespace webrtc {
+
+static const uint32_t kTestTimestamp = 123;
+static const int kFrameRate = 30;
+static const int kStartCodeSize = 4;
+static const uint8_t kStartCode[kStartCodeSize] = {0, 0, 0, 1};
+
+// Stores every encoded frame as an Annex-B stream, which is the layout the
+// RTP depacketizer hands to the decoder.
+class H264UnitTestEncodeCompleteCallback : public EncodedImageCallback {
+ public:
+	H264UnitTestEncodeCompleteCallback() : max_nal_size_(0) {}
+
+	int32_t Encoded(EncodedImage& encoded_image,
+		const CodecSpecificInfo* codec_specific_info,
+		const RTPFragmentationHeader* fragmentation) {
+		std::vector<uint8_t> frame;
+		if (fragmentation == NULL) {
+			frame.assign(encoded_image._buffer,
+				encoded_image._buffer + encoded_image._length);
+		} else {
+			for (int i = 0; i < fragmentation->fragmentationVectorSize; i++) {
+				// The fragments may point into the encoder's own buffer but
+				// must stay within the reported frame.
+				EXPECT_LE(fragmentation->fragmentationOffset[i] +
+					fragmentation->fragmentationLength[i], encoded_image._length);
+				const uint8_t* nal = encoded_image._buffer +
+					fragmentation->fragmentationOffset[i];
+				frame.insert(frame.end(), kStartCode, kStartCode + kStartCodeSize);
+				frame.insert(frame.end(), nal,
+					nal + fragmentation->fragmentationLength[i]);
+			}
+		}
+		frames_.push_back(frame);
+		frame_types_.push_back(encoded_image._frameType);
+		if (fragmentation != NULL) {
+			for (int i = 0; i < fragmentation->fragmentationVectorSize; i++) {
+				if (fragmentation->fragmentationLength[i] > max_nal_size_) {
+					max_nal_size_ = fragmentation->fragmentationLength[i];
+				}
+			}
+		}
+		return 0;
+	}
+
+	const std::vector<std::vector<uint8_t> >& frames() const { return frames_; }
+	VideoFrameType frame_type(size_t i) const { return frame_types_[i]; }
+	size_t max_nal_size() const { return max_nal_size_; }
+
+	// Average size of the frames from |first| on.
+	size_t AverageFrameSize(size_t first) const {
+		size_t size = 0;
+		for (size_t i = first; i < frames_.size(); i++) {
+			size += frames_[i].size();
+		}
+		return first < frames_.size() ? size / (frames_.size() - first) : 0;
+	}
+
+	void Reset() {
+		frames_.clear();
+		frame_types_.clear();
+		max_nal_size_ = 0;
+	}
+
+ private:
+	std::vector<std::vector<uint8_t> > frames_;
+	std::vector<VideoFrameType> frame_types_;
+	size_t max_nal_size_;
+};
+
+// Sums the visible luma samples of |frame|.
+static uint32_t LumaChecksum(const I420VideoFrame& frame) {
+	uint32_t sum = 0;
+	for (int y = 0; y < frame.height(); y++) {
+		const uint8_t* row = frame.buffer(kYPlane) + y * frame.stride(kYPlane);
+		for (int x = 0; x < frame.width(); x++) {
+			sum += row[x];
+		}
+	}
+	return sum;
+}
+
+class H264UnitTestDecodeCompleteCallback : public DecodedImageCallback {
+ public:
+	H264UnitTestDecodeCompleteCallback()
+		: decoded_frames_(0),
+		wrapped_frames_(0),
+		retain_frames_(false) {}
+
+	~H264UnitTestDecodeCompleteCallback() {
+		for (size_t i = 0; i < retained_.size(); i++) {
+			delete retained_[i];
+		}
+	}
+
+	int32_t Decoded(I420VideoFrame& frame) {
+		++decoded_frames_;
+		if (frame.IsWrapped()) {
+			++wrapped_frames_;
+		}
+		last_width_ = frame.width();
+		last_height_ = frame.height();
+		last_timestamp_ = frame.timestamp();
+		if (retain_frames_) {
+			// Hold on to the frame the way the renderer does.
+			retained_.push_back(frame.CloneFrame());
+			retained_checksums_.push_back(LumaChecksum(frame));
+		}
+		return 0;
+	}
+
+	void set_retain_frames(bool retain) { retain_frames_ = retain; }
+	const std::vector<I420VideoFrame*>& retained() const { return retained_; }
+	uint32_t retained_checksum(size_t i) const { return retained_checksums_[i]; }
+	int wrapped_frames() const { return wrapped_frames_; }
+
+	int decoded_frames() const { return decoded_frames_; }
+	int last_width() const { return last_width_; }
+	int last_height() const { return last_height_; }
+	uint32_t last_timestamp() const { return last_timestamp_; }
+
+ private:
+	int decoded_frames_;
+	int wrapped_frames_;
+	bool retain_frames_;
+	std::vector<I420VideoFrame*> retained_;
+	std::vector<uint32_t> retained_checksums_;
+	int last_width_;
+	int last_height_;
+	uint32_t last_timestamp_;
+};
+
+// The encoder and decoder pairs under test.
+enum H264Implementation {
+	kOpenH264,
+	kX264
+};
+
+class TestH264Impl : public ::testing::TestWithParam<H264Implementation> {
+ protected:
+	virtual void SetUp() {
+		if (GetParam() == kX264) {
+			encoder_.reset(H264Encoder::CreateX264());
+			decoder_.reset(H264Decoder::CreateFFmpeg());
+		} else {
+			encoder_.reset(H264Encoder::CreateOpenH264());
+			decoder_.reset(H264Decoder::CreateOpenH264());
+		}
+		encoder_->RegisterEncodeCompleteCallback(&encode_callback_);
+		decoder_->RegisterDecodeCompleteCallback(&decode_callback_);
+		memset(&codec_inst_, 0, sizeof(codec_inst_));
+		codec_inst_.codecType = kVideoCodecH264;
+		codec_inst_.maxFramerate = kFrameRate;
+		codec_inst_.startBitrate = 300;
+		codec_inst_.maxBitrate = 1000;
+	}
+
+	void SetUpEncodeDecode(int width, int height) {
+		codec_inst_.width = width;
+		codec_inst_.height = height;
+		EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK,
+			encoder_->InitEncode(&codec_inst_, 1, 1440));
+		EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK, decoder_->InitDecode(&codec_inst_, 1));
+	}
+
+	// Produces a moving gradient so consecutive frames differ.
+	void FillSyntheticFrame(int width, int height, int index) {
+		int stride_y = 0;
+		int stride_uv = 0;
+		Calc16ByteAlignedStride(width, &stride_y, &stride_uv);
+		input_frame_.CreateEmptyFrame(width, height, stride_y, stride_uv,
+			stride_uv);
+		for (int y = 0; y < height; y++) {
+			uint8_t* row = input_frame_.buffer(kYPlane) + y * stride_y;
+			for (int x = 0; x < width; x++) {
+				row[x] = static_cast<uint8_t>(x + y + index * 3);
+			}
+		}
+		memset(input_frame_.buffer(kUPlane), 128,
+			input_frame_.allocated_size(kUPlane));
+		memset(input_frame_.buffer(kVPlane), 128,
+			input_frame_.allocated_size(kVPlane));
+		input_frame_.set_timestamp(kTestTimestamp + index * 90000 / kFrameRate);
+	}
+
+	void EncodeFrames(int width, int height, int num_frames) {
+		for (int i = 0; i < num_frames; i++) {
+			FillSyntheticFrame(width, height, i);
+			std::vector<VideoFrameType> frame_types(1,
+				i == 0 ? kKeyFrame : kDeltaFrame);
+			EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK,
+				encoder_->Encode(input_frame_, NULL, &frame_types));
+		}
+	}
+
+	int DecodeFrame(size_t index) {
+		const std::vector<uint8_t>& frame = encode_callback_.frames()[index];
+		EncodedImage encoded_image(const_cast<uint8_t*>(&frame[0]), frame.size(),
+			frame.size());
+		encoded_image._frameType = encode_callback_.frame_type(index);
+		encoded_image._completeFrame = true;
+		encoded_image._timeStamp = kTestTimestamp + index;
+		CodecSpecificInfo codec_specific;
+		memset(&codec_specific, 0, sizeof(codec_specific));
+		codec_specific.codecType = kVideoCodecH264;
+		return decoder_->Decode(encoded_image, false, NULL, &codec_specific, 0);
+	}
+
+	H264UnitTestEncodeCompleteCallback encode_callback_;
+	H264UnitTestDecodeCompleteCallback decode_callback_;
+	scoped_ptr<VideoEncoder> encoder_;
+	scoped_ptr<VideoDecoder> decoder_;
+	I420VideoFrame input_frame_;
+	VideoCodec codec_inst_;
+};
+
+TEST_P(TestH264Impl, EncodeDecode) {
+	const int kNumFrames = 30;
+	SetUpEncodeDecode(352, 288);
+	EncodeFrames(352, 288, kNumFrames);
+	ASSERT_GT(encode_callback_.frames().size(), 2u);
+	for (size_t i = 0; i < encode_callback_.frames().size(); i++) {
+		EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK, DecodeFrame(i));
+	}
+	EXPECT_GT(decode_callback_.decoded_frames(), 0);
+	EXPECT_EQ(352, decode_callback_.last_width());
+	EXPECT_EQ(288, decode_callback_.last_height());
+	if (GetParam() == kX264) {
+		// FFmpeg pictures are handed over without a copy.
+		EXPECT_EQ(decode_callback_.decoded_frames(),
+			decode_callback_.wrapped_frames());
+	}
+}
+
+// Frames kept by the renderer must not be overwritten by later decodes, also
+// once more frames are held than the decoder has pooled pictures.
+TEST_P(TestH264Impl, RetainedFramesStayValid) {
+	const int kNumFrames = 40;
+	SetUpEncodeDecode(320, 240);
+	EncodeFrames(320, 240, kNumFrames);
+	decode_callback_.set_retain_frames(true);
+	for (size_t i = 0; i < encode_callback_.frames().size(); i++) {
+		EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK, DecodeFrame(i));
+	}
+	const std::vector<I420VideoFrame*>& retained = decode_callback_.retained();
+	ASSERT_GT(retained.size(), 0u);
+	for (size_t i = 0; i < retained.size(); i++) {
+		EXPECT_EQ(decode_callback_.retained_checksum(i),
+			LumaChecksum(*retained[i])) << "frame " << i;
+	}
+	// The pictures outlive the decoder.
+	EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK, decoder_->Release());
+	decoder_.reset();
+	for (size_t i = 0; i < retained.size(); i++) {
+		EXPECT_EQ(decode_callback_.retained_checksum(i),
+			LumaChecksum(*retained[i])) << "frame " << i;
+	}
+}
+
+// Noise does not compress, so the key frame is far larger than the 32 kB
+// input buffer the decoder used to have.
+TEST_P(TestH264Impl, DecodesLargeKeyFrame) {
+	// OpenH264 may hold a picture back until a later DecodeFrame2() call, so
+	// the number of pictures returned for a single key frame is not fixed.
+	if (GetParam() != kX264) {
+		return;
+	}
+	const int kWidth = 1280;
+	const int kHeight = 720;
+	codec_inst_.startBitrate = 8000;
+	codec_inst_.maxBitrate = 8000;
+	SetUpEncodeDecode(kWidth, kHeight);
+	FillSyntheticFrame(kWidth, kHeight, 0);
+	uint32_t seed = 1;
+	for (int y = 0; y < kHeight; y++) {
+		uint8_t* row = input_frame_.buffer(kYPlane) + y * input_frame_.stride(kYPlane);
+		for (int x = 0; x < kWidth; x++) {
+			seed = seed * 1103515245 + 12345;
+			row[x] = static_cast<uint8_t>(seed >> 24);
+		}
+	}
+	// The FFmpeg decoder collects the first two frames and decodes them on
+	// the third call, which returns the key frame only.
+	const int kNumFrames = 3;
+	for (int i = 0; i < kNumFrames; i++) {
+		std::vector<VideoFrameType> frame_types(1,
+			i == 0 ? kKeyFrame : kDeltaFrame);
+		input_frame_.set_timestamp(kTestTimestamp + i * 90000 / kFrameRate);
+		EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK,
+			encoder_->Encode(input_frame_, NULL, &frame_types));
+	}
+	ASSERT_EQ(static_cast<size_t>(kNumFrames), encode_callback_.frames().size());
+	EXPECT_GT(encode_callback_.frames()[0].size(), 32768u);
+	for (int i = 0; i < kNumFrames; i++) {
+		EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK, DecodeFrame(i));
+	}
+	ASSERT_EQ(1, decode_callback_.decoded_frames());
+	EXPECT_EQ(kWidth, decode_callback_.last_width());
+	EXPECT_EQ(kHeight, decode_callback_.last_height());
+}
+
+TEST_P(TestH264Impl, SetRatesRequiresInitEncode) {
+	EXPECT_EQ(WEBRTC_VIDEO_CODEC_UNINITIALIZED, encoder_->SetRates(300, 30));
+}
+
+TEST_P(TestH264Impl, SetRatesLowersBitrate) {
+	const int kWidth = 352;
+	const int kHeight = 288;
+	const int kNumFrames = 60;
+	codec_inst_.startBitrate = 1000;
+	SetUpEncodeDecode(kWidth, kHeight);
+	EncodeFrames(kWidth, kHeight, kNumFrames);
+	size_t high_rate_size = encode_callback_.AverageFrameSize(kNumFrames / 2);
+
+	EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK, encoder_->SetRates(100, kFrameRate));
+	encode_callback_.Reset();
+	EncodeFrames(kWidth, kHeight, kNumFrames);
+	size_t low_rate_size = encode_callback_.AverageFrameSize(kNumFrames / 2);
+	EXPECT_GT(low_rate_size, 0u);
+	EXPECT_LT(low_rate_size, high_rate_size / 2);
+}
+
+TEST_P(TestH264Impl, LossyChannelKeepsDecoding) {
+	SetUpEncodeDecode(320, 240);
+	// 20% loss with a long round trip starts intra refresh waves.
+	EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK, encoder_->SetChannelParameters(51, 400));
+	EncodeFrames(320, 240, 30);
+	ASSERT_GT(encode_callback_.frames().size(), 2u);
+	for (size_t i = 0; i < encode_callback_.frames().size(); i++) {
+		EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK, DecodeFrame(i));
+	}
+	EXPECT_GT(decode_callback_.decoded_frames(), 0);
+}
+
+TEST_P(TestH264Impl, DecoderFollowsResolutionChange) {
+	const int kNumFrames = 10;
+	SetUpEncodeDecode(320, 240);
+	EncodeFrames(320, 240, kNumFrames);
+	size_t first_stream_frames = encode_callback_.frames().size();
+	for (size_t i = 0; i < first_stream_frames; i++) {
+		EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK, DecodeFrame(i));
+	}
+	EXPECT_EQ(320, decode_callback_.last_width());
+
+	// Restart the encoder at a new size; the decoder is not re-initialized
+	// and has to rebuild its output pictures on its own.
+	codec_inst_.width = 640;
+	codec_inst_.height = 480;
+	EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK,
+		encoder_->InitEncode(&codec_inst_, 1, 1440));
+	EncodeFrames(640, 480, kNumFrames);
+	for (size_t i = first_stream_frames; i < encode_callback_.frames().size();
+		i++) {
+		EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK, DecodeFrame(i));
+	}
+	EXPECT_EQ(640, decode_callback_.last_width());
+	EXPECT_EQ(480, decode_callback_.last_height());
+}
+
+TEST_P(TestH264Impl, NalUnitsFitPayloadSize) {
+	// Only x264 is configured with a slice size limit.
+	if (GetParam() != kX264) {
+		return;
+	}
+	const size_t kMaxPayloadSize = 1200;
+	codec_inst_.width = 640;
+	codec_inst_.height = 480;
+	codec_inst_.startBitrate = 2000;
+	codec_inst_.maxBitrate = 2000;
+	EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK,
+		encoder_->InitEncode(&codec_inst_, 4, kMaxPayloadSize));
+	EncodeFrames(640, 480, 10);
+	// Realtime encoding returns every frame from its own Encode() call.
+	ASSERT_EQ(10u, encode_callback_.frames().size());
+	EXPECT_LE(encode_callback_.max_nal_size(), kMaxPayloadSize);
+}
+
+// Encodes synthetic 720p and 1080p sources with the realtime profile and
+// reports the time spent in Encode() and the resulting frame rate for each
+// thread count.
+TEST_P(TestH264Impl, DISABLED_EncodeLatencyVersusThreads) {
+	const int kSizes[][2] = { { 1280, 720 }, { 1920, 1080 } };
+	const int kThreadCounts[] = { 1, 2, 4, 8 };
+	const int kNumFrames = 150;
+	codec_inst_.startBitrate = 2500;
+	codec_inst_.maxBitrate = 2500;
+	for (size_t s = 0; s < sizeof(kSizes) / sizeof(kSizes[0]); s++) {
+		const int width = kSizes[s][0];
+		const int height = kSizes[s][1];
+		codec_inst_.width = width;
+		codec_inst_.height = height;
+		for (size_t t = 0; t < sizeof(kThreadCounts) / sizeof(kThreadCounts[0]);
+			t++) {
+			EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK,
+				encoder_->InitEncode(&codec_inst_, kThreadCounts[t], 1200));
+			int64_t total_us = 0;
+			int64_t max_us = 0;
+			for (int i = 0; i < kNumFrames; i++) {
+				FillSyntheticFrame(width, height, i);
+				std::vector<VideoFrameType> frame_types(1,
+					i == 0 ? kKeyFrame : kDeltaFrame);
+				int64_t start_us = TickTime::MicrosecondTimestamp();
+				EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK,
+					encoder_->Encode(input_frame_, NULL, &frame_types));
+				int64_t frame_us = TickTime::MicrosecondTimestamp() - start_us;
+				total_us += frame_us;
+				if (frame_us > max_us) {
+					max_us = frame_us;
+				}
+			}
+			printf("H264 encode %dx%d, %d threads: %.3f ms/frame (max %.3f), "
+				"%.1f fps\n", width, height, kThreadCounts[t],
+				total_us / 1000.0 / kNumFrames, max_us / 1000.0,
+				kNumFrames * 1000000.0 / total_us);
+		}
+	}
+}
+
+// Decodes a 720p stream and reports the time per frame and the number of
+// heap allocations made once the decoder has warmed up.
+TEST_P(TestH264Impl, DISABLED_SteadyStateDecodePerformance) {
+	const int kWidth = 1280;
+	const int kHeight = 720;
+	const int kNumFrames = 300;
+	const size_t kWarmupFrames = 10;
+	SetUpEncodeDecode(kWidth, kHeight);
+	EncodeFrames(kWidth, kHeight, kNumFrames);
+	const size_t num_encoded = encode_callback_.frames().size();
+	ASSERT_GT(num_encoded, kWarmupFrames);
+	for (size_t i = 0; i < kWarmupFrames; i++) {
+		EXPECT_EQ(WEBRTC_VIDEO_CODEC_OK, DecodeFrame(i));
+	}
+
+	g_allocation_count = 0;
+	g_count_allocations = true;
+	int64_t start_us = TickTime::MicrosecondTimestamp();
+	for (size_t i = kWarmupFrames; i < num_encoded; i++) {
+		DecodeFrame(i);
+	}
+	int64_t elapsed_us = TickTime::MicrosecondTimestamp() - start_us;
+	g_count_allocations = false;
+
+	size_t measured = num_encoded - kWarmupFrames;
+	printf("H264 decode %dx%d: %.3f ms/frame, %d allocations in %d frames\n",
+		kWidth, kHeight, elapsed_us / 1000.0 / measured, g_allocation_count,
+		static_cast<int>(measured));
+	EXPECT_EQ(0, g_allocation_count);
+}
+
+INSTANTIATE_TEST_CASE_P(H264, TestH264Impl,
+	::testing::Values(kOpenH264, kX264));
+
+}  // namespace webrtc
+
@@ -0,0 +1,640 @@
+/*
+ * Headless multi-channel load test built from the loopback sample in main.cc.
+ *
+ * Every channel is fed through ViEExternalCapture by one shared synthetic (or
+ * looped .yuv file) I420 source, sent to itself over loopback UDP on its own
+ * port pair and rendered into a counting ExternalRenderer. Once a second the
+ * aggregate encode/decode frame rates, the process CPU time divided by the
+ * channel count and the capture-to-render latency are printed, to find how
+ * many concurrent calls a machine sustains.
+ *
+ * --codec takes a comma separated list of codec names which are assigned to
+ * the channels in turn, so codecs can be compared within one run. With
+ * --fallback a channel whose encoder overuses the CPU switches to the next
+ * cheaper codec.
+ *
+ * Usage: load_test [--channels N] [--width W] [--height H] [--fps F]
+ *                  [--bitrate KBPS] [--duration SECONDS] [--base_port PORT]
+ *                  [--file INPUT.yuv] [--codec NAME[,NAME...]] [--fallback]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#if defined(WEBRTC_POSIX)
+#include <sys/resource.h>
+#include <sys/time.h>
+#endif
+
+#include "webrtc/system_wrappers/interface/atomic32.h"
+#include "webrtc/system_wrappers/interface/clock.h"
+#include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
+#include "webrtc/system_wrappers/interface/event_wrapper.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/system_wrappers/interface/sleep.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+#include "webrtc/video_engine/vie_base.h"
+#include "webrtc/video_engine/vie_capture.h"
+#include "webrtc/video_engine/vie_codec.h"
+#include "webrtc/video_engine/vie_external_codec.h"
+#include "webrtc/video_engine/vie_network.h"
+#include "webrtc/video_engine/vie_render.h"
+#include "webrtc/video_engine/vie_rtp_rtcp.h"
+
+#include "codec_registry.h"
+#include "video_channel_transport.h"
+
+using namespace webrtc;
+
+struct LoadTestOptions {
+	LoadTestOptions()
+		: channels(4),
+		width(640),
+		height(480),
+		fps(30),
+		bitrate(500),
+		duration(30),
+		base_port(6000),
+		file(NULL),
+		fallback(false) {}
+
+	int channels;
+	int width;
+	int height;
+	int fps;
+	int bitrate;
+	int duration;
+	int base_port;
+	const char* file;
+	std::vector<const CodecInfo*> codecs;
+	bool fallback;
+};
+
+// Parses a comma separated list of codec names.
+static bool ParseCodecs(const char* value,
+	std::vector<const CodecInfo*>* codecs) {
+	codecs->clear();
+	const char* name = value;
+	while (*name != '\0') {
+		const char* end = strchr(name, ',');
+		size_t length = end != NULL ? end - name : strlen(name);
+		char buffer[32];
+		if (length == 0 || length >= sizeof(buffer)) {
+			return false;
+		}
+		memcpy(buffer, name, length);
+		buffer[length] = '\0';
+		const CodecInfo* codec = CodecRegistry::FindCodec(buffer);
+		if (codec == NULL) {
+			printf("ERROR: unknown codec %s\n", buffer);
+			return false;
+		}
+		codecs->push_back(codec);
+		name += end != NULL ? length + 1 : length;
+	}
+	return !codecs->empty();
+}
+
+static bool ParseOptions(int argc, char* argv[], LoadTestOptions* options) {
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--fallback") == 0) {
+			options->fallback = true;
+			continue;
+		}
+		if (i + 1 >= argc) {
+			printf("ERROR: missing value for %s\n", argv[i]);
+			return false;
+		}
+		const char* value = argv[++i];
+		if (strcmp(argv[i - 1], "--channels") == 0) {
+			options->channels = atoi(value);
+		} else if (strcmp(argv[i - 1], "--width") == 0) {
+			options->width = atoi(value);
+		} else if (strcmp(argv[i - 1], "--height") == 0) {
+			options->height = atoi(value);
+		} else if (strcmp(argv[i - 1], "--fps") == 0) {
+			options->fps = atoi(value);
+		} else if (strcmp(argv[i - 1], "--bitrate") == 0) {
+			options->bitrate = atoi(value);
+		} else if (strcmp(argv[i - 1], "--duration") == 0) {
+			options->duration = atoi(value);
+		} else if (strcmp(argv[i - 1], "--base_port") == 0) {
+			options->base_port = atoi(value);
+		} else if (strcmp(argv[i - 1], "--file") == 0) {
+			options->file = value;
+		} else if (strcmp(argv[i - 1], "--codec") == 0) {
+			if (!ParseCodecs(value, &options->codecs)) {
+				return false;
+			}
+		} else {
+			printf("ERROR: unknown option %s\n", argv[i - 1]);
+			return false;
+		}
+	}
+	if (options->codecs.empty()) {
+		options->codecs.push_back(CodecRegistry::FindCodec("x264"));
+	}
+	if (options->channels < 1 || options->width < 16 || options->height < 16 ||
+		options->fps < 1 || options->bitrate < 1 || options->duration < 1 ||
+		options->base_port < 1024 ||
+		options->base_port + 2 * options->channels > 65535) {
+		printf("ERROR: invalid options\n");
+		return false;
+	}
+	return true;
+}
+
+// Produces the I420 frames delivered to every channel: a moving gradient, or
+// the frames of a raw .yuv file played in a loop.
+class I420Source {
+public:
+	I420Source(int width, int height)
+		: width_(width),
+		height_(height),
+		frame_number_(0),
+		file_(NULL),
+		buffer_(width * height + 2 * ((width + 1) / 2) * ((height + 1) / 2)) {}
+
+	~I420Source() {
+		if (file_ != NULL) {
+			fclose(file_);
+		}
+	}
+
+	bool OpenFile(const char* file_name) {
+		file_ = fopen(file_name, "rb");
+		return file_ != NULL;
+	}
+
+	// Fills |frame| with planes owned by this source, valid until the next
+	// call.
+	void NextFrame(ViEVideoFrameI420* frame) {
+		int half_width = (width_ + 1) / 2;
+		int half_height = (height_ + 1) / 2;
+		uint8_t* y_plane = &buffer_[0];
+		uint8_t* u_plane = y_plane + width_ * height_;
+		uint8_t* v_plane = u_plane + half_width * half_height;
+		if (file_ != NULL) {
+			if (fread(y_plane, 1, buffer_.size(), file_) != buffer_.size()) {
+				rewind(file_);
+				if (fread(y_plane, 1, buffer_.size(), file_) != buffer_.size()) {
+					memset(y_plane, 0, buffer_.size());
+				}
+			}
+		} else {
+			for (int y = 0; y < height_; y++) {
+				uint8_t* row = y_plane + y * width_;
+				for (int x = 0; x < width_; x++) {
+					row[x] = static_cast<uint8_t>(x + y + frame_number_ * 3);
+				}
+			}
+			memset(u_plane, 128, half_width * half_height);
+			memset(v_plane, 128, half_width * half_height);
+		}
+		frame_number_++;
+
+		frame->y_plane = y_plane;
+		frame->u_plane = u_plane;
+		frame->v_plane = v_plane;
+		frame->y_pitch = width_;
+		frame->u_pitch = half_width;
+		frame->v_pitch = half_width;
+		frame->width = static_cast<unsigned short>(width_);
+		frame->height = static_cast<unsigned short>(height_);
+	}
+
+private:
+	int width_;
+	int height_;
+	int frame_number_;
+	FILE* file_;
+	std::vector<uint8_t> buffer_;
+};
+
+// Counts rendered frames and measures capture-to-render latency. The capture
+// NTP time is known once the first RTCP sender report has arrived; since
+// sender and receiver share this machine's clock it can be compared directly.
+class LoadTestRenderer : public ExternalRenderer {
+public:
+	LoadTestRenderer()
+		: crit_(CriticalSectionWrapper::CreateCriticalSection()),
+		clock_(Clock::GetRealTimeClock()),
+		frames_(0),
+		latency_sum_ms_(0),
+		latency_count_(0),
+		max_latency_ms_(0) {}
+
+	virtual int FrameSizeChange(unsigned int width,
+		unsigned int height,
+		unsigned int number_of_streams) OVERRIDE {
+		return 0;
+	}
+
+	virtual int DeliverFrame(unsigned char* buffer,
+		int buffer_size,
+		uint32_t timestamp,
+		int64_t ntp_time_ms,
+		int64_t render_time_ms,
+		void* handle) OVERRIDE {
+		int64_t now_ms = clock_->CurrentNtpInMilliseconds();
+		CriticalSectionScoped cs(crit_.get());
+		frames_++;
+		if (ntp_time_ms > 0) {
+			int64_t latency_ms = now_ms - ntp_time_ms;
+			latency_sum_ms_ += latency_ms;
+			latency_count_++;
+			if (latency_ms > max_latency_ms_) {
+				max_latency_ms_ = latency_ms;
+			}
+		}
+		return 0;
+	}
+
+	virtual bool IsTextureSupported() OVERRIDE { return false; }
+
+	// Adds the statistics gathered since the last call to the arguments.
+	void CollectStats(int* frames, int64_t* latency_sum_ms, int* latency_count,
+		int64_t* max_latency_ms) {
+		CriticalSectionScoped cs(crit_.get());
+		*frames += frames_;
+		*latency_sum_ms += latency_sum_ms_;
+		*latency_count += latency_count_;
+		if (max_latency_ms_ > *max_latency_ms) {
+			*max_latency_ms = max_latency_ms_;
+		}
+		frames_ = 0;
+		latency_sum_ms_ = 0;
+		latency_count_ = 0;
+		max_latency_ms_ = 0;
+	}
+
+private:
+	scoped_ptr<CriticalSectionWrapper> crit_;
+	Clock* clock_;
+	int frames_;
+	int64_t latency_sum_ms_;
+	int latency_count_;
+	int64_t max_latency_ms_;
+};
+
+// Remembers overuse reports from VideoEngine's thread until the report loop
+// acts on them.
+class OveruseMonitor : public CpuOveruseObserver {
+public:
+	virtual void OveruseDetected() OVERRIDE { overused_.CompareExchange(1, 0); }
+	virtual void NormalUsage() OVERRIDE {}
+
+	// Returns true once per overuse report.
+	bool TakeOveruse() { return overused_.CompareExchange(0, 1); }
+
+private:
+	Atomic32 overused_;
+};
+
+struct LoadTestChannel {
+	LoadTestChannel()
+		: channel(-1),
+		capture_id(-1),
+		external_capture(NULL),
+		transport(NULL),
+		codecs(NULL),
+		sent_frames(0) {
+		memset(&settings, 0, sizeof(settings));
+	}
+
+	int channel;
+	int capture_id;
+	ViEExternalCapture* external_capture;
+	VideoChannelTransport* transport;
+	ChannelCodecs* codecs;
+	// Resolution, frame rate and bit rates requested for every codec.
+	VideoCodec settings;
+	LoadTestRenderer renderer;
+	OveruseMonitor overuse;
+	// Key plus delta frames sent at the last report.
+	unsigned int sent_frames;
+};
+
+// Delivers one source frame to every channel per frame interval.
+class CaptureDriver {
+public:
+	CaptureDriver(I420Source* source, std::vector<LoadTestChannel*>* channels,
+		int fps)
+		: source_(source),
+		channels_(channels),
+		fps_(fps),
+		timer_(EventWrapper::Create()),
+		thread_(ThreadWrapper::CreateThread(Run, this, kHighPriority,
+			"LoadTestCapture")) {}
+
+	~CaptureDriver() { Stop(); }
+
+	bool Start() {
+		unsigned int thread_id = 0;
+		return timer_->StartTimer(true, 1000 / fps_) && thread_->Start(thread_id);
+	}
+
+	void Stop() {
+		thread_->SetNotAlive();
+		timer_->Set();
+		thread_->Stop();
+		timer_->StopTimer();
+	}
+
+private:
+	static bool Run(void* obj) {
+		return static_cast<CaptureDriver*>(obj)->Process();
+	}
+
+	bool Process() {
+		timer_->Wait(1000);
+		ViEVideoFrameI420 frame;
+		source_->NextFrame(&frame);
+		for (size_t i = 0; i < channels_->size(); i++) {
+			(*channels_)[i]->external_capture->IncomingFrameI420(frame, 0);
+		}
+		return true;
+	}
+
+	I420Source* source_;
+	std::vector<LoadTestChannel*>* channels_;
+	int fps_;
+	scoped_ptr<EventWrapper> timer_;
+	scoped_ptr<ThreadWrapper> thread_;
+};
+
+// User plus system CPU time of the whole process, or -1 if unavailable.
+static int64_t ProcessCpuTimeUs() {
+#if defined(WEBRTC_POSIX)
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) {
+		return -1;
+	}
+	return static_cast<int64_t>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) *
+		1000000 + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+#else
+	return -1;
+#endif
+}
+
+static bool SetUpChannel(const LoadTestOptions& options, int index,
+	ViEBase* base, ViECapture* capture, ViECodec* codec,
+	ViEExternalCodec* external_codec, ViENetwork* network,
+	ViERender* render, ViERTP_RTCP* rtp_rtcp, LoadTestChannel* channel) {
+	if (base->CreateChannel(channel->channel) == -1) {
+		printf("ERROR in ViEBase::CreateChannel\n");
+		return false;
+	}
+	if (capture->AllocateExternalCaptureDevice(channel->capture_id,
+		channel->external_capture) == -1) {
+		printf("ERROR in ViECapture::AllocateExternalCaptureDevice\n");
+		return false;
+	}
+	if (capture->ConnectCaptureDevice(channel->capture_id,
+		channel->channel) == -1) {
+		printf("ERROR in ViECapture::ConnectCaptureDevice\n");
+		return false;
+	}
+
+	if (rtp_rtcp->SetRTCPStatus(channel->channel,
+		kRtcpCompound_RFC4585) == -1 ||
+		rtp_rtcp->SetKeyFrameRequestMethod(channel->channel,
+		kViEKeyFrameRequestPliRtcp) == -1 ||
+		rtp_rtcp->SetRembStatus(channel->channel, true, true) == -1) {
+		printf("ERROR in ViERTP_RTCP settings\n");
+		return false;
+	}
+
+	VideoCodec& settings = channel->settings;
+	settings.width = options.width;
+	settings.height = options.height;
+	settings.startBitrate = options.bitrate;
+	settings.targetBitrate = options.bitrate;
+	settings.minBitrate = options.bitrate / 2;
+	settings.maxBitrate = options.bitrate;
+	settings.maxFramerate = options.fps;
+	const CodecInfo* send_codec = options.codecs[index % options.codecs.size()];
+	channel->codecs = new ChannelCodecs(codec, external_codec, channel->channel);
+	if (channel->codecs->SetUpReceiveCodecs(settings) == -1 ||
+		channel->codecs->SetSendCodec(send_codec, settings) == -1) {
+		printf("ERROR setting up codec %s\n", send_codec->name);
+		return false;
+	}
+	if (options.fallback &&
+		base->RegisterCpuOveruseObserver(channel->channel,
+		&channel->overuse) == -1) {
+		printf("ERROR in ViEBase::RegisterCpuOveruseObserver\n");
+		return false;
+	}
+
+	if (render->AddRenderer(channel->channel, kVideoI420,
+		&channel->renderer) == -1 ||
+		render->StartRender(channel->channel) == -1) {
+		printf("ERROR in ViERender::AddRenderer\n");
+		return false;
+	}
+
+	// RTCP uses the port above each RTP port.
+	unsigned short rtp_port =
+		static_cast<unsigned short>(options.base_port + 2 * index);
+	channel->transport = new VideoChannelTransport(network, channel->channel);
+	if (channel->transport->SetLocalReceiver(rtp_port) == -1 ||
+		channel->transport->SetSendDestination("127.0.0.1", rtp_port) == -1) {
+		printf("ERROR in VideoChannelTransport on port %d\n", rtp_port);
+		return false;
+	}
+
+	if (base->StartReceive(channel->channel) == -1 ||
+		base->StartSend(channel->channel) == -1) {
+		printf("ERROR in ViEBase::StartReceive/StartSend\n");
+		return false;
+	}
+	return true;
+}
+
+static void TearDownChannel(ViEBase* base, ViECapture* capture,
+	ViERender* render, LoadTestChannel* channel) {
+	if (channel->channel == -1) {
+		return;
+	}
+	base->RegisterCpuOveruseObserver(channel->channel, NULL);
+	base->StopReceive(channel->channel);
+	base->StopSend(channel->channel);
+	render->StopRender(channel->channel);
+	render->RemoveRenderer(channel->channel);
+	if (channel->capture_id != -1) {
+		capture->DisconnectCaptureDevice(channel->channel);
+		capture->ReleaseCaptureDevice(channel->capture_id);
+	}
+	delete channel->codecs;
+	base->DeleteChannel(channel->channel);
+	delete channel->transport;
+}
+
+// Moves channels whose encoder overused the CPU to the next cheaper codec.
+static void FallBackOnOveruse(const std::vector<LoadTestChannel*>& channels) {
+	for (size_t i = 0; i < channels.size(); i++) {
+		LoadTestChannel* channel = channels[i];
+		if (!channel->overuse.TakeOveruse()) {
+			continue;
+		}
+		const CodecInfo* current = channel->codecs->send_codec();
+		const CodecInfo* cheaper = CodecRegistry::CheaperCodec(current);
+		if (cheaper == NULL) {
+			continue;
+		}
+		if (channel->codecs->SetSendCodec(cheaper, channel->settings) == -1) {
+			printf("ERROR switching channel %d to %s\n", channel->channel,
+				cheaper->name);
+			continue;
+		}
+		printf("channel %d overused the CPU, switched from %s to %s\n",
+			channel->channel, current->name, cheaper->name);
+	}
+}
+
+// Prints one line of aggregate statistics for the last |interval_ms|.
+static void Report(ViEBase* base, ViECodec* codec,
+	const std::vector<LoadTestChannel*>& channels, int64_t interval_ms,
+	int64_t cpu_us) {
+	unsigned int sent_frames = 0;
+	int rendered_frames = 0;
+	int64_t latency_sum_ms = 0;
+	int latency_count = 0;
+	int64_t max_latency_ms = 0;
+	int encode_usage_sum = 0;
+	int encode_usage_count = 0;
+	for (size_t i = 0; i < channels.size(); i++) {
+		LoadTestChannel* channel = channels[i];
+		unsigned int key_frames = 0;
+		unsigned int delta_frames = 0;
+		codec->GetSendCodecStastistics(channel->channel, key_frames, delta_frames);
+		sent_frames += key_frames + delta_frames - channel->sent_frames;
+		channel->sent_frames = key_frames + delta_frames;
+		channel->renderer.CollectStats(&rendered_frames, &latency_sum_ms,
+			&latency_count, &max_latency_ms);
+		CpuOveruseMetrics metrics;
+		if (base->GetCpuOveruseMetrics(channel->channel, &metrics) == 0 &&
+			metrics.encode_usage_percent >= 0) {
+			encode_usage_sum += metrics.encode_usage_percent;
+			encode_usage_count++;
+		}
+	}
+
+	double seconds = interval_ms / 1000.0;
+	int num_channels = static_cast<int>(channels.size());
+	printf("%d ch: encode %.1f fps (%.1f/ch), decode %.1f fps (%.1f/ch)",
+		num_channels, sent_frames / seconds, sent_frames / seconds / num_channels,
+		rendered_frames / seconds, rendered_frames / seconds / num_channels);
+	if (cpu_us >= 0) {
+		// getrusage() only reports the whole process, so this is an average over
+		// the channels rather than a per-channel measurement.
+		printf(", process cpu / %d ch %.1f%%", num_channels,
+			cpu_us / 10.0 / interval_ms / num_channels);
+	}
+	if (encode_usage_count > 0) {
+		printf(", encode usage %d%%", encode_usage_sum / encode_usage_count);
+	}
+	if (latency_count > 0) {
+		printf(", latency avg %d ms max %d ms",
+			static_cast<int>(latency_sum_ms / latency_count),
+			static_cast<int>(max_latency_ms));
+	}
+	printf("\n");
+}
+
+int main(int argc, char* argv[]) {
+	LoadTestOptions options;
+	if (!ParseOptions(argc, argv, &options)) {
+		return -1;
+	}
+
+	I420Source source(options.width, options.height);
+	if (options.file != NULL && !source.OpenFile(options.file)) {
+		printf("ERROR: cannot open %s\n", options.file);
+		return -1;
+	}
+
+	VideoEngine* vie = VideoEngine::Create();
+	if (vie == NULL) {
+		printf("ERROR in VideoEngine::Create\n");
+		return -1;
+	}
+	ViEBase* base = ViEBase::GetInterface(vie);
+	if (base == NULL || base->Init() == -1) {
+		printf("ERROR in ViEBase::Init\n");
+		return -1;
+	}
+	ViECapture* capture = ViECapture::GetInterface(vie);
+	ViECodec* codec = ViECodec::GetInterface(vie);
+	ViEExternalCodec* external_codec = ViEExternalCodec::GetInterface(vie);
+	ViENetwork* network = ViENetwork::GetInterface(vie);
+	ViERender* render = ViERender::GetInterface(vie);
+	ViERTP_RTCP* rtp_rtcp = ViERTP_RTCP::GetInterface(vie);
+	if (capture == NULL || codec == NULL || external_codec == NULL ||
+		network == NULL || render == NULL || rtp_rtcp == NULL) {
+		printf("ERROR in VideoEngine GetInterface\n");
+		return -1;
+	}
+
+	std::vector<LoadTestChannel*> channels;
+	bool ok = true;
+	for (int i = 0; i < options.channels && ok; i++) {
+		LoadTestChannel* channel = new LoadTestChannel();
+		channels.push_back(channel);
+		ok = SetUpChannel(options, i, base, capture, codec, external_codec,
+			network, render, rtp_rtcp, channel);
+	}
+
+	if (ok) {
+		printf("%d channels of %dx%d@%d fps, %d kbps, ports %d-%d\n",
+			options.channels, options.width, options.height, options.fps,
+			options.bitrate, options.base_port,
+			options.base_port + 2 * options.channels - 1);
+		CaptureDriver driver(&source, &channels, options.fps);
+		if (driver.Start()) {
+			int64_t last_ms = TickTime::MillisecondTimestamp();
+			int64_t last_cpu_us = ProcessCpuTimeUs();
+			for (int second = 0; second < options.duration; second++) {
+				SleepMs(1000);
+				int64_t now_ms = TickTime::MillisecondTimestamp();
+				int64_t cpu_us = ProcessCpuTimeUs();
+				Report(base, codec, channels, now_ms - last_ms,
+					cpu_us >= 0 && last_cpu_us >= 0 ? cpu_us - last_cpu_us : -1);
+				last_ms = now_ms;
+				last_cpu_us = cpu_us;
+				if (options.fallback) {
+					FallBackOnOveruse(channels);
+				}
+			}
+			driver.Stop();
+		} else {
+			printf("ERROR: cannot start the capture thread\n");
+			ok = false;
+		}
+	}
+
+	for (size_t i = 0; i < channels.size(); i++) {
+		TearDownChannel(base, capture, render, channels[i]);
+		delete channels[i];
+	}
+
+	int remaining_interfaces = capture->Release();
+	remaining_interfaces += codec->Release();
+	remaining_interfaces += external_codec->Release();
+	remaining_interfaces += network->Release();
+	remaining_interfaces += render->Release();
+	remaining_interfaces += rtp_rtcp->Release();
+	remaining_interfaces += base->Release();
+	if (remaining_interfaces > 0) {
+		printf("ERROR: Could not release all interfaces\n");
+		return -1;
+	}
+	if (!VideoEngine::Delete(vie)) {
+		printf("ERROR in VideoEngine::Delete\n");
+		return -1;
+	}
+	return ok ? 0 : -1;
+}
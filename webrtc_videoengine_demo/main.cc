@@ -18,15 +18,11 @@
 #include "webrtc/modules/video_capture/include/video_capture_factory.h"
 #include "webrtc/video_engine/vie_render.h"
 #include "webrtc/video_engine/vie_external_codec.h"
-#include "webrtc/test/channel_transport/udp_transport.h"
 #include "webrtc/video_engine/vie_autotest_window_manager_interface.h"
 #include "webrtc/video_engine/vie_window_creator.h"
 
-#include "main.h"
-
-#if USEOPENH264 || USEX264
-#include "h264.h"
-#endif
+#include "codec_registry.h"
+#include "video_channel_transport.h"
 
 #pragma comment(lib,"audio_coding_module.lib")
 #pragma comment(lib,"audio_conference_mixer.lib")
@@ -90,84 +86,8 @@
 
 using namespace webrtc;
 
-class VideoChannelTransport : public webrtc::test::UdpTransportData {
-public:
-	VideoChannelTransport(ViENetwork* vie_network, int channel);
-
-	virtual  ~VideoChannelTransport();
-
-	// Start implementation of UdpTransportData.
-	virtual void IncomingRTPPacket(const int8_t* incoming_rtp_packet,
-		const int32_t packet_length,
-		const char* /*from_ip*/,
-		const uint16_t /*from_port*/) OVERRIDE;
-
-	virtual void IncomingRTCPPacket(const int8_t* incoming_rtcp_packet,
-		const int32_t packet_length,
-		const char* /*from_ip*/,
-		const uint16_t /*from_port*/) OVERRIDE;
-	// End implementation of UdpTransportData.
-
-	// Specifies the ports to receive RTP packets on.
-	int SetLocalReceiver(uint16_t rtp_port);
-
-	// Specifies the destination port and IP address for a specified channel.
-	int SetSendDestination(const char* ip_address, uint16_t rtp_port);
-
-private:
-	int channel_;
-	ViENetwork* vie_network_;
-	webrtc::test::UdpTransport* socket_transport_;
-};
-
-VideoChannelTransport::VideoChannelTransport(ViENetwork* vie_network,
-	int channel)
-	: channel_(channel),
-	vie_network_(vie_network) {
-	uint8_t socket_threads = 1;
-	socket_transport_ = webrtc::test::UdpTransport::Create(channel, socket_threads);
-	int registered = vie_network_->RegisterSendTransport(channel,
-		*socket_transport_);
-}
-
-VideoChannelTransport::~VideoChannelTransport() {
-	vie_network_->DeregisterSendTransport(channel_);
-	webrtc::test::UdpTransport::Destroy(socket_transport_);
-}
-
-void VideoChannelTransport::IncomingRTPPacket(
-	const int8_t* incoming_rtp_packet,
-	const int32_t packet_length,
-	const char* /*from_ip*/,
-	const uint16_t /*from_port*/) {
-	vie_network_->ReceivedRTPPacket(
-		channel_, incoming_rtp_packet, packet_length, PacketTime());
-}
-
-void VideoChannelTransport::IncomingRTCPPacket(
-	const int8_t* incoming_rtcp_packet,
-	const int32_t packet_length,
-	const char* /*from_ip*/,
-	const uint16_t /*from_port*/) {
-	vie_network_->ReceivedRTCPPacket(channel_, incoming_rtcp_packet,
-		packet_length);
-}
-
-int VideoChannelTransport::SetLocalReceiver(uint16_t rtp_port) {
-	int return_value = socket_transport_->InitializeReceiveSockets(this,
-		rtp_port);
-	if (return_value == 0) {
-		return socket_transport_->StartReceiving(500);
-	}
-	return return_value;
-}
-
-int VideoChannelTransport::SetSendDestination(const char* ip_address,
-	uint16_t rtp_port) {
-	return socket_transport_->InitializeSendSockets(ip_address, rtp_port);
-}
-
-int VideoEngineSample(void* window1, void* window2)
+int VideoEngineSample(void* window1, void* window2,
+	const webrtc::CodecInfo* codec)
 {
 
 	int error = 0;
@@ -374,49 +294,37 @@ int VideoEngineSample(void* window1, void* window2)
 		return -1;
 	}
 
-#if USEOPENH264 || USEX264
-	webrtc::H264Encoder *h264encoder = webrtc::H264Encoder::Create();
-	webrtc::H264Decoder *h264decoder = webrtc::H264Decoder::Create();
-
 	webrtc::ViEExternalCodec* external_codec = webrtc::ViEExternalCodec
 		::GetInterface(ptrViE);
-	external_codec->RegisterExternalSendCodec(videoChannel, 88,
-		h264encoder, false);
-	external_codec->RegisterExternalReceiveCodec(videoChannel,
-		88, h264decoder, false);
-#endif
-
-	VideoCodec videoCodec;
-
-	int numOfVeCodecs = ptrViECodec->NumberOfCodecs();
-	for (int i = 0; i<numOfVeCodecs; ++i)
+	if (external_codec == NULL)
 	{
-		if (ptrViECodec->GetCodec(i, videoCodec) != -1)
-		{
-#if USEOPENH264 || USEX264
-			if (videoCodec.codecType == kVideoCodecH264)
-				break;
-#endif
-#if USEVP8
-			if (videoCodec.codecType == kVideoCodecVP8)
-				break;
-#endif
-		}
+		printf("ERROR in ViEExternalCodec::GetInterface\n");
+		return -1;
 	}
 
+	VideoCodec videoCodec;
+	memset(&videoCodec, 0, sizeof(videoCodec));
 	videoCodec.targetBitrate = 256;
 	videoCodec.minBitrate = 200;
 	videoCodec.maxBitrate = 300;
-#if USEOPENH264 || USEX264
-	videoCodec.plType = 88;
-#endif
 	videoCodec.maxFramerate = 25;
 
-	error = ptrViECodec->SetSendCodec(videoChannel, videoCodec);
-	assert(error != -1);
-
-	error = ptrViECodec->SetReceiveCodec(videoChannel, videoCodec);
-	assert(error != -1);
+	webrtc::ChannelCodecs* channelCodecs = new webrtc::ChannelCodecs(
+		ptrViECodec, external_codec, videoChannel);
+	error = channelCodecs->SetUpReceiveCodecs(videoCodec);
+	if (error == -1)
+	{
+		printf("ERROR in ChannelCodecs::SetUpReceiveCodecs\n");
+		return -1;
+	}
+	error = channelCodecs->SetSendCodec(codec, videoCodec);
+	if (error == -1)
+	{
+		printf("ERROR in ChannelCodecs::SetSendCodec\n");
+		return -1;
+	}
+	printf("Sending %s with payload type %d\n", codec->name,
+		codec->payload_type);
 	//
 	// Address settings
 	//
@@ -485,6 +393,8 @@ int VideoEngineSample(void* window1, void* window2)
 		return -1;
 	}
 
+	delete channelCodecs;
+
 	error = ptrViERender->StopRender(captureId);
 	if (error == -1)
 	{
@@ -550,9 +460,7 @@ int VideoEngineSample(void* window1, void* window2)
 	remainingInterfaces += ptrViERender->Release();
 	remainingInterfaces += ptrViENetwork->Release();
 	remainingInterfaces += ptrViEBase->Release();
-#if USEOPENH264 || USEX264
 	remainingInterfaces += external_codec->Release();
-#endif
 	if (remainingInterfaces > 0)
 	{
 		printf("ERROR: Could not release all interfaces\n");
@@ -572,12 +480,27 @@ int VideoEngineSample(void* window1, void* window2)
 
 int main(int argc, char* argvc[])
 {
+	// The codec to send with may be given by name; x264 by default.
+	const char* codecName = argc > 1 ? argvc[1] : "x264";
+	const webrtc::CodecInfo* codec =
+		webrtc::CodecRegistry::FindCodec(codecName);
+	if (codec == NULL)
+	{
+		printf("Unknown codec %s, choose one of:", codecName);
+		for (int i = 0; i < webrtc::CodecRegistry::NumberOfCodecs(); i++)
+		{
+			printf(" %s", webrtc::CodecRegistry::GetCodec(i)->name);
+		}
+		printf("\n");
+		return -1;
+	}
+
 	// Create the windows
 	ViEWindowCreator windowCreator;
 	ViEAutoTestWindowManagerInterface* windowManager =
 		windowCreator.CreateTwoWindows();
 	VideoEngineSample(windowManager->GetWindow1(),
-		windowManager->GetWindow2());
+		windowManager->GetWindow2(), codec);
 	return 0;
 }
 
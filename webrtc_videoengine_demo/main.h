@@ -1,3 +0,0 @@
-#define USEVP8 0
-#define USEOPENH264 0
-#define USEX264 1
\ No newline at end of file
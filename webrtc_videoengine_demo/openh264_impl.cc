@@ -0,0 +1,630 @@
+/*
+ *  Copyright (c) 2012 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ *
+ * This file contains the WEBRTC H264 wrapper implementation
+ *
+ */
+
+#include "openh264_impl.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <new>
+#include <vector>
+
+#include "webrtc/common.h"
+#include "webrtc/common_video/libyuv/include/webrtc_libyuv.h"
+#include "webrtc/modules/interface/module_common_types.h"
+#include "webrtc/system_wrappers/interface/trace.h"
+#include "webrtc/system_wrappers/interface/trace_event.h"
+
+namespace webrtc {
+
+	static const unsigned char kStartCode[] = { 0, 0, 0, 1 };
+
+	// True if |buffer| begins with a three or four byte Annex-B start code.
+	static bool HasStartCode(const uint8_t* buffer, size_t length) {
+		if (length >= 3 && buffer[0] == 0 && buffer[1] == 0 && buffer[2] == 1) {
+			return true;
+		}
+		return length >= 4 && buffer[0] == 0 && buffer[1] == 0 &&
+			buffer[2] == 0 && buffer[3] == 1;
+	}
+
+
+	H264Encoder* H264Encoder::CreateOpenH264() {
+		return new OpenH264EncoderImpl();
+	}
+
+	OpenH264EncoderImpl::OpenH264EncoderImpl()
+		: encoded_image_(),
+		encoded_buffer_(NULL),
+		encoded_buffer_size_(0),
+		fragmentation_capacity_(0),
+		encoded_complete_callback_(NULL),
+		inited_(false)
+		,encoder_(NULL)
+	{
+		memset(&codec_, 0, sizeof(codec_));
+	}
+
+	OpenH264EncoderImpl::~OpenH264EncoderImpl() {
+		Release();
+	}
+
+	int OpenH264EncoderImpl::Release() {
+		// |encoded_image_| only ever borrows its buffer.
+		encoded_image_._buffer = NULL;
+		encoded_image_._length = 0;
+		encoded_image_._size = 0;
+		delete[] encoded_buffer_;
+		encoded_buffer_ = NULL;
+		encoded_buffer_size_ = 0;
+		if (encoder_ != NULL) {
+			encoder_->Uninitialize();
+			WelsDestroySVCEncoder(encoder_);
+			encoder_ = NULL;
+		}
+		inited_ = false;
+		return WEBRTC_VIDEO_CODEC_OK;
+	}
+
+	int OpenH264EncoderImpl::SetRates(uint32_t new_bitrate_kbit,
+		uint32_t new_framerate) {
+		WEBRTC_TRACE(webrtc::kTraceApiCall, webrtc::kTraceVideoCoding, -1,
+			"OpenH264EncoderImpl::SetRates(%d, %d)", new_bitrate_kbit, new_framerate);
+		if (!inited_) {
+			return WEBRTC_VIDEO_CODEC_UNINITIALIZED;
+		}
+		if (new_framerate < 1) {
+			return WEBRTC_VIDEO_CODEC_ERR_PARAMETER;
+		}
+		// update bit rate
+		if (codec_.maxBitrate > 0 && new_bitrate_kbit > codec_.maxBitrate) {
+			new_bitrate_kbit = codec_.maxBitrate;
+		}
+		if (new_bitrate_kbit < codec_.minBitrate) {
+			new_bitrate_kbit = codec_.minBitrate;
+		}
+		if (new_bitrate_kbit < 1) {
+			return WEBRTC_VIDEO_CODEC_ERR_PARAMETER;
+		}
+		SBitrateInfo bitrate;
+		memset(&bitrate, 0, sizeof(SBitrateInfo));
+		bitrate.iLayer = SPATIAL_LAYER_ALL;
+		bitrate.iBitrate = new_bitrate_kbit * 1000;
+		int ret_val = encoder_->SetOption(ENCODER_OPTION_BITRATE, &bitrate);
+		if (ret_val != 0) {
+			WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideoCoding, -1,
+				"OpenH264EncoderImpl::SetRates() fails to set bitrate ret_val %d", ret_val);
+			return WEBRTC_VIDEO_CODEC_ERROR;
+		}
+		float frame_rate = static_cast<float>(new_framerate);
+		ret_val = encoder_->SetOption(ENCODER_OPTION_FRAME_RATE, &frame_rate);
+		if (ret_val != 0) {
+			WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideoCoding, -1,
+				"OpenH264EncoderImpl::SetRates() fails to set frame rate ret_val %d", ret_val);
+			return WEBRTC_VIDEO_CODEC_ERROR;
+		}
+		codec_.maxFramerate = new_framerate;
+		return WEBRTC_VIDEO_CODEC_OK;
+	}
+
+	int OpenH264EncoderImpl::InitEncode(const VideoCodec* inst,
+		int number_of_cores,
+		uint32_t max_payload_size) {
+		if (inst == NULL) {
+			return WEBRTC_VIDEO_CODEC_ERR_PARAMETER;
+		}
+		if (inst->maxFramerate < 1) {
+			return WEBRTC_VIDEO_CODEC_ERR_PARAMETER;
+		}
+		// allow zero to represent an unspecified maxBitRate
+		if (inst->maxBitrate > 0 && inst->startBitrate > inst->maxBitrate) {
+			return WEBRTC_VIDEO_CODEC_ERR_PARAMETER;
+		}
+		if (inst->width < 1 || inst->height < 1) {
+			return WEBRTC_VIDEO_CODEC_ERR_PARAMETER;
+		}
+		if (number_of_cores < 1) {
+			return WEBRTC_VIDEO_CODEC_ERR_PARAMETER;
+		}
+
+		int ret_val = Release();
+		if (ret_val < 0) {
+			return ret_val;
+		}
+		if (encoder_ == NULL) {
+			ret_val = WelsCreateSVCEncoder(&encoder_);
+
+			if (ret_val != 0) {
+				WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideoCoding, -1,
+					"OpenH264EncoderImpl::InitEncode() fails to create encoder ret_val %d",
+					ret_val);
+				return WEBRTC_VIDEO_CODEC_ERROR;
+			}
+		}
+		SEncParamBase param;
+		memset(&param, 0, sizeof(SEncParamBase));
+		param.iUsageType = CAMERA_VIDEO_REAL_TIME;
+		// Bit rate mode so that SetRates() targets are honoured.
+		param.iRCMode = RC_BITRATE_MODE;
+		param.fMaxFrameRate = inst->maxFramerate;
+		param.iPicWidth = inst->width;
+		param.iPicHeight = inst->height;
+		param.iTargetBitrate = inst->startBitrate * 1000;
+
+		ret_val = encoder_->Initialize(&param);
+		int videoFormat = videoFormatI420;
+		encoder_->SetOption(ENCODER_OPTION_DATAFORMAT, &videoFormat);
+
+		if (ret_val != 0) {
+			WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideoCoding, -1,
+				"OpenH264EncoderImpl::InitEncode() fails to initialize encoder ret_val %d",
+				ret_val);
+			WelsDestroySVCEncoder(encoder_);
+			encoder_ = NULL;
+			return WEBRTC_VIDEO_CODEC_ERROR;
+		}
+
+		if (&codec_ != inst) {
+			codec_ = *inst;
+		}
+
+		encoded_image_._completeFrame = true;
+
+		inited_ = true;
+		WEBRTC_TRACE(webrtc::kTraceApiCall, webrtc::kTraceVideoCoding, -1,
+			"OpenH264EncoderImpl::InitEncode(width:%d, height:%d, framerate:%d, start_bitrate:%d, max_bitrate:%d)",
+			inst->width, inst->height, inst->maxFramerate, inst->startBitrate, inst->maxBitrate);
+
+		return WEBRTC_VIDEO_CODEC_OK;
+	}
+
+	int OpenH264EncoderImpl::Encode(const I420VideoFrame& input_image,
+		const CodecSpecificInfo* codec_specific_info,
+		const std::vector<VideoFrameType>* frame_types) {
+		if (!inited_) {
+			return WEBRTC_VIDEO_CODEC_UNINITIALIZED;
+		}
+		if (input_image.IsZeroSize()) {
+			return WEBRTC_VIDEO_CODEC_ERR_PARAMETER;
+		}
+		if (encoded_complete_callback_ == NULL) {
+			return WEBRTC_VIDEO_CODEC_UNINITIALIZED;
+		}
+
+		VideoFrameType frame_type = kDeltaFrame;
+		// We only support one stream at the moment.
+		if (frame_types && frame_types->size() > 0) {
+			frame_type = (*frame_types)[0];
+		}
+
+		bool send_keyframe = (frame_type == kKeyFrame);
+		if (send_keyframe) {
+			encoder_->ForceIntraFrame(true);
+			WEBRTC_TRACE(webrtc::kTraceApiCall, webrtc::kTraceVideoCoding, -1,
+				"OpenH264EncoderImpl::EncodeKeyFrame(width:%d, height:%d)",
+				input_image.width(), input_image.height());
+		}
+
+		// Check for change in frame size.
+		if (input_image.width() != codec_.width ||
+			input_image.height() != codec_.height) {
+			int ret = UpdateCodecFrameSize(input_image);
+			if (ret < 0) {
+				return ret;
+			}
+		}
+
+		SFrameBSInfo info;
+		memset(&info, 0, sizeof(SFrameBSInfo));
+
+		SSourcePicture pic;
+		memset(&pic, 0, sizeof(SSourcePicture));
+		pic.iPicWidth = input_image.width();
+		pic.iPicHeight = input_image.height();
+		pic.iColorFormat = videoFormatI420;
+
+		pic.iStride[0] = input_image.stride(kYPlane);
+		pic.iStride[1] = input_image.stride(kUPlane);
+		pic.iStride[2] = input_image.stride(kVPlane);
+
+		pic.pData[0] = const_cast<uint8_t*>(input_image.buffer(kYPlane));
+		pic.pData[1] = const_cast<uint8_t*>(input_image.buffer(kUPlane));
+		pic.pData[2] = const_cast<uint8_t*>(input_image.buffer(kVPlane));
+
+		int retVal = encoder_->EncodeFrame(&pic, &info);
+		if (retVal == videoFrameTypeSkip) {
+			return WEBRTC_VIDEO_CODEC_OK;
+		}
+		encoded_image_._length = 0;
+		uint16_t nal_count = 0;
+		for (int layer = 0; layer < info.iLayerNum; layer++) {
+			nal_count += info.sLayerInfo[layer].iNalCount;
+		}
+		if (nal_count == 0) {
+			return WEBRTC_VIDEO_CODEC_OK;
+		}
+		PrepareFragmentationHeader(nal_count);
+
+		// The layers normally follow each other in the encoder's bitstream
+		// buffer; only if they do not are they gathered into |encoded_buffer_|.
+		uint8_t* base = info.sLayerInfo[0].pBsBuf;
+		size_t frame_size = 0;
+		bool contiguous = true;
+		for (int layer = 0; layer < info.iLayerNum; layer++) {
+			const SLayerBSInfo& layer_bs_info = info.sLayerInfo[layer];
+			if (layer_bs_info.pBsBuf != base + frame_size) {
+				contiguous = false;
+			}
+			for (int nal_index = 0; nal_index < layer_bs_info.iNalCount; nal_index++) {
+				frame_size += layer_bs_info.pNalLengthInByte[nal_index];
+			}
+		}
+		if (!contiguous) {
+			if (EnsureEncodedBufferSize(frame_size) < 0) {
+				return WEBRTC_VIDEO_CODEC_MEMORY;
+			}
+			size_t offset = 0;
+			for (int layer = 0; layer < info.iLayerNum; layer++) {
+				const SLayerBSInfo& layer_bs_info = info.sLayerInfo[layer];
+				size_t layer_size = 0;
+				for (int nal_index = 0; nal_index < layer_bs_info.iNalCount; nal_index++) {
+					layer_size += layer_bs_info.pNalLengthInByte[nal_index];
+				}
+				memcpy(encoded_buffer_ + offset, layer_bs_info.pBsBuf, layer_size);
+				offset += layer_size;
+			}
+			base = encoded_buffer_;
+		}
+		encoded_image_._buffer = base;
+		encoded_image_._length = frame_size;
+		encoded_image_._size = frame_size;
+
+		// Every NAL unit starts with a four byte start code, which the
+		// fragmentation header leaves out.
+		uint16_t totalNaluIndex = 0;
+		size_t nal_offset = 0;
+		for (int layer = 0; layer < info.iLayerNum; layer++) {
+			const SLayerBSInfo& layer_bs_info = info.sLayerInfo[layer];
+			for (int nal_index = 0; nal_index < layer_bs_info.iNalCount; nal_index++) {
+				size_t nal_length = layer_bs_info.pNalLengthInByte[nal_index];
+				size_t payload_offset = nal_offset + 4;
+				nal_offset += nal_length;
+				char nal_type = (base[payload_offset] & 0x1F);
+				if (nal_type == 14) {
+					continue;
+				}
+
+				WEBRTC_TRACE(webrtc::kTraceApiCall, webrtc::kTraceVideoCoding, -1,
+					"OpenH264EncoderImpl::Encode() nal_type %d, length:%d",
+					nal_type, static_cast<int>(nal_length - 4));
+
+				// Offset of pointer to data for each fragm.
+				frag_info_.fragmentationOffset[totalNaluIndex] = payload_offset;
+				// Data size for each fragmentation
+				frag_info_.fragmentationLength[totalNaluIndex] = nal_length - 4;
+				// Payload type of each fragmentation
+				frag_info_.fragmentationPlType[totalNaluIndex] = nal_type;
+				// Timestamp difference relative "now" for
+				// each fragmentation
+				frag_info_.fragmentationTimeDiff[totalNaluIndex] = 0;
+				totalNaluIndex++;
+			}
+		}
+		frag_info_.fragmentationVectorSize = totalNaluIndex;
+
+		if (encoded_image_._length > 0) {
+			encoded_image_._timeStamp = input_image.timestamp();
+			encoded_image_.capture_time_ms_ = input_image.render_time_ms();
+			encoded_image_._encodedHeight = codec_.height;
+			encoded_image_._encodedWidth = codec_.width;
+			encoded_image_._frameType = frame_type;
+			// call back
+			encoded_complete_callback_->Encoded(encoded_image_, NULL, &frag_info_);
+		}
+		return WEBRTC_VIDEO_CODEC_OK;
+	}
+
+	int OpenH264EncoderImpl::RegisterEncodeCompleteCallback(
+		EncodedImageCallback* callback) {
+		encoded_complete_callback_ = callback;
+		return WEBRTC_VIDEO_CODEC_OK;
+	}
+
+	int OpenH264EncoderImpl::SetChannelParameters(uint32_t packet_loss, int rtt) {
+		// OpenH264 has no intra refresh control; it recovers through the key
+		// frames requested by the receiver.
+		return WEBRTC_VIDEO_CODEC_OK;
+	}
+
+
+	void OpenH264EncoderImpl::PrepareFragmentationHeader(uint16_t count) {
+		// VerifyAndAllocateFragmentationHeader() only grows the arrays and
+		// copies |fragmentationVectorSize| entries, so track the capacity here.
+		frag_info_.fragmentationVectorSize = fragmentation_capacity_;
+		frag_info_.VerifyAndAllocateFragmentationHeader(count);
+		if (count > fragmentation_capacity_) {
+			fragmentation_capacity_ = count;
+		}
+		frag_info_.fragmentationVectorSize = count;
+	}
+
+	int OpenH264EncoderImpl::EnsureEncodedBufferSize(size_t size) {
+		if (size <= encoded_buffer_size_) {
+			return WEBRTC_VIDEO_CODEC_OK;
+		}
+		uint8_t* buffer = new (std::nothrow) uint8_t[size];
+		if (buffer == NULL) {
+			WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideoCoding, -1,
+				"OpenH264EncoderImpl::Encode() failed to grow output buffer to %d bytes",
+				static_cast<int>(size));
+			return WEBRTC_VIDEO_CODEC_MEMORY;
+		}
+		delete[] encoded_buffer_;
+		encoded_buffer_ = buffer;
+		encoded_buffer_size_ = size;
+		return WEBRTC_VIDEO_CODEC_OK;
+	}
+
+	int OpenH264EncoderImpl::UpdateCodecFrameSize(const I420VideoFrame& input_image) {
+		codec_.width = input_image.width();
+		codec_.height = input_image.height();
+		return WEBRTC_VIDEO_CODEC_OK;
+	}
+
+
+	H264Decoder* H264Decoder::CreateOpenH264() {
+		return new OpenH264DecoderImpl();
+	}
+
+	OpenH264DecoderImpl::OpenH264DecoderImpl()
+		: decode_complete_callback_(NULL),
+		inited_(false),
+		key_frame_required_(true),
+		has_decoded_frame_(false)
+		,decoder_(NULL)
+		,buffer_with_start_code_(NULL)
+		,buffer_with_start_code_size_(0)
+	{
+		memset(&codec_, 0, sizeof(codec_));
+	}
+
+	OpenH264DecoderImpl::~OpenH264DecoderImpl() {
+		inited_ = true;  // in order to do the actual release
+		Release();
+		delete[] buffer_with_start_code_;
+		buffer_with_start_code_ = NULL;
+		buffer_with_start_code_size_ = 0;
+	}
+
+	int OpenH264DecoderImpl::Reset() {
+		if (!inited_) {
+			return WEBRTC_VIDEO_CODEC_UNINITIALIZED;
+		}
+		InitDecode(&codec_, 1);
+		return WEBRTC_VIDEO_CODEC_OK;
+	}
+
+	int OpenH264DecoderImpl::InitDecode(const VideoCodec* inst, int number_of_cores) {
+		if (inst == NULL) {
+			return WEBRTC_VIDEO_CODEC_ERR_PARAMETER;
+		}
+		int ret_val = Release();
+		if (ret_val < 0) {
+			return ret_val;
+		}
+
+		if (&codec_ != inst) {
+			// Save VideoCodec instance for later; mainly for duplicating the decoder.
+			codec_ = *inst;
+		}
+		if (decoder_ == NULL) {
+			ret_val = WelsCreateDecoder(&decoder_);
+			if (ret_val != 0) {
+				decoder_ = NULL;
+				return WEBRTC_VIDEO_CODEC_ERROR;
+			}
+		}
+		SDecodingParam dec_param;
+		memset(&dec_param, 0, sizeof(SDecodingParam));
+		dec_param.eOutputColorFormat = videoFormatI420;
+		dec_param.uiTargetDqLayer = UCHAR_MAX;
+		dec_param.eEcActiveIdc = ERROR_CON_FRAME_COPY_CROSS_IDR;
+		dec_param.sVideoProperty.eVideoBsType = VIDEO_BITSTREAM_DEFAULT;
+		ret_val = decoder_->Initialize(&dec_param);
+		if (ret_val != 0) {
+			decoder_->Uninitialize();
+			WelsDestroyDecoder(decoder_);
+			decoder_ = NULL;
+			return WEBRTC_VIDEO_CODEC_ERROR;
+		}
+		inited_ = true;
+
+		// Always start with a complete key frame.
+		key_frame_required_ = true;
+		WEBRTC_TRACE(webrtc::kTraceApiCall, webrtc::kTraceVideoCoding, -1,
+			"OpenH264DecoderImpl::InitDecode(width:%d, height:%d, framerate:%d, start_bitrate:%d, max_bitrate:%d)",
+			inst->width, inst->height, inst->maxFramerate, inst->startBitrate, inst->maxBitrate);
+		return WEBRTC_VIDEO_CODEC_OK;
+	}
+
+	int OpenH264DecoderImpl::Decode(const EncodedImage& input_image,
+		bool missing_frames,
+		const RTPFragmentationHeader* fragmentation,
+		const CodecSpecificInfo* codec_specific_info,
+		int64_t /*render_time_ms*/) {
+		if (!inited_) {
+			WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideoCoding, -1,
+				"OpenH264DecoderImpl::Decode, decoder is not initialized");
+			return WEBRTC_VIDEO_CODEC_UNINITIALIZED;
+		}
+
+		if (decode_complete_callback_ == NULL) {
+			WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideoCoding, -1,
+				"OpenH264DecoderImpl::Decode, decode complete call back is not set");
+			return WEBRTC_VIDEO_CODEC_UNINITIALIZED;
+		}
+
+		if (input_image._buffer == NULL) {
+			WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideoCoding, -1,
+				"OpenH264DecoderImpl::Decode, null buffer");
+			return WEBRTC_VIDEO_CODEC_ERR_PARAMETER;
+		}
+		if (!codec_specific_info) {
+			WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideoCoding, -1,
+				"OpenH264EncoderImpl::Decode, no codec info");
+			return WEBRTC_VIDEO_CODEC_ERROR;
+		}
+		if (codec_specific_info->codecType != kVideoCodecH264) {
+			WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideoCoding, -1,
+				"OpenH264EncoderImpl::Decode, non h264 codec %d", codec_specific_info->codecType);
+			return WEBRTC_VIDEO_CODEC_ERROR;
+		}
+
+		WEBRTC_TRACE(webrtc::kTraceApiCall, webrtc::kTraceVideoCoding, -1,
+			"OpenH264DecoderImpl::Decode(frame_type:%d, length:%d",
+			input_image._frameType, input_image._length);
+
+#if 0
+		// Always start with a complete key frame.
+		if (key_frame_required_) {
+			if (input_image._frameType != kKeyFrame)
+				return WEBRTC_VIDEO_CODEC_ERROR;
+			// We have a key frame - is it complete?
+			if (input_image._completeFrame) {
+				key_frame_required_ = false;
+			}
+			else {
+				return WEBRTC_VIDEO_CODEC_ERROR;
+			}
+		}
+#endif
+		void* data[3];
+		SBufferInfo buffer_info;
+		memset(data, 0, sizeof(data));
+		memset(&buffer_info, 0, sizeof(SBufferInfo));
+
+		// The jitter buffer already inserts Annex-B start codes, so normally
+		// the frame is decoded straight from |input_image|.
+		const unsigned char* bitstream = input_image._buffer;
+		size_t bitstream_size = input_image._length;
+		if (!HasStartCode(input_image._buffer, input_image._length)) {
+			if (EnsureStartCodeBufferSize(input_image._length + sizeof(kStartCode)) < 0) {
+				return WEBRTC_VIDEO_CODEC_MEMORY;
+			}
+			memcpy(buffer_with_start_code_, kStartCode, sizeof(kStartCode));
+			memcpy(buffer_with_start_code_ + sizeof(kStartCode), input_image._buffer,
+				input_image._length);
+			bitstream = buffer_with_start_code_;
+			bitstream_size += sizeof(kStartCode);
+		}
+
+		DECODING_STATE rv = decoder_->DecodeFrame2(bitstream,
+			static_cast<int>(bitstream_size), (unsigned char**)data, &buffer_info);
+
+		if (rv != dsErrorFree) {
+			WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideoCoding, -1,
+				"OpenH264DecoderImpl::Decode, openH264 decoding fails with error %d", rv);
+			return WEBRTC_VIDEO_CODEC_ERROR;
+		}
+
+		if (buffer_info.iBufferStatus == 1) {
+			// OpenH264 overwrites its output pictures on the next DecodeFrame2()
+			// call and offers no way to hold on to them, so unlike the FFmpeg
+			// path the picture has to be copied here.
+			int size_y = buffer_info.UsrData.sSystemBuffer.iStride[0] * buffer_info.UsrData.sSystemBuffer.iHeight;
+			int size_u = buffer_info.UsrData.sSystemBuffer.iStride[1] * (buffer_info.UsrData.sSystemBuffer.iHeight / 2);
+			int size_v = buffer_info.UsrData.sSystemBuffer.iStride[1] * (buffer_info.UsrData.sSystemBuffer.iHeight / 2);
+
+			decoded_image_.CreateFrame(size_y, static_cast<uint8_t*>(data[0]),
+				size_u, static_cast<uint8_t*>(data[1]),
+				size_v, static_cast<uint8_t*>(data[2]),
+				buffer_info.UsrData.sSystemBuffer.iWidth,
+				buffer_info.UsrData.sSystemBuffer.iHeight,
+				buffer_info.UsrData.sSystemBuffer.iStride[0],
+				buffer_info.UsrData.sSystemBuffer.iStride[1],
+				buffer_info.UsrData.sSystemBuffer.iStride[1]);
+
+			decoded_image_.set_timestamp(input_image._timeStamp);
+			has_decoded_frame_ = true;
+			decode_complete_callback_->Decoded(decoded_image_);
+			return WEBRTC_VIDEO_CODEC_OK;
+		}else {
+			WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideoCoding, -1,
+				"OpenH264DecoderImpl::Decode, buffer status:%d", buffer_info.iBufferStatus);
+			return WEBRTC_VIDEO_CODEC_OK;
+		}
+	}
+
+	int OpenH264DecoderImpl::RegisterDecodeCompleteCallback(
+		DecodedImageCallback* callback) {
+		decode_complete_callback_ = callback;
+		return WEBRTC_VIDEO_CODEC_OK;
+	}
+
+	int OpenH264DecoderImpl::Release() {
+		if (decoder_ != NULL) {
+			decoder_->Uninitialize();
+			WelsDestroyDecoder(decoder_);
+			decoder_ = NULL;
+		}
+		inited_ = false;
+		return WEBRTC_VIDEO_CODEC_OK;
+	}
+
+	int OpenH264DecoderImpl::EnsureStartCodeBufferSize(size_t size) {
+		if (size <= buffer_with_start_code_size_) {
+			return WEBRTC_VIDEO_CODEC_OK;
+		}
+		// Grow geometrically so a stream of growing key frames settles quickly.
+		size_t new_size = buffer_with_start_code_size_ > 0 ?
+			buffer_with_start_code_size_ : static_cast<size_t>(MAX_ENCODED_IMAGE_SIZE);
+		while (new_size < size) {
+			new_size *= 2;
+		}
+		unsigned char* buffer = new (std::nothrow) unsigned char[new_size];
+		if (buffer == NULL) {
+			WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideoCoding, -1,
+				"OpenH264DecoderImpl::Decode, failed to grow input buffer to %d bytes",
+				static_cast<int>(size));
+			return WEBRTC_VIDEO_CODEC_MEMORY;
+		}
+		delete[] buffer_with_start_code_;
+		buffer_with_start_code_ = buffer;
+		buffer_with_start_code_size_ = new_size;
+		return WEBRTC_VIDEO_CODEC_OK;
+	}
+
+	VideoDecoder* OpenH264DecoderImpl::Copy() {
+		// Sanity checks.
+		if (!inited_) {
+			// Not initialized.
+			assert(false);
+			return NULL;
+		}
+		if (!has_decoded_frame_) {
+			// Nothing has been decoded before; cannot clone.
+			return NULL;
+		}
+		// Create a new VideoDecoder object
+		OpenH264DecoderImpl *copy = new OpenH264DecoderImpl;
+
+		// Initialize the new decoder
+		if (copy->InitDecode(&codec_, 1) != WEBRTC_VIDEO_CODEC_OK) {
+			delete copy;
+			return NULL;
+		}
+
+		return static_cast<VideoDecoder*>(copy);
+	}
+}  // namespace webrtc
@@ -7,42 +7,30 @@
  *  in the file PATENTS.  All contributing project authors may
  *  be found in the AUTHORS file in the root of the source tree.
  *
- * WEBRTC H264 wrapper interface
+ * WEBRTC H264 wrapper interface backed by OpenH264
  */
 
-#ifndef WEBRTC_MODULES_VIDEO_CODING_CODECS_H264_IMPL_H_
-#define WEBRTC_MODULES_VIDEO_CODING_CODECS_H264_IMPL_H_
+#ifndef WEBRTC_VIDEOENGINE_DEMO_OPENH264_IMPL_H_
+#define WEBRTC_VIDEOENGINE_DEMO_OPENH264_IMPL_H_
 
 #include <stdint.h>
 #include "h264.h"
 
-#if USEOPENH264 
 // OpenH264 headers
 #include "H264/include/codec_api.h"
 #include "H264/include/codec_def.h"
 #include "H264/include/codec_app_def.h"
-#elif USEX264
-#define __STDC_CONSTANT_MACROS
-//x264 and ffmpeg headers
-extern "C"
-{
-	#include "H264/include/x264.h"
-	#include "ffmpeg/libavcodec/avcodec.h"
-	#include "ffmpeg/libavformat/avformat.h"
-	#include "ffmpeg/libswscale/swscale.h"
-}
-#endif
 
 #include "webrtc/modules/video_coding/codecs/interface/video_codec_interface.h"
 
 
 namespace webrtc {
 
-	class H264EncoderImpl : public H264Encoder{
+	class OpenH264EncoderImpl : public H264Encoder{
  public:
-  H264EncoderImpl();
+  OpenH264EncoderImpl();
 
-  ~H264EncoderImpl();
+  ~OpenH264EncoderImpl();
 
   // Free encoder memory.
   //
@@ -66,7 +54,7 @@ namespace webrtc {
   //                                  WEBRTC_VIDEO_CODEC_ERROR
   int InitEncode(const VideoCodec* codec_settings,
                          int number_of_cores,
-                         size_t max_payload_size);
+                         uint32_t max_payload_size);
 
   // Encode an I420 image (as a part of a video stream). The encoded image
   // will be returned to the user through the encode complete callback.
@@ -117,37 +105,43 @@ namespace webrtc {
   // Update frame size for codec.
   int UpdateCodecFrameSize(const I420VideoFrame& input_image);
 
+  // Size |frag_info_| for |count| NAL units, reusing its arrays.
+  void PrepareFragmentationHeader(uint16_t count);
+
+  // Make |encoded_buffer_| hold at least |size| bytes.
+  int EnsureEncodedBufferSize(size_t size);
+
   //void PopulateCodecSpecific(CodecSpecificInfo* codec_specific,
   //                           const vpx_codec_cx_pkt& pkt,
   //                           uint32_t timestamp);
 
+  // Points into the encoder's own bitstream buffer, which stays valid until
+  // the next encode call and so for the whole synchronous Encoded() callback.
   EncodedImage encoded_image_;
+  // Only used when the encoder's NAL units are not contiguous; grows to the
+  // largest such frame rather than being sized for a raw frame.
+  uint8_t* encoded_buffer_;
+  size_t encoded_buffer_size_;
+  RTPFragmentationHeader frag_info_;
+  uint16_t fragmentation_capacity_;
   EncodedImageCallback* encoded_complete_callback_;
   VideoCodec codec_;
   bool inited_;
 
-#if USEOPENH264
   ISVCEncoder* encoder_;
-#elif  USEX264
-  //x264
-  x264_picture_t pic;
-  x264_picture_t pic_out;
-  x264_t *encoder_;
-  int i_frame = 0;
-  x264_nal_t *nal;
-#endif
 };  // end of H264Encoder class
 
 
-	class H264DecoderImpl : public H264Decoder {
+	class OpenH264DecoderImpl : public H264Decoder {
  public:
   enum {
+	  // Initial capacity of the input buffers; they grow on demand.
 	  MAX_ENCODED_IMAGE_SIZE = 32768
   };
 
-  H264DecoderImpl();
+  OpenH264DecoderImpl();
 
-  ~H264DecoderImpl();
+  ~OpenH264DecoderImpl();
 
   // Initialize the decoder.
   //
@@ -207,27 +201,21 @@ namespace webrtc {
   VideoDecoder* Copy();
 
  private:
+  // Make |buffer_with_start_code_| hold at least |size| bytes.
+  int EnsureStartCodeBufferSize(size_t size);
+
   I420VideoFrame decoded_image_;
   DecodedImageCallback* decode_complete_callback_;
   bool inited_;
   VideoCodec codec_;
   bool key_frame_required_;
-#if USEOPENH264
+  bool has_decoded_frame_;
   ISVCDecoder* decoder_;
+  // Only used for input that does not start with an Annex-B start code.
   unsigned char* buffer_with_start_code_;
-#elif USEX264
-  AVCodecContext	*pCodecCtx;
-  AVCodec			*pCodec;
-  AVFrame	*pFrame, *pFrameYUV;
-  AVPacket *packet;
-  struct SwsContext *img_convert_ctx;
-  uint8_t *decode_buffer;
-  uint8_t *out_buffer;
-  int framecnt = 0;
-  int encoded_length = 0;
-#endif
+  size_t buffer_with_start_code_size_;
 };  // end of H264Decoder class
 
 }  // namespace webrtc
 
-#endif  // WEBRTC_MODULES_VIDEO_CODING_CODECS_H264_IMPL_H_
+#endif  // WEBRTC_VIDEOENGINE_DEMO_OPENH264_IMPL_H_
@@ -0,0 +1,50 @@
+#include "video_channel_transport.h"
+
+using namespace webrtc;
+
+VideoChannelTransport::VideoChannelTransport(ViENetwork* vie_network,
+	int channel)
+	: channel_(channel),
+	vie_network_(vie_network) {
+	uint8_t socket_threads = 1;
+	socket_transport_ = webrtc::test::UdpTransport::Create(channel, socket_threads);
+	int registered = vie_network_->RegisterSendTransport(channel,
+		*socket_transport_);
+}
+
+VideoChannelTransport::~VideoChannelTransport() {
+	vie_network_->DeregisterSendTransport(channel_);
+	webrtc::test::UdpTransport::Destroy(socket_transport_);
+}
+
+void VideoChannelTransport::IncomingRTPPacket(
+	const int8_t* incoming_rtp_packet,
+	const int32_t packet_length,
+	const char* /*from_ip*/,
+	const uint16_t /*from_port*/) {
+	vie_network_->ReceivedRTPPacket(
+		channel_, incoming_rtp_packet, packet_length, PacketTime());
+}
+
+void VideoChannelTransport::IncomingRTCPPacket(
+	const int8_t* incoming_rtcp_packet,
+	const int32_t packet_length,
+	const char* /*from_ip*/,
+	const uint16_t /*from_port*/) {
+	vie_network_->ReceivedRTCPPacket(channel_, incoming_rtcp_packet,
+		packet_length);
+}
+
+int VideoChannelTransport::SetLocalReceiver(uint16_t rtp_port) {
+	int return_value = socket_transport_->InitializeReceiveSockets(this,
+		rtp_port);
+	if (return_value == 0) {
+		return socket_transport_->StartReceiving(500);
+	}
+	return return_value;
+}
+
+int VideoChannelTransport::SetSendDestination(const char* ip_address,
+	uint16_t rtp_port) {
+	return socket_transport_->InitializeSendSockets(ip_address, rtp_port);
+}
@@ -0,0 +1,41 @@
+/*
+ * UDP transport for one VideoEngine channel, shared by the loopback sample
+ * (main.cc) and the headless load test (load_test.cc).
+ */
+#ifndef WEBRTC_VIDEOENGINE_DEMO_VIDEO_CHANNEL_TRANSPORT_H_
+#define WEBRTC_VIDEOENGINE_DEMO_VIDEO_CHANNEL_TRANSPORT_H_
+
+#include "webrtc/test/channel_transport/udp_transport.h"
+#include "webrtc/video_engine/vie_network.h"
+
+class VideoChannelTransport : public webrtc::test::UdpTransportData {
+public:
+	VideoChannelTransport(webrtc::ViENetwork* vie_network, int channel);
+
+	virtual  ~VideoChannelTransport();
+
+	// Start implementation of UdpTransportData.
+	virtual void IncomingRTPPacket(const int8_t* incoming_rtp_packet,
+		const int32_t packet_length,
+		const char* /*from_ip*/,
+		const uint16_t /*from_port*/) OVERRIDE;
+
+	virtual void IncomingRTCPPacket(const int8_t* incoming_rtcp_packet,
+		const int32_t packet_length,
+		const char* /*from_ip*/,
+		const uint16_t /*from_port*/) OVERRIDE;
+	// End implementation of UdpTransportData.
+
+	// Specifies the ports to receive RTP packets on.
+	int SetLocalReceiver(uint16_t rtp_port);
+
+	// Specifies the destination port and IP address for a specified channel.
+	int SetSendDestination(const char* ip_address, uint16_t rtp_port);
+
+private:
+	int channel_;
+	webrtc::ViENetwork* vie_network_;
+	webrtc::test::UdpTransport* socket_transport_;
+};
+
+#endif  // WEBRTC_VIDEOENGINE_DEMO_VIDEO_CHANNEL_TRANSPORT_H_
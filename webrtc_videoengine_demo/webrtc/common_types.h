@@ -172,6 +172,23 @@ public:
 protected:
     virtual ~Transport() {}
     Transport() {}
+
+public:
+    // Sends num_packets RTP packets, in order, in as few calls to the network
+    // as the transport allows. Returns the number of packets sent before the
+    // first failure, or -1 on error. The default calls SendPacket() for each
+    // packet. Declared last so existing vtable slots keep their positions.
+    virtual int SendPackets(int channel, const void* const* data,
+                            const int* lengths, int num_packets)
+    {
+        int sent = 0;
+        while (sent < num_packets &&
+               SendPacket(channel, data[sent], lengths[sent]) > 0)
+        {
+            ++sent;
+        }
+        return sent;
+    }
 };
 
 // Statistics for an RTCP channel
@@ -603,6 +620,10 @@ struct VideoCodecH264
     VideoCodecProfile profile;
     bool           frameDroppingOn;
     int            keyFrameInterval;
+    // Higher settings select slower, better compressing encoder presets.
+    // Every setting encodes without lookahead or B-frames, so each input
+    // frame produces its output before Encode() returns.
+    VideoCodecComplexity complexity;
     // These are NULL/0 if not externally negotiated.
     const uint8_t* spsData;
     size_t         spsLen;
@@ -159,6 +159,8 @@ void I420VideoFrame::ResetSize() {
 
 void* I420VideoFrame::native_handle() const { return NULL; }
 
+bool I420VideoFrame::IsWrapped() const { return false; }
+
 int I420VideoFrame::CheckDimensions(int width, int height,
                                     int stride_y, int stride_u, int stride_v) {
   int half_width = (width + 1) / 2;
@@ -132,6 +132,12 @@ class I420VideoFrame {
   // longer in use, so the underlying resource can be freed.
   virtual void* native_handle() const;
 
+  // Return true if the planes are borrowed from another owner, e.g. a
+  // decoder's picture pool, instead of being allocated by the frame. Such
+  // frames cannot be swapped or resized; keep them with CloneFrame(), which
+  // shares the planes instead of copying them.
+  virtual bool IsWrapped() const;
+
  protected:
   // Verifies legality of parameters.
   // Return value: 0 on success, -1 on error.
@@ -0,0 +1,95 @@
+/*
+ *  Copyright (c) 2014 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef COMMON_VIDEO_INTERFACE_WRAPPED_I420_VIDEO_FRAME_H
+#define COMMON_VIDEO_INTERFACE_WRAPPED_I420_VIDEO_FRAME_H
+
+// WrappedI420VideoFrame class
+//
+// I420 video frames whose planes are borrowed from another owner, typically a
+// decoder's picture pool, instead of being copied into the frame.
+
+#include "webrtc/common_video/interface/i420_video_frame.h"
+#include "webrtc/system_wrappers/interface/scoped_refptr.h"
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+
+// Keeps the planes referenced by a WrappedI420VideoFrame alive. Every frame
+// (and every clone of it) holds a reference; the owner may recycle the planes
+// once those references are gone.
+class I420BufferHandle {
+ public:
+  virtual ~I420BufferHandle() {}
+  // For scoped_refptr
+  virtual int32_t AddRef() = 0;
+  virtual int32_t Release() = 0;
+};
+
+// An I420VideoFrame over planes owned by someone else, e.g. a decoder's
+// picture pool. The planes are read-only: the non-const buffer() accessor
+// returns NULL, so read them through a const frame.
+class WrappedI420VideoFrame : public I420VideoFrame {
+ public:
+  WrappedI420VideoFrame(I420BufferHandle* handle,
+                        int width,
+                        int height,
+                        const uint8_t* buffer_y,
+                        int stride_y,
+                        const uint8_t* buffer_u,
+                        int stride_u,
+                        const uint8_t* buffer_v,
+                        int stride_v,
+                        uint32_t timestamp,
+                        int64_t render_time_ms);
+  virtual ~WrappedI420VideoFrame();
+
+  // I420VideoFrame implementation
+  virtual int CreateEmptyFrame(int width,
+                               int height,
+                               int stride_y,
+                               int stride_u,
+                               int stride_v) OVERRIDE;
+  virtual int CreateFrame(int size_y,
+                          const uint8_t* buffer_y,
+                          int size_u,
+                          const uint8_t* buffer_u,
+                          int size_v,
+                          const uint8_t* buffer_v,
+                          int width,
+                          int height,
+                          int stride_y,
+                          int stride_u,
+                          int stride_v) OVERRIDE;
+  virtual int CopyFrame(const I420VideoFrame& videoFrame) OVERRIDE;
+  virtual I420VideoFrame* CloneFrame() const OVERRIDE;
+  virtual void SwapFrame(I420VideoFrame* videoFrame) OVERRIDE;
+  virtual uint8_t* buffer(PlaneType type) OVERRIDE;
+  virtual const uint8_t* buffer(PlaneType type) const OVERRIDE;
+  virtual int allocated_size(PlaneType type) const OVERRIDE;
+  virtual int stride(PlaneType type) const OVERRIDE;
+  virtual bool IsZeroSize() const OVERRIDE;
+  virtual void ResetSize() OVERRIDE;
+  virtual bool IsWrapped() const OVERRIDE;
+
+ protected:
+  virtual int CheckDimensions(
+      int width, int height, int stride_y, int stride_u, int stride_v) OVERRIDE;
+
+ private:
+  // Keeps |buffers_| valid for the lifetime of the frame.
+  scoped_refptr<I420BufferHandle> handle_;
+  const uint8_t* buffers_[kNumOfPlanes];
+  int strides_[kNumOfPlanes];
+};
+
+}  // namespace webrtc
+
+#endif  // COMMON_VIDEO_INTERFACE_WRAPPED_I420_VIDEO_FRAME_H
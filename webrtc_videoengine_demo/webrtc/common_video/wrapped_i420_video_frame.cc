@@ -0,0 +1,129 @@
+/*
+ *  Copyright (c) 2014 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/common_video/interface/wrapped_i420_video_frame.h"
+
+#include <assert.h>
+
+namespace webrtc {
+
+WrappedI420VideoFrame::WrappedI420VideoFrame(I420BufferHandle* handle,
+                                             int width,
+                                             int height,
+                                             const uint8_t* buffer_y,
+                                             int stride_y,
+                                             const uint8_t* buffer_u,
+                                             int stride_u,
+                                             const uint8_t* buffer_v,
+                                             int stride_v,
+                                             uint32_t timestamp,
+                                             int64_t render_time_ms)
+    : handle_(handle) {
+  buffers_[kYPlane] = buffer_y;
+  buffers_[kUPlane] = buffer_u;
+  buffers_[kVPlane] = buffer_v;
+  strides_[kYPlane] = stride_y;
+  strides_[kUPlane] = stride_u;
+  strides_[kVPlane] = stride_v;
+  set_width(width);
+  set_height(height);
+  set_timestamp(timestamp);
+  set_render_time_ms(render_time_ms);
+}
+
+WrappedI420VideoFrame::~WrappedI420VideoFrame() {}
+
+int WrappedI420VideoFrame::CreateEmptyFrame(int width,
+                                            int height,
+                                            int stride_y,
+                                            int stride_u,
+                                            int stride_v) {
+  assert(false);  // Should not be called.
+  return -1;
+}
+
+int WrappedI420VideoFrame::CreateFrame(int size_y,
+                                       const uint8_t* buffer_y,
+                                       int size_u,
+                                       const uint8_t* buffer_u,
+                                       int size_v,
+                                       const uint8_t* buffer_v,
+                                       int width,
+                                       int height,
+                                       int stride_y,
+                                       int stride_u,
+                                       int stride_v) {
+  assert(false);  // Should not be called.
+  return -1;
+}
+
+int WrappedI420VideoFrame::CopyFrame(const I420VideoFrame& videoFrame) {
+  assert(false);  // Should not be called.
+  return -1;
+}
+
+I420VideoFrame* WrappedI420VideoFrame::CloneFrame() const {
+  // The clone shares the planes and keeps its own reference to them.
+  WrappedI420VideoFrame* frame = new WrappedI420VideoFrame(
+      handle_, width(), height(),
+      buffers_[kYPlane], strides_[kYPlane],
+      buffers_[kUPlane], strides_[kUPlane],
+      buffers_[kVPlane], strides_[kVPlane],
+      timestamp(), render_time_ms());
+  frame->set_ntp_time_ms(ntp_time_ms());
+  return frame;
+}
+
+void WrappedI420VideoFrame::SwapFrame(I420VideoFrame* videoFrame) {
+  assert(false);  // Should not be called.
+}
+
+uint8_t* WrappedI420VideoFrame::buffer(PlaneType type) {
+  // The planes belong to the decoder, which may still use them as reference
+  // pictures. Read them through the const accessor.
+  assert(false);  // Should not be called.
+  return NULL;
+}
+
+const uint8_t* WrappedI420VideoFrame::buffer(PlaneType type) const {
+  return buffers_[type];
+}
+
+int WrappedI420VideoFrame::allocated_size(PlaneType type) const {
+  int rows = (type == kYPlane) ? height() : (height() + 1) / 2;
+  return strides_[type] * rows;
+}
+
+int WrappedI420VideoFrame::stride(PlaneType type) const {
+  return strides_[type];
+}
+
+bool WrappedI420VideoFrame::IsZeroSize() const {
+  return buffers_[kYPlane] == NULL;
+}
+
+void WrappedI420VideoFrame::ResetSize() {
+  assert(false);  // Should not be called.
+}
+
+bool WrappedI420VideoFrame::IsWrapped() const { return true; }
+
+int WrappedI420VideoFrame::CheckDimensions(
+    int width, int height, int stride_y, int stride_u, int stride_v) {
+  // The strides passed in are those of the (unused) base class planes, and
+  // the height is still zero while the width is being set in the constructor.
+  int half_width = (width + 1) / 2;
+  if (width < 1 || height < 0 || strides_[kYPlane] < width ||
+      strides_[kUPlane] < half_width || strides_[kVPlane] < half_width)
+    return -1;
+  return 0;
+}
+
+}  // namespace webrtc
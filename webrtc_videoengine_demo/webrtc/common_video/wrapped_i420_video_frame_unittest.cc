@@ -0,0 +1,130 @@
+/*
+ *  Copyright (c) 2014 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/common_video/interface/wrapped_i420_video_frame.h"
+
+#include <string.h>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+
+namespace webrtc {
+
+class I420BufferHandleImpl : public I420BufferHandle {
+ public:
+  I420BufferHandleImpl() : ref_count_(0) {}
+  virtual ~I420BufferHandleImpl() {}
+  virtual int32_t AddRef() { return ++ref_count_; }
+  virtual int32_t Release() { return --ref_count_; }
+
+  int32_t ref_count() { return ref_count_; }
+ private:
+  int32_t ref_count_;
+};
+
+static const int kWidth = 63;
+static const int kHeight = 31;
+static const int kStrideY = 64;
+static const int kStrideUV = 32;
+
+class TestWrappedI420VideoFrame : public ::testing::Test {
+ protected:
+  TestWrappedI420VideoFrame() {
+    memset(y_, 1, sizeof(y_));
+    memset(u_, 2, sizeof(u_));
+    memset(v_, 3, sizeof(v_));
+  }
+
+  WrappedI420VideoFrame* CreateFrame() {
+    return new WrappedI420VideoFrame(&handle_, kWidth, kHeight,
+                                     y_, kStrideY, u_, kStrideUV,
+                                     v_, kStrideUV, 100, 10);
+  }
+
+  I420BufferHandleImpl handle_;
+  uint8_t y_[kStrideY * kHeight];
+  uint8_t u_[kStrideUV * ((kHeight + 1) / 2)];
+  uint8_t v_[kStrideUV * ((kHeight + 1) / 2)];
+};
+
+TEST_F(TestWrappedI420VideoFrame, InitialValues) {
+  scoped_ptr<WrappedI420VideoFrame> frame(CreateFrame());
+  // The planes are only readable through a const frame.
+  const I420VideoFrame* const_frame = frame.get();
+  EXPECT_EQ(kWidth, frame->width());
+  EXPECT_EQ(kHeight, frame->height());
+  EXPECT_EQ(100u, frame->timestamp());
+  EXPECT_EQ(10, frame->render_time_ms());
+  EXPECT_TRUE(frame->IsWrapped());
+  EXPECT_FALSE(frame->IsZeroSize());
+  EXPECT_TRUE(frame->native_handle() == NULL);
+  EXPECT_EQ(y_, const_frame->buffer(kYPlane));
+  EXPECT_EQ(u_, const_frame->buffer(kUPlane));
+  EXPECT_EQ(v_, const_frame->buffer(kVPlane));
+  EXPECT_EQ(kStrideY, frame->stride(kYPlane));
+  EXPECT_EQ(kStrideUV, frame->stride(kUPlane));
+  EXPECT_EQ(kStrideUV, frame->stride(kVPlane));
+  EXPECT_EQ(static_cast<int>(sizeof(y_)), frame->allocated_size(kYPlane));
+  EXPECT_EQ(static_cast<int>(sizeof(u_)), frame->allocated_size(kUPlane));
+  EXPECT_EQ(static_cast<int>(sizeof(v_)), frame->allocated_size(kVPlane));
+
+  // The width can not exceed the stride of the borrowed planes.
+  EXPECT_EQ(-1, frame->set_width(kStrideY + 1));
+  EXPECT_EQ(0, frame->set_width(32));
+  EXPECT_EQ(32, frame->width());
+}
+
+TEST_F(TestWrappedI420VideoFrame, RefCount) {
+  EXPECT_EQ(0, handle_.ref_count());
+  WrappedI420VideoFrame* frame = CreateFrame();
+  EXPECT_EQ(1, handle_.ref_count());
+  I420VideoFrame* clone = frame->CloneFrame();
+  EXPECT_EQ(2, handle_.ref_count());
+  delete frame;
+  EXPECT_EQ(1, handle_.ref_count());
+  delete clone;
+  EXPECT_EQ(0, handle_.ref_count());
+}
+
+TEST_F(TestWrappedI420VideoFrame, CloneSharesPlanes) {
+  scoped_ptr<WrappedI420VideoFrame> frame(CreateFrame());
+  frame->set_ntp_time_ms(1234);
+  scoped_ptr<I420VideoFrame> clone(frame->CloneFrame());
+  ASSERT_TRUE(clone.get() != NULL);
+  const I420VideoFrame* const_frame = frame.get();
+  const I420VideoFrame* const_clone = clone.get();
+  EXPECT_TRUE(clone->IsWrapped());
+  EXPECT_EQ(frame->width(), clone->width());
+  EXPECT_EQ(frame->height(), clone->height());
+  EXPECT_EQ(frame->timestamp(), clone->timestamp());
+  EXPECT_EQ(frame->ntp_time_ms(), clone->ntp_time_ms());
+  EXPECT_EQ(frame->render_time_ms(), clone->render_time_ms());
+  for (int plane = 0; plane < kNumOfPlanes; ++plane) {
+    PlaneType type = static_cast<PlaneType>(plane);
+    EXPECT_EQ(const_frame->buffer(type), const_clone->buffer(type));
+    EXPECT_EQ(frame->stride(type), clone->stride(type));
+  }
+}
+
+TEST_F(TestWrappedI420VideoFrame, CopyIntoRegularFrame) {
+  scoped_ptr<WrappedI420VideoFrame> frame(CreateFrame());
+  const I420VideoFrame* const_frame = frame.get();
+  I420VideoFrame copy;
+  EXPECT_EQ(0, copy.CopyFrame(*frame));
+  EXPECT_FALSE(copy.IsWrapped());
+  EXPECT_EQ(kWidth, copy.width());
+  EXPECT_EQ(kHeight, copy.height());
+  EXPECT_NE(const_frame->buffer(kYPlane), copy.buffer(kYPlane));
+  EXPECT_EQ(0, memcmp(y_, copy.buffer(kYPlane), sizeof(y_)));
+  EXPECT_EQ(0, memcmp(u_, copy.buffer(kUPlane), sizeof(u_)));
+  EXPECT_EQ(0, memcmp(v_, copy.buffer(kVPlane), sizeof(v_)));
+}
+
+}  // namespace webrtc
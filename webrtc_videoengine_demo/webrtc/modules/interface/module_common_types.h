@@ -260,9 +260,12 @@ struct RTCPVoIPMetric {
 // random loss model. The type |kFecMaskBursty| is based on a bursty/consecutive
 // loss model. The packet masks are defined in
 // modules/rtp_rtcp/fec_private_tables_random(bursty).h
+// The type |kFecMaskInterleaved| computes row and column (2-D) parity masks,
+// which recover any burst up to the number of columns for every frame size.
 enum FecMaskType {
   kFecMaskRandom,
   kFecMaskBursty,
+  kFecMaskInterleaved,
 };
 
 // Struct containing forward error correction settings.
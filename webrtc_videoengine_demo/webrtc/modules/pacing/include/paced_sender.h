@@ -26,9 +26,18 @@ class CriticalSectionWrapper;
 namespace paced_sender {
 class IntervalBudget;
 struct Packet;
+struct PacketBatch;
 class PacketList;
 }  // namespace paced_sender
 
+// A queued packet handed back to PacedSender::Callback.
+struct PacedPacketInfo {
+  uint32_t ssrc;
+  uint16_t sequence_number;
+  int64_t capture_time_ms;
+  bool retransmission;
+};
+
 class PacedSender : public Module {
  public:
   enum Priority {
@@ -55,9 +64,21 @@ class PacedSender : public Module {
 
    protected:
     virtual ~Callback() {}
+
+   public:
+    // Called with the packets released by one pass over the queues, in the
+    // order they are to be sent. Returns the number of packets, counted from
+    // the start of |packets|, that were sent or can be dropped; the others
+    // stay queued. The default calls TimeToSendPacket() for each packet and
+    // stops at the first one that can't be sent. Declared last so callbacks
+    // built against the old interface keep their vtable layout.
+    virtual int TimeToSendPackets(const PacedPacketInfo* packets,
+                                  int num_packets);
   };
 
   static const int kDefaultMaxQueueLengthMs = 2000;
+  // Max number of packets handed to Callback::TimeToSendPackets() at once.
+  static const int kMaxPacketsPerBatch = 64;
   // Pace in kbits/s until we receive first estimate.
   static const int kDefaultInitialPaceKbps = 2000;
   // Pacing-rate relative to our target send rate.
@@ -120,8 +141,13 @@ class PacedSender : public Module {
   paced_sender::Packet GetNextPacketFromList(paced_sender::PacketList* packets)
       EXCLUSIVE_LOCKS_REQUIRED(critsect_);
 
-  bool SendPacketFromList(paced_sender::PacketList* packet_list)
-      EXCLUSIVE_LOCKS_REQUIRED(critsect_);
+  // Takes the packets the budget allows, up to kMaxPacketsPerBatch, off the
+  // queues. Returns false if there is nothing to send.
+  bool BuildPacketBatch() EXCLUSIVE_LOCKS_REQUIRED(critsect_);
+
+  // Hands the batch to the callback and puts back the packets that weren't
+  // sent. Returns false if any packet couldn't be sent.
+  bool SendPacketBatch() EXCLUSIVE_LOCKS_REQUIRED(critsect_);
 
   // Updates the number of bytes that can be sent for the next time interval.
   void UpdateBytesPerInterval(uint32_t delta_time_in_ms)
@@ -157,6 +183,8 @@ class PacedSender : public Module {
       GUARDED_BY(critsect_);
   scoped_ptr<paced_sender::PacketList> low_priority_packets_
       GUARDED_BY(critsect_);
+  // Kept between calls to avoid allocating on every Process().
+  scoped_ptr<paced_sender::PacketBatch> batch_ GUARDED_BY(critsect_);
 };
 }  // namespace webrtc
 #endif  // WEBRTC_MODULES_PACED_SENDER_H_
@@ -0,0 +1,138 @@
+/*
+ *  Copyright (c) 2014 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_PACING_INCLUDE_PACER_ENGINE_H_
+#define WEBRTC_MODULES_PACING_INCLUDE_PACER_ENGINE_H_
+
+#include <set>
+#include <vector>
+
+#include "webrtc/modules/interface/module.h"
+#include "webrtc/modules/pacing/include/paced_sender.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/system_wrappers/interface/thread_annotations.h"
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+class Clock;
+class CriticalSectionWrapper;
+
+// Paces the packets of many streams from a single module. Where every
+// PacedSender owns its own queues, lock and process tick, a PacerEngine is
+// shared by all streams on a host and processed by one thread.
+//
+// Each stream has its own send rate. A packet is given a release time when
+// it's queued, right after the previous packet of the same stream has
+// drained at that rate, and is put in the slot of a timing wheel covering
+// that time. Queuing and releasing a packet are O(1) and don't allocate once
+// the packet pool has grown to the peak queue size.
+class PacerEngine : public Module {
+ public:
+  // Resolution of release times.
+  static const int kSlotUs = 100;
+  // Number of slots in the wheel. Packets are never scheduled further ahead
+  // than kNumSlots * kSlotUs, about 3.3 s.
+  static const int kNumSlots = 1 << 15;
+
+  explicit PacerEngine(Clock* clock);
+  virtual ~PacerEngine();
+
+  // Adds a stream sent at up to |bitrate_kbps|. Its packets are passed to
+  // |callback| when they're released. Returns an id for the other methods.
+  int AddStream(PacedSender::Callback* callback, int bitrate_kbps);
+
+  // Removes a stream; packets still queued for it are dropped. No callbacks
+  // for the stream are made once this returns, so it must not be called
+  // from a callback.
+  void RemoveStream(int stream_id);
+
+  void UpdateBitrate(int stream_id, int bitrate_kbps);
+
+  // Queues a packet of |stream_id|. High priority packets are released at
+  // once but still count towards the stream's rate. Low priority packets
+  // are paced like normal ones. A retransmission that is already queued is
+  // ignored. Unlike PacedSender::SendPacket() the packet is always queued.
+  void SendPacket(int stream_id,
+                  PacedSender::Priority priority,
+                  uint32_t ssrc,
+                  uint16_t sequence_number,
+                  int64_t capture_time_ms,
+                  int bytes,
+                  bool retransmission);
+
+  // Sets how far ahead a packet may be scheduled. Packets that would be
+  // released later are sent faster than the stream's rate instead.
+  void set_max_queue_length_ms(int max_queue_length_ms);
+
+  // Returns how long it will take to send the packets queued for the stream.
+  int QueueInMs(int stream_id) const;
+
+  // Returns the number of packets queued for all streams.
+  int QueuedPackets() const;
+
+  virtual int32_t TimeUntilNextProcess() OVERRIDE;
+
+  // Releases all packets whose release time has passed.
+  virtual int32_t Process() OVERRIDE;
+
+ private:
+  struct Stream {
+    Stream();
+    PacedSender::Callback* callback;
+    int bitrate_kbps;
+    // Time at which the packets queued so far have been sent at
+    // |bitrate_kbps|.
+    int64_t next_send_time_us;
+    int queued_packets;
+    // Retransmissions queued, to avoid sending one twice.
+    std::set<uint16_t> queued_retransmissions;
+  };
+
+  struct Packet {
+    int stream_id;
+    uint32_t ssrc;
+    uint16_t sequence_number;
+    bool retransmission;
+    int64_t capture_time_ms;
+    // Next packet in the same slot, or -1.
+    int next;
+  };
+
+  // FIFO of packets, linked through Packet::next.
+  struct Slot {
+    Slot() : head(-1), tail(-1) {}
+    int head;
+    int tail;
+  };
+
+  int AllocatePacket() EXCLUSIVE_LOCKS_REQUIRED(critsect_);
+  void FreePacket(int index) EXCLUSIVE_LOCKS_REQUIRED(critsect_);
+  void PushBack(int64_t slot, int index) EXCLUSIVE_LOCKS_REQUIRED(critsect_);
+  void PushFront(int64_t slot, int index) EXCLUSIVE_LOCKS_REQUIRED(critsect_);
+  int PopFront(int64_t slot) EXCLUSIVE_LOCKS_REQUIRED(critsect_);
+  // Drops the packet and updates the stream's bookkeeping.
+  void PacketDone(int index) EXCLUSIVE_LOCKS_REQUIRED(critsect_);
+
+  Clock* const clock_;
+  // Held while making callbacks, so that RemoveStream() can wait for them.
+  scoped_ptr<CriticalSectionWrapper> process_critsect_;
+  scoped_ptr<CriticalSectionWrapper> critsect_;
+  int64_t max_queue_length_us_ GUARDED_BY(critsect_);
+
+  std::vector<Stream> streams_ GUARDED_BY(critsect_);
+  std::vector<Packet> packets_ GUARDED_BY(critsect_);
+  std::vector<int> free_packets_ GUARDED_BY(critsect_);
+  std::vector<Slot> wheel_ GUARDED_BY(critsect_);
+  // Absolute number, i.e. time / kSlotUs, of the next slot to release.
+  int64_t current_slot_ GUARDED_BY(critsect_);
+  int queued_packets_ GUARDED_BY(critsect_);
+};
+}  // namespace webrtc
+#endif  // WEBRTC_MODULES_PACING_INCLUDE_PACER_ENGINE_H_
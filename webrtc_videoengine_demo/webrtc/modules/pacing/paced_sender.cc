@@ -14,6 +14,7 @@
 
 #include <map>
 #include <set>
+#include <vector>
 
 #include "webrtc/modules/interface/module_common_types.h"
 #include "webrtc/system_wrappers/interface/clock.h"
@@ -88,6 +89,15 @@ class PacketList {
     }
   }
 
+  // Puts back a packet taken off the front, unless it has been queued again
+  // in the meantime.
+  void push_front(const Packet& packet) {
+    if (sequence_number_set_[packet.ssrc].insert(
+            packet.sequence_number).second) {
+      packet_list_.push_front(packet);
+    }
+  }
+
  private:
   std::list<Packet> packet_list_;
   std::map<uint32_t, std::set<uint16_t> > sequence_number_set_;
@@ -125,9 +135,37 @@ class IntervalBudget {
   int target_rate_kbps_;
   int bytes_remaining_;
 };
+
+// Packets taken off the queues to be sent together. |lists[i]| is the list
+// |packets[i]| was taken from.
+struct PacketBatch {
+  void clear() {
+    packets.clear();
+    lists.clear();
+    info.clear();
+  }
+
+  std::vector<Packet> packets;
+  std::vector<PacketList*> lists;
+  std::vector<PacedPacketInfo> info;
+};
 }  // namespace paced_sender
 
+int PacedSender::Callback::TimeToSendPackets(const PacedPacketInfo* packets,
+                                             int num_packets) {
+  int num_sent = 0;
+  while (num_sent < num_packets &&
+         TimeToSendPacket(packets[num_sent].ssrc,
+                          packets[num_sent].sequence_number,
+                          packets[num_sent].capture_time_ms,
+                          packets[num_sent].retransmission)) {
+    ++num_sent;
+  }
+  return num_sent;
+}
+
 const float PacedSender::kDefaultPaceMultiplier = 2.5f;
+const int PacedSender::kMaxPacketsPerBatch;
 
 PacedSender::PacedSender(Clock* clock,
                          Callback* callback,
@@ -146,7 +184,11 @@ PacedSender::PacedSender(Clock* clock,
       capture_time_ms_last_sent_(0),
       high_priority_packets_(new paced_sender::PacketList),
       normal_priority_packets_(new paced_sender::PacketList),
-      low_priority_packets_(new paced_sender::PacketList) {
+      low_priority_packets_(new paced_sender::PacketList),
+      batch_(new paced_sender::PacketBatch) {
+  batch_->packets.reserve(kMaxPacketsPerBatch);
+  batch_->lists.reserve(kMaxPacketsPerBatch);
+  batch_->info.reserve(kMaxPacketsPerBatch);
   UpdateBytesPerInterval(kMinPacketLimitMs);
 }
 
@@ -270,9 +312,8 @@ int32_t PacedSender::Process() {
       uint32_t delta_time_ms = std::min(kMaxIntervalTimeMs, elapsed_time_ms);
       UpdateBytesPerInterval(delta_time_ms);
     }
-    paced_sender::PacketList* packet_list;
-    while (ShouldSendNextPacket(&packet_list)) {
-      if (!SendPacketFromList(packet_list))
+    while (BuildPacketBatch()) {
+      if (!SendPacketBatch())
         return 0;
     }
     if (high_priority_packets_->empty() &&
@@ -290,34 +331,64 @@ int32_t PacedSender::Process() {
   return 0;
 }
 
-bool PacedSender::SendPacketFromList(paced_sender::PacketList* packet_list)
-    EXCLUSIVE_LOCKS_REQUIRED(critsect_.get()) {
-  paced_sender::Packet packet = GetNextPacketFromList(packet_list);
-  critsect_->Leave();
+bool PacedSender::BuildPacketBatch() {
+  paced_sender::PacketBatch* batch = batch_.get();
+  batch->clear();
+  paced_sender::PacketList* packet_list;
+  while (static_cast<int>(batch->packets.size()) < kMaxPacketsPerBatch &&
+         ShouldSendNextPacket(&packet_list)) {
+    paced_sender::Packet packet = GetNextPacketFromList(packet_list);
+    packet_list->pop_front();
+    PacedPacketInfo info = {packet.ssrc, packet.sequence_number,
+                            packet.capture_time_ms, packet.retransmission};
+    batch->packets.push_back(packet);
+    batch->lists.push_back(packet_list);
+    batch->info.push_back(info);
+  }
+  return !batch->packets.empty();
+}
 
-  const bool success = callback_->TimeToSendPacket(packet.ssrc,
-                                                   packet.sequence_number,
-                                                   packet.capture_time_ms,
-                                                   packet.retransmission);
+bool PacedSender::SendPacketBatch() {
+  paced_sender::PacketBatch* batch = batch_.get();
+  const int num_packets = static_cast<int>(batch->packets.size());
+  critsect_->Leave();
+  int num_sent = callback_->TimeToSendPackets(&batch->info[0], num_packets);
   critsect_->Enter();
-  // If packet cannot be sent then keep it in packet list and exit early.
-  // There's no need to send more packets.
-  if (!success) {
-    return false;
-  }
-  packet_list->pop_front();
-  const bool last_packet =
-      packet_list->empty() ||
-      packet_list->front().capture_time_ms > packet.capture_time_ms;
-  if (packet_list != high_priority_packets_.get()) {
+  num_sent = std::max(0, std::min(num_sent, num_packets));
+
+  // Keep the packets that couldn't be sent at the front of their lists, in
+  // their original order. There's no need to send more packets.
+  for (int i = num_packets - 1; i >= num_sent; --i)
+    batch->lists[i]->push_front(batch->packets[i]);
+
+  for (int i = 0; i < num_sent; ++i) {
+    const paced_sender::Packet& packet = batch->packets[i];
+    paced_sender::PacketList* packet_list = batch->lists[i];
+    if (packet_list == high_priority_packets_.get())
+      continue;
     if (packet.capture_time_ms > capture_time_ms_last_sent_) {
       capture_time_ms_last_sent_ = packet.capture_time_ms;
-    } else if (packet.capture_time_ms == capture_time_ms_last_sent_ &&
-               last_packet) {
+      continue;
+    }
+    if (packet.capture_time_ms < capture_time_ms_last_sent_)
+      continue;
+    // The next packet from the same list is either later in the batch or
+    // still queued.
+    int64_t next_capture_time_ms = -1;
+    for (int j = i + 1; j < num_packets; ++j) {
+      if (batch->lists[j] == packet_list) {
+        next_capture_time_ms = batch->packets[j].capture_time_ms;
+        break;
+      }
+    }
+    if (next_capture_time_ms < 0 && !packet_list->empty())
+      next_capture_time_ms = packet_list->front().capture_time_ms;
+    if (next_capture_time_ms < 0 ||
+        next_capture_time_ms > packet.capture_time_ms) {
       TRACE_EVENT_ASYNC_END0("webrtc_rtp", "PacedSend", packet.capture_time_ms);
     }
   }
-  return true;
+  return num_sent == num_packets;
 }
 
 void PacedSender::UpdateBytesPerInterval(uint32_t delta_time_ms) {
@@ -8,6 +8,8 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <vector>
+
 #include "testing/gmock/include/gmock/gmock.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -54,6 +56,38 @@ class PacedSenderPadding : public PacedSender::Callback {
   int padding_sent_;
 };
 
+// Records the batches handed to TimeToSendPackets().
+class PacedSenderBatching : public PacedSender::Callback {
+ public:
+  PacedSenderBatching() : max_packets_to_send_(-1) {}
+
+  bool TimeToSendPacket(uint32_t ssrc, uint16_t sequence_number,
+                        int64_t capture_time_ms, bool retransmission) {
+    ADD_FAILURE() << "Packets should be sent in batches.";
+    return false;
+  }
+
+  int TimeToSendPackets(const PacedPacketInfo* packets, int num_packets) {
+    batch_sizes_.push_back(num_packets);
+    int num_sent = num_packets;
+    if (max_packets_to_send_ >= 0 && max_packets_to_send_ < num_packets)
+      num_sent = max_packets_to_send_;
+    for (int i = 0; i < num_sent; ++i)
+      sequence_numbers_.push_back(packets[i].sequence_number);
+    return num_sent;
+  }
+
+  int TimeToSendPadding(int bytes) { return 0; }
+
+  void set_max_packets_to_send(int max_packets) {
+    max_packets_to_send_ = max_packets;
+  }
+
+  int max_packets_to_send_;
+  std::vector<int> batch_sizes_;
+  std::vector<uint16_t> sequence_numbers_;
+};
+
 class PacedSenderTest : public ::testing::Test {
  protected:
   PacedSenderTest() : clock_(123456) {
@@ -542,5 +576,81 @@ TEST_F(PacedSenderTest, QueueTimeGrowsOverTime) {
   send_bucket_->Process();
   EXPECT_EQ(0, send_bucket_->QueueInMs());
 }
+
+TEST_F(PacedSenderTest, ReleasesBudgetAsOneBatch) {
+  PacedSenderBatching callback;
+  send_bucket_.reset(new PacedSender(
+      &clock_, &callback, kPaceMultiplier * kTargetBitrate, 0));
+  uint32_t ssrc = 12345;
+  for (uint16_t i = 0; i < 30; ++i) {
+    EXPECT_FALSE(send_bucket_->SendPacket(PacedSender::kNormalPriority, ssrc,
+        i, clock_.TimeInMilliseconds(), 250, false));
+  }
+  // Each interval has room for 3 packets, which are passed on together.
+  for (int k = 0; k < 5; ++k) {
+    send_bucket_->Process();
+    clock_.AdvanceTimeMilliseconds(5);
+  }
+  ASSERT_EQ(5u, callback.batch_sizes_.size());
+  for (size_t i = 0; i < callback.batch_sizes_.size(); ++i)
+    EXPECT_EQ(3, callback.batch_sizes_[i]);
+  ASSERT_EQ(15u, callback.sequence_numbers_.size());
+  for (uint16_t i = 0; i < 15; ++i)
+    EXPECT_EQ(i, callback.sequence_numbers_[i]);
+}
+
+TEST_F(PacedSenderTest, UnsentPacketsAreRetriedInOrder) {
+  PacedSenderBatching callback;
+  send_bucket_.reset(new PacedSender(
+      &clock_, &callback, kPaceMultiplier * kTargetBitrate, 0));
+  uint32_t ssrc = 12345;
+  for (uint16_t i = 0; i < 10; ++i) {
+    EXPECT_FALSE(send_bucket_->SendPacket(PacedSender::kNormalPriority, ssrc,
+        i, clock_.TimeInMilliseconds(), 250, false));
+  }
+  EXPECT_FALSE(send_bucket_->SendPacket(PacedSender::kHighPriority, ssrc,
+      100, clock_.TimeInMilliseconds(), 250, true));
+  callback.set_max_packets_to_send(1);
+  send_bucket_->Process();
+  ASSERT_EQ(1u, callback.batch_sizes_.size());
+  EXPECT_EQ(3, callback.batch_sizes_[0]);
+
+  callback.set_max_packets_to_send(-1);
+  clock_.AdvanceTimeMilliseconds(5);
+  send_bucket_->Process();
+  ASSERT_EQ(2u, callback.batch_sizes_.size());
+  EXPECT_EQ(3, callback.batch_sizes_[1]);
+  // The retransmission goes first, the packets that weren't sent follow in
+  // their original order.
+  const uint16_t kExpected[] = {100, 0, 1, 2};
+  ASSERT_EQ(4u, callback.sequence_numbers_.size());
+  for (size_t i = 0; i < 4; ++i)
+    EXPECT_EQ(kExpected[i], callback.sequence_numbers_[i]);
+}
+
+TEST_F(PacedSenderTest, LongQueueIsSentInBatches) {
+  PacedSenderBatching callback;
+  send_bucket_.reset(new PacedSender(
+      &clock_, &callback, kPaceMultiplier * kTargetBitrate, 0));
+  send_bucket_->Pause();
+  uint32_t ssrc = 12345;
+  const int kNumPackets = 100;
+  for (uint16_t i = 0; i < kNumPackets; ++i) {
+    EXPECT_FALSE(send_bucket_->SendPacket(PacedSender::kNormalPriority, ssrc,
+        i, clock_.TimeInMilliseconds(), 250, false));
+  }
+  clock_.AdvanceTimeMilliseconds(PacedSender::kDefaultMaxQueueLengthMs + 1);
+  send_bucket_->Resume();
+  // The queue is too old, so all of it is sent, at most
+  // kMaxPacketsPerBatch packets at a time.
+  send_bucket_->Process();
+  EXPECT_EQ(0, send_bucket_->QueueInMs());
+  ASSERT_EQ(2u, callback.batch_sizes_.size());
+  EXPECT_EQ(PacedSender::kMaxPacketsPerBatch, callback.batch_sizes_[0]);
+  EXPECT_EQ(kNumPackets - PacedSender::kMaxPacketsPerBatch,
+            callback.batch_sizes_[1]);
+  EXPECT_EQ(static_cast<size_t>(kNumPackets),
+            callback.sequence_numbers_.size());
+}
 }  // namespace test
 }  // namespace webrtc
@@ -0,0 +1,264 @@
+/*
+ *  Copyright (c) 2014 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/pacing/include/pacer_engine.h"
+
+#include <assert.h>
+
+#include <algorithm>
+
+#include "webrtc/system_wrappers/interface/clock.h"
+#include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
+
+namespace {
+// Longest time Process() waits when nothing is due. Packets queued while it
+// waits are released late by up to this much, as with PacedSender.
+const int kMaxProcessIntervalMs = 5;
+}  // namespace
+
+namespace webrtc {
+
+const int PacerEngine::kSlotUs;
+const int PacerEngine::kNumSlots;
+
+PacerEngine::Stream::Stream()
+    : callback(NULL),
+      bitrate_kbps(0),
+      next_send_time_us(0),
+      queued_packets(0) {}
+
+PacerEngine::PacerEngine(Clock* clock)
+    : clock_(clock),
+      process_critsect_(CriticalSectionWrapper::CreateCriticalSection()),
+      critsect_(CriticalSectionWrapper::CreateCriticalSection()),
+      max_queue_length_us_(PacedSender::kDefaultMaxQueueLengthMs * 1000),
+      wheel_(kNumSlots),
+      current_slot_(clock->TimeInMicroseconds() / kSlotUs),
+      queued_packets_(0) {}
+
+PacerEngine::~PacerEngine() {}
+
+int PacerEngine::AddStream(PacedSender::Callback* callback,
+                           int bitrate_kbps) {
+  assert(callback);
+  CriticalSectionScoped cs(critsect_.get());
+  // Reuse the id of a removed stream once its packets are gone, so that
+  // stale packets can't be mistaken for the new stream's.
+  size_t id = 0;
+  while (id < streams_.size() &&
+         (streams_[id].callback || streams_[id].queued_packets > 0)) {
+    ++id;
+  }
+  if (id == streams_.size())
+    streams_.push_back(Stream());
+  Stream& stream = streams_[id];
+  stream.callback = callback;
+  stream.bitrate_kbps = bitrate_kbps;
+  stream.next_send_time_us = 0;
+  stream.queued_retransmissions.clear();
+  return static_cast<int>(id);
+}
+
+void PacerEngine::RemoveStream(int stream_id) {
+  // Wait for any callback in progress.
+  CriticalSectionScoped process_cs(process_critsect_.get());
+  CriticalSectionScoped cs(critsect_.get());
+  assert(stream_id >= 0 && stream_id < static_cast<int>(streams_.size()));
+  // Queued packets are dropped when they're released.
+  streams_[stream_id].callback = NULL;
+}
+
+void PacerEngine::UpdateBitrate(int stream_id, int bitrate_kbps) {
+  CriticalSectionScoped cs(critsect_.get());
+  assert(stream_id >= 0 && stream_id < static_cast<int>(streams_.size()));
+  streams_[stream_id].bitrate_kbps = bitrate_kbps;
+}
+
+void PacerEngine::SendPacket(int stream_id,
+                             PacedSender::Priority priority,
+                             uint32_t ssrc,
+                             uint16_t sequence_number,
+                             int64_t capture_time_ms,
+                             int bytes,
+                             bool retransmission) {
+  CriticalSectionScoped cs(critsect_.get());
+  assert(stream_id >= 0 && stream_id < static_cast<int>(streams_.size()));
+  Stream& stream = streams_[stream_id];
+  if (!stream.callback)
+    return;
+  if (retransmission &&
+      !stream.queued_retransmissions.insert(sequence_number).second) {
+    return;
+  }
+  const int64_t now_us = clock_->TimeInMicroseconds();
+  if (capture_time_ms < 0)
+    capture_time_ms = now_us / 1000;
+
+  const int64_t latest_send_time_us = now_us + max_queue_length_us_;
+  const int64_t send_time_us = std::max(stream.next_send_time_us, now_us);
+  const int64_t duration_us = stream.bitrate_kbps > 0 ?
+      static_cast<int64_t>(bytes) * 8000 / stream.bitrate_kbps :
+      max_queue_length_us_;
+  stream.next_send_time_us =
+      std::min(send_time_us + duration_us, latest_send_time_us);
+  const int64_t release_time_us = priority == PacedSender::kHighPriority ?
+      now_us : std::min(send_time_us, latest_send_time_us);
+
+  int index = AllocatePacket();
+  Packet& packet = packets_[index];
+  packet.stream_id = stream_id;
+  packet.ssrc = ssrc;
+  packet.sequence_number = sequence_number;
+  packet.retransmission = retransmission;
+  packet.capture_time_ms = capture_time_ms;
+  ++stream.queued_packets;
+  ++queued_packets_;
+
+  // Never schedule behind the slot being released, or a full turn ahead.
+  int64_t slot = std::max(release_time_us / kSlotUs, current_slot_);
+  slot = std::min(slot, current_slot_ + kNumSlots - 1);
+  PushBack(slot, index);
+}
+
+void PacerEngine::set_max_queue_length_ms(int max_queue_length_ms) {
+  CriticalSectionScoped cs(critsect_.get());
+  const int64_t max_us = static_cast<int64_t>(kNumSlots - 1) * kSlotUs;
+  if (max_queue_length_ms < 0) {
+    max_queue_length_us_ = max_us;
+  } else {
+    max_queue_length_us_ =
+        std::min(static_cast<int64_t>(max_queue_length_ms) * 1000, max_us);
+  }
+}
+
+int PacerEngine::QueueInMs(int stream_id) const {
+  CriticalSectionScoped cs(critsect_.get());
+  assert(stream_id >= 0 && stream_id < static_cast<int>(streams_.size()));
+  const Stream& stream = streams_[stream_id];
+  if (stream.queued_packets == 0)
+    return 0;
+  int64_t queue_us = stream.next_send_time_us - clock_->TimeInMicroseconds();
+  return static_cast<int>(std::max<int64_t>(queue_us, 0) / 1000);
+}
+
+int PacerEngine::QueuedPackets() const {
+  CriticalSectionScoped cs(critsect_.get());
+  return queued_packets_;
+}
+
+int32_t PacerEngine::TimeUntilNextProcess() {
+  CriticalSectionScoped cs(critsect_.get());
+  if (queued_packets_ == 0)
+    return kMaxProcessIntervalMs;
+  const int64_t now_us = clock_->TimeInMicroseconds();
+  const int64_t last_slot =
+      current_slot_ + kMaxProcessIntervalMs * 1000 / kSlotUs;
+  for (int64_t slot = current_slot_; slot < last_slot; ++slot) {
+    if (wheel_[slot % kNumSlots].head >= 0) {
+      int64_t wait_us = slot * kSlotUs - now_us;
+      return static_cast<int32_t>(std::max<int64_t>(wait_us, 0) / 1000);
+    }
+  }
+  return kMaxProcessIntervalMs;
+}
+
+int32_t PacerEngine::Process() {
+  CriticalSectionScoped process_cs(process_critsect_.get());
+  CriticalSectionScoped cs(critsect_.get());
+  const int64_t now_slot = clock_->TimeInMicroseconds() / kSlotUs;
+  while (queued_packets_ > 0 && current_slot_ <= now_slot) {
+    int index = PopFront(current_slot_);
+    if (index < 0) {
+      // Stay on the current slot, packets may still be queued for it.
+      if (current_slot_ == now_slot)
+        break;
+      ++current_slot_;
+      continue;
+    }
+    // Copy, |packets_| may grow while the lock is released.
+    const Packet packet = packets_[index];
+    PacedSender::Callback* callback = streams_[packet.stream_id].callback;
+    if (!callback) {
+      PacketDone(index);
+      continue;
+    }
+    critsect_->Leave();
+    const bool success = callback->TimeToSendPacket(packet.ssrc,
+                                                    packet.sequence_number,
+                                                    packet.capture_time_ms,
+                                                    packet.retransmission);
+    critsect_->Enter();
+    if (!success) {
+      // Retry on the next call, like PacedSender does.
+      PushFront(current_slot_, index);
+      return 0;
+    }
+    PacketDone(index);
+  }
+  if (queued_packets_ == 0)
+    current_slot_ = std::max(current_slot_, now_slot);
+  return 0;
+}
+
+int PacerEngine::AllocatePacket() {
+  if (free_packets_.empty()) {
+    packets_.push_back(Packet());
+    return static_cast<int>(packets_.size()) - 1;
+  }
+  int index = free_packets_.back();
+  free_packets_.pop_back();
+  return index;
+}
+
+void PacerEngine::FreePacket(int index) {
+  free_packets_.push_back(index);
+}
+
+void PacerEngine::PushBack(int64_t slot, int index) {
+  Slot& s = wheel_[slot % kNumSlots];
+  packets_[index].next = -1;
+  if (s.tail >= 0) {
+    packets_[s.tail].next = index;
+  } else {
+    s.head = index;
+  }
+  s.tail = index;
+}
+
+void PacerEngine::PushFront(int64_t slot, int index) {
+  Slot& s = wheel_[slot % kNumSlots];
+  packets_[index].next = s.head;
+  s.head = index;
+  if (s.tail < 0)
+    s.tail = index;
+}
+
+int PacerEngine::PopFront(int64_t slot) {
+  Slot& s = wheel_[slot % kNumSlots];
+  int index = s.head;
+  if (index >= 0) {
+    s.head = packets_[index].next;
+    if (s.head < 0)
+      s.tail = -1;
+  }
+  return index;
+}
+
+void PacerEngine::PacketDone(int index) {
+  const Packet& packet = packets_[index];
+  Stream& stream = streams_[packet.stream_id];
+  if (packet.retransmission)
+    stream.queued_retransmissions.erase(packet.sequence_number);
+  --stream.queued_packets;
+  --queued_packets_;
+  FreePacket(index);
+}
+
+}  // namespace webrtc
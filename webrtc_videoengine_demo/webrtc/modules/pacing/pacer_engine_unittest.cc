@@ -0,0 +1,301 @@
+/*
+ *  Copyright (c) 2014 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdio.h>
+
+#include <vector>
+
+#include "testing/gmock/include/gmock/gmock.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+#include "webrtc/modules/pacing/include/pacer_engine.h"
+#include "webrtc/system_wrappers/interface/clock.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+
+using testing::_;
+using testing::Return;
+
+namespace webrtc {
+namespace test {
+
+static const uint32_t kSsrc = 12345;
+static const int kPacketSize = 1000;
+// 1000 bytes take 10 ms at 800 kbps.
+static const int kBitrateKbps = 800;
+
+// Records when each packet was released.
+class RecordingCallback : public PacedSender::Callback {
+ public:
+  explicit RecordingCallback(Clock* clock)
+      : clock_(clock), packets_sent_(0), fail_(false) {}
+
+  virtual bool TimeToSendPacket(uint32_t ssrc, uint16_t sequence_number,
+                                int64_t capture_time_ms,
+                                bool retransmission) OVERRIDE {
+    if (fail_)
+      return false;
+    ++packets_sent_;
+    sequence_numbers_.push_back(sequence_number);
+    send_times_ms_.push_back(clock_->TimeInMilliseconds());
+    return true;
+  }
+
+  virtual int TimeToSendPadding(int bytes) OVERRIDE { return 0; }
+
+  Clock* clock_;
+  int packets_sent_;
+  bool fail_;
+  std::vector<uint16_t> sequence_numbers_;
+  std::vector<int64_t> send_times_ms_;
+};
+
+class PacerEngineTest : public ::testing::Test {
+ protected:
+  PacerEngineTest() : clock_(123456), pacer_(&clock_), callback_(&clock_) {}
+
+  void AdvanceAndProcess(int ms) {
+    for (int i = 0; i < ms; ++i) {
+      clock_.AdvanceTimeMilliseconds(1);
+      pacer_.Process();
+    }
+  }
+
+  SimulatedClock clock_;
+  PacerEngine pacer_;
+  RecordingCallback callback_;
+};
+
+TEST_F(PacerEngineTest, PacesStreamAtItsBitrate) {
+  int stream = pacer_.AddStream(&callback_, kBitrateKbps);
+  for (uint16_t i = 0; i < 10; ++i) {
+    pacer_.SendPacket(stream, PacedSender::kNormalPriority, kSsrc, i,
+                      clock_.TimeInMilliseconds(), kPacketSize, false);
+  }
+  EXPECT_EQ(100, pacer_.QueueInMs(stream));
+  const int64_t start_ms = clock_.TimeInMilliseconds();
+  pacer_.Process();
+  EXPECT_EQ(1, callback_.packets_sent_);
+  AdvanceAndProcess(100);
+  ASSERT_EQ(10, callback_.packets_sent_);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(i, callback_.sequence_numbers_[i]);
+    EXPECT_EQ(start_ms + 10 * i, callback_.send_times_ms_[i]);
+  }
+  EXPECT_EQ(0, pacer_.QueuedPackets());
+}
+
+TEST_F(PacerEngineTest, StreamsArePacedIndependently) {
+  RecordingCallback fast_callback(&clock_);
+  int slow = pacer_.AddStream(&callback_, kBitrateKbps);
+  int fast = pacer_.AddStream(&fast_callback, 4 * kBitrateKbps);
+  for (uint16_t i = 0; i < 8; ++i) {
+    pacer_.SendPacket(slow, PacedSender::kNormalPriority, kSsrc, i,
+                      clock_.TimeInMilliseconds(), kPacketSize, false);
+    pacer_.SendPacket(fast, PacedSender::kNormalPriority, kSsrc + 1, i,
+                      clock_.TimeInMilliseconds(), kPacketSize, false);
+  }
+  pacer_.Process();
+  AdvanceAndProcess(20);
+  EXPECT_EQ(3, callback_.packets_sent_);
+  EXPECT_EQ(8, fast_callback.packets_sent_);
+  AdvanceAndProcess(60);
+  EXPECT_EQ(8, callback_.packets_sent_);
+}
+
+TEST_F(PacerEngineTest, HighPriorityIsSentFirst) {
+  int stream = pacer_.AddStream(&callback_, kBitrateKbps);
+  for (uint16_t i = 0; i < 5; ++i) {
+    pacer_.SendPacket(stream, PacedSender::kNormalPriority, kSsrc, i,
+                      clock_.TimeInMilliseconds(), kPacketSize, false);
+  }
+  pacer_.Process();
+  EXPECT_EQ(1, callback_.packets_sent_);
+  pacer_.SendPacket(stream, PacedSender::kHighPriority, kSsrc, 100,
+                    clock_.TimeInMilliseconds(), kPacketSize, true);
+  pacer_.Process();
+  ASSERT_EQ(2, callback_.packets_sent_);
+  EXPECT_EQ(100, callback_.sequence_numbers_[1]);
+  // It still uses the stream's bitrate.
+  EXPECT_EQ(60, pacer_.QueueInMs(stream));
+}
+
+TEST_F(PacerEngineTest, QueuedRetransmissionIsNotDuplicated) {
+  int stream = pacer_.AddStream(&callback_, kBitrateKbps);
+  for (int i = 0; i < 3; ++i) {
+    pacer_.SendPacket(stream, PacedSender::kHighPriority, kSsrc, 7,
+                      clock_.TimeInMilliseconds(), kPacketSize, true);
+  }
+  EXPECT_EQ(1, pacer_.QueuedPackets());
+  pacer_.Process();
+  EXPECT_EQ(1, callback_.packets_sent_);
+  // Once sent it may be retransmitted again.
+  pacer_.SendPacket(stream, PacedSender::kHighPriority, kSsrc, 7,
+                    clock_.TimeInMilliseconds(), kPacketSize, true);
+  EXPECT_EQ(1, pacer_.QueuedPackets());
+}
+
+TEST_F(PacerEngineTest, FailedSendIsRetried) {
+  int stream = pacer_.AddStream(&callback_, kBitrateKbps);
+  pacer_.SendPacket(stream, PacedSender::kNormalPriority, kSsrc, 1,
+                    clock_.TimeInMilliseconds(), kPacketSize, false);
+  pacer_.SendPacket(stream, PacedSender::kNormalPriority, kSsrc, 2,
+                    clock_.TimeInMilliseconds(), kPacketSize, false);
+  callback_.fail_ = true;
+  AdvanceAndProcess(20);
+  EXPECT_EQ(0, callback_.packets_sent_);
+  EXPECT_EQ(2, pacer_.QueuedPackets());
+  callback_.fail_ = false;
+  pacer_.Process();
+  ASSERT_EQ(2, callback_.packets_sent_);
+  EXPECT_EQ(1, callback_.sequence_numbers_[0]);
+  EXPECT_EQ(2, callback_.sequence_numbers_[1]);
+}
+
+TEST_F(PacerEngineTest, RemovedStreamIsNotCalled) {
+  int stream = pacer_.AddStream(&callback_, kBitrateKbps);
+  for (uint16_t i = 0; i < 5; ++i) {
+    pacer_.SendPacket(stream, PacedSender::kNormalPriority, kSsrc, i,
+                      clock_.TimeInMilliseconds(), kPacketSize, false);
+  }
+  pacer_.Process();
+  pacer_.RemoveStream(stream);
+  RecordingCallback other_callback(&clock_);
+  // The id isn't reused while packets of the removed stream are queued.
+  EXPECT_NE(stream, pacer_.AddStream(&other_callback, kBitrateKbps));
+  AdvanceAndProcess(100);
+  EXPECT_EQ(1, callback_.packets_sent_);
+  EXPECT_EQ(0, pacer_.QueuedPackets());
+  EXPECT_EQ(stream, pacer_.AddStream(&other_callback, kBitrateKbps));
+}
+
+TEST_F(PacerEngineTest, MaxQueueLength) {
+  pacer_.set_max_queue_length_ms(50);
+  int stream = pacer_.AddStream(&callback_, kBitrateKbps);
+  for (uint16_t i = 0; i < 20; ++i) {
+    pacer_.SendPacket(stream, PacedSender::kNormalPriority, kSsrc, i,
+                      clock_.TimeInMilliseconds(), kPacketSize, false);
+  }
+  EXPECT_EQ(50, pacer_.QueueInMs(stream));
+  pacer_.Process();
+  AdvanceAndProcess(50);
+  EXPECT_EQ(20, callback_.packets_sent_);
+}
+
+TEST_F(PacerEngineTest, TimeUntilNextProcess) {
+  int stream = pacer_.AddStream(&callback_, kBitrateKbps);
+  EXPECT_EQ(5, pacer_.TimeUntilNextProcess());
+  pacer_.SendPacket(stream, PacedSender::kNormalPriority, kSsrc, 1,
+                    clock_.TimeInMilliseconds(), kPacketSize / 4, false);
+  pacer_.SendPacket(stream, PacedSender::kNormalPriority, kSsrc, 2,
+                    clock_.TimeInMilliseconds(), kPacketSize / 4, false);
+  EXPECT_EQ(0, pacer_.TimeUntilNextProcess());
+  pacer_.Process();
+  // The second packet is due 2.5 ms after the first.
+  EXPECT_EQ(2, pacer_.TimeUntilNextProcess());
+  clock_.AdvanceTimeMicroseconds(2500);
+  EXPECT_EQ(0, pacer_.TimeUntilNextProcess());
+  pacer_.Process();
+  EXPECT_EQ(2, callback_.packets_sent_);
+}
+
+class CountingCallback : public PacedSender::Callback {
+ public:
+  CountingCallback() : packets_sent_(0) {}
+  virtual bool TimeToSendPacket(uint32_t ssrc, uint16_t sequence_number,
+                                int64_t capture_time_ms,
+                                bool retransmission) OVERRIDE {
+    ++packets_sent_;
+    return true;
+  }
+  virtual int TimeToSendPadding(int bytes) OVERRIDE { return 0; }
+  int packets_sent_;
+};
+
+// Paces 100k packets/s spread over 1000 streams for 10 simulated seconds,
+// once with a PacedSender per stream processed every 5 ms and once with a
+// single PacerEngine processed every millisecond.
+TEST(PacerEngineBenchmark, DISABLED_ThousandStreams) {
+  const int kNumStreams = 1000;
+  const int kPacketsPerMs = 100;
+  const int kDurationMs = 10000;
+  const int kStreamBitrateKbps = 2500;
+  const int kBenchmarkPacketSize = 1200;
+
+  std::vector<CountingCallback> callbacks(kNumStreams);
+  {
+    SimulatedClock clock(0);
+    std::vector<PacedSender*> senders;
+    for (int i = 0; i < kNumStreams; ++i) {
+      senders.push_back(new PacedSender(&clock, &callbacks[i],
+                                        kStreamBitrateKbps, 0));
+    }
+    uint16_t sequence_number = 0;
+    int stream = 0;
+    TickTime start = TickTime::Now();
+    for (int ms = 0; ms < kDurationMs; ++ms) {
+      for (int i = 0; i < kPacketsPerMs; ++i) {
+        senders[stream]->SendPacket(PacedSender::kNormalPriority, kSsrc + stream,
+                                    sequence_number, clock.TimeInMilliseconds(),
+                                    kBenchmarkPacketSize, false);
+        if (++stream == kNumStreams) {
+          stream = 0;
+          ++sequence_number;
+        }
+      }
+      clock.AdvanceTimeMilliseconds(1);
+      for (int i = 0; i < kNumStreams; ++i) {
+        if (senders[i]->TimeUntilNextProcess() <= 0)
+          senders[i]->Process();
+      }
+    }
+    int64_t elapsed_us = (TickTime::Now() - start).Microseconds();
+    int sent = 0;
+    for (int i = 0; i < kNumStreams; ++i) {
+      sent += callbacks[i].packets_sent_;
+      callbacks[i].packets_sent_ = 0;
+      delete senders[i];
+    }
+    printf("PacedSender x %d: %d packets, %.3f us/packet\n", kNumStreams, sent,
+           static_cast<double>(elapsed_us) / sent);
+  }
+  {
+    SimulatedClock clock(0);
+    PacerEngine pacer(&clock);
+    std::vector<int> streams;
+    for (int i = 0; i < kNumStreams; ++i)
+      streams.push_back(pacer.AddStream(&callbacks[i], kStreamBitrateKbps));
+    uint16_t sequence_number = 0;
+    int stream = 0;
+    TickTime start = TickTime::Now();
+    for (int ms = 0; ms < kDurationMs; ++ms) {
+      for (int i = 0; i < kPacketsPerMs; ++i) {
+        pacer.SendPacket(streams[stream], PacedSender::kNormalPriority,
+                         kSsrc + stream, sequence_number,
+                         clock.TimeInMilliseconds(), kBenchmarkPacketSize,
+                         false);
+        if (++stream == kNumStreams) {
+          stream = 0;
+          ++sequence_number;
+        }
+      }
+      clock.AdvanceTimeMilliseconds(1);
+      pacer.Process();
+    }
+    int64_t elapsed_us = (TickTime::Now() - start).Microseconds();
+    int sent = 0;
+    for (int i = 0; i < kNumStreams; ++i)
+      sent += callbacks[i].packets_sent_;
+    printf("PacerEngine: %d packets, %.3f us/packet\n", sent,
+           static_cast<double>(elapsed_us) / sent);
+  }
+}
+
+}  // namespace test
+}  // namespace webrtc
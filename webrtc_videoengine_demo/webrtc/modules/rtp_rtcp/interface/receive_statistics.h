@@ -44,6 +44,12 @@ class StreamStatistician {
 
 typedef std::map<uint32_t, StreamStatistician*> StatisticianMap;
 
+// Statistics of one stream, as sent in an RTCP report block.
+struct ReportBlockStatistics {
+  uint32_t ssrc;
+  RtcpStatistics statistics;
+};
+
 class ReceiveStatistics : public Module {
  public:
   virtual ~ReceiveStatistics() {}
@@ -75,6 +81,14 @@ class ReceiveStatistics : public Module {
   // Called on new RTP stats creation.
   virtual void RegisterRtpStatisticsCallback(
       StreamDataCountersCallback* callback) = 0;
+
+  // Takes the statistics of up to |max_streams| of the active statisticians,
+  // as GetStatistics() would, and writes them to |statistics|. Streams that
+  // have nothing to report are skipped. Returns the number of entries written.
+  // Kept last so that implementations built elsewhere keep their vtable.
+  virtual int GetActiveStatistics(bool reset,
+                                  ReportBlockStatistics* statistics,
+                                  int max_streams);
 };
 
 class NullReceiveStatistics : public ReceiveStatistics {
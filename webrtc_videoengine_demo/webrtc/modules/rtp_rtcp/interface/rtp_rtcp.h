@@ -20,6 +20,7 @@ namespace webrtc {
 // Forward declarations.
 class PacedSender;
 class ReceiveStatistics;
+struct PacedPacketInfo;
 class RemoteBitrateEstimator;
 class RtpReceiver;
 class Transport;
@@ -730,6 +731,17 @@ class RtpRtcp : public Module {
     *   return -1 on failure else 0
     */
     virtual int32_t RequestKeyFrame() = 0;
+
+    /*
+    *   Sends a batch of packets released by the pacer, with one call to the
+    *   transport per sender where possible. Declared last so callers built
+    *   against the previous interface keep their vtable layout.
+    *
+    *   return the number of packets, from the start of |packets|, that were
+    *   sent or dropped
+    */
+    virtual int TimeToSendPackets(const PacedPacketInfo* packets,
+                                  int num_packets) = 0;
 };
 }  // namespace webrtc
 #endif // WEBRTC_MODULES_RTP_RTCP_INTERFACE_RTP_RTCP_H_
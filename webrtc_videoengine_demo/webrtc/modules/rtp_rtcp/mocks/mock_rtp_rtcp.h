@@ -132,6 +132,8 @@ class MockRtpRtcp : public RtpRtcp {
   MOCK_METHOD4(TimeToSendPacket,
       bool(uint32_t ssrc, uint16_t sequence_number, int64_t capture_time_ms,
            bool retransmission));
+  MOCK_METHOD2(TimeToSendPackets,
+      int(const PacedPacketInfo* packets, int num_packets));
   MOCK_METHOD1(TimeToSendPadding,
       int(int bytes));
   MOCK_CONST_METHOD2(GetSendSideDelay,
@@ -38,6 +38,12 @@ void Bitrate::Update(const int32_t bytes) {
   packet_count_++;
 }
 
+void Bitrate::Update(const int32_t bytes, const uint32_t packets) {
+  CriticalSectionScoped cs(crit_.get());
+  bytes_count_ += bytes;
+  packet_count_ += packets;
+}
+
 uint32_t Bitrate::PacketRate() const {
   CriticalSectionScoped cs(crit_.get());
   return packet_rate_;
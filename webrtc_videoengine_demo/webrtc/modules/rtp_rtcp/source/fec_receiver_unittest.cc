@@ -220,6 +220,36 @@ TEST_F(ReceiverFecTest, MaxFramesOneFec) {
   DeletePackets(&media_packets);
 }
 
+TEST_F(ReceiverFecTest, InterleavedMaskRecoversBurst) {
+  const unsigned int kNumFecPackets = 4u;
+  const unsigned int kNumMediaPackets = 12u;
+  std::list<RtpPacket*> media_rtp_packets;
+  std::list<Packet*> media_packets;
+  GenerateFrame(kNumMediaPackets, 0, &media_rtp_packets, &media_packets);
+  std::list<Packet*> fec_packets;
+  EXPECT_EQ(0, fec_->GenerateFEC(media_packets,
+                                 kNumFecPackets * 255 / kNumMediaPackets, 0,
+                                 false, kFecMaskInterleaved, &fec_packets));
+  ASSERT_EQ(kNumFecPackets, fec_packets.size());
+
+  // Drop a burst of 4 media packets, one in each column.
+  std::list<RtpPacket*>::iterator it = media_rtp_packets.begin();
+  for (unsigned int i = 0; i < kNumMediaPackets; ++i, ++it) {
+    VerifyReconstructedMediaPacket(*it, 1);
+    if (i >= 3 && i < 3 + kNumFecPackets)
+      continue;
+    BuildAndAddRedMediaPacket(*it);
+    EXPECT_EQ(0, receiver_fec_->ProcessReceivedFec());
+  }
+  for (std::list<Packet*>::iterator fec_it = fec_packets.begin();
+       fec_it != fec_packets.end(); ++fec_it) {
+    BuildAndAddRedFecPacket(*fec_it);
+    EXPECT_EQ(0, receiver_fec_->ProcessReceivedFec());
+  }
+
+  DeletePackets(&media_packets);
+}
+
 TEST_F(ReceiverFecTest, TooManyFrames) {
   const unsigned int kNumFecPackets = 1u;
   const unsigned int kNumMediaPackets = 49u;
@@ -0,0 +1,56 @@
+/*
+ *  Copyright (c) 2014 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/rtp_rtcp/source/fec_xor.h"
+
+#include <string.h>
+
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
+
+namespace webrtc {
+
+void XorBuffers_C(uint8_t* dst, const uint8_t* src, size_t length) {
+  // Eight bytes at a time; memcpy keeps the unaligned accesses well defined
+  // and compiles to plain loads and stores.
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t)) {
+    uint64_t a;
+    uint64_t b;
+    memcpy(&a, dst + i, sizeof(a));
+    memcpy(&b, src + i, sizeof(b));
+    a ^= b;
+    memcpy(dst + i, &a, sizeof(a));
+  }
+  for (; i < length; ++i) {
+    dst[i] ^= src[i];
+  }
+}
+
+void XorBuffers(uint8_t* dst, const uint8_t* src, size_t length) {
+  static void (*xor_proc)(uint8_t*, const uint8_t*, size_t) = NULL;
+
+  if (!xor_proc) {
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+    if (WebRtc_GetCPUInfo(kAVX2)) {
+      xor_proc = &XorBuffers_AVX2;
+    } else if (WebRtc_GetCPUInfo(kSSE2)) {
+      xor_proc = &XorBuffers_SSE2;
+    } else {
+      xor_proc = &XorBuffers_C;
+    }
+#else
+    xor_proc = &XorBuffers_C;
+#endif
+  }
+
+  xor_proc(dst, src, length);
+}
+
+}  // namespace webrtc
@@ -0,0 +1,33 @@
+/*
+ *  Copyright (c) 2014 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_RTP_RTCP_SOURCE_FEC_XOR_H_
+#define WEBRTC_MODULES_RTP_RTCP_SOURCE_FEC_XOR_H_
+
+#include <stddef.h>
+
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+
+// Computes dst[i] ^= src[i] for |length| bytes, using the widest kernel the
+// CPU supports. The buffers may be unaligned but must not overlap.
+void XorBuffers(uint8_t* dst, const uint8_t* src, size_t length);
+
+// The kernels XorBuffers() chooses from; exposed for tests and benchmarks.
+void XorBuffers_C(uint8_t* dst, const uint8_t* src, size_t length);
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+void XorBuffers_SSE2(uint8_t* dst, const uint8_t* src, size_t length);
+void XorBuffers_AVX2(uint8_t* dst, const uint8_t* src, size_t length);
+#endif
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_RTP_RTCP_SOURCE_FEC_XOR_H_
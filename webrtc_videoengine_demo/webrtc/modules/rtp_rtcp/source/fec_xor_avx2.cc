@@ -0,0 +1,60 @@
+/*
+ *  Copyright (c) 2014 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/rtp_rtcp/source/fec_xor.h"
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+
+#include <immintrin.h>
+
+namespace webrtc {
+
+// The target attribute lets this file be built without -mavx2; it's only
+// called after XorBuffers() has checked for AVX2.
+#if defined(__GNUC__)
+__attribute__((target("avx2")))
+#endif
+void XorBuffers_AVX2(uint8_t* dst, const uint8_t* src, size_t length) {
+  size_t i = 0;
+  for (; i + 64 <= length; i += 64) {
+    __m256i* d = reinterpret_cast<__m256i*>(dst + i);
+    const __m256i* s = reinterpret_cast<const __m256i*>(src + i);
+    __m256i d0 = _mm256_loadu_si256(d);
+    __m256i d1 = _mm256_loadu_si256(d + 1);
+    d0 = _mm256_xor_si256(d0, _mm256_loadu_si256(s));
+    d1 = _mm256_xor_si256(d1, _mm256_loadu_si256(s + 1));
+    _mm256_storeu_si256(d, d0);
+    _mm256_storeu_si256(d + 1, d1);
+  }
+  if (i + 32 <= length) {
+    __m256i* d = reinterpret_cast<__m256i*>(dst + i);
+    const __m256i* s = reinterpret_cast<const __m256i*>(src + i);
+    _mm256_storeu_si256(d, _mm256_xor_si256(_mm256_loadu_si256(d),
+                                            _mm256_loadu_si256(s)));
+    i += 32;
+  }
+  // Finish here rather than in XorBuffers_SSE2(), since mixing legacy SSE
+  // code with dirty upper YMM state is slow on many CPUs.
+  if (i + 16 <= length) {
+    __m128i* d = reinterpret_cast<__m128i*>(dst + i);
+    const __m128i* s = reinterpret_cast<const __m128i*>(src + i);
+    _mm_storeu_si128(d, _mm_xor_si128(_mm_loadu_si128(d),
+                                      _mm_loadu_si128(s)));
+    i += 16;
+  }
+  for (; i < length; ++i) {
+    dst[i] ^= src[i];
+  }
+  _mm256_zeroupper();
+}
+
+}  // namespace webrtc
+
+#endif  // defined(WEBRTC_ARCH_X86_FAMILY)
@@ -0,0 +1,55 @@
+/*
+ *  Copyright (c) 2014 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/rtp_rtcp/source/fec_xor.h"
+
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <emmintrin.h>
+#endif
+
+namespace webrtc {
+
+#if defined(__GNUC__)
+__attribute__((target("sse2")))
+#endif
+void XorBuffers_SSE2(uint8_t* dst, const uint8_t* src, size_t length) {
+  size_t i = 0;
+  for (; i + 64 <= length; i += 64) {
+    __m128i* d = reinterpret_cast<__m128i*>(dst + i);
+    const __m128i* s = reinterpret_cast<const __m128i*>(src + i);
+    __m128i d0 = _mm_loadu_si128(d);
+    __m128i d1 = _mm_loadu_si128(d + 1);
+    __m128i d2 = _mm_loadu_si128(d + 2);
+    __m128i d3 = _mm_loadu_si128(d + 3);
+    d0 = _mm_xor_si128(d0, _mm_loadu_si128(s));
+    d1 = _mm_xor_si128(d1, _mm_loadu_si128(s + 1));
+    d2 = _mm_xor_si128(d2, _mm_loadu_si128(s + 2));
+    d3 = _mm_xor_si128(d3, _mm_loadu_si128(s + 3));
+    _mm_storeu_si128(d, d0);
+    _mm_storeu_si128(d + 1, d1);
+    _mm_storeu_si128(d + 2, d2);
+    _mm_storeu_si128(d + 3, d3);
+  }
+  for (; i + 16 <= length; i += 16) {
+    __m128i* d = reinterpret_cast<__m128i*>(dst + i);
+    const __m128i* s = reinterpret_cast<const __m128i*>(src + i);
+    _mm_storeu_si128(d, _mm_xor_si128(_mm_loadu_si128(d),
+                                      _mm_loadu_si128(s)));
+  }
+  XorBuffers_C(dst + i, src + i, length - i);
+}
+
+}  // namespace webrtc
+
+#endif  // defined(WEBRTC_ARCH_X86_FAMILY)
@@ -0,0 +1,137 @@
+/*
+ *  Copyright (c) 2014 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <list>
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/modules/rtp_rtcp/source/fec_xor.h"
+#include "webrtc/modules/rtp_rtcp/source/forward_error_correction.h"
+#include "webrtc/modules/rtp_rtcp/source/rtp_utility.h"
+#include "webrtc/system_wrappers/interface/cpu_features_wrapper.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+
+namespace webrtc {
+
+typedef void (*XorFunction)(uint8_t* dst, const uint8_t* src, size_t length);
+
+struct XorKernel {
+  const char* name;
+  XorFunction function;
+  bool supported;
+};
+
+static std::vector<XorKernel> SupportedKernels() {
+  std::vector<XorKernel> kernels;
+  XorKernel c = {"C", &XorBuffers_C, true};
+  kernels.push_back(c);
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  XorKernel sse2 = {"SSE2", &XorBuffers_SSE2, WebRtc_GetCPUInfo(kSSE2) != 0};
+  kernels.push_back(sse2);
+  XorKernel avx2 = {"AVX2", &XorBuffers_AVX2, WebRtc_GetCPUInfo(kAVX2) != 0};
+  kernels.push_back(avx2);
+#endif
+  XorKernel dispatch = {"XorBuffers", &XorBuffers, true};
+  kernels.push_back(dispatch);
+  return kernels;
+}
+
+TEST(FecXorTest, MatchesBytewiseXor) {
+  const size_t kMaxLength = 300;
+  uint8_t src[kMaxLength + 4];
+  uint8_t dst[kMaxLength + 4];
+  uint8_t expected[kMaxLength + 4];
+  for (size_t i = 0; i < sizeof(src); ++i)
+    src[i] = static_cast<uint8_t>(rand());
+
+  std::vector<XorKernel> kernels = SupportedKernels();
+  for (size_t k = 0; k < kernels.size(); ++k) {
+    if (!kernels[k].supported)
+      continue;
+    SCOPED_TRACE(kernels[k].name);
+    // Cover every tail length and misaligned buffers.
+    for (size_t offset = 0; offset < 4; ++offset) {
+      for (size_t length = 0; length <= kMaxLength; ++length) {
+        for (size_t i = 0; i < sizeof(dst); ++i)
+          dst[i] = expected[i] = static_cast<uint8_t>(i * 7);
+        for (size_t i = 0; i < length; ++i)
+          expected[offset + i] ^= src[3 - offset + i];
+        kernels[k].function(dst + offset, src + 3 - offset, length);
+        ASSERT_EQ(0, memcmp(expected, dst, sizeof(dst)))
+            << "offset " << offset << " length " << length;
+      }
+    }
+  }
+}
+
+// Prints the throughput of each XOR kernel and of FEC generation.
+TEST(FecXorTest, DISABLED_Benchmark) {
+  const size_t kPacketLength = 1200;
+  const int kIterations = 200000;
+  uint8_t src[kPacketLength];
+  uint8_t dst[kPacketLength];
+  for (size_t i = 0; i < kPacketLength; ++i)
+    src[i] = dst[i] = static_cast<uint8_t>(rand());
+
+  std::vector<XorKernel> kernels = SupportedKernels();
+  for (size_t k = 0; k < kernels.size(); ++k) {
+    if (!kernels[k].supported)
+      continue;
+    TickTime start = TickTime::Now();
+    for (int i = 0; i < kIterations; ++i)
+      kernels[k].function(dst, src, kPacketLength);
+    int64_t elapsed_us = (TickTime::Now() - start).Microseconds();
+    printf("%-10s %8.0f MB/s\n", kernels[k].name,
+           static_cast<double>(kPacketLength) * kIterations / elapsed_us);
+  }
+
+  // Full protection of 1200 byte packets for a range of frame sizes.
+  const int kNumMediaPackets[] = {2, 4, 8, 12, 24, 48};
+  const uint8_t kProtectionFactor = 255;
+  ForwardErrorCorrection fec;
+  for (size_t n = 0; n < sizeof(kNumMediaPackets) / sizeof(int); ++n) {
+    const int num_media_packets = kNumMediaPackets[n];
+    ForwardErrorCorrection::PacketList media_packets;
+    for (int i = 0; i < num_media_packets; ++i) {
+      ForwardErrorCorrection::Packet* packet =
+          new ForwardErrorCorrection::Packet;
+      packet->length = kPacketLength;
+      for (size_t j = 0; j < kPacketLength; ++j)
+        packet->data[j] = static_cast<uint8_t>(rand());
+      packet->data[0] = 0x80;
+      RtpUtility::AssignUWord16ToBuffer(&packet->data[2], i);
+      media_packets.push_back(packet);
+    }
+    const int kFecIterations = 200000 / num_media_packets;
+    int fec_packets = 0;
+    TickTime start = TickTime::Now();
+    for (int i = 0; i < kFecIterations; ++i) {
+      ForwardErrorCorrection::PacketList fec_packet_list;
+      ASSERT_EQ(0, fec.GenerateFEC(media_packets, kProtectionFactor, 0, false,
+                                   kFecMaskRandom, &fec_packet_list));
+      fec_packets = static_cast<int>(fec_packet_list.size());
+    }
+    int64_t elapsed_us = (TickTime::Now() - start).Microseconds();
+    printf("GenerateFEC %2d media, %2d FEC packets: %6.0f MB/s of media\n",
+           num_media_packets, fec_packets,
+           static_cast<double>(kPacketLength) * num_media_packets *
+               kFecIterations / elapsed_us);
+    while (!media_packets.empty()) {
+      delete media_packets.front();
+      media_packets.pop_front();
+    }
+  }
+}
+
+}  // namespace webrtc
@@ -15,12 +15,15 @@
 #include <string.h>
 
 #include <algorithm>
-#include <iterator>
 
 #include "webrtc/modules/rtp_rtcp/interface/rtp_rtcp_defines.h"
+#include "webrtc/modules/rtp_rtcp/source/fec_xor.h"
 #include "webrtc/modules/rtp_rtcp/source/forward_error_correction_internal.h"
 #include "webrtc/modules/rtp_rtcp/source/rtp_utility.h"
+#include "webrtc/system_wrappers/interface/atomic32.h"
+#include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
 #include "webrtc/system_wrappers/interface/logging.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
 
 namespace webrtc {
 
@@ -40,13 +43,81 @@ enum {
   kMaxFecPackets = ForwardErrorCorrection::kMaxMediaPackets
 };
 
+// Number of released packets a PacketPool keeps for reuse.
+const size_t kMaxFreePackets = ForwardErrorCorrection::kMaxMediaPackets;
+
+// Recycles the storage of the packets handed out by AllocatePacket() and
+// used for recovered packets. Packets hold a reference to the pool, so it
+// outlives the ForwardErrorCorrection if the caller still holds packets.
+class ForwardErrorCorrection::PacketPool {
+ public:
+  PacketPool()
+      : ref_count_(0),
+        crit_(CriticalSectionWrapper::CreateCriticalSection()) {}
+
+  ~PacketPool() {
+    for (size_t i = 0; i < free_packets_.size(); ++i)
+      delete free_packets_[i];
+  }
+
+  int32_t AddRef() { return ++ref_count_; }
+
+  int32_t Release() {
+    int32_t ref_count = --ref_count_;
+    if (ref_count == 0)
+      delete this;
+    return ref_count;
+  }
+
+  Packet* Get() {
+    Packet* packet = NULL;
+    {
+      CriticalSectionScoped cs(crit_.get());
+      if (!free_packets_.empty()) {
+        packet = free_packets_.back();
+        free_packets_.pop_back();
+      }
+    }
+    if (!packet) {
+      packet = new Packet;
+      packet->pool_ = this;
+    }
+    packet->length = 0;
+    // Released in Return().
+    AddRef();
+    return packet;
+  }
+
+  void Return(Packet* packet) {
+    {
+      CriticalSectionScoped cs(crit_.get());
+      if (free_packets_.size() < kMaxFreePackets) {
+        free_packets_.push_back(packet);
+        packet = NULL;
+      }
+    }
+    delete packet;
+    // May delete the pool, so this must come last.
+    Release();
+  }
+
+ private:
+  Atomic32 ref_count_;
+  scoped_ptr<CriticalSectionWrapper> crit_;
+  std::vector<Packet*> free_packets_;
+};
+
 int32_t ForwardErrorCorrection::Packet::AddRef() { return ++ref_count_; }
 
 int32_t ForwardErrorCorrection::Packet::Release() {
   int32_t ref_count;
   ref_count = --ref_count_;
-  if (ref_count == 0)
-    delete this;
+  if (ref_count == 0) {
+    if (pool_)
+      pool_->Return(this);
+    else
+      delete this;
+  }
   return ref_count;
 }
 
@@ -56,17 +127,22 @@ int32_t ForwardErrorCorrection::Packet::Release() {
 class ProtectedPacket : public ForwardErrorCorrection::SortablePacket {
  public:
   scoped_refptr<ForwardErrorCorrection::Packet> pkt;
+  FecPacket* fec_packet;  // The FEC packet protecting this packet.
+  ProtectedPacket* next;  // Next entry in the same protected index slot.
 };
 
-typedef std::list<ProtectedPacket*> ProtectedPacketList;
-
 //
 // Used for internal storage of FEC packets in a list.
 //
 // TODO(holmer): Refactor into a proper class.
 class FecPacket : public ForwardErrorCorrection::SortablePacket {
  public:
-  ProtectedPacketList protected_pkt_list;
+  // Sorted by sequence number. A packet mask covers at most kMaxMediaPackets
+  // packets, so they are stored inline and FEC packets are recycled.
+  ProtectedPacket protected_packets[ForwardErrorCorrection::kMaxMediaPackets];
+  int num_protected;
+  // Number of |protected_packets| whose |pkt| is still NULL.
+  int num_missing;
   uint32_t ssrc;  // SSRC of the current frame.
   scoped_refptr<ForwardErrorCorrection::Packet> pkt;
 };
@@ -84,9 +160,22 @@ ForwardErrorCorrection::RecoveredPacket::~RecoveredPacket() {}
 
 ForwardErrorCorrection::ForwardErrorCorrection()
     : generated_fec_packets_(kMaxMediaPackets),
-      fec_packet_received_(false) {}
+      packet_pool_(new PacketPool),
+      fec_packet_received_(false) {
+  memset(protected_index_, 0, sizeof(protected_index_));
+}
+
+ForwardErrorCorrection::~ForwardErrorCorrection() {
+  for (size_t i = 0; i < fec_packet_list_.size(); ++i)
+    delete fec_packet_list_[i];
+  for (size_t i = 0; i < free_fec_packets_.size(); ++i)
+    delete free_fec_packets_[i];
+}
 
-ForwardErrorCorrection::~ForwardErrorCorrection() {}
+scoped_refptr<ForwardErrorCorrection::Packet>
+ForwardErrorCorrection::AllocatePacket() {
+  return packet_pool_->Get();
+}
 
 // Input packet
 //   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
@@ -263,11 +352,10 @@ void ForwardErrorCorrection::GenerateFecBitStrings(
           generated_fec_packets_[i].data[9] ^= media_payload_length[1];
 
           // XOR with RTP payload, leaving room for the ULP header.
-          for (int32_t j = kFecHeaderSize + ulp_header_size;
-               j < fec_packet_length; j++) {
-            generated_fec_packets_[i].data[j] ^=
-                media_packet->data[j - fec_rtp_offset];
-          }
+          XorBuffers(
+              &generated_fec_packets_[i].data[kFecHeaderSize + ulp_header_size],
+              &media_packet->data[kRtpHeaderSize],
+              media_packet->length - kRtpHeaderSize);
         }
         if (fec_packet_length > generated_fec_packets_[i].length) {
           generated_fec_packets_[i].length = fec_packet_length;
@@ -454,37 +542,21 @@ void ForwardErrorCorrection::ResetState(
   assert(recovered_packet_list->empty());
 
   // Free the FEC packet list.
-  while (!fec_packet_list_.empty()) {
-    FecPacketList::iterator fec_packet_list_it = fec_packet_list_.begin();
-    FecPacket* fec_packet = *fec_packet_list_it;
-    ProtectedPacketList::iterator protected_packet_list_it;
-    protected_packet_list_it = fec_packet->protected_pkt_list.begin();
-    while (protected_packet_list_it != fec_packet->protected_pkt_list.end()) {
-      delete* protected_packet_list_it;
-      protected_packet_list_it =
-          fec_packet->protected_pkt_list.erase(protected_packet_list_it);
-    }
-    assert(fec_packet->protected_pkt_list.empty());
-    delete fec_packet;
-    fec_packet_list_.pop_front();
-  }
-  assert(fec_packet_list_.empty());
+  for (size_t i = 0; i < fec_packet_list_.size(); ++i)
+    DiscardFECPacket(fec_packet_list_[i]);
+  fec_packet_list_.clear();
 }
 
 void ForwardErrorCorrection::InsertMediaPacket(
     ReceivedPacket* rx_packet, RecoveredPacketList* recovered_packet_list) {
   RecoveredPacketList::iterator recovered_packet_list_it =
-      recovered_packet_list->begin();
-
-  // Search for duplicate packets.
-  while (recovered_packet_list_it != recovered_packet_list->end()) {
-    if (rx_packet->seq_num == (*recovered_packet_list_it)->seq_num) {
-      // Duplicate packet, no need to add to list.
-      // Delete duplicate media packet data.
-      rx_packet->pkt = NULL;
-      return;
-    }
-    recovered_packet_list_it++;
+      FindRecoveredPosition(recovered_packet_list, rx_packet->seq_num);
+  if (recovered_packet_list_it != recovered_packet_list->end() &&
+      (*recovered_packet_list_it)->seq_num == rx_packet->seq_num) {
+    // Duplicate packet, no need to add to list.
+    // Delete duplicate media packet data.
+    rx_packet->pkt = NULL;
+    return;
   }
   RecoveredPacket* recoverd_packet_to_insert = new RecoveredPacket;
   recoverd_packet_to_insert->was_recovered = false;
@@ -494,24 +566,34 @@ void ForwardErrorCorrection::InsertMediaPacket(
   recoverd_packet_to_insert->pkt = rx_packet->pkt;
   recoverd_packet_to_insert->pkt->length = rx_packet->pkt->length;
 
-  // TODO(holmer): Consider replacing this with a binary search for the right
-  // position, and then just insert the new packet. Would get rid of the sort.
-  recovered_packet_list->push_back(recoverd_packet_to_insert);
-  recovered_packet_list->sort(SortablePacket::LessThan);
+  recovered_packet_list->insert(recovered_packet_list_it,
+                                recoverd_packet_to_insert);
   UpdateCoveringFECPackets(recoverd_packet_to_insert);
 }
 
+ForwardErrorCorrection::RecoveredPacketList::iterator
+ForwardErrorCorrection::FindRecoveredPosition(
+    RecoveredPacketList* recovered_packet_list, uint16_t seq_num) {
+  RecoveredPacketList::iterator it = recovered_packet_list->end();
+  while (it != recovered_packet_list->begin()) {
+    RecoveredPacketList::iterator prev = it;
+    --prev;
+    if (IsNewerSequenceNumber(seq_num, (*prev)->seq_num))
+      break;
+    it = prev;
+  }
+  return it;
+}
+
 void ForwardErrorCorrection::UpdateCoveringFECPackets(RecoveredPacket* packet) {
-  for (FecPacketList::iterator it = fec_packet_list_.begin();
-       it != fec_packet_list_.end(); ++it) {
-    // Is this FEC packet protecting the media packet |packet|?
-    ProtectedPacketList::iterator protected_it = std::lower_bound(
-        (*it)->protected_pkt_list.begin(), (*it)->protected_pkt_list.end(),
-        packet, SortablePacket::LessThan);
-    if (protected_it != (*it)->protected_pkt_list.end() &&
-        (*protected_it)->seq_num == packet->seq_num) {
+  ProtectedPacket* protected_packet =
+      protected_index_[packet->seq_num & (kProtectedIndexSize - 1)];
+  for (; protected_packet != NULL; protected_packet = protected_packet->next) {
+    if (protected_packet->seq_num == packet->seq_num &&
+        protected_packet->pkt == NULL) {
       // Found an FEC packet which is protecting |packet|.
-      (*protected_it)->pkt = packet->pkt;
+      protected_packet->pkt = packet->pkt;
+      --protected_packet->fec_packet->num_missing;
     }
   }
 }
@@ -521,17 +603,29 @@ void ForwardErrorCorrection::InsertFECPacket(
     const RecoveredPacketList* recovered_packet_list) {
   fec_packet_received_ = true;
 
-  // Check for duplicate.
-  FecPacketList::iterator fec_packet_list_it = fec_packet_list_.begin();
-  while (fec_packet_list_it != fec_packet_list_.end()) {
-    if (rx_packet->seq_num == (*fec_packet_list_it)->seq_num) {
-      // Delete duplicate FEC packet data.
-      rx_packet->pkt = NULL;
-      return;
-    }
-    fec_packet_list_it++;
+  // Find the position in the sorted list, searching from the back where new
+  // packets usually go, and check for duplicate.
+  size_t position = fec_packet_list_.size();
+  while (position > 0 && !IsNewerSequenceNumber(
+      rx_packet->seq_num, fec_packet_list_[position - 1]->seq_num)) {
+    --position;
+  }
+  if (position < fec_packet_list_.size() &&
+      fec_packet_list_[position]->seq_num == rx_packet->seq_num) {
+    // Delete duplicate FEC packet data.
+    rx_packet->pkt = NULL;
+    return;
   }
-  FecPacket* fec_packet = new FecPacket;
+  const uint16_t ulp_header_size =
+      (rx_packet->pkt->data[0] & 0x40) ? kUlpHeaderSizeLBitSet
+                                       : kUlpHeaderSizeLBitClear;
+  if (rx_packet->pkt->length < kFecHeaderSize + ulp_header_size) {
+    // Pooled packet data isn't cleared, so never read past the packet.
+    LOG(LS_WARNING) << "Truncated FEC packet.";
+    rx_packet->pkt = NULL;
+    return;
+  }
+  FecPacket* fec_packet = NewFECPacket();
   fec_packet->pkt = rx_packet->pkt;
   fec_packet->seq_num = rx_packet->seq_num;
   fec_packet->ssrc = rx_packet->ssrc;
@@ -546,8 +640,8 @@ void ForwardErrorCorrection::InsertFECPacket(
     uint8_t packet_mask = fec_packet->pkt->data[12 + byte_idx];
     for (uint16_t bit_idx = 0; bit_idx < 8; ++bit_idx) {
       if (packet_mask & (1 << (7 - bit_idx))) {
-        ProtectedPacket* protected_packet = new ProtectedPacket;
-        fec_packet->protected_pkt_list.push_back(protected_packet);
+        ProtectedPacket* protected_packet =
+            &fec_packet->protected_packets[fec_packet->num_protected++];
         // This wraps naturally with the sequence number.
         protected_packet->seq_num =
             static_cast<uint16_t>(seq_num_base + (byte_idx << 3) + bit_idx);
@@ -555,19 +649,24 @@ void ForwardErrorCorrection::InsertFECPacket(
       }
     }
   }
-  if (fec_packet->protected_pkt_list.empty()) {
+  if (fec_packet->num_protected == 0) {
     // All-zero packet mask; we can discard this FEC packet.
     LOG(LS_WARNING) << "FEC packet has an all-zero packet mask.";
-    delete fec_packet;
+    DiscardFECPacket(fec_packet);
   } else {
+    fec_packet->num_missing = fec_packet->num_protected;
     AssignRecoveredPackets(fec_packet, recovered_packet_list);
-    // TODO(holmer): Consider replacing this with a binary search for the right
-    // position, and then just insert the new packet. Would get rid of the sort.
-    fec_packet_list_.push_back(fec_packet);
-    fec_packet_list_.sort(SortablePacket::LessThan);
+    for (int i = 0; i < fec_packet->num_protected; ++i) {
+      ProtectedPacket* protected_packet = &fec_packet->protected_packets[i];
+      ProtectedPacket** slot = &protected_index_[
+          protected_packet->seq_num & (kProtectedIndexSize - 1)];
+      protected_packet->next = *slot;
+      *slot = protected_packet;
+    }
+    fec_packet_list_.insert(fec_packet_list_.begin() + position, fec_packet);
     if (fec_packet_list_.size() > kMaxFecPackets) {
       DiscardFECPacket(fec_packet_list_.front());
-      fec_packet_list_.pop_front();
+      fec_packet_list_.erase(fec_packet_list_.begin());
     }
     assert(fec_packet_list_.size() <= kMaxFecPackets);
   }
@@ -576,23 +675,23 @@ void ForwardErrorCorrection::InsertFECPacket(
 void ForwardErrorCorrection::AssignRecoveredPackets(
     FecPacket* fec_packet, const RecoveredPacketList* recovered_packets) {
   // Search for missing packets which have arrived or have been recovered by
-  // another FEC packet.
-  ProtectedPacketList* not_recovered = &fec_packet->protected_pkt_list;
-  RecoveredPacketList already_recovered;
-  std::set_intersection(
-      recovered_packets->begin(), recovered_packets->end(),
-      not_recovered->begin(), not_recovered->end(),
-      std::inserter(already_recovered, already_recovered.end()),
-      SortablePacket::LessThan);
+  // another FEC packet, walking both sorted lists at once.
   // Set the FEC pointers to all recovered packets so that we don't have to
   // search for them when we are doing recovery.
-  ProtectedPacketList::iterator not_recovered_it = not_recovered->begin();
-  for (RecoveredPacketList::iterator it = already_recovered.begin();
-       it != already_recovered.end(); ++it) {
-    // Search for the next recovered packet in |not_recovered|.
-    while ((*not_recovered_it)->seq_num != (*it)->seq_num)
-      ++not_recovered_it;
-    (*not_recovered_it)->pkt = (*it)->pkt;
+  RecoveredPacketList::const_iterator it = recovered_packets->begin();
+  int i = 0;
+  while (it != recovered_packets->end() && i < fec_packet->num_protected) {
+    ProtectedPacket* protected_packet = &fec_packet->protected_packets[i];
+    if (SortablePacket::LessThan(*it, protected_packet)) {
+      ++it;
+    } else if (SortablePacket::LessThan(protected_packet, *it)) {
+      ++i;
+    } else {
+      protected_packet->pkt = (*it)->pkt;
+      --fec_packet->num_missing;
+      ++it;
+      ++i;
+    }
   }
 }
 
@@ -616,7 +715,7 @@ void ForwardErrorCorrection::InsertPackets(
           static_cast<int>(fec_packet_list_.front()->seq_num));
       if (seq_num_diff > 0x3fff) {
         DiscardFECPacket(fec_packet_list_.front());
-        fec_packet_list_.pop_front();
+        fec_packet_list_.erase(fec_packet_list_.begin());
       }
     }
 
@@ -640,17 +739,20 @@ void ForwardErrorCorrection::InitRecovery(const FecPacket* fec_packet,
   const uint16_t ulp_header_size =
       fec_packet->pkt->data[0] & 0x40 ? kUlpHeaderSizeLBitSet
                                       : kUlpHeaderSizeLBitClear;  // L bit set?
-  recovered->pkt = new Packet;
-  memset(recovered->pkt->data, 0, IP_PACKET_SIZE);
+  recovered->pkt = packet_pool_->Get();
   recovered->returned = false;
   recovered->was_recovered = true;
-  uint8_t protection_length[2];
   // Copy the protection length from the ULP header.
-  memcpy(protection_length, &fec_packet->pkt->data[10], 2);
-  // Copy FEC payload, skipping the ULP header.
+  const uint16_t protection_length = std::min<uint16_t>(
+      RtpUtility::BufferToUWord16(&fec_packet->pkt->data[10]),
+      IP_PACKET_SIZE - kFecHeaderSize - ulp_header_size);
+  // Copy FEC payload, skipping the ULP header. Only the bytes after it need
+  // clearing; the header fields are all written below or in FinishRecovery().
   memcpy(&recovered->pkt->data[kRtpHeaderSize],
          &fec_packet->pkt->data[kFecHeaderSize + ulp_header_size],
-         RtpUtility::BufferToUWord16(protection_length));
+         protection_length);
+  memset(&recovered->pkt->data[kRtpHeaderSize + protection_length], 0,
+         IP_PACKET_SIZE - kRtpHeaderSize - protection_length);
   // Copy the length recovery field.
   memcpy(recovered->length_recovery, &fec_packet->pkt->data[8], 2);
   // Copy the first 2 bytes of the FEC header.
@@ -691,94 +793,104 @@ void ForwardErrorCorrection::XorPackets(const Packet* src_packet,
   dst_packet->length_recovery[0] ^= media_payload_length[0];
   dst_packet->length_recovery[1] ^= media_payload_length[1];
 
-  // XOR with RTP payload.
-  // TODO(marpan/ajm): Are we doing more XORs than required here?
-  for (int32_t i = kRtpHeaderSize; i < src_packet->length; ++i) {
-    dst_packet->pkt->data[i] ^= src_packet->data[i];
+  // XOR with RTP payload. Shorter packets are implicitly zero padded, so
+  // only the payload of |src_packet| needs to be XORed.
+  if (src_packet->length > kRtpHeaderSize) {
+    XorBuffers(&dst_packet->pkt->data[kRtpHeaderSize],
+               &src_packet->data[kRtpHeaderSize],
+               src_packet->length - kRtpHeaderSize);
   }
 }
 
 void ForwardErrorCorrection::RecoverPacket(
     const FecPacket* fec_packet, RecoveredPacket* rec_packet_to_insert) {
   InitRecovery(fec_packet, rec_packet_to_insert);
-  ProtectedPacketList::const_iterator protected_it =
-      fec_packet->protected_pkt_list.begin();
-  while (protected_it != fec_packet->protected_pkt_list.end()) {
-    if ((*protected_it)->pkt == NULL) {
+  for (int i = 0; i < fec_packet->num_protected; ++i) {
+    const ProtectedPacket& protected_packet = fec_packet->protected_packets[i];
+    if (protected_packet.pkt == NULL) {
       // This is the packet we're recovering.
-      rec_packet_to_insert->seq_num = (*protected_it)->seq_num;
+      rec_packet_to_insert->seq_num = protected_packet.seq_num;
     } else {
-      XorPackets((*protected_it)->pkt, rec_packet_to_insert);
+      XorPackets(protected_packet.pkt, rec_packet_to_insert);
     }
-    ++protected_it;
   }
   FinishRecovery(rec_packet_to_insert);
 }
 
 void ForwardErrorCorrection::AttemptRecover(
     RecoveredPacketList* recovered_packet_list) {
-  FecPacketList::iterator fec_packet_list_it = fec_packet_list_.begin();
-  while (fec_packet_list_it != fec_packet_list_.end()) {
-    // Search for each FEC packet's protected media packets.
-    int packets_missing = NumCoveredPacketsMissing(*fec_packet_list_it);
+  size_t i = 0;
+  while (i < fec_packet_list_.size()) {
+    FecPacket* fec_packet = fec_packet_list_[i];
+    int packets_missing = NumCoveredPacketsMissing(fec_packet);
 
     // We can only recover one packet with an FEC packet.
     if (packets_missing == 1) {
       // Recovery possible.
       RecoveredPacket* packet_to_insert = new RecoveredPacket;
       packet_to_insert->pkt = NULL;
-      RecoverPacket(*fec_packet_list_it, packet_to_insert);
+      RecoverPacket(fec_packet, packet_to_insert);
 
       // Add recovered packet to the list of recovered packets and update any
       // FEC packets covering this packet with a pointer to the data.
-      // TODO(holmer): Consider replacing this with a binary search for the
-      // right position, and then just insert the new packet. Would get rid of
-      // the sort.
-      recovered_packet_list->push_back(packet_to_insert);
-      recovered_packet_list->sort(SortablePacket::LessThan);
+      recovered_packet_list->insert(
+          FindRecoveredPosition(recovered_packet_list,
+                                packet_to_insert->seq_num),
+          packet_to_insert);
       UpdateCoveringFECPackets(packet_to_insert);
       DiscardOldPackets(recovered_packet_list);
-      DiscardFECPacket(*fec_packet_list_it);
-      fec_packet_list_it = fec_packet_list_.erase(fec_packet_list_it);
+      DiscardFECPacket(fec_packet);
+      fec_packet_list_.erase(fec_packet_list_.begin() + i);
 
       // A packet has been recovered. We need to check the FEC list again, as
       // this may allow additional packets to be recovered.
       // Restart for first FEC packet.
-      fec_packet_list_it = fec_packet_list_.begin();
+      i = 0;
     } else if (packets_missing == 0) {
       // Either all protected packets arrived or have been recovered. We can
       // discard this FEC packet.
-      DiscardFECPacket(*fec_packet_list_it);
-      fec_packet_list_it = fec_packet_list_.erase(fec_packet_list_it);
+      DiscardFECPacket(fec_packet);
+      fec_packet_list_.erase(fec_packet_list_.begin() + i);
     } else {
-      fec_packet_list_it++;
+      ++i;
     }
   }
 }
 
 int ForwardErrorCorrection::NumCoveredPacketsMissing(
     const FecPacket* fec_packet) {
-  int packets_missing = 0;
-  ProtectedPacketList::const_iterator it =
-      fec_packet->protected_pkt_list.begin();
-  for (; it != fec_packet->protected_pkt_list.end(); ++it) {
-    if ((*it)->pkt == NULL) {
-      ++packets_missing;
-      if (packets_missing > 1) {
-        break;  // We can't recover more than one packet.
-      }
-    }
+  return std::min(fec_packet->num_missing, 2);
+}
+
+FecPacket* ForwardErrorCorrection::NewFECPacket() {
+  FecPacket* fec_packet;
+  if (free_fec_packets_.empty()) {
+    fec_packet = new FecPacket;
+    for (unsigned int i = 0; i < kMaxMediaPackets; ++i)
+      fec_packet->protected_packets[i].fec_packet = fec_packet;
+  } else {
+    fec_packet = free_fec_packets_.back();
+    free_fec_packets_.pop_back();
   }
-  return packets_missing;
+  fec_packet->num_protected = 0;
+  fec_packet->num_missing = 0;
+  return fec_packet;
 }
 
 void ForwardErrorCorrection::DiscardFECPacket(FecPacket* fec_packet) {
-  while (!fec_packet->protected_pkt_list.empty()) {
-    delete fec_packet->protected_pkt_list.front();
-    fec_packet->protected_pkt_list.pop_front();
-  }
-  assert(fec_packet->protected_pkt_list.empty());
-  delete fec_packet;
+  for (int i = 0; i < fec_packet->num_protected; ++i) {
+    ProtectedPacket* protected_packet = &fec_packet->protected_packets[i];
+    ProtectedPacket** link = &protected_index_[
+        protected_packet->seq_num & (kProtectedIndexSize - 1)];
+    while (*link != NULL && *link != protected_packet)
+      link = &(*link)->next;
+    if (*link != NULL)
+      *link = protected_packet->next;
+    protected_packet->pkt = NULL;
+  }
+  fec_packet->num_protected = 0;
+  fec_packet->pkt = NULL;
+  free_fec_packets_.push_back(fec_packet);
 }
 
 void ForwardErrorCorrection::DiscardOldPackets(
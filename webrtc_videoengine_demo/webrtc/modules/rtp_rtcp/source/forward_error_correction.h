@@ -23,6 +23,7 @@ namespace webrtc {
 
 // Forward declaration.
 class FecPacket;
+class ProtectedPacket;
 
 // Performs codec-independent forward error correction (FEC), based on RFC 5109.
 // Option exists to enable unequal protection (UEP) across packets.
@@ -33,27 +34,32 @@ class ForwardErrorCorrection {
   // Maximum number of media packets we can protect
   static const unsigned int kMaxMediaPackets = 48u;
 
+  class PacketPool;
+
   // TODO(holmer): As a next step all these struct-like packet classes should be
   // refactored into proper classes, and their members should be made private.
   // This will require parts of the functionality in forward_error_correction.cc
   // and receiver_fec.cc to be refactored into the packet classes.
   class Packet {
    public:
-    Packet() : length(0), data(), ref_count_(0) {}
+    Packet() : length(0), data(), ref_count_(0), pool_(NULL) {}
     virtual ~Packet() {}
 
     // Add a reference.
     virtual int32_t AddRef();
 
-    // Release a reference. Will delete the object if the reference count
-    // reaches zero.
+    // Release a reference. Will delete the object, or return it to the pool
+    // it came from, if the reference count reaches zero.
     virtual int32_t Release();
 
     uint16_t length;               // Length of packet in bytes.
     uint8_t data[IP_PACKET_SIZE];  // Packet data.
 
    private:
+    friend class PacketPool;
+
     int32_t ref_count_;  // Counts the number of references to a packet.
+    PacketPool* pool_;   // Set if allocated by AllocatePacket().
   };
 
   // TODO(holmer): Refactor into a proper class.
@@ -193,6 +199,12 @@ class ForwardErrorCorrection {
   int32_t DecodeFEC(ReceivedPacketList* received_packet_list,
                     RecoveredPacketList* recovered_packet_list);
 
+  // Returns an empty packet for the received list of DecodeFEC(). Unlike
+  // packets created with new, its storage is recycled when it's released,
+  // which avoids an allocation and a clear of IP_PACKET_SIZE bytes per
+  // received packet. The data is not cleared; only |length| is reset.
+  scoped_refptr<Packet> AllocatePacket();
+
   // Get the number of FEC packets, given the number of media packets and the
   // protection factor.
   int GetNumberOfFecPackets(int num_media_packets, int protection_factor);
@@ -207,7 +219,11 @@ class ForwardErrorCorrection {
   void ResetState(RecoveredPacketList* recovered_packet_list);
 
  private:
-  typedef std::list<FecPacket*> FecPacketList;
+  // Sorted by sequence number; never longer than kMaxMediaPackets.
+  typedef std::vector<FecPacket*> FecPacketList;
+
+  // Number of slots of |protected_index_|, a power of two.
+  static const int kProtectedIndexSize = 256;
 
   void GenerateFecUlpHeaders(const PacketList& media_packet_list,
                              uint8_t* packet_mask, bool l_bit,
@@ -271,16 +287,17 @@ class ForwardErrorCorrection {
   static void AssignRecoveredPackets(
       FecPacket* fec_packet, const RecoveredPacketList* recovered_packets);
 
-  // Insert into recovered list in correct position.
-  void InsertRecoveredPacket(RecoveredPacket* rec_packet_to_insert,
-                             RecoveredPacketList* recovered_packet_list);
+  // Returns the first position in |recovered_packet_list| whose packet is not
+  // older than |seq_num|. Searches from the back, where new packets usually
+  // go.
+  static RecoveredPacketList::iterator FindRecoveredPosition(
+      RecoveredPacketList* recovered_packet_list, uint16_t seq_num);
 
   // Attempt to recover missing packets.
   void AttemptRecover(RecoveredPacketList* recovered_packet_list);
 
   // Initializes the packet recovery using the FEC packet.
-  static void InitRecovery(const FecPacket* fec_packet,
-                           RecoveredPacket* recovered);
+  void InitRecovery(const FecPacket* fec_packet, RecoveredPacket* recovered);
 
   // Performs XOR between |src_packet| and |dst_packet| and stores the result
   // in |dst_packet|.
@@ -299,12 +316,21 @@ class ForwardErrorCorrection {
   // This function returns 2 when two or more packets are missing.
   static int NumCoveredPacketsMissing(const FecPacket* fec_packet);
 
-  static void DiscardFECPacket(FecPacket* fec_packet);
+  // Takes an FEC packet from |free_fec_packets_|, or allocates one.
+  FecPacket* NewFECPacket();
+  // Unlinks the FEC packet from |protected_index_| and recycles it.
+  void DiscardFECPacket(FecPacket* fec_packet);
   static void DiscardOldPackets(RecoveredPacketList* recovered_packet_list);
   static uint16_t ParseSequenceNumber(uint8_t* packet);
 
   std::vector<Packet> generated_fec_packets_;
   FecPacketList fec_packet_list_;
+  std::vector<FecPacket*> free_fec_packets_;
+  // The protected packets of |fec_packet_list_|, chained by sequence number
+  // modulo kProtectedIndexSize. Finds the FEC packets covering a media packet
+  // without searching every FEC packet.
+  ProtectedPacket* protected_index_[kProtectedIndexSize];
+  scoped_refptr<PacketPool> packet_pool_;
   bool fec_packet_received_;
 };
 }  // namespace webrtc
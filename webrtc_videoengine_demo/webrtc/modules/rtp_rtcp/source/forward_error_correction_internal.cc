@@ -161,17 +161,19 @@ FecMaskType PacketMaskTable::InitMaskType(FecMaskType fec_mask_type,
         return kFecMaskBursty;
       }
     }
+    case kFecMaskInterleaved: { return kFecMaskInterleaved; }
   }
   assert(false);
   return kFecMaskRandom;
 }
 
 // Returns the pointer to the packet mask tables corresponding to type
-// |fec_mask_type|.
+// |fec_mask_type|. Interleaved masks are computed, so they have no table.
 const uint8_t*** PacketMaskTable::InitMaskTable(FecMaskType fec_mask_type) {
   switch (fec_mask_type) {
     case kFecMaskRandom: { return kPacketMaskRandomTbl; }
     case kFecMaskBursty: { return kPacketMaskBurstyTbl; }
+    case kFecMaskInterleaved: { return NULL; }
   }
   assert(false);
   return kPacketMaskRandomTbl;
@@ -344,6 +346,38 @@ void UnequalProtectionMask(int num_media_packets, int num_fec_packets,
 
 }
 
+void InterleavedPacketMask(int num_media_packets, int num_fec_packets,
+                           int num_mask_bytes, uint8_t* packet_mask) {
+  // Lay out the media packets row by row in a grid, using as many columns as
+  // possible while leaving room for at least two row parity packets. With
+  // fewer FEC packets than that, or with as many as media packets, only
+  // protect the columns.
+  int num_columns = num_fec_packets;
+  int num_rows = 0;
+  if (num_fec_packets < num_media_packets) {
+    for (int columns = num_fec_packets - 2; columns >= 2; --columns) {
+      const int rows = (num_media_packets + columns - 1) / columns;
+      if (columns + rows <= num_fec_packets) {
+        num_columns = columns;
+        num_rows = rows;
+        break;
+      }
+    }
+  }
+  memset(packet_mask, 0, num_fec_packets * num_mask_bytes);
+  for (int i = 0; i < num_media_packets; ++i) {
+    const uint8_t bit = static_cast<uint8_t>(1 << (7 - i % 8));
+    // Column parity: packets |num_columns| apart, so a burst of up to
+    // |num_columns| packets loses at most one packet per column.
+    packet_mask[(i % num_columns) * num_mask_bytes + i / 8] |= bit;
+    // Row parity: consecutive packets, recovers a second loss in a column.
+    if (num_rows > 0) {
+      const int row = num_columns + i / num_columns;
+      packet_mask[row * num_mask_bytes + i / 8] |= bit;
+    }
+  }
+}
+
 void GeneratePacketMasks(int num_media_packets, int num_fec_packets,
                          int num_imp_packets, bool use_unequal_protection,
                          const PacketMaskTable& mask_table,
@@ -356,6 +390,13 @@ void GeneratePacketMasks(int num_media_packets, int num_fec_packets,
   const int num_mask_bytes =
       (l_bit == 1) ? kMaskSizeLBitSet : kMaskSizeLBitClear;
 
+  if (mask_table.fec_mask_type() == kFecMaskInterleaved) {
+    // Every packet gets the same protection, so UEP doesn't apply.
+    InterleavedPacketMask(num_media_packets, num_fec_packets, num_mask_bytes,
+                          packet_mask);
+    return;
+  }
+
   // Equal-protection for these cases.
   if (!use_unequal_protection || num_imp_packets == 0) {
     // Retrieve corresponding mask table directly:for equal-protection case.
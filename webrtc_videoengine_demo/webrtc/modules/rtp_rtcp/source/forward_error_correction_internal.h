@@ -39,6 +39,14 @@ class PacketMaskTable {
   const uint8_t*** fec_packet_mask_table_;
 };
 
+// Computes the masks of |kFecMaskInterleaved|: column parity packets that
+// protect media packets a fixed stride apart, followed, if there are enough
+// FEC packets, by row parity packets that protect consecutive media packets.
+// Any burst of up to |num_fec_packets| (column only) or the number of
+// columns (row and column) media packets can be recovered.
+void InterleavedPacketMask(int num_media_packets, int num_fec_packets,
+                           int num_mask_bytes, uint8_t* packet_mask);
+
 // Returns an array of packet masks. The mask of a single FEC packet
 // corresponds to a number of mask bytes. The mask indicates which
 // media packets should be protected by the FEC packet.
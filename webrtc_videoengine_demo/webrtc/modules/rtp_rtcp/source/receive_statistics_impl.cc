@@ -11,6 +11,10 @@
 #include "webrtc/modules/rtp_rtcp/source/receive_statistics_impl.h"
 
 #include <math.h>
+#include <string.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 #include "webrtc/modules/rtp_rtcp/source/bitrate.h"
 #include "webrtc/modules/rtp_rtcp/source/rtp_utility.h"
@@ -21,9 +25,85 @@ namespace webrtc {
 
 const int64_t kStatisticsTimeoutMs = 8000;
 const int kStatisticsProcessIntervalMs = 1000;
+const int kInitialStatisticianEntries = 4;
+
+namespace subtle {
+
+// Order the accesses to the state that the receive thread updates without a
+// lock. x86 keeps loads in order with loads and stores with stores, so only
+// the compiler needs to be kept from reordering them there.
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+inline void ReadBarrier() {
+  _ReadWriteBarrier();
+}
+inline void WriteBarrier() {
+  _ReadWriteBarrier();
+}
+
+#elif defined(__x86_64__) || defined(__i386__)
+inline void ReadBarrier() {
+  __asm__ __volatile__("" : : : "memory");
+}
+inline void WriteBarrier() {
+  __asm__ __volatile__("" : : : "memory");
+}
+
+#elif defined(__aarch64__)
+inline void ReadBarrier() {
+  __asm__ __volatile__("dmb ishld" : : : "memory");
+}
+inline void WriteBarrier() {
+  __asm__ __volatile__("dmb ishst" : : : "memory");
+}
+
+#elif defined(__GNUC__)
+inline void ReadBarrier() {
+  __sync_synchronize();
+}
+inline void WriteBarrier() {
+  __sync_synchronize();
+}
+
+#else
+#error Add an implementation of ReadBarrier() and WriteBarrier() for this platform!
+#endif
+
+}  // namespace subtle
 
 StreamStatistician::~StreamStatistician() {}
 
+int ReceiveStatistics::GetActiveStatistics(bool reset,
+                                           ReportBlockStatistics* statistics,
+                                           int max_streams) {
+  StatisticianMap statisticians = GetActiveStatisticians();
+  int num_streams = 0;
+  for (StatisticianMap::const_iterator it = statisticians.begin();
+       it != statisticians.end() && num_streams < max_streams; ++it) {
+    if (it->second->GetStatistics(&statistics[num_streams].statistics,
+                                  reset)) {
+      statistics[num_streams].ssrc = it->first;
+      ++num_streams;
+    }
+  }
+  return num_streams;
+}
+
+StreamStatisticianImpl::State::State()
+    : ssrc(0),
+      jitter_q4(0),
+      jitter_q4_transmission_time_offset(0),
+      last_receive_time_ms(0),
+      last_receive_time_secs(0),
+      last_receive_time_frac(0),
+      last_received_timestamp(0),
+      last_received_transmission_time_offset(0),
+      received_seq_first(0),
+      received_seq_max(0),
+      received_seq_wraps(0),
+      received_packet_overhead(12),
+      total_bytes(0),
+      total_packets(0) {}
+
 StreamStatisticianImpl::StreamStatisticianImpl(
     Clock* clock,
     RtcpStatisticsCallback* rtcp_callback,
@@ -31,66 +111,84 @@ StreamStatisticianImpl::StreamStatisticianImpl(
     : clock_(clock),
       stream_lock_(CriticalSectionWrapper::CreateCriticalSection()),
       incoming_bitrate_(clock, NULL),
-      ssrc_(0),
       max_reordering_threshold_(kDefaultMaxReorderingThreshold),
-      jitter_q4_(0),
+      state_sequence_(0),
       cumulative_loss_(0),
-      jitter_q4_transmission_time_offset_(0),
-      last_receive_time_ms_(0),
-      last_receive_time_secs_(0),
-      last_receive_time_frac_(0),
-      last_received_timestamp_(0),
-      last_received_transmission_time_offset_(0),
-      received_seq_first_(0),
-      received_seq_max_(0),
-      received_seq_wraps_(0),
-      received_packet_overhead_(12),
+      bitrate_bytes_(0),
+      bitrate_packets_(0),
       last_report_inorder_packets_(0),
       last_report_old_packets_(0),
       last_report_seq_max_(0),
       rtcp_callback_(rtcp_callback),
       rtp_callback_(rtp_callback) {}
 
+void StreamStatisticianImpl::BeginStateUpdate() {
+  state_sequence_ = state_sequence_ + 1;
+  subtle::WriteBarrier();
+}
+
+void StreamStatisticianImpl::EndStateUpdate() {
+  subtle::WriteBarrier();
+  state_sequence_ = state_sequence_ + 1;
+}
+
+StreamStatisticianImpl::State StreamStatisticianImpl::ReadState() const {
+  State state;
+  uint32_t sequence;
+  do {
+    sequence = state_sequence_;
+    subtle::ReadBarrier();
+    state = state_;
+    subtle::ReadBarrier();
+  } while ((sequence & 1) != 0 || sequence != state_sequence_);
+  return state;
+}
+
 void StreamStatisticianImpl::ResetStatistics() {
   CriticalSectionScoped cs(stream_lock_.get());
   last_report_inorder_packets_ = 0;
   last_report_old_packets_ = 0;
   last_report_seq_max_ = 0;
   last_reported_statistics_ = RtcpStatistics();
-  jitter_q4_ = 0;
   cumulative_loss_ = 0;
-  jitter_q4_transmission_time_offset_ = 0;
-  received_seq_wraps_ = 0;
-  received_seq_max_ = 0;
-  received_seq_first_ = 0;
-  receive_counters_ = StreamDataCounters();
+  BeginStateUpdate();
+  state_.jitter_q4 = 0;
+  state_.jitter_q4_transmission_time_offset = 0;
+  state_.received_seq_wraps = 0;
+  state_.received_seq_max = 0;
+  state_.received_seq_first = 0;
+  state_.receive_counters = StreamDataCounters();
+  EndStateUpdate();
 }
 
 void StreamStatisticianImpl::IncomingPacket(const RTPHeader& header,
                                             size_t bytes,
                                             bool retransmitted) {
+  BeginStateUpdate();
   UpdateCounters(header, bytes, retransmitted);
+  EndStateUpdate();
   NotifyRtpCallback();
 }
 
 void StreamStatisticianImpl::UpdateCounters(const RTPHeader& header,
                                             size_t bytes,
                                             bool retransmitted) {
-  CriticalSectionScoped cs(stream_lock_.get());
-  bool in_order = InOrderPacketInternal(header.sequenceNumber);
-  ssrc_ = header.ssrc;
-  incoming_bitrate_.Update(bytes);
-  receive_counters_.bytes +=
+  bool in_order = InOrderPacketInternal(state_, header.sequenceNumber);
+  state_.ssrc = header.ssrc;
+  state_.total_bytes += bytes;
+  ++state_.total_packets;
+  StreamDataCounters& receive_counters = state_.receive_counters;
+  receive_counters.bytes +=
       bytes - (header.paddingLength + header.headerLength);
-  receive_counters_.header_bytes += header.headerLength;
-  receive_counters_.padding_bytes += header.paddingLength;
-  ++receive_counters_.packets;
+  receive_counters.header_bytes += header.headerLength;
+  receive_counters.padding_bytes += header.paddingLength;
+  ++receive_counters.packets;
   if (!in_order && retransmitted) {
-    ++receive_counters_.retransmitted_packets;
+    ++receive_counters.retransmitted_packets;
   }
 
-  if (receive_counters_.packets == 1) {
-    received_seq_first_ = header.sequenceNumber;
+  if (receive_counters.packets == 1) {
+    state_.received_seq_first = header.sequenceNumber;
   }
 
   // Count only the new packets received. That is, if packets 1, 2, 3, 5, 4, 6
@@ -102,32 +200,33 @@ void StreamStatisticianImpl::UpdateCounters(const RTPHeader& header,
     clock_->CurrentNtp(receive_time_secs, receive_time_frac);
 
     // Wrong if we use RetransmitOfOldPacket.
-    if (receive_counters_.packets > 1 &&
-        received_seq_max_ > header.sequenceNumber) {
+    if (receive_counters.packets > 1 &&
+        state_.received_seq_max > header.sequenceNumber) {
       // Wrap around detected.
-      received_seq_wraps_++;
+      state_.received_seq_wraps++;
     }
     // New max.
-    received_seq_max_ = header.sequenceNumber;
+    state_.received_seq_max = header.sequenceNumber;
 
     // If new time stamp and more than one in-order packet received, calculate
     // new jitter statistics.
-    if (header.timestamp != last_received_timestamp_ &&
-        (receive_counters_.packets - receive_counters_.retransmitted_packets) >
+    if (header.timestamp != state_.last_received_timestamp &&
+        (receive_counters.packets - receive_counters.retransmitted_packets) >
             1) {
       UpdateJitter(header, receive_time_secs, receive_time_frac);
     }
-    last_received_timestamp_ = header.timestamp;
-    last_receive_time_secs_ = receive_time_secs;
-    last_receive_time_frac_ = receive_time_frac;
-    last_receive_time_ms_ = clock_->TimeInMilliseconds();
+    state_.last_received_timestamp = header.timestamp;
+    state_.last_receive_time_secs = receive_time_secs;
+    state_.last_receive_time_frac = receive_time_frac;
+    state_.last_receive_time_ms = clock_->TimeInMilliseconds();
   }
 
   uint16_t packet_oh = header.headerLength + header.paddingLength;
 
   // Our measured overhead. Filter from RFC 5104 4.2.1.2:
   // avg_OH (new) = 15/16*avg_OH (old) + 1/16*pckt_OH,
-  received_packet_overhead_ = (15 * received_packet_overhead_ + packet_oh) >> 4;
+  state_.received_packet_overhead =
+      (15 * state_.received_packet_overhead + packet_oh) >> 4;
 }
 
 void StreamStatisticianImpl::UpdateJitter(const RTPHeader& header,
@@ -136,11 +235,11 @@ void StreamStatisticianImpl::UpdateJitter(const RTPHeader& header,
   uint32_t receive_time_rtp = RtpUtility::ConvertNTPTimeToRTP(
       receive_time_secs, receive_time_frac, header.payload_type_frequency);
   uint32_t last_receive_time_rtp =
-      RtpUtility::ConvertNTPTimeToRTP(last_receive_time_secs_,
-                                      last_receive_time_frac_,
+      RtpUtility::ConvertNTPTimeToRTP(state_.last_receive_time_secs,
+                                      state_.last_receive_time_frac,
                                       header.payload_type_frequency);
   int32_t time_diff_samples = (receive_time_rtp - last_receive_time_rtp) -
-      (header.timestamp - last_received_timestamp_);
+      (header.timestamp - state_.last_received_timestamp);
 
   time_diff_samples = abs(time_diff_samples);
 
@@ -149,8 +248,8 @@ void StreamStatisticianImpl::UpdateJitter(const RTPHeader& header,
   // as the threshold.
   if (time_diff_samples < 450000) {
     // Note we calculate in Q4 to avoid using float.
-    int32_t jitter_diff_q4 = (time_diff_samples << 4) - jitter_q4_;
-    jitter_q4_ += ((jitter_diff_q4 + 8) >> 4);
+    int32_t jitter_diff_q4 = (time_diff_samples << 4) - state_.jitter_q4;
+    state_.jitter_q4 += ((jitter_diff_q4 + 8) >> 4);
   }
 
   // Extended jitter report, RFC 5450.
@@ -159,52 +258,42 @@ void StreamStatisticianImpl::UpdateJitter(const RTPHeader& header,
     (receive_time_rtp - last_receive_time_rtp) -
     ((header.timestamp +
       header.extension.transmissionTimeOffset) -
-     (last_received_timestamp_ +
-      last_received_transmission_time_offset_));
+     (state_.last_received_timestamp +
+      state_.last_received_transmission_time_offset));
 
   time_diff_samples_ext = abs(time_diff_samples_ext);
 
   if (time_diff_samples_ext < 450000) {
     int32_t jitter_diffQ4TransmissionTimeOffset =
-      (time_diff_samples_ext << 4) - jitter_q4_transmission_time_offset_;
-    jitter_q4_transmission_time_offset_ +=
+      (time_diff_samples_ext << 4) - state_.jitter_q4_transmission_time_offset;
+    state_.jitter_q4_transmission_time_offset +=
       ((jitter_diffQ4TransmissionTimeOffset + 8) >> 4);
   }
 }
 
 void StreamStatisticianImpl::NotifyRtpCallback() {
-  StreamDataCounters data;
-  uint32_t ssrc;
-  {
-    CriticalSectionScoped cs(stream_lock_.get());
-    data = receive_counters_;
-    ssrc = ssrc_;
-  }
-  rtp_callback_->DataCountersUpdated(data, ssrc);
+  // Called on the receive thread, which is the only writer of |state_|.
+  rtp_callback_->DataCountersUpdated(state_.receive_counters, state_.ssrc);
 }
 
 void StreamStatisticianImpl::NotifyRtcpCallback() {
   RtcpStatistics data;
-  uint32_t ssrc;
   {
     CriticalSectionScoped cs(stream_lock_.get());
     data = last_reported_statistics_;
-    ssrc = ssrc_;
   }
-  rtcp_callback_->StatisticsUpdated(data, ssrc);
+  rtcp_callback_->StatisticsUpdated(data, ReadState().ssrc);
 }
 
 void StreamStatisticianImpl::FecPacketReceived() {
-  {
-    CriticalSectionScoped cs(stream_lock_.get());
-    ++receive_counters_.fec_packets;
-  }
+  BeginStateUpdate();
+  ++state_.receive_counters.fec_packets;
+  EndStateUpdate();
   NotifyRtpCallback();
 }
 
 void StreamStatisticianImpl::SetMaxReorderingThreshold(
     int max_reordering_threshold) {
-  CriticalSectionScoped cs(stream_lock_.get());
   max_reordering_threshold_ = max_reordering_threshold;
 }
 
@@ -212,7 +301,8 @@ bool StreamStatisticianImpl::GetStatistics(RtcpStatistics* statistics,
                                            bool reset) {
   {
     CriticalSectionScoped cs(stream_lock_.get());
-    if (received_seq_first_ == 0 && receive_counters_.bytes == 0) {
+    const State state = ReadState();
+    if (state.received_seq_first == 0 && state.receive_counters.bytes == 0) {
       // We have not received anything.
       return false;
     }
@@ -227,7 +317,7 @@ bool StreamStatisticianImpl::GetStatistics(RtcpStatistics* statistics,
       return true;
     }
 
-    *statistics = CalculateRtcpStatistics();
+    *statistics = CalculateRtcpStatistics(state);
   }
 
   NotifyRtcpCallback();
@@ -235,18 +325,20 @@ bool StreamStatisticianImpl::GetStatistics(RtcpStatistics* statistics,
   return true;
 }
 
-RtcpStatistics StreamStatisticianImpl::CalculateRtcpStatistics() {
+RtcpStatistics StreamStatisticianImpl::CalculateRtcpStatistics(
+    const State& state) {
   RtcpStatistics stats;
+  const StreamDataCounters& receive_counters = state.receive_counters;
 
   if (last_report_inorder_packets_ == 0) {
     // First time we send a report.
-    last_report_seq_max_ = received_seq_first_ - 1;
+    last_report_seq_max_ = state.received_seq_first - 1;
   }
 
   // Calculate fraction lost.
-  uint16_t exp_since_last = (received_seq_max_ - last_report_seq_max_);
+  uint16_t exp_since_last = (state.received_seq_max - last_report_seq_max_);
 
-  if (last_report_seq_max_ > received_seq_max_) {
+  if (last_report_seq_max_ > state.received_seq_max) {
     // Can we assume that the seq_num can't go decrease over a full RTCP period?
     exp_since_last = 0;
   }
@@ -254,7 +346,7 @@ RtcpStatistics StreamStatisticianImpl::CalculateRtcpStatistics() {
   // Number of received RTP packets since last report, counts all packets but
   // not re-transmissions.
   uint32_t rec_since_last =
-      (receive_counters_.packets - receive_counters_.retransmitted_packets) -
+      (receive_counters.packets - receive_counters.retransmitted_packets) -
       last_report_inorder_packets_;
 
   // With NACK we don't know the expected retransmissions during the last
@@ -267,7 +359,7 @@ RtcpStatistics StreamStatisticianImpl::CalculateRtcpStatistics() {
   // re-transmitted. We use RTT to decide if a packet is re-ordered or
   // re-transmitted.
   uint32_t retransmitted_packets =
-      receive_counters_.retransmitted_packets - last_report_old_packets_;
+      receive_counters.retransmitted_packets - last_report_old_packets_;
   rec_since_last += retransmitted_packets;
 
   int32_t missing = 0;
@@ -286,72 +378,83 @@ RtcpStatistics StreamStatisticianImpl::CalculateRtcpStatistics() {
   cumulative_loss_ += missing;
   stats.cumulative_lost = cumulative_loss_;
   stats.extended_max_sequence_number =
-      (received_seq_wraps_ << 16) + received_seq_max_;
+      (state.received_seq_wraps << 16) + state.received_seq_max;
   // Note: internal jitter value is in Q4 and needs to be scaled by 1/16.
-  stats.jitter = jitter_q4_ >> 4;
+  stats.jitter = state.jitter_q4 >> 4;
 
   // Store this report.
   last_reported_statistics_ = stats;
 
   // Only for report blocks in RTCP SR and RR.
   last_report_inorder_packets_ =
-      receive_counters_.packets - receive_counters_.retransmitted_packets;
-  last_report_old_packets_ = receive_counters_.retransmitted_packets;
-  last_report_seq_max_ = received_seq_max_;
+      receive_counters.packets - receive_counters.retransmitted_packets;
+  last_report_old_packets_ = receive_counters.retransmitted_packets;
+  last_report_seq_max_ = state.received_seq_max;
 
   return stats;
 }
 
 void StreamStatisticianImpl::GetDataCounters(
     uint32_t* bytes_received, uint32_t* packets_received) const {
-  CriticalSectionScoped cs(stream_lock_.get());
+  const State state = ReadState();
   if (bytes_received) {
-    *bytes_received = receive_counters_.bytes + receive_counters_.header_bytes +
-                      receive_counters_.padding_bytes;
+    *bytes_received = state.receive_counters.bytes +
+                      state.receive_counters.header_bytes +
+                      state.receive_counters.padding_bytes;
   }
   if (packets_received) {
-    *packets_received = receive_counters_.packets;
+    *packets_received = state.receive_counters.packets;
   }
 }
 
+void StreamStatisticianImpl::UpdateBitrate() const {
+  const State state = ReadState();
+  incoming_bitrate_.Update(state.total_bytes - bitrate_bytes_,
+                           state.total_packets - bitrate_packets_);
+  bitrate_bytes_ = state.total_bytes;
+  bitrate_packets_ = state.total_packets;
+}
+
 uint32_t StreamStatisticianImpl::BitrateReceived() const {
   CriticalSectionScoped cs(stream_lock_.get());
+  UpdateBitrate();
   return incoming_bitrate_.BitrateNow();
 }
 
 void StreamStatisticianImpl::ProcessBitrate() {
   CriticalSectionScoped cs(stream_lock_.get());
+  UpdateBitrate();
   incoming_bitrate_.Process();
 }
 
 void StreamStatisticianImpl::LastReceiveTimeNtp(uint32_t* secs,
                                                 uint32_t* frac) const {
-  CriticalSectionScoped cs(stream_lock_.get());
-  *secs = last_receive_time_secs_;
-  *frac = last_receive_time_frac_;
+  const State state = ReadState();
+  *secs = state.last_receive_time_secs;
+  *frac = state.last_receive_time_frac;
 }
 
 bool StreamStatisticianImpl::IsRetransmitOfOldPacket(
     const RTPHeader& header, int min_rtt) const {
-  CriticalSectionScoped cs(stream_lock_.get());
-  if (InOrderPacketInternal(header.sequenceNumber)) {
+  const State state = ReadState();
+  if (InOrderPacketInternal(state, header.sequenceNumber)) {
     return false;
   }
   uint32_t frequency_khz = header.payload_type_frequency / 1000;
   assert(frequency_khz > 0);
 
   int64_t time_diff_ms = clock_->TimeInMilliseconds() -
-      last_receive_time_ms_;
+      state.last_receive_time_ms;
 
   // Diff in time stamp since last received in order.
-  uint32_t timestamp_diff = header.timestamp - last_received_timestamp_;
+  uint32_t timestamp_diff = header.timestamp - state.last_received_timestamp;
   int32_t rtp_time_stamp_diff_ms = static_cast<int32_t>(timestamp_diff) /
       frequency_khz;
 
   int32_t max_delay_ms = 0;
   if (min_rtt == 0) {
     // Jitter standard deviation in samples.
-    float jitter_std = sqrt(static_cast<float>(jitter_q4_ >> 4));
+    float jitter_std = sqrt(static_cast<float>(state.jitter_q4 >> 4));
 
     // 2 times the standard deviation => 95% confidence.
     // And transform to milliseconds by dividing by the frequency in kHz.
@@ -368,21 +471,20 @@ bool StreamStatisticianImpl::IsRetransmitOfOldPacket(
 }
 
 bool StreamStatisticianImpl::IsPacketInOrder(uint16_t sequence_number) const {
-  CriticalSectionScoped cs(stream_lock_.get());
-  return InOrderPacketInternal(sequence_number);
+  return InOrderPacketInternal(ReadState(), sequence_number);
 }
 
 bool StreamStatisticianImpl::InOrderPacketInternal(
-    uint16_t sequence_number) const {
+    const State& state, uint16_t sequence_number) const {
   // First packet is always in order.
-  if (last_receive_time_ms_ == 0)
+  if (state.last_receive_time_ms == 0)
     return true;
 
-  if (IsNewerSequenceNumber(sequence_number, received_seq_max_)) {
+  if (IsNewerSequenceNumber(sequence_number, state.received_seq_max)) {
     return true;
   } else {
     // If we have a restart of the remote side this packet is still in order.
-    return !IsNewerSequenceNumber(sequence_number, received_seq_max_ -
+    return !IsNewerSequenceNumber(sequence_number, state.received_seq_max -
                                   max_reordering_threshold_);
   }
 }
@@ -395,38 +497,77 @@ ReceiveStatisticsImpl::ReceiveStatisticsImpl(Clock* clock)
     : clock_(clock),
       receive_statistics_lock_(CriticalSectionWrapper::CreateCriticalSection()),
       last_rate_update_ms_(0),
+      entries_(NULL),
+      num_entries_(0),
+      entries_capacity_(0),
       rtcp_stats_callback_(NULL),
-      rtp_stats_callback_(NULL) {}
+      rtp_stats_callback_(NULL),
+      has_rtp_stats_callback_(false) {}
 
 ReceiveStatisticsImpl::~ReceiveStatisticsImpl() {
   while (!statisticians_.empty()) {
     delete statisticians_.begin()->second;
     statisticians_.erase(statisticians_.begin());
   }
+  for (size_t i = 0; i < entry_arrays_.size(); ++i)
+    delete [] entry_arrays_[i];
+}
+
+StreamStatisticianImpl* ReceiveStatisticsImpl::FindStatistician(
+    uint32_t ssrc) const {
+  const int num_entries = num_entries_;
+  subtle::ReadBarrier();
+  const StatisticianEntry* entries = entries_;
+  for (int i = 0; i < num_entries; ++i) {
+    if (entries[i].ssrc == ssrc)
+      return entries[i].statistician;
+  }
+  return NULL;
+}
+
+void ReceiveStatisticsImpl::AddEntry(uint32_t ssrc,
+                                     StreamStatisticianImpl* statistician) {
+  StatisticianEntry* entries = entries_;
+  if (num_entries_ == entries_capacity_) {
+    entries_capacity_ = std::max(2 * entries_capacity_,
+                                 kInitialStatisticianEntries);
+    StatisticianEntry* new_entries = new StatisticianEntry[entries_capacity_];
+    if (num_entries_ > 0)
+      memcpy(new_entries, entries, num_entries_ * sizeof(*entries));
+    entry_arrays_.push_back(new_entries);
+    entries = new_entries;
+  }
+  entries[num_entries_].ssrc = ssrc;
+  entries[num_entries_].statistician = statistician;
+  // Publish the array before the count, and the entry before either.
+  subtle::WriteBarrier();
+  entries_ = entries;
+  subtle::WriteBarrier();
+  num_entries_ = num_entries_ + 1;
 }
 
 void ReceiveStatisticsImpl::IncomingPacket(const RTPHeader& header,
                                            size_t bytes,
                                            bool retransmitted) {
-  StatisticianImplMap::iterator it;
-  {
+  StreamStatisticianImpl* statistician = FindStatistician(header.ssrc);
+  if (!statistician) {
     CriticalSectionScoped cs(receive_statistics_lock_.get());
-    it = statisticians_.find(header.ssrc);
-    if (it == statisticians_.end()) {
-      std::pair<StatisticianImplMap::iterator, uint32_t> insert_result =
-          statisticians_.insert(std::make_pair(
-              header.ssrc, new StreamStatisticianImpl(clock_, this, this)));
-      it = insert_result.first;
+    StatisticianImplMap::iterator it = statisticians_.find(header.ssrc);
+    if (it != statisticians_.end()) {
+      statistician = it->second;
+    } else {
+      statistician = new StreamStatisticianImpl(clock_, this, this);
+      statisticians_[header.ssrc] = statistician;
+      AddEntry(header.ssrc, statistician);
     }
   }
-  it->second->IncomingPacket(header, bytes, retransmitted);
+  statistician->IncomingPacket(header, bytes, retransmitted);
 }
 
 void ReceiveStatisticsImpl::FecPacketReceived(uint32_t ssrc) {
-  CriticalSectionScoped cs(receive_statistics_lock_.get());
-  StatisticianImplMap::iterator it = statisticians_.find(ssrc);
-  assert(it != statisticians_.end());
-  it->second->FecPacketReceived();
+  StreamStatisticianImpl* statistician = FindStatistician(ssrc);
+  assert(statistician);
+  statistician->FecPacketReceived();
 }
 
 void ReceiveStatisticsImpl::ChangeSsrc(uint32_t from_ssrc, uint32_t to_ssrc) {
@@ -438,6 +579,12 @@ void ReceiveStatisticsImpl::ChangeSsrc(uint32_t from_ssrc, uint32_t to_ssrc) {
     return;
   statisticians_[to_ssrc] = from_it->second;
   statisticians_.erase(from_it);
+  // A concurrent FindStatistician() finds it by either SSRC.
+  StatisticianEntry* entries = entries_;
+  for (int i = 0; i < num_entries_; ++i) {
+    if (entries[i].ssrc == from_ssrc)
+      entries[i].ssrc = to_ssrc;
+  }
 }
 
 StatisticianMap ReceiveStatisticsImpl::GetActiveStatisticians() const {
@@ -456,6 +603,29 @@ StatisticianMap ReceiveStatisticsImpl::GetActiveStatisticians() const {
   return active_statisticians;
 }
 
+int ReceiveStatisticsImpl::GetActiveStatistics(
+    bool reset,
+    ReportBlockStatistics* statistics,
+    int max_streams) {
+  CriticalSectionScoped cs(receive_statistics_lock_.get());
+  const int64_t now_ms = clock_->CurrentNtpInMilliseconds();
+  int num_streams = 0;
+  for (StatisticianImplMap::const_iterator it = statisticians_.begin();
+       it != statisticians_.end() && num_streams < max_streams; ++it) {
+    uint32_t secs;
+    uint32_t frac;
+    it->second->LastReceiveTimeNtp(&secs, &frac);
+    if (now_ms - Clock::NtpToMs(secs, frac) >= kStatisticsTimeoutMs)
+      continue;
+    if (it->second->GetStatistics(&statistics[num_streams].statistics,
+                                  reset)) {
+      statistics[num_streams].ssrc = it->first;
+      ++num_streams;
+    }
+  }
+  return num_streams;
+}
+
 StreamStatistician* ReceiveStatisticsImpl::GetStatistician(
     uint32_t ssrc) const {
   CriticalSectionScoped cs(receive_statistics_lock_.get());
@@ -513,10 +683,14 @@ void ReceiveStatisticsImpl::RegisterRtpStatisticsCallback(
   if (callback != NULL)
     assert(rtp_stats_callback_ == NULL);
   rtp_stats_callback_ = callback;
+  has_rtp_stats_callback_ = callback != NULL;
 }
 
 void ReceiveStatisticsImpl::DataCountersUpdated(const StreamDataCounters& stats,
                                                 uint32_t ssrc) {
+  // Called for every packet; checked again with the lock held.
+  if (!has_rtp_stats_callback_)
+    return;
   CriticalSectionScoped cs(receive_statistics_lock_.get());
   if (rtp_stats_callback_) {
     rtp_stats_callback_->DataCountersUpdated(stats, ssrc);
@@ -14,15 +14,22 @@
 #include "webrtc/modules/rtp_rtcp/interface/receive_statistics.h"
 
 #include <algorithm>
+#include <vector>
 
 #include "webrtc/modules/rtp_rtcp/source/bitrate.h"
 #include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
 #include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/system_wrappers/interface/thread_annotations.h"
 
 namespace webrtc {
 
 class CriticalSectionWrapper;
 
+// Counts the packets of one stream. IncomingPacket(), FecPacketReceived() and
+// ResetStatistics() must be called on one thread at a time, the receive
+// thread, which updates the counters without taking a lock. Other threads read
+// the counters through a seqlock: they copy them and retry if the receive
+// thread was updating them meanwhile.
 class StreamStatisticianImpl : public StreamStatistician {
  public:
   StreamStatisticianImpl(Clock* clock,
@@ -48,46 +55,80 @@ class StreamStatisticianImpl : public StreamStatistician {
   virtual void LastReceiveTimeNtp(uint32_t* secs, uint32_t* frac) const;
 
  private:
-  bool InOrderPacketInternal(uint16_t sequence_number) const;
-  RtcpStatistics CalculateRtcpStatistics();
+  // The counters written by the receive thread.
+  struct State {
+    State();
+
+    uint32_t ssrc;
+
+    // Stats on received RTP packets.
+    uint32_t jitter_q4;
+    uint32_t jitter_q4_transmission_time_offset;
+
+    int64_t last_receive_time_ms;
+    uint32_t last_receive_time_secs;
+    uint32_t last_receive_time_frac;
+    uint32_t last_received_timestamp;
+    int32_t last_received_transmission_time_offset;
+    uint16_t received_seq_first;
+    uint16_t received_seq_max;
+    uint16_t received_seq_wraps;
+
+    // Current counter values.
+    uint16_t received_packet_overhead;
+    StreamDataCounters receive_counters;
+
+    // Bytes and packets received since the statistician was created, which
+    // are added to |incoming_bitrate_| when it's read. Wrap around.
+    uint32_t total_bytes;
+    uint32_t total_packets;
+  };
+
+  // Bracket every change to |state_|; only called on the receive thread.
+  void BeginStateUpdate();
+  void EndStateUpdate();
+  // Returns a consistent copy of |state_|. May be called on any thread.
+  State ReadState() const;
+
+  bool InOrderPacketInternal(const State& state,
+                             uint16_t sequence_number) const;
+  RtcpStatistics CalculateRtcpStatistics(const State& state)
+      EXCLUSIVE_LOCKS_REQUIRED(stream_lock_.get());
   void UpdateJitter(const RTPHeader& header,
                     uint32_t receive_time_secs,
                     uint32_t receive_time_frac);
   void UpdateCounters(const RTPHeader& rtp_header,
                       size_t bytes,
                       bool retransmitted);
-  void NotifyRtpCallback() LOCKS_EXCLUDED(stream_lock_.get());
+  // Adds the bytes and packets received since the last call to
+  // |incoming_bitrate_|.
+  void UpdateBitrate() const EXCLUSIVE_LOCKS_REQUIRED(stream_lock_.get());
+  void NotifyRtpCallback();
   void NotifyRtcpCallback() LOCKS_EXCLUDED(stream_lock_.get());
 
   Clock* clock_;
+  // Guards the report state below. Not taken by the receive thread, except
+  // in ResetStatistics().
   scoped_ptr<CriticalSectionWrapper> stream_lock_;
-  Bitrate incoming_bitrate_;
-  uint32_t ssrc_;
-  int max_reordering_threshold_;  // In number of packets or sequence numbers.
-
-  // Stats on received RTP packets.
-  uint32_t jitter_q4_;
-  uint32_t cumulative_loss_;
-  uint32_t jitter_q4_transmission_time_offset_;
-
-  int64_t last_receive_time_ms_;
-  uint32_t last_receive_time_secs_;
-  uint32_t last_receive_time_frac_;
-  uint32_t last_received_timestamp_;
-  int32_t last_received_transmission_time_offset_;
-  uint16_t received_seq_first_;
-  uint16_t received_seq_max_;
-  uint16_t received_seq_wraps_;
-
-  // Current counter values.
-  uint16_t received_packet_overhead_;
-  StreamDataCounters receive_counters_;
+  mutable Bitrate incoming_bitrate_;
+  // In number of packets or sequence numbers. Read by the receive thread
+  // without a lock; a new value applies from some later packet on.
+  volatile int max_reordering_threshold_;
+
+  // Odd while the receive thread is updating |state_|.
+  volatile uint32_t state_sequence_;
+  State state_;
+
+  uint32_t cumulative_loss_ GUARDED_BY(stream_lock_.get());
+  // Totals of |state_| last added to |incoming_bitrate_|.
+  mutable uint32_t bitrate_bytes_ GUARDED_BY(stream_lock_.get());
+  mutable uint32_t bitrate_packets_ GUARDED_BY(stream_lock_.get());
 
   // Counter values when we sent the last report.
-  uint32_t last_report_inorder_packets_;
-  uint32_t last_report_old_packets_;
-  uint16_t last_report_seq_max_;
-  RtcpStatistics last_reported_statistics_;
+  uint32_t last_report_inorder_packets_ GUARDED_BY(stream_lock_.get());
+  uint32_t last_report_old_packets_ GUARDED_BY(stream_lock_.get());
+  uint16_t last_report_seq_max_ GUARDED_BY(stream_lock_.get());
+  RtcpStatistics last_reported_statistics_ GUARDED_BY(stream_lock_.get());
 
   RtcpStatisticsCallback* const rtcp_callback_;
   StreamDataCountersCallback* const rtp_callback_;
@@ -107,6 +148,9 @@ class ReceiveStatisticsImpl : public ReceiveStatistics,
                               bool retransmitted) OVERRIDE;
   virtual void FecPacketReceived(uint32_t ssrc) OVERRIDE;
   virtual StatisticianMap GetActiveStatisticians() const OVERRIDE;
+  virtual int GetActiveStatistics(bool reset,
+                                  ReportBlockStatistics* statistics,
+                                  int max_streams) OVERRIDE;
   virtual StreamStatistician* GetStatistician(uint32_t ssrc) const OVERRIDE;
   virtual void SetMaxReorderingThreshold(int max_reordering_threshold) OVERRIDE;
 
@@ -130,13 +174,36 @@ class ReceiveStatisticsImpl : public ReceiveStatistics,
 
   typedef std::map<uint32_t, StreamStatisticianImpl*> StatisticianImplMap;
 
+  // Lets IncomingPacket() find the statistician of an SSRC without a lock.
+  // Entries are appended under |receive_statistics_lock_| and never removed.
+  // A full array is replaced by a copy of twice the size; the old one is kept
+  // until destruction, since a reader may still be scanning it.
+  struct StatisticianEntry {
+    uint32_t ssrc;
+    StreamStatisticianImpl* statistician;
+  };
+
+  StreamStatisticianImpl* FindStatistician(uint32_t ssrc) const;
+  void AddEntry(uint32_t ssrc, StreamStatisticianImpl* statistician)
+      EXCLUSIVE_LOCKS_REQUIRED(receive_statistics_lock_.get());
+
   Clock* clock_;
   scoped_ptr<CriticalSectionWrapper> receive_statistics_lock_;
   int64_t last_rate_update_ms_;
   StatisticianImplMap statisticians_;
 
+  StatisticianEntry* volatile entries_;
+  volatile int num_entries_;
+  int entries_capacity_ GUARDED_BY(receive_statistics_lock_.get());
+  // Every array |entries_| has pointed to, for deletion.
+  std::vector<StatisticianEntry*> entry_arrays_
+      GUARDED_BY(receive_statistics_lock_.get());
+
   RtcpStatisticsCallback* rtcp_stats_callback_;
   StreamDataCountersCallback* rtp_stats_callback_;
+  // Set while |rtp_stats_callback_| is, so that the lock isn't taken for
+  // every packet when there is no callback.
+  volatile bool has_rtp_stats_callback_;
 };
 }  // namespace webrtc
 #endif  // WEBRTC_MODULES_RTP_RTCP_SOURCE_RECEIVE_STATISTICS_IMPL_H_
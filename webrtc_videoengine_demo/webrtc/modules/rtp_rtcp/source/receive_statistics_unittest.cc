@@ -8,11 +8,15 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <stdio.h>
+
 #include "testing/gmock/include/gmock/gmock.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "webrtc/modules/rtp_rtcp/interface/receive_statistics.h"
 #include "webrtc/system_wrappers/interface/clock.h"
 #include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
 
 namespace webrtc {
 
@@ -132,6 +136,38 @@ TEST_F(ReceiveStatisticsTest, ActiveStatisticians) {
   EXPECT_EQ(2u, packets_received);
 }
 
+TEST_F(ReceiveStatisticsTest, ActiveStatistics) {
+  receive_statistics_->IncomingPacket(header1_, kPacketSize1, false);
+  ++header1_.sequenceNumber;
+  clock_.AdvanceTimeMilliseconds(1000);
+  receive_statistics_->IncomingPacket(header2_, kPacketSize2, false);
+  ++header2_.sequenceNumber;
+
+  ReportBlockStatistics statistics[2];
+  EXPECT_EQ(1, receive_statistics_->GetActiveStatistics(true, statistics, 1));
+  EXPECT_EQ(kSsrc1, statistics[0].ssrc);
+  EXPECT_EQ(2, receive_statistics_->GetActiveStatistics(true, statistics, 2));
+  EXPECT_EQ(kSsrc1, statistics[0].ssrc);
+  EXPECT_EQ(kSsrc2, statistics[1].ssrc);
+  EXPECT_EQ(100u, statistics[1].statistics.extended_max_sequence_number);
+
+  // Matches GetStatistics() on the statistician.
+  StreamStatistician* statistician =
+      receive_statistics_->GetStatistician(kSsrc2);
+  ASSERT_TRUE(statistician != NULL);
+  RtcpStatistics expected;
+  EXPECT_TRUE(statistician->GetStatistics(&expected, false));
+  EXPECT_EQ(expected.fraction_lost, statistics[1].statistics.fraction_lost);
+  EXPECT_EQ(expected.cumulative_lost,
+            statistics[1].statistics.cumulative_lost);
+  EXPECT_EQ(expected.jitter, statistics[1].statistics.jitter);
+
+  clock_.AdvanceTimeMilliseconds(7000);
+  // kSsrc1 should have timed out.
+  EXPECT_EQ(1, receive_statistics_->GetActiveStatistics(true, statistics, 2));
+  EXPECT_EQ(kSsrc2, statistics[0].ssrc);
+}
+
 TEST_F(ReceiveStatisticsTest, RtcpCallbacks) {
   class TestCallback : public RtcpStatisticsCallback {
    public:
@@ -300,4 +336,111 @@ TEST_F(ReceiveStatisticsTest, RtpCallbacks) {
   callback.ExpectMatches(
       5, kSsrc1, 4 * kPacketSize1, kPaddingLength * 2, 4, 1, 1);
 }
+
+// Receives packets of one SSRC on a thread of its own.
+class ReceiveThread {
+ public:
+  ReceiveThread(ReceiveStatistics* receive_statistics, uint32_t ssrc,
+                int num_packets)
+      : receive_statistics_(receive_statistics),
+        num_packets_(num_packets),
+        thread_(ThreadWrapper::CreateThread(&Run, this)) {
+    memset(&header_, 0, sizeof(header_));
+    header_.ssrc = ssrc;
+    header_.headerLength = 12;
+  }
+
+  void Start() {
+    unsigned int id;
+    EXPECT_TRUE(thread_->Start(id));
+  }
+  void Stop() { EXPECT_TRUE(thread_->Stop()); }
+
+ private:
+  static bool Run(void* obj) {
+    ReceiveThread* thread = static_cast<ReceiveThread*>(obj);
+    for (int i = 0; i < thread->num_packets_; ++i) {
+      thread->receive_statistics_->IncomingPacket(thread->header_,
+                                                  kPacketSize1, false);
+      ++thread->header_.sequenceNumber;
+    }
+    return false;
+  }
+
+  ReceiveStatistics* receive_statistics_;
+  const int num_packets_;
+  RTPHeader header_;
+  scoped_ptr<ThreadWrapper> thread_;
+};
+
+// The counters are read while other threads update them. Every read must see
+// the bytes and packets of the same packet.
+TEST_F(ReceiveStatisticsTest, ConcurrentUpdatesAndReads) {
+  const int kNumThreads = 4;
+  const int kNumPackets = 200000;
+  scoped_ptr<ReceiveThread> threads[kNumThreads];
+  for (int i = 0; i < kNumThreads; ++i) {
+    // Create the statisticians first; they can't be looked up otherwise.
+    header1_.ssrc = kSsrc1 + i;
+    receive_statistics_->IncomingPacket(header1_, kPacketSize1, false);
+    threads[i].reset(
+        new ReceiveThread(receive_statistics_.get(), kSsrc1 + i, kNumPackets));
+  }
+  for (int i = 0; i < kNumThreads; ++i)
+    threads[i]->Start();
+
+  bool done = false;
+  while (!done) {
+    done = true;
+    for (int i = 0; i < kNumThreads; ++i) {
+      StreamStatistician* statistician =
+          receive_statistics_->GetStatistician(kSsrc1 + i);
+      ASSERT_TRUE(statistician != NULL);
+      uint32_t bytes_received = 0;
+      uint32_t packets_received = 0;
+      statistician->GetDataCounters(&bytes_received, &packets_received);
+      ASSERT_EQ(packets_received * kPacketSize1, bytes_received);
+      RtcpStatistics statistics;
+      EXPECT_TRUE(statistician->GetStatistics(&statistics, true));
+      if (packets_received < kNumPackets + 1u)
+        done = false;
+    }
+  }
+  for (int i = 0; i < kNumThreads; ++i)
+    threads[i]->Stop();
+}
+
+// Prints the time it takes to count a packet with packets of different SSRCs
+// received on several threads, while the statistics are read for RTCP.
+TEST_F(ReceiveStatisticsTest, DISABLED_ContentionBenchmark) {
+  const int kNumThreads[] = {1, 2, 4, 8};
+  const int kNumPackets = 2000000;
+  for (size_t n = 0; n < sizeof(kNumThreads) / sizeof(int); ++n) {
+    const int num_threads = kNumThreads[n];
+    scoped_ptr<ReceiveStatistics> receive_statistics(
+        ReceiveStatistics::Create(&clock_));
+    scoped_ptr<ReceiveThread> threads[8];
+    for (int i = 0; i < num_threads; ++i) {
+      threads[i].reset(
+          new ReceiveThread(receive_statistics.get(), kSsrc1 + i, kNumPackets));
+    }
+    TickTime start = TickTime::Now();
+    for (int i = 0; i < num_threads; ++i)
+      threads[i]->Start();
+    ReportBlockStatistics statistics[8];
+    int reports = 0;
+    for (int i = 0; i < num_threads; ++i) {
+      // Take a report now and then, as the RTCP sender does.
+      while (receive_statistics->GetStatistician(kSsrc1 + i) == NULL) {}
+      receive_statistics->GetActiveStatistics(true, statistics, num_threads);
+      ++reports;
+    }
+    for (int i = 0; i < num_threads; ++i)
+      threads[i]->Stop();
+    int64_t elapsed_us = (TickTime::Now() - start).Microseconds();
+    printf("%d threads: %6.1f ns/packet per thread, %5.1f Mpackets/s\n",
+           num_threads, 1000.0 * elapsed_us / kNumPackets,
+           static_cast<double>(num_threads) * kNumPackets / elapsed_us);
+  }
+}
 }  // namespace webrtc
@@ -185,11 +185,12 @@ void CreateReceiverReport(const RTCPPacketRR& rr,
 //  |                   delay since last SR (DLSR)                  |
 //  +=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+=+
 
-void CreateReportBlocks(const std::vector<RTCPPacketReportBlockItem>& blocks,
+void CreateReportBlocks(const RTCPPacketReportBlockItem* blocks,
+                        size_t num_blocks,
                         uint8_t* buffer,
                         size_t* pos) {
-  for (std::vector<RTCPPacketReportBlockItem>::const_iterator
-       it = blocks.begin(); it != blocks.end(); ++it) {
+  for (const RTCPPacketReportBlockItem* it = blocks;
+       it != blocks + num_blocks; ++it) {
     AssignUWord32(buffer, pos, (*it).SSRC);
     AssignUWord8(buffer, pos, (*it).FractionLost);
     AssignUWord24(buffer, pos, (*it).CumulativeNumOfPacketsLost);
@@ -762,17 +763,16 @@ void SenderReport::Create(uint8_t* packet,
     return;
   }
   CreateSenderReport(sr_, BlockToHeaderLength(BlockLength()), packet, length);
-  CreateReportBlocks(report_blocks_, packet, length);
+  CreateReportBlocks(report_blocks_, sr_.NumberOfReportBlocks, packet, length);
 }
 
 void SenderReport::WithReportBlock(ReportBlock* block) {
   assert(block);
-  if (report_blocks_.size() >= kMaxNumberOfReportBlocks) {
+  if (sr_.NumberOfReportBlocks >= kMaxNumberOfReportBlocks) {
     LOG(LS_WARNING) << "Max report blocks reached.";
     return;
   }
-  report_blocks_.push_back(block->report_block_);
-  sr_.NumberOfReportBlocks = report_blocks_.size();
+  report_blocks_[sr_.NumberOfReportBlocks++] = block->report_block_;
 }
 
 void ReceiverReport::Create(uint8_t* packet,
@@ -783,17 +783,16 @@ void ReceiverReport::Create(uint8_t* packet,
     return;
   }
   CreateReceiverReport(rr_, BlockToHeaderLength(BlockLength()), packet, length);
-  CreateReportBlocks(report_blocks_, packet, length);
+  CreateReportBlocks(report_blocks_, rr_.NumberOfReportBlocks, packet, length);
 }
 
 void ReceiverReport::WithReportBlock(ReportBlock* block) {
   assert(block);
-  if (report_blocks_.size() >= kMaxNumberOfReportBlocks) {
+  if (rr_.NumberOfReportBlocks >= kMaxNumberOfReportBlocks) {
     LOG(LS_WARNING) << "Max report blocks reached.";
     return;
   }
-  report_blocks_.push_back(block->report_block_);
-  rr_.NumberOfReportBlocks = report_blocks_.size();
+  report_blocks_[rr_.NumberOfReportBlocks++] = block->report_block_;
 }
 
 void Ij::Create(uint8_t* packet, size_t* length, size_t max_length) const {
@@ -214,11 +214,13 @@ class SenderReport : public RtcpPacket {
     const size_t kSrHeaderLength = 8;
     const size_t kSenderInfoLength = 20;
     return kSrHeaderLength + kSenderInfoLength +
-           report_blocks_.size() * kReportBlockLength;
+           sr_.NumberOfReportBlocks * kReportBlockLength;
   }
 
   RTCPUtility::RTCPPacketSR sr_;
-  std::vector<RTCPUtility::RTCPPacketReportBlockItem> report_blocks_;
+  // Held in place so that building a report doesn't allocate.
+  RTCPUtility::RTCPPacketReportBlockItem
+      report_blocks_[kMaxNumberOfReportBlocks];
 
   DISALLOW_COPY_AND_ASSIGN(SenderReport);
 };
@@ -258,11 +260,12 @@ class ReceiverReport : public RtcpPacket {
 
   size_t BlockLength() const {
     const size_t kRrHeaderLength = 8;
-    return kRrHeaderLength + report_blocks_.size() * kReportBlockLength;
+    return kRrHeaderLength + rr_.NumberOfReportBlocks * kReportBlockLength;
   }
 
   RTCPUtility::RTCPPacketRR rr_;
-  std::vector<RTCPUtility::RTCPPacketReportBlockItem> report_blocks_;
+  RTCPUtility::RTCPPacketReportBlockItem
+      report_blocks_[kMaxNumberOfReportBlocks];
 
   DISALLOW_COPY_AND_ASSIGN(ReceiverReport);
 };
@@ -28,6 +28,9 @@ using namespace RTCPHelp;
 // The number of RTCP time intervals needed to trigger a timeout.
 const int kRrTimeoutIntervals = 3;
 
+// The most remote SSRCs erased by one UpdateRTCPReceiveInformationTimers().
+const size_t kMaxSsrcsToErase = 16;
+
 RTCPReceiver::RTCPReceiver(const int32_t id, Clock* clock,
                            ModuleRtpRtcpImpl* owner)
     : TMMBRHelp(),
@@ -51,7 +54,6 @@ RTCPReceiver::RTCPReceiver(const int32_t id, Clock* clock,
     _lastReceivedXRNTPsecs(0),
     _lastReceivedXRNTPfrac(0),
     xr_rr_rtt_ms_(0),
-    _receivedInfoMap(),
     _packetTimeOutMS(0),
     _lastReceivedRrMs(0),
     _lastIncreasedSequenceNumberMs(0),
@@ -62,25 +64,6 @@ RTCPReceiver::RTCPReceiver(const int32_t id, Clock* clock,
 RTCPReceiver::~RTCPReceiver() {
   delete _criticalSectionRTCPReceiver;
   delete _criticalSectionFeedbacks;
-
-  while (!_receivedReportBlockMap.empty()) {
-    std::map<uint32_t, RTCPReportBlockInformation*>::iterator first =
-        _receivedReportBlockMap.begin();
-    delete first->second;
-    _receivedReportBlockMap.erase(first);
-  }
-  while (!_receivedInfoMap.empty()) {
-    std::map<uint32_t, RTCPReceiveInformation*>::iterator first =
-        _receivedInfoMap.begin();
-    delete first->second;
-    _receivedInfoMap.erase(first);
-  }
-  while (!_receivedCnameMap.empty()) {
-    std::map<uint32_t, RTCPCnameInformation*>::iterator first =
-        _receivedCnameMap.begin();
-    delete first->second;
-    _receivedCnameMap.erase(first);
-  }
 }
 
 void
@@ -115,10 +98,11 @@ int64_t
 RTCPReceiver::LastReceivedReceiverReport() const {
     CriticalSectionScoped lock(_criticalSectionRTCPReceiver);
     int64_t last_received_rr = -1;
-    for (ReceivedInfoMap::const_iterator it = _receivedInfoMap.begin();
+    for (SsrcMap<RTCPReceiveInformation>::const_iterator it =
+             _receivedInfoMap.begin();
          it != _receivedInfoMap.end(); ++it) {
-      if (it->second->lastTimeReceived > last_received_rr) {
-        last_received_rr = it->second->lastTimeReceived;
+      if (it->value.lastTimeReceived > last_received_rr) {
+        last_received_rr = it->value.lastTimeReceived;
       }
     }
     return last_received_rr;
@@ -192,7 +176,7 @@ int32_t RTCPReceiver::RTT(uint32_t remoteSSRC,
                           uint16_t* maxRTT) const {
   CriticalSectionScoped lock(_criticalSectionRTCPReceiver);
 
-  RTCPReportBlockInformation* reportBlock =
+  const RTCPReportBlockInformation* reportBlock =
       GetReportBlockInformation(remoteSSRC);
 
   if (reportBlock == NULL) {
@@ -295,12 +279,13 @@ int32_t RTCPReceiver::StatisticsReceived(
   assert(receiveBlocks);
   CriticalSectionScoped lock(_criticalSectionRTCPReceiver);
 
-  std::map<uint32_t, RTCPReportBlockInformation*>::const_iterator it =
-      _receivedReportBlockMap.begin();
-
-  while (it != _receivedReportBlockMap.end()) {
-    receiveBlocks->push_back(it->second->remoteReceiveBlock);
-    it++;
+  // Report in SSRC order, as before the blocks were kept in a hash table.
+  std::vector<uint32_t> ssrcs;
+  ssrcs.reserve(_receivedReportBlockMap.size());
+  _receivedReportBlockMap.SortedSsrcs(&ssrcs);
+  for (size_t i = 0; i < ssrcs.size(); ++i) {
+    receiveBlocks->push_back(
+        _receivedReportBlockMap.Find(ssrcs[i])->remoteReceiveBlock);
   }
   return 0;
 }
@@ -593,88 +578,38 @@ void RTCPReceiver::HandleReportBlock(
 
 RTCPReportBlockInformation*
 RTCPReceiver::CreateReportBlockInformation(uint32_t remoteSSRC) {
-  CriticalSectionScoped lock(_criticalSectionRTCPReceiver);
-
-  std::map<uint32_t, RTCPReportBlockInformation*>::iterator it =
-      _receivedReportBlockMap.find(remoteSSRC);
-
-  RTCPReportBlockInformation* ptrReportBlockInfo = NULL;
-  if (it != _receivedReportBlockMap.end()) {
-    ptrReportBlockInfo = it->second;
-  } else {
-    ptrReportBlockInfo = new RTCPReportBlockInformation;
-    _receivedReportBlockMap[remoteSSRC] = ptrReportBlockInfo;
-  }
-  return ptrReportBlockInfo;
+  return _receivedReportBlockMap.Insert(remoteSSRC);
 }
 
-RTCPReportBlockInformation*
+const RTCPReportBlockInformation*
 RTCPReceiver::GetReportBlockInformation(uint32_t remoteSSRC) const {
-  CriticalSectionScoped lock(_criticalSectionRTCPReceiver);
-
-  std::map<uint32_t, RTCPReportBlockInformation*>::const_iterator it =
-      _receivedReportBlockMap.find(remoteSSRC);
+  return _receivedReportBlockMap.Find(remoteSSRC);
+}
 
-  if (it == _receivedReportBlockMap.end()) {
-    return NULL;
-  }
-  return it->second;
+RTCPReportBlockInformation*
+RTCPReceiver::GetReportBlockInformation(uint32_t remoteSSRC) {
+  return _receivedReportBlockMap.Find(remoteSSRC);
 }
 
 RTCPCnameInformation*
 RTCPReceiver::CreateCnameInformation(uint32_t remoteSSRC) {
-  CriticalSectionScoped lock(_criticalSectionRTCPReceiver);
-
-  std::map<uint32_t, RTCPCnameInformation*>::iterator it =
-      _receivedCnameMap.find(remoteSSRC);
-
-  if (it != _receivedCnameMap.end()) {
-    return it->second;
-  }
-  RTCPCnameInformation* cnameInfo = new RTCPCnameInformation;
-  memset(cnameInfo->name, 0, RTCP_CNAME_SIZE);
-  _receivedCnameMap[remoteSSRC] = cnameInfo;
-  return cnameInfo;
+  // A new entry is zero-initialized by the table.
+  return _receivedCnameMap.Insert(remoteSSRC);
 }
 
-RTCPCnameInformation*
+const RTCPCnameInformation*
 RTCPReceiver::GetCnameInformation(uint32_t remoteSSRC) const {
-  CriticalSectionScoped lock(_criticalSectionRTCPReceiver);
-
-  std::map<uint32_t, RTCPCnameInformation*>::const_iterator it =
-      _receivedCnameMap.find(remoteSSRC);
-
-  if (it == _receivedCnameMap.end()) {
-    return NULL;
-  }
-  return it->second;
+  return _receivedCnameMap.Find(remoteSSRC);
 }
 
 RTCPReceiveInformation*
 RTCPReceiver::CreateReceiveInformation(uint32_t remoteSSRC) {
-  CriticalSectionScoped lock(_criticalSectionRTCPReceiver);
-
-  std::map<uint32_t, RTCPReceiveInformation*>::iterator it =
-      _receivedInfoMap.find(remoteSSRC);
-
-  if (it != _receivedInfoMap.end()) {
-    return it->second;
-  }
-  RTCPReceiveInformation* receiveInfo = new RTCPReceiveInformation;
-  _receivedInfoMap[remoteSSRC] = receiveInfo;
-  return receiveInfo;
+  return _receivedInfoMap.Insert(remoteSSRC);
 }
 
 RTCPReceiveInformation*
 RTCPReceiver::GetReceiveInformation(uint32_t remoteSSRC) {
-  CriticalSectionScoped lock(_criticalSectionRTCPReceiver);
-
-  std::map<uint32_t, RTCPReceiveInformation*>::iterator it =
-      _receivedInfoMap.find(remoteSSRC);
-  if (it == _receivedInfoMap.end()) {
-    return NULL;
-  }
-  return it->second;
+  return _receivedInfoMap.Find(remoteSSRC);
 }
 
 void RTCPReceiver::UpdateReceiveInformation(
@@ -718,14 +653,14 @@ bool RTCPReceiver::UpdateRTCPReceiveInformationTimers() {
   bool updateBoundingSet = false;
   int64_t timeNow = _clock->TimeInMilliseconds();
 
-  std::map<uint32_t, RTCPReceiveInformation*>::iterator receiveInfoIt =
-      _receivedInfoMap.begin();
+  // Entries can't be erased while iterating, collect them first.
+  uint32_t ssrcsToErase[kMaxSsrcsToErase];
+  size_t numSsrcsToErase = 0;
 
-  while (receiveInfoIt != _receivedInfoMap.end()) {
-    RTCPReceiveInformation* receiveInfo = receiveInfoIt->second;
-    if (receiveInfo == NULL) {
-      return updateBoundingSet;
-    }
+  for (SsrcMap<RTCPReceiveInformation>::iterator receiveInfoIt =
+           _receivedInfoMap.begin();
+       receiveInfoIt != _receivedInfoMap.end(); ++receiveInfoIt) {
+    RTCPReceiveInformation* receiveInfo = &receiveInfoIt->value;
     // time since last received rtcp packet
     // when we dont have a lastTimeReceived and the object is marked
     // readyForDelete it's removed from the map
@@ -741,31 +676,23 @@ bool RTCPReceiver::UpdateRTCPReceiveInformationTimers() {
         // send new TMMBN to all channels using the default codec
         updateBoundingSet = true;
       }
-      receiveInfoIt++;
-    } else if (receiveInfo->readyForDelete) {
-      // store our current receiveInfoItem
-      std::map<uint32_t, RTCPReceiveInformation*>::iterator
-      receiveInfoItemToBeErased = receiveInfoIt;
-      receiveInfoIt++;
-      delete receiveInfoItemToBeErased->second;
-      _receivedInfoMap.erase(receiveInfoItemToBeErased);
-    } else {
-      receiveInfoIt++;
+    } else if (receiveInfo->readyForDelete &&
+               numSsrcsToErase < kMaxSsrcsToErase) {
+      // Any left over are erased on the next call.
+      ssrcsToErase[numSsrcsToErase++] = receiveInfoIt->ssrc;
     }
   }
+  for (size_t i = 0; i < numSsrcsToErase; ++i) {
+    _receivedInfoMap.Erase(ssrcsToErase[i]);
+  }
   return updateBoundingSet;
 }
 
 int32_t RTCPReceiver::BoundingSet(bool &tmmbrOwner, TMMBRSet* boundingSetRec) {
   CriticalSectionScoped lock(_criticalSectionRTCPReceiver);
 
-  std::map<uint32_t, RTCPReceiveInformation*>::iterator receiveInfoIt =
-      _receivedInfoMap.find(_remoteSSRC);
-
-  if (receiveInfoIt == _receivedInfoMap.end()) {
-    return -1;
-  }
-  RTCPReceiveInformation* receiveInfo = receiveInfoIt->second;
+  const RTCPReceiveInformation* receiveInfo =
+      _receivedInfoMap.Find(_remoteSSRC);
   if (receiveInfo == NULL) {
     return -1;
   }
@@ -864,30 +791,14 @@ void RTCPReceiver::HandleBYE(RTCPUtility::RTCPParserV2& rtcpParser) {
   const RTCPUtility::RTCPPacket& rtcpPacket = rtcpParser.Packet();
 
   // clear our lists
-  CriticalSectionScoped lock(_criticalSectionRTCPReceiver);
-  std::map<uint32_t, RTCPReportBlockInformation*>::iterator
-      reportBlockInfoIt = _receivedReportBlockMap.find(
-          rtcpPacket.BYE.SenderSSRC);
-
-  if (reportBlockInfoIt != _receivedReportBlockMap.end()) {
-    delete reportBlockInfoIt->second;
-    _receivedReportBlockMap.erase(reportBlockInfoIt);
-  }
+  _receivedReportBlockMap.Erase(rtcpPacket.BYE.SenderSSRC);
   //  we can't delete it due to TMMBR
-  std::map<uint32_t, RTCPReceiveInformation*>::iterator receiveInfoIt =
-      _receivedInfoMap.find(rtcpPacket.BYE.SenderSSRC);
-
-  if (receiveInfoIt != _receivedInfoMap.end()) {
-    receiveInfoIt->second->readyForDelete = true;
-  }
-
-  std::map<uint32_t, RTCPCnameInformation*>::iterator cnameInfoIt =
-      _receivedCnameMap.find(rtcpPacket.BYE.SenderSSRC);
-
-  if (cnameInfoIt != _receivedCnameMap.end()) {
-    delete cnameInfoIt->second;
-    _receivedCnameMap.erase(cnameInfoIt);
+  RTCPReceiveInformation* receiveInfo =
+      _receivedInfoMap.Find(rtcpPacket.BYE.SenderSSRC);
+  if (receiveInfo) {
+    receiveInfo->readyForDelete = true;
   }
+  _receivedCnameMap.Erase(rtcpPacket.BYE.SenderSSRC);
   xr_rr_rtt_ms_ = 0;
   rtcpParser.Iterate();
 }
@@ -1481,7 +1392,7 @@ int32_t RTCPReceiver::CNAME(const uint32_t remoteSSRC,
   assert(cName);
 
   CriticalSectionScoped lock(_criticalSectionRTCPReceiver);
-  RTCPCnameInformation* cnameInfo = GetCnameInformation(remoteSSRC);
+  const RTCPCnameInformation* cnameInfo = GetCnameInformation(remoteSSRC);
   if (cnameInfo == NULL) {
     return -1;
   }
@@ -1496,18 +1407,17 @@ int32_t RTCPReceiver::TMMBRReceived(const uint32_t size,
                                     TMMBRSet* candidateSet) const {
   CriticalSectionScoped lock(_criticalSectionRTCPReceiver);
 
-  std::map<uint32_t, RTCPReceiveInformation*>::const_iterator
-      receiveInfoIt = _receivedInfoMap.begin();
-  if (receiveInfoIt == _receivedInfoMap.end()) {
+  if (_receivedInfoMap.empty()) {
     return -1;
   }
   uint32_t num = accNumCandidates;
   if (candidateSet) {
-    while( num < size && receiveInfoIt != _receivedInfoMap.end()) {
-      RTCPReceiveInformation* receiveInfo = receiveInfoIt->second;
-      if (receiveInfo == NULL) {
-        return 0;
-      }
+    // Candidates are collected in SSRC order.
+    std::vector<uint32_t> ssrcs;
+    ssrcs.reserve(_receivedInfoMap.size());
+    _receivedInfoMap.SortedSsrcs(&ssrcs);
+    for (size_t n = 0; num < size && n < ssrcs.size(); ++n) {
+      RTCPReceiveInformation* receiveInfo = _receivedInfoMap.Find(ssrcs[n]);
       for (uint32_t i = 0;
            (num < size) && (i < receiveInfo->TmmbrSet.lengthOfSet()); i++) {
         if (receiveInfo->GetTMMBRSet(i, num, candidateSet,
@@ -1515,16 +1425,12 @@ int32_t RTCPReceiver::TMMBRReceived(const uint32_t size,
           num++;
         }
       }
-      receiveInfoIt++;
     }
   } else {
-    while (receiveInfoIt != _receivedInfoMap.end()) {
-      RTCPReceiveInformation* receiveInfo = receiveInfoIt->second;
-      if(receiveInfo == NULL) {
-        return -1;
-      }
-      num += receiveInfo->TmmbrSet.lengthOfSet();
-      receiveInfoIt++;
+    for (SsrcMap<RTCPReceiveInformation>::const_iterator receiveInfoIt =
+             _receivedInfoMap.begin();
+         receiveInfoIt != _receivedInfoMap.end(); ++receiveInfoIt) {
+      num += receiveInfoIt->value.TmmbrSet.lengthOfSet();
     }
   }
   return num;
@@ -11,7 +11,6 @@
 #ifndef WEBRTC_MODULES_RTP_RTCP_SOURCE_RTCP_RECEIVER_H_
 #define WEBRTC_MODULES_RTP_RTCP_SOURCE_RTCP_RECEIVER_H_
 
-#include <map>
 #include <vector>
 #include <set>
 
@@ -19,7 +18,9 @@
 #include "webrtc/modules/rtp_rtcp/source/rtcp_receiver_help.h"
 #include "webrtc/modules/rtp_rtcp/source/rtcp_utility.h"
 #include "webrtc/modules/rtp_rtcp/source/rtp_utility.h"
+#include "webrtc/modules/rtp_rtcp/source/ssrc_map.h"
 #include "webrtc/modules/rtp_rtcp/source/tmmbr_help.h"
+#include "webrtc/system_wrappers/interface/thread_annotations.h"
 #include "webrtc/typedefs.h"
 
 namespace webrtc {
@@ -115,14 +116,32 @@ public:
     RtcpStatisticsCallback* GetRtcpStatisticsCallback();
 
 protected:
-    RTCPHelp::RTCPReportBlockInformation* CreateReportBlockInformation(const uint32_t remoteSSRC);
-    RTCPHelp::RTCPReportBlockInformation* GetReportBlockInformation(const uint32_t remoteSSRC) const;
-
-    RTCPUtility::RTCPCnameInformation* CreateCnameInformation(const uint32_t remoteSSRC);
-    RTCPUtility::RTCPCnameInformation* GetCnameInformation(const uint32_t remoteSSRC) const;
-
-    RTCPHelp::RTCPReceiveInformation* CreateReceiveInformation(const uint32_t remoteSSRC);
-    RTCPHelp::RTCPReceiveInformation* GetReceiveInformation(const uint32_t remoteSSRC);
+    // The per-SSRC state is looked up with _criticalSectionRTCPReceiver held.
+    // The returned pointers are valid until the next Create call for the same
+    // kind of state or the lock is released.
+    RTCPHelp::RTCPReportBlockInformation* CreateReportBlockInformation(
+        const uint32_t remoteSSRC)
+        EXCLUSIVE_LOCKS_REQUIRED(_criticalSectionRTCPReceiver);
+    const RTCPHelp::RTCPReportBlockInformation* GetReportBlockInformation(
+        const uint32_t remoteSSRC) const
+        EXCLUSIVE_LOCKS_REQUIRED(_criticalSectionRTCPReceiver);
+    RTCPHelp::RTCPReportBlockInformation* GetReportBlockInformation(
+        const uint32_t remoteSSRC)
+        EXCLUSIVE_LOCKS_REQUIRED(_criticalSectionRTCPReceiver);
+
+    RTCPUtility::RTCPCnameInformation* CreateCnameInformation(
+        const uint32_t remoteSSRC)
+        EXCLUSIVE_LOCKS_REQUIRED(_criticalSectionRTCPReceiver);
+    const RTCPUtility::RTCPCnameInformation* GetCnameInformation(
+        const uint32_t remoteSSRC) const
+        EXCLUSIVE_LOCKS_REQUIRED(_criticalSectionRTCPReceiver);
+
+    RTCPHelp::RTCPReceiveInformation* CreateReceiveInformation(
+        const uint32_t remoteSSRC)
+        EXCLUSIVE_LOCKS_REQUIRED(_criticalSectionRTCPReceiver);
+    RTCPHelp::RTCPReceiveInformation* GetReceiveInformation(
+        const uint32_t remoteSSRC)
+        EXCLUSIVE_LOCKS_REQUIRED(_criticalSectionRTCPReceiver);
 
     void UpdateReceiveInformation( RTCPHelp::RTCPReceiveInformation& receiveInformation);
 
@@ -219,8 +238,6 @@ protected:
                        RTCPHelp::RTCPPacketInformation& rtcpPacketInformation);
 
  private:
-  typedef std::map<uint32_t, RTCPHelp::RTCPReceiveInformation*>
-      ReceivedInfoMap;
   int32_t           _id;
   Clock*                  _clock;
   RTCPMethod              _method;
@@ -251,12 +268,13 @@ protected:
   // Estimated rtt, zero when there is no valid estimate.
   uint16_t xr_rr_rtt_ms_;
 
+  // State of each remote SSRC, held by value so that a compound packet is
+  // handled without allocating once its senders are known.
   // Received report blocks.
-  std::map<uint32_t, RTCPHelp::RTCPReportBlockInformation*>
-      _receivedReportBlockMap;
-  ReceivedInfoMap _receivedInfoMap;
-  std::map<uint32_t, RTCPUtility::RTCPCnameInformation*>
-      _receivedCnameMap;
+  SsrcMap<RTCPHelp::RTCPReportBlockInformation> _receivedReportBlockMap;
+  // Mutable since TMMBRReceived() drops timed out TMMBR entries.
+  mutable SsrcMap<RTCPHelp::RTCPReceiveInformation> _receivedInfoMap;
+  SsrcMap<RTCPUtility::RTCPCnameInformation> _receivedCnameMap;
 
   uint32_t            _packetTimeOutMS;
 
@@ -12,6 +12,10 @@
 /*
  * This file includes unit tests for the RTCPReceiver.
  */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
 #include "testing/gmock/include/gmock/gmock.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -24,6 +28,7 @@
 #include "webrtc/modules/rtp_rtcp/source/rtcp_sender.h"
 #include "webrtc/modules/rtp_rtcp/source/rtp_rtcp_impl.h"
 #include "webrtc/modules/rtp_rtcp/source/rtp_utility.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
 
 namespace webrtc {
 
@@ -604,6 +609,151 @@ TEST_F(RtcpReceiverTest, TmmbrThreeConstraintsTimeOut) {
   EXPECT_EQ(kSenderSsrc + 1, candidate_set.Ssrc(0));
 }
 
+TEST_F(RtcpReceiverTest, ManyRemoteSsrcs) {
+  const uint32_t kSourceSsrc = 0x40506;
+  const uint32_t kFirstSenderSsrc = 0x1000;
+  const int kNumSenders = 100;
+
+  std::set<uint32_t> ssrcs;
+  ssrcs.insert(kSourceSsrc);
+  rtcp_receiver_->SetSsrcs(kSourceSsrc, ssrcs);
+
+  // Received in descending order, reported in ascending order.
+  for (int i = kNumSenders - 1; i >= 0; --i) {
+    rtcp::ReportBlock rb;
+    rb.To(kSourceSsrc);
+    rb.WithExtHighestSeqNum(i);
+    rtcp::ReceiverReport rr;
+    rr.From(kFirstSenderSsrc + i);
+    rr.WithReportBlock(&rb);
+    rtcp::RawPacket p = rr.Build();
+    EXPECT_EQ(0, InjectRtcpPacket(p.buffer(), p.buffer_length()));
+  }
+  std::vector<RTCPReportBlock> report_blocks;
+  EXPECT_EQ(0, rtcp_receiver_->StatisticsReceived(&report_blocks));
+  ASSERT_EQ(static_cast<size_t>(kNumSenders), report_blocks.size());
+  for (int i = 0; i < kNumSenders; ++i) {
+    EXPECT_EQ(kFirstSenderSsrc + i, report_blocks[i].remoteSSRC);
+    EXPECT_EQ(static_cast<uint32_t>(i), report_blocks[i].extendedHighSeqNum);
+  }
+
+  // A BYE removes the report block of its sender.
+  for (int i = 0; i < kNumSenders; i += 2) {
+    rtcp::Bye bye;
+    bye.From(kFirstSenderSsrc + i);
+    rtcp::RawPacket p = bye.Build();
+    EXPECT_EQ(0, InjectRtcpPacket(p.buffer(), p.buffer_length()));
+  }
+  report_blocks.clear();
+  EXPECT_EQ(0, rtcp_receiver_->StatisticsReceived(&report_blocks));
+  ASSERT_EQ(static_cast<size_t>(kNumSenders / 2), report_blocks.size());
+  for (int i = 0; i < kNumSenders / 2; ++i)
+    EXPECT_EQ(kFirstSenderSsrc + 2 * i + 1, report_blocks[i].remoteSSRC);
+
+  // Senders that have said BYE are forgotten once they have timed out.
+  for (int i = 1; i < kNumSenders; i += 2) {
+    rtcp::Bye bye;
+    bye.From(kFirstSenderSsrc + i);
+    rtcp::RawPacket p = bye.Build();
+    EXPECT_EQ(0, InjectRtcpPacket(p.buffer(), p.buffer_length()));
+  }
+  system_clock_.AdvanceTimeMilliseconds(5 * RTCP_INTERVAL_AUDIO_MS + 1);
+  EXPECT_TRUE(rtcp_receiver_->UpdateRTCPReceiveInformationTimers());
+  EXPECT_EQ(0, rtcp_receiver_->LastReceivedReceiverReport());
+  for (int i = 0; i < kNumSenders; ++i)
+    rtcp_receiver_->UpdateRTCPReceiveInformationTimers();
+  EXPECT_EQ(-1, rtcp_receiver_->LastReceivedReceiverReport());
+}
+
+// Builds a compound packet from |sender_ssrc| with the blocks a video sender
+// typically receives.
+static rtcp::RawPacket BuildCompoundPacket(uint32_t sender_ssrc,
+                                           uint32_t media_ssrc) {
+  const uint16_t kNackList[] = {1, 2, 3, 5, 8, 13, 21, 34, 55, 89};
+  rtcp::ReportBlock rb;
+  rb.To(media_ssrc);
+  rb.WithExtHighestSeqNum(1000);
+  rb.WithFractionLost(10);
+  rb.WithJitter(100);
+  rtcp::SenderReport sr;
+  sr.From(sender_ssrc);
+  sr.WithReportBlock(&rb);
+  rtcp::Sdes sdes;
+  sdes.WithCName(sender_ssrc, "receiver@example.com");
+  sr.Append(&sdes);
+  rtcp::Nack nack;
+  nack.From(sender_ssrc);
+  nack.To(media_ssrc);
+  nack.WithList(kNackList, sizeof(kNackList) / sizeof(kNackList[0]));
+  sr.Append(&nack);
+  rtcp::Remb remb;
+  remb.From(sender_ssrc);
+  remb.AppliesTo(media_ssrc);
+  remb.WithBitrateBps(500000);
+  sr.Append(&remb);
+  rtcp::Tmmbr tmmbr;
+  tmmbr.From(sender_ssrc);
+  tmmbr.To(media_ssrc);
+  tmmbr.WithBitrateKbps(300);
+  sr.Append(&tmmbr);
+  return sr.Build();
+}
+
+// Corrupts and truncates compound packets at random. Nothing is checked but
+// that the receiver handles them without crashing.
+TEST_F(RtcpReceiverTest, RandomlyCorruptedPackets) {
+  const uint32_t kSenderSsrc = 0x10203;
+  const uint32_t kSourceSsrc = 0x40506;
+  const int kIterations = 5000;
+  std::set<uint32_t> ssrcs;
+  ssrcs.insert(kSourceSsrc);
+  rtcp_receiver_->SetSsrcs(kSourceSsrc, ssrcs);
+
+  rtcp::RawPacket p = BuildCompoundPacket(kSenderSsrc, kSourceSsrc);
+  const uint16_t length = static_cast<uint16_t>(p.buffer_length());
+  uint8_t packet[IP_PACKET_SIZE];
+  srand(17);
+  for (int i = 0; i < kIterations; ++i) {
+    memcpy(packet, p.buffer(), length);
+    const int num_errors = 1 + rand() % 4;
+    for (int j = 0; j < num_errors; ++j)
+      packet[rand() % length] = static_cast<uint8_t>(rand());
+    const uint16_t packet_length = 1 + rand() % length;
+    EXPECT_EQ(0, InjectRtcpPacket(packet, packet_length));
+    system_clock_.AdvanceTimeMilliseconds(10);
+    rtcp_receiver_->UpdateRTCPReceiveInformationTimers();
+  }
+}
+
+// Prints the time it takes to handle a compound packet, from a single remote
+// sender and from many.
+TEST_F(RtcpReceiverTest, DISABLED_Benchmark) {
+  const uint32_t kSourceSsrc = 0x40506;
+  const int kNumSenders[] = {1, 16, 256};
+  const int kIterations = 200000;
+  std::set<uint32_t> ssrcs;
+  ssrcs.insert(kSourceSsrc);
+  rtcp_receiver_->SetSsrcs(kSourceSsrc, ssrcs);
+
+  for (size_t n = 0; n < sizeof(kNumSenders) / sizeof(int); ++n) {
+    std::vector<rtcp::RawPacket> packets;
+    for (int i = 0; i < kNumSenders[n]; ++i)
+      packets.push_back(BuildCompoundPacket(0x1000 + i, kSourceSsrc));
+    TickTime start = TickTime::Now();
+    for (int i = 0; i < kIterations; ++i) {
+      rtcp::RawPacket& packet = packets[i % packets.size()];
+      RTCPUtility::RTCPParserV2 parser(packet.buffer(), packet.buffer_length(),
+                                       true);
+      RTCPHelp::RTCPPacketInformation packet_information;
+      rtcp_receiver_->IncomingRTCPPacket(packet_information, &parser);
+    }
+    int64_t elapsed_us = (TickTime::Now() - start).Microseconds();
+    printf("%3d senders, %d byte packets: %6.0f ns/packet\n", kNumSenders[n],
+           static_cast<int>(packets[0].buffer_length()),
+           1000.0 * elapsed_us / kIterations);
+  }
+}
+
 TEST_F(RtcpReceiverTest, Callbacks) {
   class RtcpCallbackImpl : public RtcpStatisticsCallback {
    public:
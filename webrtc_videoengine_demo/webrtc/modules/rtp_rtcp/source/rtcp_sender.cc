@@ -26,6 +26,20 @@ namespace webrtc {
 
 using RTCPUtility::RTCPCnameInformation;
 
+namespace {
+// Builds |packet| into |buffer| at |pos|. Returns -2 if it doesn't fit.
+int32_t AppendPacket(const rtcp::RtcpPacket& packet,
+                     uint8_t* buffer,
+                     int& pos) {
+  size_t length = 0;
+  packet.Build(buffer + pos, &length, IP_PACKET_SIZE - pos);
+  if (length == 0)
+    return -2;
+  pos += static_cast<int>(length);
+  return 0;
+}
+}  // namespace
+
 NACKStringBuilder::NACKStringBuilder() :
     _stream(""), _count(0), _consecutive(false)
 {
@@ -103,7 +117,7 @@ RTCPSender::RTCPSender(const int32_t id,
     _remoteSSRC(0),
     _CNAME(),
     receive_statistics_(receive_statistics),
-    internal_report_blocks_(),
+    num_report_blocks_(0),
     external_report_blocks_(),
     _csrcCNAMEs(),
 
@@ -148,10 +162,6 @@ RTCPSender::~RTCPSender() {
   delete [] _rembSSRC;
   delete [] _appData;
 
-  while (!internal_report_blocks_.empty()) {
-    delete internal_report_blocks_.begin()->second;
-    internal_report_blocks_.erase(internal_report_blocks_.begin());
-  }
   while (!external_report_blocks_.empty()) {
     std::map<uint32_t, RTCPReportBlock*>::iterator it =
         external_report_blocks_.begin();
@@ -591,14 +601,6 @@ int32_t RTCPSender::BuildSR(const FeedbackState& feedback_state,
         LOG(LS_WARNING) << "Failed to build Sender Report.";
         return -2;
     }
-    uint32_t RTPtime;
-
-    uint32_t posNumberOfReportBlocks = pos;
-    rtcpbuffer[pos++]=(uint8_t)0x80;
-
-    // Sender report
-    rtcpbuffer[pos++]=(uint8_t)200;
-
     for(int i = (RTCP_NUMBER_OF_SR-2); i >= 0; i--)
     {
         // shift old
@@ -613,51 +615,22 @@ int32_t RTCPSender::BuildSR(const FeedbackState& feedback_state,
     // the frame being captured at this moment. We are calculating that
     // timestamp as the last frame's timestamp + the time since the last frame
     // was captured.
-    RTPtime = start_timestamp_ + last_rtp_timestamp_ +
-              (_clock->TimeInMilliseconds() - last_frame_capture_time_ms_) *
-                  (feedback_state.frequency_hz / 1000);
-
-    // Add sender data
-    // Save  for our length field
-    pos++;
-    pos++;
-
-    // Add our own SSRC
-    RtpUtility::AssignUWord32ToBuffer(rtcpbuffer + pos, _SSRC);
-    pos += 4;
-    // NTP
-    RtpUtility::AssignUWord32ToBuffer(rtcpbuffer + pos, NTPsec);
-    pos += 4;
-    RtpUtility::AssignUWord32ToBuffer(rtcpbuffer + pos, NTPfrac);
-    pos += 4;
-    RtpUtility::AssignUWord32ToBuffer(rtcpbuffer + pos, RTPtime);
-    pos += 4;
-
-    //sender's packet count
-    RtpUtility::AssignUWord32ToBuffer(rtcpbuffer + pos,
-                                      feedback_state.packets_sent);
-    pos += 4;
-
-    //sender's octet count
-    RtpUtility::AssignUWord32ToBuffer(rtcpbuffer + pos,
-                                      feedback_state.media_bytes_sent);
-    pos += 4;
-
-    uint8_t numberOfReportBlocks = 0;
-    int32_t retVal = WriteAllReportBlocksToBuffer(rtcpbuffer, pos,
-                                                  numberOfReportBlocks,
-                                                  NTPsec, NTPfrac);
-    if(retVal < 0)
+    uint32_t RTPtime = start_timestamp_ + last_rtp_timestamp_ +
+        (_clock->TimeInMilliseconds() - last_frame_capture_time_ms_) *
+            (feedback_state.frequency_hz / 1000);
+
+    rtcp::SenderReport report;
+    report.From(_SSRC);
+    report.WithNtpSec(NTPsec);
+    report.WithNtpFrac(NTPfrac);
+    report.WithRtpTimestamp(RTPtime);
+    report.WithPacketCount(feedback_state.packets_sent);
+    report.WithOctetCount(feedback_state.media_bytes_sent);
+    for (int i = 0; i < num_report_blocks_; ++i)
     {
-        //
-        return retVal ;
+        report.WithReportBlock(&report_blocks_[i]);
     }
-    pos = retVal;
-    rtcpbuffer[posNumberOfReportBlocks] += numberOfReportBlocks;
-
-    uint16_t len = uint16_t((pos/4) -1);
-    RtpUtility::AssignUWord16ToBuffer(rtcpbuffer + 2, len);
-    return 0;
+    return AppendPacket(report, rtcpbuffer, pos);
 }
 
 
@@ -753,43 +726,15 @@ int32_t RTCPSender::BuildSDEC(uint8_t* rtcpbuffer, int& pos) {
 }
 
 int32_t
-RTCPSender::BuildRR(uint8_t* rtcpbuffer,
-                    int& pos,
-                    const uint32_t NTPsec,
-                    const uint32_t NTPfrac)
+RTCPSender::BuildRR(uint8_t* rtcpbuffer, int& pos)
 {
-    // sanity one block
-    if(pos + 32 >= IP_PACKET_SIZE)
-    {
-        return -2;
-    }
-    uint32_t posNumberOfReportBlocks = pos;
-
-    rtcpbuffer[pos++]=(uint8_t)0x80;
-    rtcpbuffer[pos++]=(uint8_t)201;
-
-    // Save  for our length field
-    pos++;
-    pos++;
-
-    // Add our own SSRC
-    RtpUtility::AssignUWord32ToBuffer(rtcpbuffer + pos, _SSRC);
-    pos += 4;
-
-    uint8_t numberOfReportBlocks = 0;
-    int retVal = WriteAllReportBlocksToBuffer(rtcpbuffer, pos,
-                                              numberOfReportBlocks,
-                                              NTPsec, NTPfrac);
-    if(retVal < 0)
+    rtcp::ReceiverReport report;
+    report.From(_SSRC);
+    for (int i = 0; i < num_report_blocks_; ++i)
     {
-        return pos;
+        report.WithReportBlock(&report_blocks_[i]);
     }
-    pos = retVal;
-    rtcpbuffer[posNumberOfReportBlocks] += numberOfReportBlocks;
-
-    uint16_t len = uint16_t((pos)/4 -1);
-    RtpUtility::AssignUWord16ToBuffer(rtcpbuffer + 2, len);
-    return 0;
+    return AppendPacket(report, rtcpbuffer, pos);
 }
 
 // From RFC 5450: Transmission Time Offsets in RTP Streams.
@@ -1617,14 +1562,6 @@ int32_t RTCPSender::SendRTCP(const FeedbackState& feedback_state,
                              const uint16_t* nackList,
                              bool repeat,
                              uint64_t pictureID) {
-  {
-    CriticalSectionScoped lock(_criticalSectionRTCPSender);
-    if(_method == kRtcpOff)
-    {
-        LOG(LS_WARNING) << "Can't send rtcp if it is disabled.";
-        return -1;
-    }
-  }
   uint8_t rtcp_buffer[IP_PACKET_SIZE];
   int rtcp_length = PrepareRTCP(feedback_state,
                                 packetTypeFlags,
@@ -1661,6 +1598,11 @@ int RTCPSender::PrepareRTCP(const FeedbackState& feedback_state,
   int position = 0;
 
   CriticalSectionScoped lock(_criticalSectionRTCPSender);
+  if(_method == kRtcpOff)
+  {
+      LOG(LS_WARNING) << "Can't send rtcp if it is disabled.";
+      return -1;
+  }
 
   if(_TMMBR )  // Attach TMMBR to send and receive reports.
   {
@@ -1754,26 +1696,21 @@ int RTCPSender::PrepareRTCP(const FeedbackState& feedback_state,
   // If the data does not fit in the packet we fill it as much as possible.
   int32_t buildVal = 0;
 
-  // We need to send our NTP even if we haven't received any reports.
-  _clock->CurrentNtp(NTPsec, NTPfrac);
+  // Snapshot the statistics of all received streams at once.
+  ReportBlockStatistics statistics[RTCP_MAX_REPORT_BLOCKS];
+  int num_statistics = 0;
   if (ShouldSendReportBlocks(rtcpPacketTypeFlags)) {
-    StatisticianMap statisticians =
-        receive_statistics_->GetActiveStatisticians();
-    if (!statisticians.empty()) {
-      StatisticianMap::const_iterator it;
-      int i;
-      for (it = statisticians.begin(), i = 0; it != statisticians.end();
-           ++it, ++i) {
-        RTCPReportBlock report_block;
-        if (PrepareReport(
-                feedback_state, it->second, &report_block, &NTPsec, &NTPfrac))
-          AddReportBlock(it->first, &internal_report_blocks_, &report_block);
-      }
-      if (_IJ && !statisticians.empty()) {
-        rtcpPacketTypeFlags |= kRtcpTransmissionTimeOffset;
-      }
+    num_statistics = receive_statistics_->GetActiveStatistics(
+        true, statistics, RTCP_MAX_REPORT_BLOCKS);
+    if (_IJ && num_statistics > 0) {
+      rtcpPacketTypeFlags |= kRtcpTransmissionTimeOffset;
     }
   }
+  // We need to send our NTP even if we haven't received any reports. Get it
+  // after the statistics to avoid a race.
+  _clock->CurrentNtp(NTPsec, NTPfrac);
+  PrepareReportBlocks(feedback_state, statistics, num_statistics, NTPsec,
+                      NTPfrac);
 
   if(rtcpPacketTypeFlags & kRtcpSr)
   {
@@ -1791,7 +1728,7 @@ int RTCPSender::PrepareRTCP(const FeedbackState& feedback_state,
       }
   }else if(rtcpPacketTypeFlags & kRtcpRr)
   {
-      buildVal = BuildRR(rtcp_buffer, position, NTPsec, NTPfrac);
+      buildVal = BuildRR(rtcp_buffer, position);
       if (buildVal == -1) {
         return -1;
       } else if (buildVal == -2) {
@@ -1964,37 +1901,25 @@ int RTCPSender::PrepareRTCP(const FeedbackState& feedback_state,
 }
 
 bool RTCPSender::ShouldSendReportBlocks(uint32_t rtcp_packet_type) const {
-  return Status() == kRtcpCompound ||
+  return _method == kRtcpCompound ||
       (rtcp_packet_type & kRtcpReport) ||
       (rtcp_packet_type & kRtcpSr) ||
       (rtcp_packet_type & kRtcpRr);
 }
 
-bool RTCPSender::PrepareReport(const FeedbackState& feedback_state,
-                               StreamStatistician* statistician,
-                               RTCPReportBlock* report_block,
-                               uint32_t* ntp_secs, uint32_t* ntp_frac) {
-  // Do we have receive statistics to send?
-  RtcpStatistics stats;
-  if (!statistician->GetStatistics(&stats, true))
-    return false;
-  report_block->fractionLost = stats.fraction_lost;
-  report_block->cumulativeLost = stats.cumulative_lost;
-  report_block->extendedHighSeqNum =
-      stats.extended_max_sequence_number;
-  report_block->jitter = stats.jitter;
-
-  // get our NTP as late as possible to avoid a race
-  _clock->CurrentNtp(*ntp_secs, *ntp_frac);
-
-  // Delay since last received report
+void RTCPSender::PrepareReportBlocks(const FeedbackState& feedback_state,
+                                     const ReportBlockStatistics* statistics,
+                                     int num_statistics,
+                                     uint32_t ntp_secs,
+                                     uint32_t ntp_frac) {
+  // Delay since last received report, the same for all blocks.
   uint32_t delaySinceLastReceivedSR = 0;
   if ((feedback_state.last_rr_ntp_secs != 0) ||
       (feedback_state.last_rr_ntp_frac != 0)) {
     // get the 16 lowest bits of seconds and the 16 higest bits of fractions
-    uint32_t now=*ntp_secs&0x0000FFFF;
+    uint32_t now=ntp_secs&0x0000FFFF;
     now <<=16;
-    now += (*ntp_frac&0xffff0000)>>16;
+    now += (ntp_frac&0xffff0000)>>16;
 
     uint32_t receiveTime = feedback_state.last_rr_ntp_secs&0x0000FFFF;
     receiveTime <<=16;
@@ -2002,9 +1927,33 @@ bool RTCPSender::PrepareReport(const FeedbackState& feedback_state,
 
     delaySinceLastReceivedSR = now-receiveTime;
   }
-  report_block->delaySinceLastSR = delaySinceLastReceivedSR;
-  report_block->lastSR = feedback_state.remote_sr;
-  return true;
+
+  num_report_blocks_ = 0;
+  for (int i = 0; i < num_statistics; ++i) {
+    const RtcpStatistics& stats = statistics[i].statistics;
+    rtcp::ReportBlock& block = report_blocks_[num_report_blocks_++];
+    block.To(statistics[i].ssrc);
+    block.WithFractionLost(stats.fraction_lost);
+    block.WithCumulativeLost(stats.cumulative_lost);
+    block.WithExtHighestSeqNum(stats.extended_max_sequence_number);
+    block.WithJitter(stats.jitter);
+    block.WithLastSr(feedback_state.remote_sr);
+    block.WithDelayLastSr(delaySinceLastReceivedSR);
+  }
+  std::map<uint32_t, RTCPReportBlock*>::const_iterator it =
+      external_report_blocks_.begin();
+  for (; it != external_report_blocks_.end() &&
+             num_report_blocks_ < RTCP_MAX_REPORT_BLOCKS; ++it) {
+    const RTCPReportBlock* external_block = it->second;
+    rtcp::ReportBlock& block = report_blocks_[num_report_blocks_++];
+    block.To(it->first);
+    block.WithFractionLost(external_block->fractionLost);
+    block.WithCumulativeLost(external_block->cumulativeLost);
+    block.WithExtHighestSeqNum(external_block->extendedHighSeqNum);
+    block.WithJitter(external_block->jitter);
+    block.WithLastSr(external_block->lastSR);
+    block.WithDelayLastSr(external_block->delaySinceLastSR);
+  }
 }
 
 int32_t
@@ -2092,72 +2041,6 @@ bool RTCPSender::RtcpXrReceiverReferenceTime() const {
   return xrSendReceiverReferenceTimeEnabled_;
 }
 
-// called under critsect _criticalSectionRTCPSender
-int32_t RTCPSender::WriteAllReportBlocksToBuffer(
-    uint8_t* rtcpbuffer,
-    int pos,
-    uint8_t& numberOfReportBlocks,
-    const uint32_t NTPsec,
-    const uint32_t NTPfrac) {
-  numberOfReportBlocks = external_report_blocks_.size();
-  numberOfReportBlocks += internal_report_blocks_.size();
-  if ((pos + numberOfReportBlocks * 24) >= IP_PACKET_SIZE) {
-    LOG(LS_WARNING) << "Can't fit all report blocks.";
-    return -1;
-  }
-  pos = WriteReportBlocksToBuffer(rtcpbuffer, pos, internal_report_blocks_);
-  while (!internal_report_blocks_.empty()) {
-    delete internal_report_blocks_.begin()->second;
-    internal_report_blocks_.erase(internal_report_blocks_.begin());
-  }
-  pos = WriteReportBlocksToBuffer(rtcpbuffer, pos, external_report_blocks_);
-  return pos;
-}
-
-int32_t RTCPSender::WriteReportBlocksToBuffer(
-    uint8_t* rtcpbuffer,
-    int32_t position,
-    const std::map<uint32_t, RTCPReportBlock*>& report_blocks) {
-  std::map<uint32_t, RTCPReportBlock*>::const_iterator it =
-      report_blocks.begin();
-  for (; it != report_blocks.end(); it++) {
-    uint32_t remoteSSRC = it->first;
-    RTCPReportBlock* reportBlock = it->second;
-    if (reportBlock) {
-      // Remote SSRC
-      RtpUtility::AssignUWord32ToBuffer(rtcpbuffer + position, remoteSSRC);
-      position += 4;
-
-      // fraction lost
-      rtcpbuffer[position++] = reportBlock->fractionLost;
-
-      // cumulative loss
-      RtpUtility::AssignUWord24ToBuffer(rtcpbuffer + position,
-                                        reportBlock->cumulativeLost);
-      position += 3;
-
-      // extended highest seq_no, contain the highest sequence number received
-      RtpUtility::AssignUWord32ToBuffer(rtcpbuffer + position,
-                                        reportBlock->extendedHighSeqNum);
-      position += 4;
-
-      // Jitter
-      RtpUtility::AssignUWord32ToBuffer(rtcpbuffer + position,
-                                        reportBlock->jitter);
-      position += 4;
-
-      RtpUtility::AssignUWord32ToBuffer(rtcpbuffer + position,
-                                        reportBlock->lastSR);
-      position += 4;
-
-      RtpUtility::AssignUWord32ToBuffer(rtcpbuffer + position,
-                                        reportBlock->delaySinceLastSR);
-      position += 4;
-    }
-  }
-  return position;
-}
-
 // no callbacks allowed inside this function
 int32_t
 RTCPSender::SetTMMBN(const TMMBRSet* boundingSet,
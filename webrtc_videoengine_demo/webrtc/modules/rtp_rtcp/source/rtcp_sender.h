@@ -19,7 +19,9 @@
 #include "webrtc/modules/remote_bitrate_estimator/include/remote_bitrate_estimator.h"
 #include "webrtc/modules/rtp_rtcp/interface/receive_statistics.h"
 #include "webrtc/modules/rtp_rtcp/interface/rtp_rtcp_defines.h"
+#include "webrtc/modules/rtp_rtcp/source/rtcp_packet.h"
 #include "webrtc/modules/rtp_rtcp/source/rtcp_utility.h"
+#include "webrtc/modules/rtp_rtcp/source/rtp_rtcp_config.h"
 #include "webrtc/modules/rtp_rtcp/source/rtp_utility.h"
 #include "webrtc/modules/rtp_rtcp/source/tmmbr_help.h"
 #include "webrtc/system_wrappers/interface/scoped_ptr.h"
@@ -180,27 +182,20 @@ public:
 private:
     int32_t SendToNetwork(const uint8_t* dataBuffer, const uint16_t length);
 
-    int32_t WriteAllReportBlocksToBuffer(uint8_t* rtcpbuffer,
-                            int pos,
-                            uint8_t& numberOfReportBlocks,
-                            const uint32_t NTPsec,
-                            const uint32_t NTPfrac)
-        EXCLUSIVE_LOCKS_REQUIRED(_criticalSectionRTCPSender);
-
-    int32_t WriteReportBlocksToBuffer(
-        uint8_t* rtcpbuffer,
-        int32_t position,
-        const std::map<uint32_t, RTCPReportBlock*>& report_blocks);
-
     int32_t AddReportBlock(
         uint32_t SSRC,
         std::map<uint32_t, RTCPReportBlock*>* report_blocks,
         const RTCPReportBlock* receiveBlock);
 
-    bool PrepareReport(const FeedbackState& feedback_state,
-                       StreamStatistician* statistician,
-                       RTCPReportBlock* report_block,
-                       uint32_t* ntp_secs, uint32_t* ntp_frac);
+    // Fills |report_blocks_| with the blocks of the next report: one for each
+    // of the |num_statistics| received streams, followed by the external
+    // blocks.
+    void PrepareReportBlocks(const FeedbackState& feedback_state,
+                             const ReportBlockStatistics* statistics,
+                             int num_statistics,
+                             uint32_t ntp_secs,
+                             uint32_t ntp_frac)
+        EXCLUSIVE_LOCKS_REQUIRED(_criticalSectionRTCPSender);
 
     int32_t BuildSR(const FeedbackState& feedback_state,
                     uint8_t* rtcpbuffer,
@@ -209,10 +204,7 @@ private:
                     uint32_t NTPfrac)
         EXCLUSIVE_LOCKS_REQUIRED(_criticalSectionRTCPSender);
 
-    int32_t BuildRR(uint8_t* rtcpbuffer,
-                    int& pos,
-                    const uint32_t NTPsec,
-                    const uint32_t NTPfrac)
+    int32_t BuildRR(uint8_t* rtcpbuffer, int& pos)
         EXCLUSIVE_LOCKS_REQUIRED(_criticalSectionRTCPSender);
 
     int PrepareRTCP(
@@ -225,7 +217,8 @@ private:
         uint8_t* rtcp_buffer,
         int buffer_size);
 
-    bool ShouldSendReportBlocks(uint32_t rtcp_packet_type) const;
+    bool ShouldSendReportBlocks(uint32_t rtcp_packet_type) const
+        EXCLUSIVE_LOCKS_REQUIRED(_criticalSectionRTCPSender);
 
     int32_t BuildExtendedJitterReport(
         uint8_t* rtcpbuffer,
@@ -305,8 +298,10 @@ private:
 
     ReceiveStatistics* receive_statistics_
         GUARDED_BY(_criticalSectionRTCPSender);
-    std::map<uint32_t, RTCPReportBlock*> internal_report_blocks_
+    // Report blocks of the report being built.
+    rtcp::ReportBlock report_blocks_[RTCP_MAX_REPORT_BLOCKS]
         GUARDED_BY(_criticalSectionRTCPSender);
+    int num_report_blocks_ GUARDED_BY(_criticalSectionRTCPSender);
     std::map<uint32_t, RTCPReportBlock*> external_report_blocks_
         GUARDED_BY(_criticalSectionRTCPSender);
     std::map<uint32_t, RTCPUtility::RTCPCnameInformation*> _csrcCNAMEs
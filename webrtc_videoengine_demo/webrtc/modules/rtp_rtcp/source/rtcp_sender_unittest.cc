@@ -13,6 +13,10 @@
  * This file includes unit tests for the RTCPSender.
  */
 
+#include <stdio.h>
+
+#include <vector>
+
 #include "testing/gmock/include/gmock/gmock.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -27,6 +31,7 @@
 #include "webrtc/modules/rtp_rtcp/source/rtp_receiver_video.h"
 #include "webrtc/modules/rtp_rtcp/source/rtp_rtcp_impl.h"
 #include "webrtc/modules/rtp_rtcp/source/rtp_utility.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
 
 namespace webrtc {
 
@@ -237,6 +242,20 @@ class TestTransport : public Transport,
                                          true); // Allow non-compound RTCP
 
     EXPECT_TRUE(rtcpParser.IsValid());
+    // The receiver drops report blocks that aren't for its own SSRC, so
+    // collect the SSRCs of all blocks here.
+    report_block_ssrcs_.clear();
+    RTCPUtility::RTCPParserV2 block_parser(static_cast<const uint8_t*>(packet),
+                                           packet_len,
+                                           true);
+    for (RTCPUtility::RTCPPacketTypes type = block_parser.Begin();
+         type != RTCPUtility::kRtcpNotValidCode;
+         type = block_parser.Iterate()) {
+      if (type == RTCPUtility::kRtcpReportBlockItemCode) {
+        report_block_ssrcs_.push_back(
+            block_parser.Packet().ReportBlockItem.SSRC);
+      }
+    }
     RTCPHelp::RTCPPacketInformation rtcpPacketInformation;
     EXPECT_EQ(0, rtcp_receiver_->IncomingRTCPPacket(rtcpPacketInformation,
                                                     &rtcpParser));
@@ -268,6 +287,21 @@ class TestTransport : public Transport,
   }
   RTCPReceiver* rtcp_receiver_;
   RTCPHelp::RTCPPacketInformation rtcp_packet_info_;
+  std::vector<uint32_t> report_block_ssrcs_;
+};
+
+// Transport that drops all packets, for measuring the sender alone.
+class CountingTransport : public Transport {
+ public:
+  CountingTransport() : rtcp_packets_(0) {}
+  virtual int SendPacket(int /*ch*/, const void* /*data*/, int /*len*/) {
+    return -1;
+  }
+  virtual int SendRTCPPacket(int /*ch*/, const void* /*data*/, int len) {
+    ++rtcp_packets_;
+    return len;
+  }
+  int rtcp_packets_;
 };
 
 class RtcpSenderTest : public ::testing::Test {
@@ -313,6 +347,20 @@ class RtcpSenderTest : public ::testing::Test {
     delete test_transport_;
   }
 
+  // Feeds one RTP packet from each of |num_streams| SSRCs, starting at
+  // |first_ssrc|, to |receive_statistics|.
+  void ReceivePackets(ReceiveStatistics* receive_statistics,
+                      uint32_t first_ssrc,
+                      int num_streams) {
+    RTPHeader header;
+    memset(&header, 0, sizeof(header));
+    header.sequenceNumber = 1;
+    for (int i = 0; i < num_streams; ++i) {
+      header.ssrc = first_ssrc + i;
+      receive_statistics->IncomingPacket(header, 100, false);
+    }
+  }
+
   // Helper function: Incoming RTCP has a specific packet type.
   bool gotPacketType(RTCPPacketType packet_type) {
     return ((test_transport_->rtcp_packet_info_.rtcpPacketTypeFlags) &
@@ -400,6 +448,42 @@ TEST_F(RtcpSenderTest, TestCompound_NoRtpReceived) {
       kRtcpTransmissionTimeOffset);
 }
 
+TEST_F(RtcpSenderTest, ReportBlocksForReceivedStreams) {
+  const uint32_t kFirstSsrc = 0x1000;
+  ReceivePackets(receive_statistics_.get(), kFirstSsrc, 3);
+  EXPECT_EQ(0, rtcp_sender_->SetRTCPStatus(kRtcpCompound));
+  RTCPSender::FeedbackState feedback_state = rtp_rtcp_impl_->GetFeedbackState();
+  EXPECT_EQ(0, rtcp_sender_->SendRTCP(feedback_state, kRtcpRr));
+  ASSERT_EQ(3u, test_transport_->report_block_ssrcs_.size());
+  for (uint32_t i = 0; i < 3; ++i)
+    EXPECT_EQ(kFirstSsrc + i, test_transport_->report_block_ssrcs_[i]);
+
+  // External blocks follow the blocks of the received streams.
+  const uint32_t kExternalSsrc = 0x10;
+  RTCPReportBlock external_block;
+  memset(&external_block, 0, sizeof(external_block));
+  EXPECT_EQ(0, rtcp_sender_->AddExternalReportBlock(kExternalSsrc,
+                                                    &external_block));
+  EXPECT_EQ(0, rtcp_sender_->SendRTCP(feedback_state, kRtcpRr));
+  ASSERT_EQ(4u, test_transport_->report_block_ssrcs_.size());
+  EXPECT_EQ(kExternalSsrc, test_transport_->report_block_ssrcs_[3]);
+}
+
+TEST_F(RtcpSenderTest, ReportBlocksAreLimitedToMax) {
+  ReceivePackets(receive_statistics_.get(), 0x1000,
+                 RTCP_MAX_REPORT_BLOCKS + 10);
+  EXPECT_EQ(0, rtcp_sender_->SetRTCPStatus(kRtcpCompound));
+  RTCPSender::FeedbackState feedback_state = rtp_rtcp_impl_->GetFeedbackState();
+  EXPECT_EQ(0, rtcp_sender_->SendRTCP(feedback_state, kRtcpRr));
+  EXPECT_EQ(static_cast<size_t>(RTCP_MAX_REPORT_BLOCKS),
+            test_transport_->report_block_ssrcs_.size());
+
+  EXPECT_EQ(0, rtcp_sender_->SetSendingStatus(feedback_state, true));
+  EXPECT_EQ(0, rtcp_sender_->SendRTCP(feedback_state, kRtcpSr));
+  EXPECT_EQ(static_cast<size_t>(RTCP_MAX_REPORT_BLOCKS),
+            test_transport_->report_block_ssrcs_.size());
+}
+
 TEST_F(RtcpSenderTest, TestXrReceiverReferenceTime) {
   EXPECT_EQ(0, rtcp_sender_->SetRTCPStatus(kRtcpCompound));
   RTCPSender::FeedbackState feedback_state = rtp_rtcp_impl_->GetFeedbackState();
@@ -511,4 +595,34 @@ TEST_F(RtcpSenderTest, SendsTmmbnIfSetAndValid) {
       &incoming_set));
   EXPECT_EQ(kSourceSsrc, incoming_set.Ssrc(0));
 }
+
+// Prints the number of compound receiver reports built and sent per second
+// by one thread, for a range of received streams.
+TEST_F(RtcpSenderTest, DISABLED_ReportRateBenchmark) {
+  const int kNumStreams[] = {1, 4, 16, RTCP_MAX_REPORT_BLOCKS};
+  const int kNumReports = 200000;
+  for (size_t n = 0; n < sizeof(kNumStreams) / sizeof(kNumStreams[0]); ++n) {
+    scoped_ptr<ReceiveStatistics> receive_statistics(
+        ReceiveStatistics::Create(&clock_));
+    ReceivePackets(receive_statistics.get(), 0x1000, kNumStreams[n]);
+    CountingTransport transport;
+    RTCPSender sender(0, false, &clock_, receive_statistics.get());
+    EXPECT_EQ(0, sender.RegisterSendTransport(&transport));
+    EXPECT_EQ(0, sender.SetRTCPStatus(kRtcpCompound));
+    EXPECT_EQ(0, sender.SetCNAME("benchmark@webrtc"));
+    uint32_t remb_ssrc = 0x1000;
+    EXPECT_EQ(0, sender.SetREMBStatus(true));
+    EXPECT_EQ(0, sender.SetREMBData(1000000, 1, &remb_ssrc));
+    RTCPSender::FeedbackState feedback_state =
+        rtp_rtcp_impl_->GetFeedbackState();
+
+    TickTime start = TickTime::Now();
+    for (int i = 0; i < kNumReports; ++i)
+      sender.SendRTCP(feedback_state, kRtcpRr);
+    int64_t elapsed_us = (TickTime::Now() - start).Microseconds();
+    EXPECT_EQ(kNumReports, transport.rtcp_packets_);
+    printf("%2d streams: %8.0f reports/s\n", kNumStreams[n],
+           kNumReports * 1e6 / elapsed_us);
+  }
+}
 }  // namespace webrtc
@@ -8,11 +8,14 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
+#include <stdio.h>
+
 #include <list>
 
 #include "testing/gtest/include/gtest/gtest.h"
 #include "webrtc/modules/rtp_rtcp/source/forward_error_correction.h"
 #include "webrtc/modules/rtp_rtcp/source/rtp_utility.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
 
 using webrtc::ForwardErrorCorrection;
 
@@ -793,6 +796,211 @@ TEST_F(RtpFecTest, FecRecoveryNonConsecutivePacketsWrap) {
   EXPECT_FALSE(IsRecoveryComplete());
 }
 
+TEST_F(RtpFecTest, FecRecoveryWithBurstLoss48Packets) {
+  const int kNumImportantPackets = 0;
+  const bool kUseUnequalProtection = false;
+  const int kNumMediaPackets = kMaxNumberMediaPackets;
+  const uint8_t kProtectionFactor = 255;
+
+  fec_seq_num_ = ConstructMediaPacketsSeqNum(kNumMediaPackets, 0xFFFF - 20);
+
+  EXPECT_EQ(0, fec_->GenerateFEC(media_packet_list_, kProtectionFactor,
+                                 kNumImportantPackets, kUseUnequalProtection,
+                                 webrtc::kFecMaskRandom, &fec_packet_list_));
+
+  EXPECT_EQ(kNumMediaPackets, static_cast<int>(fec_packet_list_.size()));
+
+  // A burst of 8 media packets and a burst of 2 FEC packets lost. The FEC
+  // packets arrive first, so the media packets have to be matched to the FEC
+  // packets already stored.
+  memset(media_loss_mask_, 0, sizeof(media_loss_mask_));
+  memset(fec_loss_mask_, 0, sizeof(fec_loss_mask_));
+  for (int i = 16; i < 24; ++i)
+    media_loss_mask_[i] = 1;
+  for (int i = 0; i < 2; ++i)
+    fec_loss_mask_[i] = 1;
+  ReceivedPackets(fec_packet_list_, fec_loss_mask_, true);
+  ReceivedPackets(media_packet_list_, media_loss_mask_, false);
+
+  EXPECT_EQ(0,
+            fec_->DecodeFEC(&received_packet_list_, &recovered_packet_list_));
+
+  EXPECT_TRUE(IsRecoveryComplete());
+}
+
+TEST_F(RtpFecTest, FecRecoveryWithBurstLossInterleavedMask) {
+  const int kNumImportantPackets = 0;
+  const bool kUseUnequalProtection = false;
+  const int kNumMediaPackets = 24;
+  const uint8_t kProtectionFactor = 85;
+
+  fec_seq_num_ = ConstructMediaPackets(kNumMediaPackets);
+
+  EXPECT_EQ(0, fec_->GenerateFEC(media_packet_list_, kProtectionFactor,
+                                 kNumImportantPackets, kUseUnequalProtection,
+                                 webrtc::kFecMaskInterleaved,
+                                 &fec_packet_list_));
+
+  // Too few FEC packets for rows, so 8 column parity packets.
+  EXPECT_EQ(8, static_cast<int>(fec_packet_list_.size()));
+
+  // Any 8 consecutive media packets lost: one per column.
+  memset(media_loss_mask_, 0, sizeof(media_loss_mask_));
+  memset(fec_loss_mask_, 0, sizeof(fec_loss_mask_));
+  for (int i = 5; i < 13; ++i)
+    media_loss_mask_[i] = 1;
+  NetworkReceivedPackets();
+
+  EXPECT_EQ(0,
+            fec_->DecodeFEC(&received_packet_list_, &recovered_packet_list_));
+
+  EXPECT_TRUE(IsRecoveryComplete());
+  FreeRecoveredPacketList();
+
+  // 9 consecutive packets lost: two in the first column.
+  memset(media_loss_mask_, 0, sizeof(media_loss_mask_));
+  memset(fec_loss_mask_, 0, sizeof(fec_loss_mask_));
+  for (int i = 5; i < 14; ++i)
+    media_loss_mask_[i] = 1;
+  NetworkReceivedPackets();
+
+  EXPECT_EQ(0,
+            fec_->DecodeFEC(&received_packet_list_, &recovered_packet_list_));
+
+  EXPECT_FALSE(IsRecoveryComplete());
+}
+
+TEST_F(RtpFecTest, FecRecoveryWithLossInterleavedMaskRowsAndColumns) {
+  const int kNumImportantPackets = 0;
+  const bool kUseUnequalProtection = false;
+  const int kNumMediaPackets = 12;
+  const uint8_t kProtectionFactor = 170;
+
+  // 8 FEC packets: a grid of 6 columns and 2 rows.
+  //
+  //             media#0 ... media#5    media#6 ... media#11
+  // fec#0-5:    one column each        one column each
+  // fec#6:        1  ...    1            0   ...    0
+  // fec#7:        0  ...    0            1   ...    1
+  fec_seq_num_ = ConstructMediaPackets(kNumMediaPackets);
+
+  EXPECT_EQ(0, fec_->GenerateFEC(media_packet_list_, kProtectionFactor,
+                                 kNumImportantPackets, kUseUnequalProtection,
+                                 webrtc::kFecMaskInterleaved,
+                                 &fec_packet_list_));
+
+  EXPECT_EQ(8, static_cast<int>(fec_packet_list_.size()));
+
+  // 7 consecutive packets lost. Column 0 misses media#0 and media#6, but the
+  // second row parity recovers media#6, after which the column recovers
+  // media#0.
+  memset(media_loss_mask_, 0, sizeof(media_loss_mask_));
+  memset(fec_loss_mask_, 0, sizeof(fec_loss_mask_));
+  for (int i = 0; i < 7; ++i)
+    media_loss_mask_[i] = 1;
+  NetworkReceivedPackets();
+
+  EXPECT_EQ(0,
+            fec_->DecodeFEC(&received_packet_list_, &recovered_packet_list_));
+
+  EXPECT_TRUE(IsRecoveryComplete());
+}
+
+TEST_F(RtpFecTest, AllocatedPacketsAreRecycled) {
+  ForwardErrorCorrection::Packet* storage = NULL;
+  {
+    webrtc::scoped_refptr<ForwardErrorCorrection::Packet> packet =
+        fec_->AllocatePacket();
+    packet->length = 100;
+    storage = packet.get();
+  }
+  webrtc::scoped_refptr<ForwardErrorCorrection::Packet> packet =
+      fec_->AllocatePacket();
+  EXPECT_EQ(storage, packet.get());
+  EXPECT_EQ(0, packet->length);
+
+  // Packets may outlive the ForwardErrorCorrection they came from.
+  delete fec_;
+  fec_ = new ForwardErrorCorrection();
+  packet = NULL;
+}
+
+// Prints the time spent decoding 48 packet frames with bursts of loss.
+TEST_F(RtpFecTest, DISABLED_DecodeBenchmark) {
+  const int kNumMediaPackets = kMaxNumberMediaPackets;
+  const uint8_t kProtectionFactor = 80;
+  const int kMaxBurstLength = 8;
+  const int kNumFrames = 20000;
+  // Sequence numbers used by a frame, including its FEC packets.
+  const int kFrameSeqNums = 64;
+
+  srand(1234);
+  ConstructMediaPacketsSeqNum(kNumMediaPackets, 0);
+  EXPECT_EQ(0, fec_->GenerateFEC(media_packet_list_, kProtectionFactor, 0,
+                                 false, webrtc::kFecMaskRandom,
+                                 &fec_packet_list_));
+  const int num_fec_packets = static_cast<int>(fec_packet_list_.size());
+
+  int lost = 0;
+  int recovered = 0;
+  int64_t elapsed_us = 0;
+  for (int frame = 0; frame < kNumFrames; ++frame) {
+    const uint16_t seq_num_base = static_cast<uint16_t>(frame * kFrameSeqNums);
+    const int burst_start = rand() % kNumMediaPackets;
+    const int burst_length = 1 + rand() % kMaxBurstLength;
+    int seq_num = seq_num_base;
+    for (PacketList::iterator it = media_packet_list_.begin();
+         it != media_packet_list_.end(); ++it, ++seq_num) {
+      int index = seq_num - seq_num_base;
+      if (index >= burst_start && index < burst_start + burst_length) {
+        ++lost;
+        continue;
+      }
+      ForwardErrorCorrection::ReceivedPacket* received_packet =
+          new ForwardErrorCorrection::ReceivedPacket;
+      received_packet->pkt = new ForwardErrorCorrection::Packet;
+      received_packet->pkt->length = (*it)->length;
+      memcpy(received_packet->pkt->data, (*it)->data, (*it)->length);
+      webrtc::RtpUtility::AssignUWord16ToBuffer(&received_packet->pkt->data[2],
+                                                seq_num);
+      received_packet->is_fec = false;
+      received_packet->seq_num = seq_num;
+      received_packet_list_.push_back(received_packet);
+    }
+    for (PacketList::iterator it = fec_packet_list_.begin();
+         it != fec_packet_list_.end(); ++it, ++seq_num) {
+      ForwardErrorCorrection::ReceivedPacket* received_packet =
+          new ForwardErrorCorrection::ReceivedPacket;
+      received_packet->pkt = new ForwardErrorCorrection::Packet;
+      received_packet->pkt->length = (*it)->length;
+      memcpy(received_packet->pkt->data, (*it)->data, (*it)->length);
+      // The sequence number base isn't covered by the parity.
+      webrtc::RtpUtility::AssignUWord16ToBuffer(&received_packet->pkt->data[2],
+                                                seq_num_base);
+      received_packet->is_fec = true;
+      received_packet->seq_num = seq_num;
+      received_packet->ssrc = ssrc_;
+      received_packet_list_.push_back(received_packet);
+    }
+
+    webrtc::TickTime start = webrtc::TickTime::Now();
+    EXPECT_EQ(0,
+              fec_->DecodeFEC(&received_packet_list_, &recovered_packet_list_));
+    elapsed_us += (webrtc::TickTime::Now() - start).Microseconds();
+    for (RecoveredPacketList::iterator it = recovered_packet_list_.begin();
+         it != recovered_packet_list_.end(); ++it) {
+      if ((*it)->was_recovered && !(*it)->returned) {
+        (*it)->returned = true;
+        ++recovered;
+      }
+    }
+  }
+  printf("%d media + %d FEC packets per frame, bursts of 1-%d lost: "
+         "%.2f us per frame, %d of %d lost packets recovered\n",
+         kNumMediaPackets, num_fec_packets, kMaxBurstLength,
+         static_cast<double>(elapsed_us) / kNumFrames, recovered, lost);
+}
+
 void RtpFecTest::TearDown() {
   fec_->ResetState(&recovered_packet_list_);
   delete fec_;
@@ -0,0 +1,95 @@
+/*
+ *  Copyright (c) 2014 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/rtp_rtcp/source/rtp_packet_buffer.h"
+
+#include <string.h>
+
+#include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
+
+namespace webrtc {
+
+RtpPacketBuffer::RtpPacketBuffer() : ref_count_(0), pool_(NULL), length_(0) {}
+
+RtpPacketBuffer::~RtpPacketBuffer() {}
+
+int32_t RtpPacketBuffer::AddRef() { return ++ref_count_; }
+
+int32_t RtpPacketBuffer::Release() {
+  int32_t ref_count = --ref_count_;
+  if (ref_count == 0)
+    pool_->Return(this);
+  return ref_count;
+}
+
+bool RtpPacketBuffer::HasOneRef() { return ref_count_.Value() == 1; }
+
+RtpPacketBufferPool::RtpPacketBufferPool(size_t max_free_buffers)
+    : ref_count_(0),
+      crit_(CriticalSectionWrapper::CreateCriticalSection()),
+      max_free_buffers_(max_free_buffers) {}
+
+RtpPacketBufferPool::~RtpPacketBufferPool() {
+  for (size_t i = 0; i < free_buffers_.size(); ++i)
+    delete free_buffers_[i];
+}
+
+int32_t RtpPacketBufferPool::AddRef() { return ++ref_count_; }
+
+int32_t RtpPacketBufferPool::Release() {
+  int32_t ref_count = --ref_count_;
+  if (ref_count == 0)
+    delete this;
+  return ref_count;
+}
+
+scoped_refptr<RtpPacketBuffer> RtpPacketBufferPool::Get() {
+  RtpPacketBuffer* buffer = NULL;
+  {
+    CriticalSectionScoped cs(crit_.get());
+    if (!free_buffers_.empty()) {
+      buffer = free_buffers_.back();
+      free_buffers_.pop_back();
+    }
+  }
+  if (!buffer) {
+    buffer = new RtpPacketBuffer();
+    buffer->pool_ = this;
+  }
+  buffer->length_ = 0;
+  // Released in Return().
+  AddRef();
+  return scoped_refptr<RtpPacketBuffer>(buffer);
+}
+
+scoped_refptr<RtpPacketBuffer> RtpPacketBufferPool::Copy(const uint8_t* packet,
+                                                         uint16_t length) {
+  if (length > IP_PACKET_SIZE)
+    return NULL;
+  scoped_refptr<RtpPacketBuffer> buffer = Get();
+  memcpy(buffer->data(), packet, length);
+  buffer->set_length(length);
+  return buffer;
+}
+
+void RtpPacketBufferPool::Return(RtpPacketBuffer* buffer) {
+  {
+    CriticalSectionScoped cs(crit_.get());
+    if (free_buffers_.size() < max_free_buffers_) {
+      free_buffers_.push_back(buffer);
+      buffer = NULL;
+    }
+  }
+  delete buffer;
+  // May delete the pool, so this must come last.
+  Release();
+}
+
+}  // namespace webrtc
@@ -0,0 +1,100 @@
+/*
+ *  Copyright (c) 2014 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_RTP_RTCP_SOURCE_RTP_PACKET_BUFFER_H_
+#define WEBRTC_MODULES_RTP_RTCP_SOURCE_RTP_PACKET_BUFFER_H_
+
+#include <assert.h>
+
+#include <vector>
+
+#include "webrtc/base/constructormagic.h"
+#include "webrtc/modules/rtp_rtcp/interface/rtp_rtcp_defines.h"
+#include "webrtc/system_wrappers/interface/atomic32.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/system_wrappers/interface/scoped_refptr.h"
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+
+class CriticalSectionWrapper;
+class RtpPacketBufferPool;
+
+// Reference counted storage for a single RTP packet. A packet is written once
+// into a buffer taken from an RtpPacketBufferPool and can then be held by the
+// packet history and sent to the transport without being copied. The buffer
+// goes back to its pool when the last reference is released.
+class RtpPacketBuffer {
+ public:
+  int32_t AddRef();
+  int32_t Release();
+
+  // Returns true if the caller holds the only reference.
+  bool HasOneRef();
+
+  uint8_t* data() { return data_; }
+  const uint8_t* data() const { return data_; }
+
+  uint16_t length() const { return length_; }
+  void set_length(uint16_t length) {
+    assert(length <= IP_PACKET_SIZE);
+    length_ = length;
+  }
+
+ private:
+  friend class RtpPacketBufferPool;
+
+  RtpPacketBuffer();
+  ~RtpPacketBuffer();
+
+  Atomic32 ref_count_;
+  RtpPacketBufferPool* pool_;
+  uint16_t length_;
+  uint8_t data_[IP_PACKET_SIZE];
+
+  DISALLOW_COPY_AND_ASSIGN(RtpPacketBuffer);
+};
+
+// Hands out RtpPacketBuffers and keeps up to |max_free_buffers| released ones
+// for reuse. The pool is reference counted and every outstanding buffer holds
+// a reference to it, so buffers may outlive the object that created the pool.
+class RtpPacketBufferPool {
+ public:
+  explicit RtpPacketBufferPool(size_t max_free_buffers);
+
+  int32_t AddRef();
+  int32_t Release();
+
+  // Returns an empty buffer. Never fails.
+  scoped_refptr<RtpPacketBuffer> Get();
+
+  // Returns a buffer holding a copy of |packet|, or NULL if |length| is larger
+  // than a buffer.
+  scoped_refptr<RtpPacketBuffer> Copy(const uint8_t* packet, uint16_t length);
+
+ private:
+  friend class RtpPacketBuffer;
+
+  ~RtpPacketBufferPool();
+
+  // Called by a buffer when its last reference has been released.
+  void Return(RtpPacketBuffer* buffer);
+
+  Atomic32 ref_count_;
+  scoped_ptr<CriticalSectionWrapper> crit_;
+  const size_t max_free_buffers_;
+  std::vector<RtpPacketBuffer*> free_buffers_;
+
+  DISALLOW_COPY_AND_ASSIGN(RtpPacketBufferPool);
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_RTP_RTCP_SOURCE_RTP_PACKET_BUFFER_H_
@@ -0,0 +1,58 @@
+/*
+ *  Copyright (c) 2014 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+#include "webrtc/modules/rtp_rtcp/source/rtp_packet_buffer.h"
+
+namespace webrtc {
+
+TEST(RtpPacketBufferPoolTest, ReleasedBufferIsReused) {
+  scoped_refptr<RtpPacketBufferPool> pool(new RtpPacketBufferPool(1));
+  scoped_refptr<RtpPacketBuffer> packet = pool->Get();
+  packet->set_length(100);
+  RtpPacketBuffer* first = packet.get();
+  packet = NULL;
+
+  packet = pool->Get();
+  EXPECT_EQ(first, packet.get());
+  EXPECT_EQ(0, packet->length());
+}
+
+TEST(RtpPacketBufferPoolTest, HasOneRef) {
+  scoped_refptr<RtpPacketBufferPool> pool(new RtpPacketBufferPool(1));
+  scoped_refptr<RtpPacketBuffer> packet = pool->Get();
+  EXPECT_TRUE(packet->HasOneRef());
+  scoped_refptr<RtpPacketBuffer> other = packet;
+  EXPECT_FALSE(packet->HasOneRef());
+  other = NULL;
+  EXPECT_TRUE(packet->HasOneRef());
+}
+
+TEST(RtpPacketBufferPoolTest, Copy) {
+  scoped_refptr<RtpPacketBufferPool> pool(new RtpPacketBufferPool(1));
+  const uint8_t data[] = {1, 2, 3, 4, 5};
+  scoped_refptr<RtpPacketBuffer> packet = pool->Copy(data, sizeof(data));
+  ASSERT_TRUE(packet.get() != NULL);
+  EXPECT_EQ(sizeof(data), packet->length());
+  EXPECT_EQ(0, memcmp(data, packet->data(), sizeof(data)));
+  EXPECT_TRUE(pool->Copy(data, IP_PACKET_SIZE + 1).get() == NULL);
+}
+
+TEST(RtpPacketBufferPoolTest, BufferOutlivesPool) {
+  scoped_refptr<RtpPacketBufferPool> pool(new RtpPacketBufferPool(1));
+  scoped_refptr<RtpPacketBuffer> packet = pool->Get();
+  pool = NULL;
+  // The pool is deleted together with the last buffer.
+  packet->set_length(10);
+  packet = NULL;
+}
+
+}  // namespace webrtc
@@ -12,7 +12,8 @@
 
 #include <assert.h>
 #include <stdlib.h>
-#include <string.h>   // memset
+#include <string.h>   // memcpy
+#include <algorithm>
 #include <limits>
 #include <set>
 
@@ -23,13 +24,29 @@
 namespace webrtc {
 
 enum { kMinPacketRequestBytes = 50 };
+// Released buffers kept for reuse. Once the history is full every stored
+// packet frees a slot, so only a few are needed for the packets in flight.
+enum { kMaxFreePacketBuffers = 32 };
+// Width of the packet length ranges searched by GetBestFittingPacket().
+enum { kSizeBucketBytes = 16 };
+enum { kNumSizeBuckets = IP_PACKET_SIZE / kSizeBucketBytes + 1 };
+
+const int RTPPacketHistory::kMaxPacketAgeMs;
+
+RTPPacketHistory::StoredPacket::StoredPacket()
+    : sequence_number(0),
+      capture_time_ms(0),
+      store_time_ms(0),
+      send_time_ms(0),
+      storage_type(kDontStore) {}
 
 RTPPacketHistory::RTPPacketHistory(Clock* clock)
   : clock_(clock),
     critsect_(CriticalSectionWrapper::CreateCriticalSection()),
     store_(false),
-    prev_index_(0),
-    max_packet_length_(0) {
+    max_packet_length_(0),
+    packet_pool_(new RtpPacketBufferPool(kMaxFreePacketBuffers)),
+    slot_mask_(0) {
 }
 
 RTPPacketHistory::~RTPPacketHistory() {
@@ -58,12 +75,14 @@ void RTPPacketHistory::Allocate(uint16_t number_to_store) {
   assert(number_to_store > 0);
   assert(!store_);
   store_ = true;
-  stored_packets_.resize(number_to_store);
-  stored_seq_nums_.resize(number_to_store);
-  stored_lengths_.resize(number_to_store);
-  stored_times_.resize(number_to_store);
-  stored_send_times_.resize(number_to_store);
-  stored_types_.resize(number_to_store);
+  // Round up to a power of two so that the slot is a mask of the sequence
+  // number. At most 2^16 slots are needed.
+  uint32_t num_slots = 1;
+  while (num_slots < number_to_store)
+    num_slots <<= 1;
+  stored_packets_.resize(num_slots);
+  slot_mask_ = num_slots - 1;
+  size_buckets_.assign(kNumSizeBuckets, -1);
 }
 
 void RTPPacketHistory::Free() {
@@ -71,20 +90,12 @@ void RTPPacketHistory::Free() {
     return;
   }
 
-  std::vector<std::vector<uint8_t> >::iterator it;
-  for (it = stored_packets_.begin(); it != stored_packets_.end(); ++it) {
-    it->clear();
-  }
-
+  // Returns the buffers to the pool, unless they are still being sent.
   stored_packets_.clear();
-  stored_seq_nums_.clear();
-  stored_lengths_.clear();
-  stored_times_.clear();
-  stored_send_times_.clear();
-  stored_types_.clear();
+  size_buckets_.clear();
 
   store_ = false;
-  prev_index_ = 0;
+  slot_mask_ = 0;
   max_packet_length_ = 0;
 }
 
@@ -94,21 +105,15 @@ bool RTPPacketHistory::StorePackets() const {
 }
 
 // private, lock should already be taken
-void RTPPacketHistory::VerifyAndAllocatePacketLength(uint16_t packet_length) {
+void RTPPacketHistory::UpdateMaxPacketLength(uint16_t packet_length) {
   assert(packet_length > 0);
-  if (!store_) {
-    return;
-  }
-
-  if (packet_length <= max_packet_length_) {
-    return;
+  if (packet_length > max_packet_length_) {
+    max_packet_length_ = std::min<uint16_t>(packet_length, IP_PACKET_SIZE);
   }
+}
 
-  std::vector<std::vector<uint8_t> >::iterator it;
-  for (it = stored_packets_.begin(); it != stored_packets_.end(); ++it) {
-    it->resize(packet_length);
-  }
-  max_packet_length_ = packet_length;
+scoped_refptr<RtpPacketBuffer> RTPPacketHistory::AllocatePacket() {
+  return packet_pool_->Get();
 }
 
 int32_t RTPPacketHistory::PutRTPPacket(const uint8_t* packet,
@@ -128,7 +133,7 @@ int32_t RTPPacketHistory::PutRTPPacket(const uint8_t* packet,
   assert(packet);
   assert(packet_length > 3);
 
-  VerifyAndAllocatePacketLength(max_packet_length);
+  UpdateMaxPacketLength(max_packet_length);
 
   if (packet_length > max_packet_length_) {
     LOG(LS_WARNING) << "Failed to store RTP packet with length: "
@@ -136,40 +141,64 @@ int32_t RTPPacketHistory::PutRTPPacket(const uint8_t* packet,
     return -1;
   }
 
-  const uint16_t seq_num = (packet[2] << 8) + packet[3];
-
-  // Store packet
-  std::vector<std::vector<uint8_t> >::iterator it =
-      stored_packets_.begin() + prev_index_;
-  std::copy(packet, packet + packet_length, it->begin());
+  StorePacket(packet_pool_->Copy(packet, packet_length), capture_time_ms, type);
+  return 0;
+}
 
-  stored_seq_nums_[prev_index_] = seq_num;
-  stored_lengths_[prev_index_] = packet_length;
-  stored_times_[prev_index_] = (capture_time_ms > 0) ? capture_time_ms :
-      clock_->TimeInMilliseconds();
-  stored_send_times_[prev_index_] = 0;  // Packet not sent.
-  stored_types_[prev_index_] = type;
+int32_t RTPPacketHistory::PutRTPPacket(RtpPacketBuffer* packet,
+                                       int64_t capture_time_ms,
+                                       StorageType type) {
+  if (type == kDontStore) {
+    return 0;
+  }
 
-  ++prev_index_;
-  if (prev_index_ >= stored_seq_nums_.size()) {
-    prev_index_ = 0;
+  CriticalSectionScoped cs(critsect_);
+  if (!store_) {
+    return 0;
   }
+
+  assert(packet);
+  assert(packet->length() > 3);
+
+  UpdateMaxPacketLength(packet->length());
+  StorePacket(packet, capture_time_ms, type);
   return 0;
 }
 
+// private, lock should already be taken
+void RTPPacketHistory::StorePacket(RtpPacketBuffer* packet,
+                                   int64_t capture_time_ms,
+                                   StorageType type) {
+  const uint8_t* data = packet->data();
+  const uint16_t seq_num = (data[2] << 8) + data[3];
+  const int64_t now_ms = clock_->TimeInMilliseconds();
+  const int index = seq_num & slot_mask_;
+
+  // Replacing the reference returns the previous packet in this slot to the
+  // pool, unless it is still being sent.
+  StoredPacket& slot = stored_packets_[index];
+  slot.packet = packet;
+  slot.sequence_number = seq_num;
+  slot.capture_time_ms = (capture_time_ms > 0) ? capture_time_ms : now_ms;
+  slot.store_time_ms = now_ms;
+  slot.send_time_ms = 0;  // Packet not sent.
+  slot.storage_type = type;
+
+  size_buckets_[packet->length() / kSizeBucketBytes] = index;
+}
+
 bool RTPPacketHistory::HasRTPPacket(uint16_t sequence_number) const {
   CriticalSectionScoped cs(critsect_);
   if (!store_) {
     return false;
   }
 
-  int32_t index = 0;
-  bool found = FindSeqNum(sequence_number, &index);
-  if (!found) {
+  int index = FindSeqNum(sequence_number, clock_->TimeInMilliseconds());
+  if (index < 0) {
     return false;
   }
 
-  uint16_t length = stored_lengths_.at(index);
+  uint16_t length = stored_packets_[index].packet->length();
   if (length == 0 || length > max_packet_length_) {
     // Invalid length.
     return false;
@@ -185,18 +214,75 @@ bool RTPPacketHistory::GetPacketAndSetSendTime(uint16_t sequence_number,
                                                int64_t* stored_time_ms) {
   assert(*packet_length >= max_packet_length_);
   CriticalSectionScoped cs(critsect_);
-  if (!store_) {
+  int32_t index = 0;
+  if (!FindPacketToSend(sequence_number, min_elapsed_time_ms, retransmit,
+                        true, &index)) {
     return false;
   }
+  GetPacket(index, packet, packet_length, stored_time_ms);
+  return true;
+}
 
+bool RTPPacketHistory::GetPacketAndSetSendTime(
+    uint16_t sequence_number,
+    uint32_t min_elapsed_time_ms,
+    bool retransmit,
+    scoped_refptr<RtpPacketBuffer>* packet,
+    int64_t* stored_time_ms) {
+  CriticalSectionScoped cs(critsect_);
   int32_t index = 0;
-  bool found = FindSeqNum(sequence_number, &index);
-  if (!found) {
+  if (!FindPacketToSend(sequence_number, min_elapsed_time_ms, retransmit,
+                        true, &index)) {
+    return false;
+  }
+  GetPacket(index, packet, stored_time_ms);
+  return true;
+}
+
+bool RTPPacketHistory::GetPacket(uint16_t sequence_number,
+                                 bool retransmit,
+                                 scoped_refptr<RtpPacketBuffer>* packet,
+                                 int64_t* stored_time_ms) {
+  CriticalSectionScoped cs(critsect_);
+  int32_t index = 0;
+  if (!FindPacketToSend(sequence_number, 0, retransmit, false, &index)) {
+    return false;
+  }
+  GetPacket(index, packet, stored_time_ms);
+  return true;
+}
+
+void RTPPacketHistory::SetSendTime(uint16_t sequence_number) {
+  CriticalSectionScoped cs(critsect_);
+  if (!store_) {
+    return;
+  }
+  int64_t now = clock_->TimeInMilliseconds();
+  int index = FindSeqNum(sequence_number, now);
+  if (index >= 0) {
+    stored_packets_[index].send_time_ms = now;
+  }
+}
+
+// private, lock should already be taken
+bool RTPPacketHistory::FindPacketToSend(uint16_t sequence_number,
+                                        uint32_t min_elapsed_time_ms,
+                                        bool retransmit,
+                                        bool set_send_time,
+                                        int32_t* index) {
+  if (!store_) {
+    return false;
+  }
+
+  int64_t now = clock_->TimeInMilliseconds();
+  *index = FindSeqNum(sequence_number, now);
+  if (*index < 0) {
     LOG(LS_WARNING) << "No match for getting seqNum " << sequence_number;
     return false;
   }
 
-  uint16_t length = stored_lengths_.at(index);
+  StoredPacket& slot = stored_packets_[*index];
+  uint16_t length = slot.packet->length();
   assert(length <= max_packet_length_);
   if (length == 0) {
     LOG(LS_WARNING) << "No match for getting seqNum " << sequence_number
@@ -205,19 +291,19 @@ bool RTPPacketHistory::GetPacketAndSetSendTime(uint16_t sequence_number,
   }
 
   // Verify elapsed time since last retrieve.
-  int64_t now = clock_->TimeInMilliseconds();
   if (min_elapsed_time_ms > 0 &&
-      ((now - stored_send_times_.at(index)) < min_elapsed_time_ms)) {
+      ((now - slot.send_time_ms) < min_elapsed_time_ms)) {
     return false;
   }
 
-  if (retransmit && stored_types_.at(index) == kDontRetransmit) {
+  if (retransmit && slot.storage_type == kDontRetransmit) {
     // No bytes copied since this packet shouldn't be retransmitted or is
     // of zero size.
     return false;
   }
-  stored_send_times_[index] = clock_->TimeInMilliseconds();
-  GetPacket(index, packet, packet_length, stored_time_ms);
+  if (set_send_time) {
+    slot.send_time_ms = now;
+  }
   return true;
 }
 
@@ -226,13 +312,26 @@ void RTPPacketHistory::GetPacket(int index,
                                  uint16_t* packet_length,
                                  int64_t* stored_time_ms) const {
   // Get packet.
-  uint16_t length = stored_lengths_.at(index);
-  std::vector<std::vector<uint8_t> >::const_iterator it_found_packet =
-      stored_packets_.begin() + index;
-  std::copy(it_found_packet->begin(), it_found_packet->begin() + length,
-            packet);
+  const StoredPacket& slot = stored_packets_[index];
+  uint16_t length = slot.packet->length();
+  memcpy(packet, slot.packet->data(), length);
   *packet_length = length;
-  *stored_time_ms = stored_times_.at(index);
+  *stored_time_ms = slot.capture_time_ms;
+}
+
+void RTPPacketHistory::GetPacket(int index,
+                                 scoped_refptr<RtpPacketBuffer>* packet,
+                                 int64_t* stored_time_ms) const {
+  // References are only handed out under |critsect_|, so a buffer referenced
+  // by nobody but the history can't be in use by another sender.
+  const StoredPacket& slot = stored_packets_[index];
+  RtpPacketBuffer* stored = slot.packet.get();
+  if (stored->HasOneRef()) {
+    *packet = stored;
+  } else {
+    *packet = packet_pool_->Copy(stored->data(), stored->length());
+  }
+  *stored_time_ms = slot.capture_time_ms;
 }
 
 bool RTPPacketHistory::GetBestFittingPacket(uint8_t* packet,
@@ -248,57 +347,74 @@ bool RTPPacketHistory::GetBestFittingPacket(uint8_t* packet,
   return true;
 }
 
-// private, lock should already be taken
-bool RTPPacketHistory::FindSeqNum(uint16_t sequence_number,
-                                  int32_t* index) const {
-  uint16_t temp_sequence_number = 0;
-  if (prev_index_ > 0) {
-    *index = prev_index_ - 1;
-    temp_sequence_number = stored_seq_nums_[*index];
-  } else {
-    *index = stored_seq_nums_.size() - 1;
-    temp_sequence_number = stored_seq_nums_[*index];  // wrap
-  }
+bool RTPPacketHistory::GetBestFittingPacket(
+    uint16_t size,
+    scoped_refptr<RtpPacketBuffer>* packet,
+    int64_t* stored_time_ms) {
+  CriticalSectionScoped cs(critsect_);
+  if (!store_)
+    return false;
+  int index = FindBestFittingPacket(size);
+  if (index < 0)
+    return false;
+  GetPacket(index, packet, stored_time_ms);
+  return true;
+}
 
-  int32_t idx = (prev_index_ - 1) - (temp_sequence_number - sequence_number);
-  if (idx >= 0 && idx < static_cast<int>(stored_seq_nums_.size())) {
-    *index = idx;
-    temp_sequence_number = stored_seq_nums_[*index];
-  }
+bool RTPPacketHistory::IsValid(const StoredPacket& slot,
+                               int64_t now_ms) const {
+  return slot.packet.get() != NULL &&
+      now_ms - slot.store_time_ms <= kMaxPacketAgeMs;
+}
 
-  if (temp_sequence_number != sequence_number) {
-    // We did not found a match, search all.
-    for (uint16_t m = 0; m < stored_seq_nums_.size(); m++) {
-      if (stored_seq_nums_[m] == sequence_number) {
-        *index = m;
-        temp_sequence_number = stored_seq_nums_[*index];
-        break;
-      }
-    }
-  }
-  if (temp_sequence_number == sequence_number) {
-    // We found a match.
-    return true;
-  }
-  return false;
+// private, lock should already be taken
+int RTPPacketHistory::FindSeqNum(uint16_t sequence_number,
+                                 int64_t now_ms) const {
+  const int index = sequence_number & slot_mask_;
+  const StoredPacket& slot = stored_packets_[index];
+  if (!IsValid(slot, now_ms) || slot.sequence_number != sequence_number)
+    return -1;
+  return index;
 }
 
-int RTPPacketHistory::FindBestFittingPacket(uint16_t size) const {
-  if (size < kMinPacketRequestBytes || stored_lengths_.empty())
+// private, lock should already be taken
+int RTPPacketHistory::FindBestFittingPacket(uint16_t size) {
+  if (size < kMinPacketRequestBytes)
     return -1;
+  const int64_t now_ms = clock_->TimeInMilliseconds();
+  const int target_bucket =
+      std::min<int>(size / kSizeBucketBytes, kNumSizeBuckets - 1);
   int min_diff = -1;
-  size_t best_index = 0;
-  for (size_t i = 0; i < stored_lengths_.size(); ++i) {
-    if (stored_lengths_[i] == 0)
-      continue;
-    int diff = abs(stored_lengths_[i] - size);
-    if (min_diff < 0 || diff < min_diff) {
-      min_diff = diff;
-      best_index = i;
+  int best_index = -1;
+  // Look at the buckets closest to |size| first. A packet in a bucket one
+  // step further away may still be closer than the first one found, so keep
+  // looking one step past the first hit.
+  int last_distance = kNumSizeBuckets;
+  for (int distance = 0; distance <= last_distance; ++distance) {
+    const int buckets[2] = {target_bucket - distance,
+                            target_bucket + distance};
+    for (int i = 0; i < (distance == 0 ? 1 : 2); ++i) {
+      const int bucket = buckets[i];
+      if (bucket < 0 || bucket >= kNumSizeBuckets)
+        continue;
+      const int index = size_buckets_[bucket];
+      if (index < 0)
+        continue;
+      const StoredPacket& slot = stored_packets_[index];
+      if (!IsValid(slot, now_ms) ||
+          slot.packet->length() / kSizeBucketBytes != bucket) {
+        // Replaced by a packet of another size, or too old.
+        size_buckets_[bucket] = -1;
+        continue;
+      }
+      int diff = abs(slot.packet->length() - size);
+      if (min_diff < 0 || diff < min_diff) {
+        min_diff = diff;
+        best_index = index;
+      }
+      last_distance = std::min(last_distance, distance + 1);
     }
   }
-  if (min_diff < 0)
-    return -1;
   return best_index;
 }
 }  // namespace webrtc
@@ -17,7 +17,9 @@
 
 #include "webrtc/modules/interface/module_common_types.h"
 #include "webrtc/modules/rtp_rtcp/interface/rtp_rtcp_defines.h"
+#include "webrtc/modules/rtp_rtcp/source/rtp_packet_buffer.h"
 #include "webrtc/typedefs.h"
+#include "webrtc/system_wrappers/interface/scoped_refptr.h"
 #include "webrtc/system_wrappers/interface/thread_annotations.h"
 
 namespace webrtc {
@@ -25,8 +27,16 @@ namespace webrtc {
 class Clock;
 class CriticalSectionWrapper;
 
+// Stores sent RTP packets for retransmission and redundant padding. Packets
+// are kept in a ring with a power of two number of slots, indexed by
+// sequence number, so that a packet is found, stored or evicted in constant
+// time. A packet is evicted when a packet with the same slot is stored or
+// when it is older than kMaxPacketAgeMs.
 class RTPPacketHistory {
  public:
+  // Packets stored longer ago than this are no longer returned.
+  static const int kMaxPacketAgeMs = 10000;
+
   RTPPacketHistory(Clock* clock);
   ~RTPPacketHistory();
 
@@ -41,6 +51,16 @@ class RTPPacketHistory {
                        int64_t capture_time_ms,
                        StorageType type);
 
+  // Stores |packet| without copying it. The history holds a reference to the
+  // buffer until its slot is reused, so the caller must not modify the buffer
+  // after this call.
+  int32_t PutRTPPacket(RtpPacketBuffer* packet,
+                       int64_t capture_time_ms,
+                       StorageType type);
+
+  // Returns an empty buffer from the pool the history stores packets in.
+  scoped_refptr<RtpPacketBuffer> AllocatePacket();
+
   // Gets stored RTP packet corresponding to the input sequence number.
   // The packet is copied to the buffer pointed to by ptr_rtp_packet.
   // The rtp_packet_length should show the available buffer size.
@@ -59,33 +79,96 @@ class RTPPacketHistory {
                                uint16_t* packet_length,
                                int64_t* stored_time_ms);
 
+  // Same as above, but returns a reference to the stored buffer instead of a
+  // copy. The caller may update header extensions in the returned buffer
+  // before sending it. If the stored buffer is already referenced elsewhere,
+  // i.e. it is being sent by another thread, a private copy is returned.
+  bool GetPacketAndSetSendTime(uint16_t sequence_number,
+                               uint32_t min_elapsed_time_ms,
+                               bool retransmit,
+                               scoped_refptr<RtpPacketBuffer>* packet,
+                               int64_t* stored_time_ms);
+
+  // Same as above with no minimum elapsed time, but leaves the send time
+  // untouched. Call SetSendTime() once the packet has been sent.
+  bool GetPacket(uint16_t sequence_number,
+                 bool retransmit,
+                 scoped_refptr<RtpPacketBuffer>* packet,
+                 int64_t* stored_time_ms);
+
+  // Records the current time as the send time of a stored packet.
+  void SetSendTime(uint16_t sequence_number);
+
   bool GetBestFittingPacket(uint8_t* packet, uint16_t* packet_length,
                             int64_t* stored_time_ms);
 
+  // Same as above, but returns a reference rather than a copy. |size| is the
+  // packet size to look for. Only the last packet stored in each range of 16
+  // bytes of length is considered, so the result may not be the closest
+  // stored packet.
+  bool GetBestFittingPacket(uint16_t size,
+                            scoped_refptr<RtpPacketBuffer>* packet,
+                            int64_t* stored_time_ms);
+
   bool HasRTPPacket(uint16_t sequence_number) const;
 
  private:
+  struct StoredPacket {
+    StoredPacket();
+
+    // NULL if the slot is empty.
+    scoped_refptr<RtpPacketBuffer> packet;
+    uint16_t sequence_number;
+    // Returned as the stored time.
+    int64_t capture_time_ms;
+    // When the packet was put in the history, for eviction by age.
+    int64_t store_time_ms;
+    // When the packet was last sent, 0 if never.
+    int64_t send_time_ms;
+    StorageType storage_type;
+  };
+
   void GetPacket(int index, uint8_t* packet, uint16_t* packet_length,
-                 int64_t* stored_time_ms) const;
+                 int64_t* stored_time_ms) const
+      EXCLUSIVE_LOCKS_REQUIRED(*critsect_);
+  void GetPacket(int index, scoped_refptr<RtpPacketBuffer>* packet,
+                 int64_t* stored_time_ms) const
+      EXCLUSIVE_LOCKS_REQUIRED(*critsect_);
+  // Looks up |sequence_number| and, if it may be sent now, updates its send
+  // time and returns its index.
+  bool FindPacketToSend(uint16_t sequence_number,
+                        uint32_t min_elapsed_time_ms,
+                        bool retransmit,
+                        bool set_send_time,
+                        int32_t* index) EXCLUSIVE_LOCKS_REQUIRED(*critsect_);
+  void StorePacket(RtpPacketBuffer* packet,
+                   int64_t capture_time_ms,
+                   StorageType type) EXCLUSIVE_LOCKS_REQUIRED(*critsect_);
   void Allocate(uint16_t number_to_store) EXCLUSIVE_LOCKS_REQUIRED(*critsect_);
   void Free() EXCLUSIVE_LOCKS_REQUIRED(*critsect_);
-  void VerifyAndAllocatePacketLength(uint16_t packet_length);
-  bool FindSeqNum(uint16_t sequence_number, int32_t* index) const;
-  int FindBestFittingPacket(uint16_t size) const;
+  void UpdateMaxPacketLength(uint16_t packet_length)
+      EXCLUSIVE_LOCKS_REQUIRED(*critsect_);
+  // Returns the slot holding |sequence_number|, or -1 if it isn't stored.
+  int FindSeqNum(uint16_t sequence_number, int64_t now_ms) const
+      EXCLUSIVE_LOCKS_REQUIRED(*critsect_);
+  int FindBestFittingPacket(uint16_t size)
+      EXCLUSIVE_LOCKS_REQUIRED(*critsect_);
+  // Returns true if |slot| holds a packet stored within kMaxPacketAgeMs.
+  bool IsValid(const StoredPacket& slot, int64_t now_ms) const;
 
- private:
   Clock* clock_;
   CriticalSectionWrapper* critsect_;
-  bool store_;
-  uint32_t prev_index_;
-  uint16_t max_packet_length_;
-
-  std::vector<std::vector<uint8_t> > stored_packets_;
-  std::vector<uint16_t> stored_seq_nums_;
-  std::vector<uint16_t> stored_lengths_;
-  std::vector<int64_t> stored_times_;
-  std::vector<int64_t> stored_send_times_;
-  std::vector<StorageType> stored_types_;
+  bool store_ GUARDED_BY(*critsect_);
+  uint16_t max_packet_length_ GUARDED_BY(*critsect_);
+
+  // Buffers are shared with the sender; see GetPacketAndSetSendTime().
+  scoped_refptr<RtpPacketBufferPool> packet_pool_;
+  // Indexed by sequence number & |slot_mask_|.
+  std::vector<StoredPacket> stored_packets_ GUARDED_BY(*critsect_);
+  uint32_t slot_mask_ GUARDED_BY(*critsect_);
+  // Slot of the last packet stored in each range of kSizeBucketBytes packet
+  // lengths, or -1. Used to find a packet of a given size without a search.
+  std::vector<int> size_buckets_ GUARDED_BY(*critsect_);
 };
 }  // namespace webrtc
 #endif  // WEBRTC_MODULES_RTP_RTCP_RTP_PACKET_HISTORY_H_
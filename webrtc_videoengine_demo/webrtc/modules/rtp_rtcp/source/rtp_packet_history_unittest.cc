@@ -10,11 +10,14 @@
  * This file includes unit tests for the RTPPacketHistory.
  */
 
+#include <stdio.h>
+
 #include "testing/gtest/include/gtest/gtest.h"
 
 #include "webrtc/modules/rtp_rtcp/interface/rtp_rtcp_defines.h"
 #include "webrtc/modules/rtp_rtcp/source/rtp_packet_history.h"
 #include "webrtc/system_wrappers/interface/clock.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
 #include "webrtc/typedefs.h"
 
 namespace webrtc {
@@ -54,6 +57,15 @@ class RtpPacketHistoryTest : public ::testing::Test {
     array[(*cur_pos)++] = ssrc >> 8;
     array[(*cur_pos)++] = ssrc;
   } 
+
+  // Stores a packet with |seq_num| of |length| bytes.
+  void PutPacket(uint16_t seq_num, uint16_t length) {
+    uint16_t len = 0;
+    CreateRtpPacket(seq_num, kSsrc, kPayload, kTimestamp, packet_, &len);
+    EXPECT_EQ(0, hist_->PutRTPPacket(packet_, length, kMaxPacketLength,
+                                     fake_clock_.TimeInMilliseconds(),
+                                     kAllowRetransmission));
+  }
 };
 
 TEST_F(RtpPacketHistoryTest, SetStoreStatus) {
@@ -203,4 +215,171 @@ TEST_F(RtpPacketHistoryTest, MinResendTime) {
   EXPECT_FALSE(hist_->GetPacketAndSetSendTime(kSeqNum, 101, false, packet_,
                                               &len, &time));
 }
+
+TEST_F(RtpPacketHistoryTest, PutRtpPacketBufferIsNotCopied) {
+  hist_->SetStorePacketsStatus(true, 10);
+  scoped_refptr<RtpPacketBuffer> packet = hist_->AllocatePacket();
+  uint16_t len = 0;
+  CreateRtpPacket(kSeqNum, kSsrc, kPayload, kTimestamp, packet->data(), &len);
+  packet->set_length(len);
+  int64_t capture_time_ms = 1;
+  EXPECT_EQ(0, hist_->PutRTPPacket(packet, capture_time_ms,
+                                   kAllowRetransmission));
+  RtpPacketBuffer* stored = packet.get();
+  packet = NULL;
+
+  scoped_refptr<RtpPacketBuffer> packet_out;
+  int64_t time;
+  EXPECT_TRUE(hist_->GetPacketAndSetSendTime(kSeqNum, 0, false, &packet_out,
+                                             &time));
+  EXPECT_EQ(stored, packet_out.get());
+  EXPECT_EQ(len, packet_out->length());
+  EXPECT_EQ(capture_time_ms, time);
+}
+
+TEST_F(RtpPacketHistoryTest, PacketInUseIsCopied) {
+  hist_->SetStorePacketsStatus(true, 10);
+  uint16_t len = 0;
+  CreateRtpPacket(kSeqNum, kSsrc, kPayload, kTimestamp, packet_, &len);
+  EXPECT_EQ(0, hist_->PutRTPPacket(packet_, len, kMaxPacketLength, 1,
+                                   kAllowRetransmission));
+
+  scoped_refptr<RtpPacketBuffer> first;
+  scoped_refptr<RtpPacketBuffer> second;
+  int64_t time;
+  EXPECT_TRUE(hist_->GetPacketAndSetSendTime(kSeqNum, 0, false, &first,
+                                             &time));
+  // |first| may be modified while it is sent, so a second sender must get its
+  // own copy.
+  EXPECT_TRUE(hist_->GetPacketAndSetSendTime(kSeqNum, 0, false, &second,
+                                             &time));
+  EXPECT_NE(first.get(), second.get());
+  ASSERT_EQ(len, second->length());
+  for (int i = 0; i < len; i++) {
+    EXPECT_EQ(packet_[i], second->data()[i]);
+  }
+}
+
+TEST_F(RtpPacketHistoryTest, GetBestFittingPacketBuffer) {
+  hist_->SetStorePacketsStatus(true, 10);
+  uint16_t len = 0;
+  CreateRtpPacket(kSeqNum, kSsrc, kPayload, kTimestamp, packet_, &len);
+  len = 100;
+  EXPECT_EQ(0, hist_->PutRTPPacket(packet_, len, kMaxPacketLength, 1,
+                                   kAllowRetransmission));
+  len = 0;
+  CreateRtpPacket(kSeqNum + 1, kSsrc, kPayload, kTimestamp, packet_, &len);
+  len = 300;
+  EXPECT_EQ(0, hist_->PutRTPPacket(packet_, len, kMaxPacketLength, 1,
+                                   kAllowRetransmission));
+
+  scoped_refptr<RtpPacketBuffer> packet_out;
+  int64_t time;
+  EXPECT_TRUE(hist_->GetBestFittingPacket(250, &packet_out, &time));
+  EXPECT_EQ(300, packet_out->length());
+  // Requests for less than 50 bytes are ignored.
+  EXPECT_FALSE(hist_->GetBestFittingPacket(10, &packet_out, &time));
+}
+
+TEST_F(RtpPacketHistoryTest, KeepsMostRecentPackets) {
+  // Rounded up to 16 slots.
+  hist_->SetStorePacketsStatus(true, 10);
+  const uint16_t kFirstSeqNum = 65530;
+  for (uint16_t i = 0; i < 40; ++i)
+    PutPacket(kFirstSeqNum + i, 100);
+  for (uint16_t i = 0; i < 24; ++i)
+    EXPECT_FALSE(hist_->HasRTPPacket(kFirstSeqNum + i));
+  // The packets stored last are kept across the sequence number wrap.
+  for (uint16_t i = 24; i < 40; ++i)
+    EXPECT_TRUE(hist_->HasRTPPacket(kFirstSeqNum + i));
+}
+
+TEST_F(RtpPacketHistoryTest, OldPacketsAreEvicted) {
+  hist_->SetStorePacketsStatus(true, 10);
+  PutPacket(kSeqNum, 100);
+  fake_clock_.AdvanceTimeMilliseconds(RTPPacketHistory::kMaxPacketAgeMs);
+  PutPacket(kSeqNum + 1, 100);
+  EXPECT_TRUE(hist_->HasRTPPacket(kSeqNum));
+  fake_clock_.AdvanceTimeMilliseconds(1);
+  EXPECT_FALSE(hist_->HasRTPPacket(kSeqNum));
+  EXPECT_TRUE(hist_->HasRTPPacket(kSeqNum + 1));
+
+  scoped_refptr<RtpPacketBuffer> packet_out;
+  int64_t time;
+  EXPECT_FALSE(hist_->GetPacketAndSetSendTime(kSeqNum, 0, true, &packet_out,
+                                              &time));
+  EXPECT_TRUE(hist_->GetBestFittingPacket(100, &packet_out, &time));
+  EXPECT_EQ(kSeqNum + 1, (packet_out->data()[2] << 8) + packet_out->data()[3]);
+}
+
+TEST_F(RtpPacketHistoryTest, GetBestFittingPacketPicksClosestSize) {
+  hist_->SetStorePacketsStatus(true, 10);
+  const uint16_t kLengths[] = {120, 520, 570, 900, 1400};
+  for (uint16_t i = 0; i < sizeof(kLengths) / sizeof(kLengths[0]); ++i)
+    PutPacket(kSeqNum + i, kLengths[i]);
+
+  scoped_refptr<RtpPacketBuffer> packet_out;
+  int64_t time;
+  ASSERT_TRUE(hist_->GetBestFittingPacket(500, &packet_out, &time));
+  EXPECT_EQ(520, packet_out->length());
+  ASSERT_TRUE(hist_->GetBestFittingPacket(560, &packet_out, &time));
+  EXPECT_EQ(570, packet_out->length());
+  ASSERT_TRUE(hist_->GetBestFittingPacket(1200, &packet_out, &time));
+  EXPECT_EQ(1400, packet_out->length());
+  ASSERT_TRUE(hist_->GetBestFittingPacket(60, &packet_out, &time));
+  EXPECT_EQ(120, packet_out->length());
+
+  // A slot reused by a packet of another size is no longer a candidate.
+  PutPacket(kSeqNum + 3 + 16, 200);
+  ASSERT_TRUE(hist_->GetBestFittingPacket(900, &packet_out, &time));
+  EXPECT_EQ(570, packet_out->length());
+}
+
+// Prints the time taken to look up the packets of NACK lists of 500 packets,
+// both for packets still in the history and for packets already evicted.
+TEST_F(RtpPacketHistoryTest, DISABLED_NackStormBenchmark) {
+  const uint16_t kNumberToStore = 600;
+  const int kNackListSize = 500;
+  const int kNumStorms = 2000;
+  hist_->SetStorePacketsStatus(true, kNumberToStore);
+  uint16_t seq_num = 0;
+  for (int i = 0; i < 4 * kNumberToStore; ++i)
+    PutPacket(seq_num++, 1000 + i % 200);
+
+  const struct {
+    const char* name;
+    uint16_t first_seq_num;
+  } kStorms[] = {
+    {"stored", static_cast<uint16_t>(seq_num - kNackListSize)},
+    {"evicted", 0},
+  };
+  for (size_t s = 0; s < sizeof(kStorms) / sizeof(kStorms[0]); ++s) {
+    int found = 0;
+    TickTime start = TickTime::Now();
+    for (int storm = 0; storm < kNumStorms; ++storm) {
+      for (int i = 0; i < kNackListSize; ++i) {
+        scoped_refptr<RtpPacketBuffer> packet_out;
+        int64_t time;
+        if (hist_->GetPacketAndSetSendTime(kStorms[s].first_seq_num + i, 0,
+                                           true, &packet_out, &time)) {
+          ++found;
+        }
+      }
+    }
+    int64_t elapsed_us = (TickTime::Now() - start).Microseconds();
+    printf("NACK storm of %d %s packets: %6.2f us (%d found)\n",
+           kNackListSize, kStorms[s].name,
+           static_cast<double>(elapsed_us) / kNumStorms, found / kNumStorms);
+  }
+
+  const int kNumRequests = 1000000;
+  int64_t time;
+  scoped_refptr<RtpPacketBuffer> packet_out;
+  TickTime start = TickTime::Now();
+  for (int i = 0; i < kNumRequests; ++i)
+    hist_->GetBestFittingPacket(900 + i % 400, &packet_out, &time);
+  int64_t elapsed_us = (TickTime::Now() - start).Microseconds();
+  printf("GetBestFittingPacket: %6.3f us\n",
+         static_cast<double>(elapsed_us) / kNumRequests);
+}
 }  // namespace webrtc
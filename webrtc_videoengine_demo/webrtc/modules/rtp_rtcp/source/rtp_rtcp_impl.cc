@@ -605,6 +605,44 @@ bool ModuleRtpRtcpImpl::TimeToSendPacket(uint32_t ssrc,
   return true;
 }
 
+int ModuleRtpRtcpImpl::TimeToSendPackets(const PacedPacketInfo* packets,
+                                         int num_packets) {
+  int num_sent = 0;
+  while (num_sent < num_packets) {
+    // Hand each run of packets with the same SSRC to its sender at once.
+    const uint32_t ssrc = packets[num_sent].ssrc;
+    int run_length = 1;
+    while (num_sent + run_length < num_packets &&
+           packets[num_sent + run_length].ssrc == ssrc) {
+      ++run_length;
+    }
+    // Packets no RTP sender is interested in are dropped.
+    int run_sent = run_length;
+    if (!IsDefaultModule()) {
+      // Don't send from default module.
+      if (SendingMedia() && ssrc == rtp_sender_.SSRC()) {
+        run_sent = rtp_sender_.TimeToSendPackets(packets + num_sent,
+                                                 run_length);
+      }
+    } else {
+      CriticalSectionScoped lock(critical_section_module_ptrs_.get());
+      std::vector<ModuleRtpRtcpImpl*>::iterator it = child_modules_.begin();
+      while (it != child_modules_.end()) {
+        if ((*it)->SendingMedia() && ssrc == (*it)->rtp_sender_.SSRC()) {
+          run_sent = (*it)->rtp_sender_.TimeToSendPackets(packets + num_sent,
+                                                          run_length);
+          break;
+        }
+        ++it;
+      }
+    }
+    num_sent += run_sent;
+    if (run_sent < run_length)
+      break;
+  }
+  return num_sent;
+}
+
 int ModuleRtpRtcpImpl::TimeToSendPadding(int bytes) {
   if (!IsDefaultModule()) {
     // Don't send from default module.
@@ -1273,7 +1311,7 @@ bool ModuleRtpRtcpImpl::SendTimeOfXrRrReport(
 }
 
 void ModuleRtpRtcpImpl::OnReceivedNACK(
-    const std::list<uint16_t>& nack_sequence_numbers) {
+    const std::vector<uint16_t>& nack_sequence_numbers) {
   if (!rtp_sender_.StorePackets() ||
       nack_sequence_numbers.size() == 0) {
     return;
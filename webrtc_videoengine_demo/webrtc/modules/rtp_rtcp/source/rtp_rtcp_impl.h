@@ -128,6 +128,8 @@ class ModuleRtpRtcpImpl : public RtpRtcp {
                                 uint16_t sequence_number,
                                 int64_t capture_time_ms,
                                 bool retransmission) OVERRIDE;
+  virtual int TimeToSendPackets(const PacedPacketInfo* packets,
+                                int num_packets) OVERRIDE;
   // Returns the number of padding bytes actually sent, which can be more or
   // less than |bytes|.
   virtual int TimeToSendPadding(int bytes) OVERRIDE;
@@ -364,7 +366,7 @@ class ModuleRtpRtcpImpl : public RtpRtcp {
   void OnReceivedReferencePictureSelectionIndication(
       const uint64_t picture_id);
 
-  void OnReceivedNACK(const std::list<uint16_t>& nack_sequence_numbers);
+  void OnReceivedNACK(const std::vector<uint16_t>& nack_sequence_numbers);
 
   void OnRequestSendReport();
 
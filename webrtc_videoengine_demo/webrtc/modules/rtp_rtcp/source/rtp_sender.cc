@@ -458,18 +458,19 @@ int RTPSender::TrySendRedundantPayloads(int bytes_to_send) {
       return 0;
   }
 
-  uint8_t buffer[IP_PACKET_SIZE];
   int bytes_left = bytes_to_send;
   while (bytes_left > 0) {
-    uint16_t length = bytes_left;
+    scoped_refptr<RtpPacketBuffer> packet;
     int64_t capture_time_ms;
-    if (!packet_history_.GetBestFittingPacket(buffer, &length,
+    if (!packet_history_.GetBestFittingPacket(bytes_left, &packet,
                                               &capture_time_ms)) {
       break;
     }
-    if (!PrepareAndSendPacket(buffer, length, capture_time_ms, true, false))
+    uint16_t length = packet->length();
+    if (!PrepareAndSendPacket(packet->data(), length, capture_time_ms, true,
+                              false))
       return -1;
-    RtpUtility::RtpHeaderParser rtp_parser(buffer, length);
+    RtpUtility::RtpHeaderParser rtp_parser(packet->data(), length);
     RTPHeader rtp_header;
     rtp_parser.Parse(rtp_header);
     bytes_left -= length - rtp_header.headerLength;
@@ -598,18 +599,17 @@ bool RTPSender::StorePackets() const {
 }
 
 int32_t RTPSender::ReSendPacket(uint16_t packet_id, uint32_t min_resend_time) {
-  uint16_t length = IP_PACKET_SIZE;
-  uint8_t data_buffer[IP_PACKET_SIZE];
+  scoped_refptr<RtpPacketBuffer> packet;
   int64_t capture_time_ms;
   if (!packet_history_.GetPacketAndSetSendTime(packet_id, min_resend_time, true,
-                                               data_buffer, &length,
-                                               &capture_time_ms)) {
+                                               &packet, &capture_time_ms)) {
     // Packet not found.
     return 0;
   }
+  uint16_t length = packet->length();
 
   if (paced_sender_) {
-    RtpUtility::RtpHeaderParser rtp_parser(data_buffer, length);
+    RtpUtility::RtpHeaderParser rtp_parser(packet->data(), length);
     RTPHeader header;
     if (!rtp_parser.Parse(header)) {
       assert(false);
@@ -636,7 +636,7 @@ int32_t RTPSender::ReSendPacket(uint16_t packet_id, uint32_t min_resend_time) {
     CriticalSectionScoped lock(send_critsect_);
     rtx = rtx_;
   }
-  return PrepareAndSendPacket(data_buffer, length, capture_time_ms,
+  return PrepareAndSendPacket(packet->data(), length, capture_time_ms,
                               (rtx & kRtxRetransmitted) > 0, true) ?
       length : -1;
 }
@@ -656,6 +656,52 @@ bool RTPSender::SendPacketToNetwork(const uint8_t *packet, uint32_t size) {
   return true;
 }
 
+int RTPSender::SendBatchToNetwork(const BatchPacket* batch, int num_packets) {
+  if (num_packets == 0)
+    return 0;
+  const void* data[PacedSender::kMaxPacketsPerBatch];
+  int lengths[PacedSender::kMaxPacketsPerBatch];
+  for (int i = 0; i < num_packets; ++i) {
+    data[i] = batch[i].buffer->data();
+    lengths[i] = batch[i].buffer->length();
+  }
+  int num_sent = -1;
+  if (transport_) {
+    num_sent = transport_->SendPackets(id_, data, lengths, num_packets);
+  }
+  TRACE_EVENT_INSTANT2("webrtc_rtp", "RTPSender::SendBatchToNetwork",
+                       "packets", num_packets, "sent", num_sent);
+  if (num_sent < num_packets) {
+    LOG(LS_WARNING) << "Transport failed to send packet";
+    num_sent = std::max(num_sent, 0);
+  }
+  if (num_sent == 0)
+    return 0;
+  {
+    CriticalSectionScoped lock(send_critsect_);
+    media_has_been_sent_ = true;
+  }
+  // Only the packets the transport took count as sent.
+  const int64_t now_ms = clock_->TimeInMilliseconds();
+  for (int i = 0; i < num_sent; ++i) {
+    packet_history_.SetSendTime(batch[i].header.sequenceNumber);
+    if (!batch[i].is_retransmit && batch[i].capture_time_ms > 0) {
+      UpdateDelayStatistics(batch[i].capture_time_ms, now_ms);
+    }
+  }
+  uint32_t ssrc = SSRC();
+  CriticalSectionScoped lock(statistics_crit_.get());
+  for (int i = 0; i < num_sent; ++i) {
+    IncrementCounters(&rtp_stats_, batch[i].buffer->data(),
+                      batch[i].buffer->length(), batch[i].header,
+                      batch[i].is_retransmit);
+  }
+  if (rtp_stats_callback_) {
+    rtp_stats_callback_->DataCountersUpdated(rtp_stats_, ssrc);
+  }
+  return num_sent;
+}
+
 int RTPSender::SelectiveRetransmissions() const {
   if (!video_)
     return -1;
@@ -669,7 +715,7 @@ int RTPSender::SetSelectiveRetransmissions(uint8_t settings) {
 }
 
 void RTPSender::OnReceivedNACK(
-    const std::list<uint16_t>& nack_sequence_numbers,
+    const std::vector<uint16_t>& nack_sequence_numbers,
     const uint16_t avg_rtt) {
   TRACE_EVENT2("webrtc_rtp", "RTPSender::OnReceivedNACK",
                "num_seqnum", nack_sequence_numbers.size(), "avg_rtt", avg_rtt);
@@ -684,8 +730,9 @@ void RTPSender::OnReceivedNACK(
     return;
   }
 
-  for (std::list<uint16_t>::const_iterator it = nack_sequence_numbers.begin();
-      it != nack_sequence_numbers.end(); ++it) {
+  for (std::vector<uint16_t>::const_iterator it =
+           nack_sequence_numbers.begin();
+       it != nack_sequence_numbers.end(); ++it) {
     const int32_t bytes_sent = ReSendPacket(*it, 5 + avg_rtt);
     if (bytes_sent > 0) {
       bytes_re_sent += bytes_sent;
@@ -776,15 +823,13 @@ void RTPSender::UpdateNACKBitRate(const uint32_t bytes,
 bool RTPSender::TimeToSendPacket(uint16_t sequence_number,
                                  int64_t capture_time_ms,
                                  bool retransmission) {
-  uint16_t length = IP_PACKET_SIZE;
-  uint8_t data_buffer[IP_PACKET_SIZE];
+  scoped_refptr<RtpPacketBuffer> packet;
   int64_t stored_time_ms;
 
   if (!packet_history_.GetPacketAndSetSendTime(sequence_number,
                                                0,
                                                retransmission,
-                                               data_buffer,
-                                               &length,
+                                               &packet,
                                                &stored_time_ms)) {
     // Packet cannot be found. Allow sending to continue.
     return true;
@@ -797,13 +842,73 @@ bool RTPSender::TimeToSendPacket(uint16_t sequence_number,
     CriticalSectionScoped lock(send_critsect_);
     rtx = rtx_;
   }
-  return PrepareAndSendPacket(data_buffer,
-                              length,
+  return PrepareAndSendPacket(packet->data(),
+                              packet->length(),
                               capture_time_ms,
                               retransmission && (rtx & kRtxRetransmitted) > 0,
                               retransmission);
 }
 
+// Called from pacer with the packets it releases at once. Packets sent as
+// they are stored are passed to the transport together; RTX retransmissions
+// are rewritten into a separate buffer and sent on their own. Send times and
+// delay statistics are only recorded for packets the transport accepted.
+int RTPSender::TimeToSendPackets(const PacedPacketInfo* packets,
+                                 int num_packets) {
+  int rtx;
+  {
+    CriticalSectionScoped lock(send_critsect_);
+    rtx = rtx_;
+  }
+  BatchPacket batch[PacedSender::kMaxPacketsPerBatch];
+  int batch_size = 0;
+  const int64_t now_ms = clock_->TimeInMilliseconds();
+  for (int i = 0; i < num_packets; ++i) {
+    const PacedPacketInfo& info = packets[i];
+    scoped_refptr<RtpPacketBuffer> packet;
+    int64_t stored_time_ms;
+    if (!packet_history_.GetPacket(info.sequence_number,
+                                   info.retransmission,
+                                   &packet,
+                                   &stored_time_ms)) {
+      // Packet cannot be found. Allow sending to continue.
+      continue;
+    }
+    const bool send_over_rtx =
+        info.retransmission && (rtx & kRtxRetransmitted) > 0;
+    if (send_over_rtx || batch_size == PacedSender::kMaxPacketsPerBatch) {
+      int num_sent = SendBatchToNetwork(batch, batch_size);
+      if (num_sent < batch_size)
+        return batch[num_sent].index;
+      batch_size = 0;
+    }
+    if (send_over_rtx) {
+      if (!PrepareAndSendPacket(packet->data(), packet->length(),
+                                info.capture_time_ms, true, true)) {
+        return i;
+      }
+      packet_history_.SetSendTime(info.sequence_number);
+      continue;
+    }
+    BatchPacket& batch_packet = batch[batch_size++];
+    RtpUtility::RtpHeaderParser rtp_parser(packet->data(), packet->length());
+    rtp_parser.Parse(batch_packet.header);
+    UpdateTransmissionTimeOffset(packet->data(), packet->length(),
+                                 batch_packet.header,
+                                 now_ms - info.capture_time_ms);
+    UpdateAbsoluteSendTime(packet->data(), packet->length(),
+                           batch_packet.header, now_ms);
+    batch_packet.buffer = packet;
+    batch_packet.capture_time_ms = info.capture_time_ms;
+    batch_packet.is_retransmit = info.retransmission;
+    batch_packet.index = i;
+  }
+  int num_sent = SendBatchToNetwork(batch, batch_size);
+  if (num_sent < batch_size)
+    return batch[num_sent].index;
+  return num_packets;
+}
+
 bool RTPSender::PrepareAndSendPacket(uint8_t* buffer,
                                      uint16_t length,
                                      int64_t capture_time_ms,
@@ -855,6 +960,18 @@ void RTPSender::UpdateRtpStats(const uint8_t* buffer,
     counters = &rtp_stats_;
   }
 
+  IncrementCounters(counters, buffer, size, header, is_retransmit);
+
+  if (rtp_stats_callback_) {
+    rtp_stats_callback_->DataCountersUpdated(*counters, ssrc);
+  }
+}
+
+void RTPSender::IncrementCounters(StreamDataCounters* counters,
+                                  const uint8_t* buffer,
+                                  uint32_t size,
+                                  const RTPHeader& header,
+                                  bool is_retransmit) {
   bitrate_sent_.Update(size);
   ++counters->packets;
   if (IsFecPacket(buffer, header)) {
@@ -868,10 +985,6 @@ void RTPSender::UpdateRtpStats(const uint8_t* buffer,
     counters->header_bytes += header.headerLength;
     counters->padding_bytes += header.paddingLength;
   }
-
-  if (rtp_stats_callback_) {
-    rtp_stats_callback_->DataCountersUpdated(*counters, ssrc);
-  }
 }
 
 bool RTPSender::IsFecPacket(const uint8_t* buffer,
@@ -901,11 +1014,33 @@ int RTPSender::TimeToSendPadding(int bytes) {
   return bytes - available_bytes;
 }
 
-// TODO(pwestin): send in the RtpHeaderParser to avoid parsing it again.
 int32_t RTPSender::SendToNetwork(
     uint8_t *buffer, int payload_length, int rtp_header_length,
     int64_t capture_time_ms, StorageType storage,
     PacedSender::Priority priority) {
+  return StoreAndSendPacket(buffer, NULL, payload_length, rtp_header_length,
+                            capture_time_ms, storage, priority);
+}
+
+scoped_refptr<RtpPacketBuffer> RTPSender::AllocatePacket() {
+  return packet_history_.AllocatePacket();
+}
+
+int32_t RTPSender::SendToNetwork(
+    RtpPacketBuffer* packet, int payload_length, int rtp_header_length,
+    int64_t capture_time_ms, StorageType storage,
+    PacedSender::Priority priority) {
+  packet->set_length(payload_length + rtp_header_length);
+  return StoreAndSendPacket(packet->data(), packet, payload_length,
+                            rtp_header_length, capture_time_ms, storage,
+                            priority);
+}
+
+// TODO(pwestin): send in the RtpHeaderParser to avoid parsing it again.
+int32_t RTPSender::StoreAndSendPacket(
+    uint8_t *buffer, RtpPacketBuffer* packet, int payload_length,
+    int rtp_header_length, int64_t capture_time_ms, StorageType storage,
+    PacedSender::Priority priority) {
   RtpUtility::RtpHeaderParser rtp_parser(buffer,
                                          payload_length + rtp_header_length);
   RTPHeader rtp_header;
@@ -925,9 +1060,12 @@ int32_t RTPSender::SendToNetwork(
                          rtp_header, now_ms);
 
   // Used for NACK and to spread out the transmission of packets.
-  if (packet_history_.PutRTPPacket(buffer, rtp_header_length + payload_length,
+  int32_t stored = packet ?
+      packet_history_.PutRTPPacket(packet, capture_time_ms, storage) :
+      packet_history_.PutRTPPacket(buffer, rtp_header_length + payload_length,
                                    max_payload_length_, capture_time_ms,
-                                   storage) != 0) {
+                                   storage);
+  if (stored != 0) {
     return -1;
   }
 
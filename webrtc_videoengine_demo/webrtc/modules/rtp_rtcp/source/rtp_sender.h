@@ -15,12 +15,14 @@
 #include <math.h>
 
 #include <map>
+#include <vector>
 
 #include "webrtc/common_types.h"
 #include "webrtc/modules/pacing/include/paced_sender.h"
 #include "webrtc/modules/rtp_rtcp/interface/rtp_rtcp_defines.h"
 #include "webrtc/modules/rtp_rtcp/source/bitrate.h"
 #include "webrtc/modules/rtp_rtcp/source/rtp_header_extension.h"
+#include "webrtc/modules/rtp_rtcp/source/rtp_packet_buffer.h"
 #include "webrtc/modules/rtp_rtcp/source/rtp_packet_history.h"
 #include "webrtc/modules/rtp_rtcp/source/rtp_rtcp_config.h"
 #include "webrtc/modules/rtp_rtcp/source/ssrc_database.h"
@@ -63,6 +65,17 @@ class RTPSenderInterface {
       uint8_t *data_buffer, int payload_length, int rtp_header_length,
       int64_t capture_time_ms, StorageType storage,
       PacedSender::Priority priority) = 0;
+
+  // Returns an empty buffer to build a packet in. A packet sent with the
+  // SendToNetwork() overload below is stored and sent without being copied.
+  virtual scoped_refptr<RtpPacketBuffer> AllocatePacket() = 0;
+
+  // Sends |packet|, which must not be modified afterwards since the packet
+  // history may keep a reference to it.
+  virtual int32_t SendToNetwork(
+      RtpPacketBuffer* packet, int payload_length, int rtp_header_length,
+      int64_t capture_time_ms, StorageType storage,
+      PacedSender::Priority priority) = 0;
 };
 
 class RTPSender : public RTPSenderInterface, public Bitrate::Observer {
@@ -170,12 +183,16 @@ class RTPSender : public RTPSenderInterface, public Bitrate::Observer {
 
   bool TimeToSendPacket(uint16_t sequence_number, int64_t capture_time_ms,
                         bool retransmission);
+  // Sends a batch of packets released by the pacer. All packets must be for
+  // this sender. Returns the number of packets, from the start of |packets|,
+  // that were sent or dropped.
+  int TimeToSendPackets(const PacedPacketInfo* packets, int num_packets);
   int TimeToSendPadding(int bytes);
 
   // NACK.
   int SelectiveRetransmissions() const;
   int SetSelectiveRetransmissions(uint8_t settings);
-  void OnReceivedNACK(const std::list<uint16_t>& nack_sequence_numbers,
+  void OnReceivedNACK(const std::vector<uint16_t>& nack_sequence_numbers,
                       const uint16_t avg_rtt);
 
   void SetStorePacketsStatus(const bool enable,
@@ -221,6 +238,13 @@ class RTPSender : public RTPSenderInterface, public Bitrate::Observer {
       int64_t capture_time_ms, StorageType storage,
       PacedSender::Priority priority) OVERRIDE;
 
+  virtual scoped_refptr<RtpPacketBuffer> AllocatePacket() OVERRIDE;
+
+  virtual int32_t SendToNetwork(
+      RtpPacketBuffer* packet, int payload_length, int rtp_header_length,
+      int64_t capture_time_ms, StorageType storage,
+      PacedSender::Priority priority) OVERRIDE;
+
   // Audio.
 
   // Send a DTMF tone using RFC 2833 (4733).
@@ -291,6 +315,16 @@ class RTPSender : public RTPSenderInterface, public Bitrate::Observer {
   // time.
   typedef std::map<int64_t, int> SendDelayMap;
 
+  // A packet from the history waiting to be sent in a batch.
+  struct BatchPacket {
+    scoped_refptr<RtpPacketBuffer> buffer;
+    RTPHeader header;
+    int64_t capture_time_ms;
+    bool is_retransmit;
+    // Index in the batch passed to TimeToSendPackets().
+    int index;
+  };
+
   int CreateRTPHeader(uint8_t* header, int8_t payload_type,
                       uint32_t ssrc, bool marker_bit,
                       uint32_t timestamp, uint16_t sequence_number,
@@ -310,11 +344,22 @@ class RTPSender : public RTPSenderInterface, public Bitrate::Observer {
 
   int BuildPaddingPacket(uint8_t* packet, int header_length, int32_t bytes);
 
+  // Stores and sends the packet in |buffer|. |packet| is the pooled buffer
+  // holding it, or NULL if the packet must be copied into the history.
+  int32_t StoreAndSendPacket(uint8_t* buffer, RtpPacketBuffer* packet,
+                             int payload_length, int rtp_header_length,
+                             int64_t capture_time_ms, StorageType storage,
+                             PacedSender::Priority priority);
+
   void BuildRtxPacket(uint8_t* buffer, uint16_t* length,
                       uint8_t* buffer_rtx);
 
   bool SendPacketToNetwork(const uint8_t *packet, uint32_t size);
 
+  // Sends |num_packets| packets with one call to the transport and updates
+  // the statistics of the ones sent. Returns the number of packets sent.
+  int SendBatchToNetwork(const BatchPacket* batch, int num_packets);
+
   void UpdateDelayStatistics(int64_t capture_time_ms, int64_t now_ms);
 
   void UpdateTransmissionTimeOffset(uint8_t *rtp_packet,
@@ -332,6 +377,12 @@ class RTPSender : public RTPSenderInterface, public Bitrate::Observer {
                       bool is_rtx,
                       bool is_retransmit);
   bool IsFecPacket(const uint8_t* buffer, const RTPHeader& header) const;
+  void IncrementCounters(StreamDataCounters* counters,
+                         const uint8_t* buffer,
+                         uint32_t size,
+                         const RTPHeader& header,
+                         bool is_retransmit)
+      EXCLUSIVE_LOCKS_REQUIRED(statistics_crit_);
 
   Clock* clock_;
   Bitrate bitrate_sent_;
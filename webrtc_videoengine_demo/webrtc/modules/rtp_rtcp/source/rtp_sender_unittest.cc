@@ -63,18 +63,29 @@ uint64_t ConvertMsToAbsSendTime(int64_t time_ms) {
 class LoopbackTransportTest : public webrtc::Transport {
  public:
   LoopbackTransportTest()
-      : packets_sent_(0), last_sent_packet_len_(0), total_bytes_sent_(0) {}
+      : packets_sent_(0), batches_sent_(0), max_packets_(-1),
+        last_sent_packet_len_(0), total_bytes_sent_(0) {}
   virtual int SendPacket(int channel, const void *data, int len) {
+    if (max_packets_ >= 0 && packets_sent_ >= max_packets_)
+      return -1;
     packets_sent_++;
     memcpy(last_sent_packet_, data, len);
     last_sent_packet_len_ = len;
     total_bytes_sent_ += static_cast<size_t>(len);
     return len;
   }
+  virtual int SendPackets(int channel, const void* const* data,
+                          const int* lengths, int num_packets) {
+    batches_sent_++;
+    return Transport::SendPackets(channel, data, lengths, num_packets);
+  }
   virtual int SendRTCPPacket(int channel, const void *data, int len) {
     return -1;
   }
   int packets_sent_;
+  int batches_sent_;
+  // Packets after the first |max_packets_| fail to send; -1 for no limit.
+  int max_packets_;
   int last_sent_packet_len_;
   size_t total_bytes_sent_;
   uint8_t last_sent_packet_[kMaxPacketLength];
@@ -551,6 +562,91 @@ TEST_F(RtpSenderTest, TrafficSmoothingRetransmits) {
   EXPECT_EQ(expected_send_time, rtp_header.extension.absoluteSendTime);
 }
 
+TEST_F(RtpSenderTest, TimeToSendPacketsUsesOneTransportCall) {
+  EXPECT_CALL(mock_paced_sender_,
+              SendPacket(PacedSender::kNormalPriority, _, _, _, _, _)).
+                  WillRepeatedly(testing::Return(false));
+  rtp_sender_->SetStorePacketsStatus(true, 10);
+  EXPECT_EQ(0, rtp_sender_->RegisterRtpHeaderExtension(
+      kRtpExtensionAbsoluteSendTime, kAbsoluteSendTimeExtensionId));
+  const int kNumPackets = 6;
+  const int kPayloadLength = 100;
+  const int64_t capture_time_ms = fake_clock_.TimeInMilliseconds();
+  PacedPacketInfo packets[kNumPackets];
+  for (int i = 0; i < kNumPackets; ++i) {
+    SendPacket(capture_time_ms, kPayloadLength);
+    PacedPacketInfo info = {rtp_sender_->SSRC(),
+                            static_cast<uint16_t>(kSeqNum + i),
+                            capture_time_ms, false};
+    packets[i] = info;
+  }
+  EXPECT_EQ(0, transport_.packets_sent_);
+  // A packet that isn't in the history is skipped.
+  packets[2].sequence_number = kSeqNum + 100;
+
+  fake_clock_.AdvanceTimeMilliseconds(10);
+  EXPECT_EQ(kNumPackets, rtp_sender_->TimeToSendPackets(packets, kNumPackets));
+  EXPECT_EQ(kNumPackets - 1, transport_.packets_sent_);
+  EXPECT_EQ(1, transport_.batches_sent_);
+
+  // The send time is written into every packet.
+  webrtc::RtpUtility::RtpHeaderParser rtp_parser(
+      transport_.last_sent_packet_, transport_.last_sent_packet_len_);
+  webrtc::RTPHeader rtp_header;
+  RtpHeaderExtensionMap map;
+  map.Register(kRtpExtensionAbsoluteSendTime, kAbsoluteSendTimeExtensionId);
+  ASSERT_TRUE(rtp_parser.Parse(rtp_header, &map));
+  EXPECT_EQ(kSeqNum + kNumPackets - 1, rtp_header.sequenceNumber);
+  EXPECT_EQ(ConvertMsToAbsSendTime(fake_clock_.TimeInMilliseconds()),
+            rtp_header.extension.absoluteSendTime);
+
+  StreamDataCounters rtp_stats;
+  StreamDataCounters rtx_stats;
+  rtp_sender_->GetDataCounters(&rtp_stats, &rtx_stats);
+  EXPECT_EQ(static_cast<uint32_t>(kNumPackets - 1), rtp_stats.packets);
+  EXPECT_EQ(static_cast<uint32_t>((kNumPackets - 1) * kPayloadLength),
+            rtp_stats.bytes);
+}
+
+TEST_F(RtpSenderTest, TimeToSendPacketsOnlyMarksSentPackets) {
+  EXPECT_CALL(mock_paced_sender_,
+              SendPacket(PacedSender::kNormalPriority, _, _, _, _, _)).
+                  WillRepeatedly(testing::Return(false));
+  EXPECT_CALL(mock_paced_sender_,
+              SendPacket(PacedSender::kHighPriority, _, _, _, _, _)).
+                  WillRepeatedly(testing::Return(false));
+  rtp_sender_->SetStorePacketsStatus(true, 10);
+  const int kNumPackets = 4;
+  const int kNumAccepted = 2;
+  const int kPayloadLength = 100;
+  const int64_t start_ms = fake_clock_.TimeInMilliseconds();
+  PacedPacketInfo packets[kNumPackets];
+  for (int i = 0; i < kNumPackets; ++i) {
+    // Distinct capture times tell the delay samples apart.
+    SendPacket(start_ms + i, kPayloadLength);
+    PacedPacketInfo info = {rtp_sender_->SSRC(),
+                            static_cast<uint16_t>(kSeqNum + i),
+                            start_ms + i, false};
+    packets[i] = info;
+  }
+  fake_clock_.AdvanceTimeMilliseconds(10);
+  transport_.max_packets_ = kNumAccepted;
+  EXPECT_EQ(kNumAccepted,
+            rtp_sender_->TimeToSendPackets(packets, kNumPackets));
+  EXPECT_EQ(kNumAccepted, transport_.packets_sent_);
+
+  // The delay statistics come from the last packet that was sent.
+  int avg_delay_ms = 0;
+  int max_delay_ms = 0;
+  EXPECT_TRUE(rtp_sender_->GetSendSideDelay(&avg_delay_ms, &max_delay_ms));
+  EXPECT_EQ(fake_clock_.TimeInMilliseconds() - (start_ms + kNumAccepted - 1),
+            max_delay_ms);
+
+  // Only the sent packets have a send time, which holds back a resend.
+  EXPECT_EQ(0, rtp_sender_->ReSendPacket(kSeqNum + kNumAccepted - 1, 100));
+  EXPECT_LT(0, rtp_sender_->ReSendPacket(kSeqNum + kNumAccepted, 100));
+}
+
 // This test sends 1 regular video packet, then 4 padding packets, and then
 // 1 more regular packet.
 TEST_F(RtpSenderTest, SendPadding) {
@@ -107,7 +107,7 @@ int32_t RTPSenderVideo::RegisterVideoPayload(
 }
 
 int32_t
-RTPSenderVideo::SendVideoPacket(uint8_t* data_buffer,
+RTPSenderVideo::SendVideoPacket(RtpPacketBuffer* packet,
                                 const uint16_t payload_length,
                                 const uint16_t rtp_header_length,
                                 const uint32_t capture_timestamp,
@@ -115,6 +115,7 @@ RTPSenderVideo::SendVideoPacket(uint8_t* data_buffer,
                                 StorageType storage,
                                 bool protect) {
   if(_fecEnabled) {
+    const uint8_t* data_buffer = packet->data();
     int ret = 0;
     int fec_overhead_sent = 0;
     int video_sent = 0;
@@ -188,7 +189,7 @@ RTPSenderVideo::SendVideoPacket(uint8_t* data_buffer,
   TRACE_EVENT_INSTANT2("webrtc_rtp", "Video::PacketNormal",
                        "timestamp", capture_timestamp,
                        "seqnum", _rtpSender.SequenceNumber());
-  int ret = _rtpSender.SendToNetwork(data_buffer,
+  int ret = _rtpSender.SendToNetwork(packet,
                                      payload_length,
                                      rtp_header_length,
                                      capture_time_ms,
@@ -350,20 +351,21 @@ int32_t RTPSenderVideo::SendGeneric(const FrameType frame_type,
   uint32_t payload_length = (size + num_packets - 1) / num_packets;
   assert(payload_length <= max_length);
 
-  // Fragment packet into packets of max MaxPayloadLength bytes payload.
-  uint8_t buffer[IP_PACKET_SIZE];
-
   uint8_t generic_header = RtpFormatVideoGeneric::kFirstPacketBit;
   if (frame_type == kVideoFrameKey) {
     generic_header |= RtpFormatVideoGeneric::kKeyFrameBit;
   }
 
+  // Fragment packet into packets of max MaxPayloadLength bytes payload.
   while (size > 0) {
     if (size < payload_length) {
       payload_length = size;
     }
     size -= payload_length;
 
+    scoped_refptr<RtpPacketBuffer> packet = _rtpSender.AllocatePacket();
+    uint8_t* buffer = packet->data();
+
     // MarkerBit is 1 on final packet (bytes_to_send == 0)
     if (_rtpSender.BuildRTPheader(buffer, payload_type, size == 0,
                                   capture_timestamp,
@@ -382,7 +384,7 @@ int32_t RTPSenderVideo::SendGeneric(const FrameType frame_type,
     memcpy(out_ptr, payload, payload_length);
     payload += payload_length;
 
-    if (SendVideoPacket(buffer, payload_length + 1, rtp_header_length,
+    if (SendVideoPacket(packet, payload_length + 1, rtp_header_length,
                         capture_timestamp, capture_time_ms,
                         kAllowRetransmission, true)) {
       return -1;
@@ -452,7 +454,8 @@ RTPSenderVideo::SendVP8(const FrameType frameType,
     while (!last)
     {
         // Write VP8 Payload Descriptor and VP8 payload.
-        uint8_t dataBuffer[IP_PACKET_SIZE] = {0};
+        scoped_refptr<RtpPacketBuffer> packet = _rtpSender.AllocatePacket();
+        uint8_t* dataBuffer = packet->data();
         size_t payloadBytesInPacket = 0;
         if (!packetizer.NextPacket(
                 &dataBuffer[rtpHeaderLength], &payloadBytesInPacket, &last))
@@ -462,7 +465,7 @@ RTPSenderVideo::SendVP8(const FrameType frameType,
         // Set marker bit true if this is the last packet in frame.
         _rtpSender.BuildRTPheader(dataBuffer, payloadType, last,
             captureTimeStamp, capture_time_ms);
-        if (-1 == SendVideoPacket(dataBuffer, payloadBytesInPacket,
+        if (-1 == SendVideoPacket(packet, payloadBytesInPacket,
                                   rtpHeaderLength, captureTimeStamp,
                                   capture_time_ms, storage, protect))
         {
@@ -499,7 +502,8 @@ bool RTPSenderVideo::SendH264(const FrameType frameType,
 
   while (!last) {
     // Write H264 payload.
-    uint8_t dataBuffer[IP_PACKET_SIZE] = {0};
+    scoped_refptr<RtpPacketBuffer> packet = _rtpSender.AllocatePacket();
+    uint8_t* dataBuffer = packet->data();
     size_t payload_bytes_in_packet = 0;
     if (!packetizer->NextPacket(
             &dataBuffer[rtp_header_length], &payload_bytes_in_packet, &last)) {
@@ -510,7 +514,7 @@ bool RTPSenderVideo::SendH264(const FrameType frameType,
     // Set marker bit true if this is the last packet in frame.
     _rtpSender.BuildRTPheader(
         dataBuffer, payloadType, last, captureTimeStamp, capture_time_ms);
-    if (SendVideoPacket(dataBuffer,
+    if (SendVideoPacket(packet,
                         payload_bytes_in_packet,
                         rtp_header_length,
                         captureTimeStamp,
@@ -86,7 +86,7 @@ public:
     int SetSelectiveRetransmissions(uint8_t settings);
 
 protected:
-    virtual int32_t SendVideoPacket(uint8_t* dataBuffer,
+    virtual int32_t SendVideoPacket(RtpPacketBuffer* packet,
                                     const uint16_t payloadLength,
                                     const uint16_t rtpHeaderLength,
                                     const uint32_t capture_timestamp,
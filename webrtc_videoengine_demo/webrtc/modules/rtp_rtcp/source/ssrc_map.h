@@ -0,0 +1,211 @@
+/*
+ *  Copyright (c) 2014 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_RTP_RTCP_SOURCE_SSRC_MAP_H_
+#define WEBRTC_MODULES_RTP_RTCP_SOURCE_SSRC_MAP_H_
+
+#include <algorithm>
+#include <vector>
+
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+
+// Maps SSRCs to values of type T, stored by value in an open-addressed table
+// with linear probing. The table has a power of two number of slots and is
+// kept at most half full, so a lookup touches one or two slots and needs no
+// allocation; entries are removed by shifting the following entries back
+// rather than leaving tombstones. T must be default constructible and
+// assignable.
+//
+// Pointers to values and iterators are invalidated by Insert() and Erase().
+// Entries are visited in slot order, not in SSRC order.
+template <typename T>
+class SsrcMap {
+ public:
+  struct Entry {
+    Entry() : used(false), ssrc(0), value() {}
+
+    bool used;
+    uint32_t ssrc;
+    T value;
+  };
+
+  template <typename EntryType>
+  class IteratorBase {
+   public:
+    IteratorBase() : entry_(NULL), end_(NULL) {}
+    IteratorBase(EntryType* entry, EntryType* end) : entry_(entry), end_(end) {
+      SkipUnused();
+    }
+    // Converts an iterator to a const_iterator.
+    template <typename OtherEntryType>
+    IteratorBase(const IteratorBase<OtherEntryType>& other)
+        : entry_(other.entry_), end_(other.end_) {}
+
+    EntryType& operator*() const { return *entry_; }
+    EntryType* operator->() const { return entry_; }
+    IteratorBase& operator++() {
+      ++entry_;
+      SkipUnused();
+      return *this;
+    }
+    bool operator==(const IteratorBase& other) const {
+      return entry_ == other.entry_;
+    }
+    bool operator!=(const IteratorBase& other) const {
+      return entry_ != other.entry_;
+    }
+
+   private:
+    template <typename OtherEntryType>
+    friend class IteratorBase;
+
+    void SkipUnused() {
+      while (entry_ != end_ && !entry_->used)
+        ++entry_;
+    }
+
+    EntryType* entry_;
+    EntryType* end_;
+  };
+
+  typedef IteratorBase<Entry> iterator;
+  typedef IteratorBase<const Entry> const_iterator;
+
+  SsrcMap() : size_(0), mask_(0) {}
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  iterator begin() {
+    return iterator(slots_.empty() ? NULL : &slots_[0], EndPointer());
+  }
+  iterator end() { return iterator(EndPointer(), EndPointer()); }
+  const_iterator begin() const {
+    return const_iterator(slots_.empty() ? NULL : &slots_[0], EndPointer());
+  }
+  const_iterator end() const {
+    return const_iterator(EndPointer(), EndPointer());
+  }
+
+  // Returns the value of |ssrc|, or NULL if there is none.
+  T* Find(uint32_t ssrc) {
+    int index = FindSlot(ssrc);
+    return index < 0 ? NULL : &slots_[index].value;
+  }
+  const T* Find(uint32_t ssrc) const {
+    int index = FindSlot(ssrc);
+    return index < 0 ? NULL : &slots_[index].value;
+  }
+
+  // Returns the value of |ssrc|, inserting a default constructed value if
+  // there is none.
+  T* Insert(uint32_t ssrc) {
+    if (2 * (size_ + 1) > slots_.size())
+      Grow();
+    size_t index = Home(ssrc);
+    while (slots_[index].used) {
+      if (slots_[index].ssrc == ssrc)
+        return &slots_[index].value;
+      index = (index + 1) & mask_;
+    }
+    slots_[index].used = true;
+    slots_[index].ssrc = ssrc;
+    ++size_;
+    return &slots_[index].value;
+  }
+
+  // Removes |ssrc|. Returns false if there is no value for it.
+  bool Erase(uint32_t ssrc) {
+    int found = FindSlot(ssrc);
+    if (found < 0)
+      return false;
+    // Move back each following entry of the probe sequence whose home slot
+    // is not between the hole and itself, so that it stays reachable.
+    size_t hole = found;
+    for (size_t next = (hole + 1) & mask_; slots_[next].used;
+         next = (next + 1) & mask_) {
+      size_t home = Home(slots_[next].ssrc);
+      if (((next - home) & mask_) >= ((next - hole) & mask_)) {
+        std::swap(slots_[hole], slots_[next]);
+        hole = next;
+      }
+    }
+    slots_[hole] = Entry();
+    --size_;
+    return true;
+  }
+
+  void Clear() {
+    slots_.clear();
+    size_ = 0;
+    mask_ = 0;
+  }
+
+  // Appends the SSRCs in the map to |ssrcs| in ascending order, for callers
+  // that must report entries in a stable order.
+  void SortedSsrcs(std::vector<uint32_t>* ssrcs) const {
+    const size_t first = ssrcs->size();
+    for (const_iterator it = begin(); it != end(); ++it)
+      ssrcs->push_back(it->ssrc);
+    std::sort(ssrcs->begin() + first, ssrcs->end());
+  }
+
+ private:
+  static const size_t kMinSlots = 8;
+
+  // Fibonacci hashing; SSRCs are random, but tests and some applications
+  // use consecutive values, which this spreads over the table.
+  size_t Home(uint32_t ssrc) const {
+    return static_cast<size_t>((ssrc * 0x9E3779B1u) >> 16) & mask_;
+  }
+
+  int FindSlot(uint32_t ssrc) const {
+    if (size_ == 0)
+      return -1;
+    for (size_t index = Home(ssrc); slots_[index].used;
+         index = (index + 1) & mask_) {
+      if (slots_[index].ssrc == ssrc)
+        return static_cast<int>(index);
+    }
+    return -1;
+  }
+
+  void Grow() {
+    std::vector<Entry> old_slots;
+    old_slots.swap(slots_);
+    slots_.resize(old_slots.empty() ? kMinSlots : 2 * old_slots.size());
+    mask_ = slots_.size() - 1;
+    for (size_t i = 0; i < old_slots.size(); ++i) {
+      if (!old_slots[i].used)
+        continue;
+      size_t index = Home(old_slots[i].ssrc);
+      while (slots_[index].used)
+        index = (index + 1) & mask_;
+      std::swap(slots_[index], old_slots[i]);
+    }
+  }
+
+  Entry* EndPointer() {
+    return slots_.empty() ? NULL : &slots_[0] + slots_.size();
+  }
+  const Entry* EndPointer() const {
+    return slots_.empty() ? NULL : &slots_[0] + slots_.size();
+  }
+
+  std::vector<Entry> slots_;
+  size_t size_;
+  size_t mask_;
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_RTP_RTCP_SOURCE_SSRC_MAP_H_
@@ -0,0 +1,100 @@
+/*
+ *  Copyright (c) 2014 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdlib.h>
+
+#include <map>
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/modules/rtp_rtcp/source/ssrc_map.h"
+
+namespace webrtc {
+
+TEST(SsrcMapTest, Empty) {
+  SsrcMap<int> map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(0u, map.size());
+  EXPECT_TRUE(map.Find(1) == NULL);
+  EXPECT_FALSE(map.Erase(1));
+  EXPECT_TRUE(map.begin() == map.end());
+}
+
+TEST(SsrcMapTest, InsertFindErase) {
+  SsrcMap<int> map;
+  int* value = map.Insert(0x1234);
+  ASSERT_TRUE(value != NULL);
+  EXPECT_EQ(0, *value);
+  *value = 17;
+  EXPECT_EQ(value, map.Insert(0x1234));
+  EXPECT_EQ(1u, map.size());
+  ASSERT_TRUE(map.Find(0x1234) != NULL);
+  EXPECT_EQ(17, *map.Find(0x1234));
+  EXPECT_TRUE(map.Find(0x1235) == NULL);
+
+  EXPECT_TRUE(map.Erase(0x1234));
+  EXPECT_TRUE(map.empty());
+  EXPECT_TRUE(map.Find(0x1234) == NULL);
+  // A value inserted again starts out default constructed.
+  EXPECT_EQ(0, *map.Insert(0x1234));
+}
+
+TEST(SsrcMapTest, SortedSsrcs) {
+  SsrcMap<int> map;
+  const uint32_t kSsrcs[] = {5, 0xffffffff, 3, 0, 100, 4};
+  const size_t kNumSsrcs = sizeof(kSsrcs) / sizeof(kSsrcs[0]);
+  for (size_t i = 0; i < kNumSsrcs; ++i)
+    map.Insert(kSsrcs[i]);
+  std::vector<uint32_t> ssrcs;
+  map.SortedSsrcs(&ssrcs);
+  ASSERT_EQ(kNumSsrcs, ssrcs.size());
+  EXPECT_EQ(0u, ssrcs[0]);
+  EXPECT_EQ(3u, ssrcs[1]);
+  EXPECT_EQ(4u, ssrcs[2]);
+  EXPECT_EQ(5u, ssrcs[3]);
+  EXPECT_EQ(100u, ssrcs[4]);
+  EXPECT_EQ(0xffffffffu, ssrcs[5]);
+}
+
+// Inserts and erases SSRCs at random, from a small range so that probe
+// sequences collide and wrap, and compares the map with a std::map.
+TEST(SsrcMapTest, MatchesStdMap) {
+  const int kIterations = 100000;
+  SsrcMap<int> map;
+  std::map<uint32_t, int> reference;
+  srand(42);
+  for (int i = 0; i < kIterations; ++i) {
+    const uint32_t ssrc = rand() % 200;
+    if (rand() % 3 == 0) {
+      ASSERT_EQ(reference.erase(ssrc) == 1, map.Erase(ssrc));
+    } else {
+      *map.Insert(ssrc) = i;
+      reference[ssrc] = i;
+    }
+    ASSERT_EQ(reference.size(), map.size());
+    const uint32_t lookup = rand() % 200;
+    const int* value = map.Find(lookup);
+    std::map<uint32_t, int>::const_iterator it = reference.find(lookup);
+    if (it == reference.end()) {
+      ASSERT_TRUE(value == NULL);
+    } else {
+      ASSERT_TRUE(value != NULL);
+      ASSERT_EQ(it->second, *value);
+    }
+  }
+  size_t visited = 0;
+  for (SsrcMap<int>::const_iterator it = map.begin(); it != map.end(); ++it) {
+    EXPECT_EQ(reference[it->ssrc], it->value);
+    ++visited;
+  }
+  EXPECT_EQ(reference.size(), visited);
+}
+
+}  // namespace webrtc
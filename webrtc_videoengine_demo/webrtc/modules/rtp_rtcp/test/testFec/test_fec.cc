@@ -91,7 +91,8 @@ TEST(FecTest, FecTest) {
   const bool kUseUnequalProtection = true;
 
   // FEC mask types.
-  const FecMaskType kMaskTypes[] = { kFecMaskRandom, kFecMaskBursty };
+  const FecMaskType kMaskTypes[] = { kFecMaskRandom, kFecMaskBursty,
+                                     kFecMaskInterleaved };
   const int kNumFecMaskTypes = sizeof(kMaskTypes) / sizeof(*kMaskTypes);
 
   // TODO(pbos): Fix this. Hack to prevent a warning
@@ -100,7 +101,8 @@ TEST(FecTest, FecTest) {
 
   // Maximum number of media packets allowed for the mask type.
   const uint16_t kMaxMediaPackets[] = {kMaxNumberMediaPackets,
-      sizeof(kPacketMaskBurstyTbl) / sizeof(*kPacketMaskBurstyTbl)};
+      sizeof(kPacketMaskBurstyTbl) / sizeof(*kPacketMaskBurstyTbl),
+      kMaxNumberMediaPackets};
 
   ASSERT_EQ(12, kMaxMediaPackets[1]) << "Max media packets for bursty mode not "
                                      << "equal to 12.";
@@ -138,7 +140,7 @@ TEST(FecTest, FecTest) {
   uint32_t timeStamp = static_cast<uint32_t>(rand());
   const uint32_t ssrc = static_cast<uint32_t>(rand());
 
-  // Loop over the mask types: random and bursty.
+  // Loop over the mask types: random, bursty and interleaved.
   for (int mask_type_idx = 0; mask_type_idx < kNumFecMaskTypes;
        ++mask_type_idx) {
 
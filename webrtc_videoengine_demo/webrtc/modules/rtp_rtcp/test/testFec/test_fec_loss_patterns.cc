@@ -0,0 +1,284 @@
+/*
+ *  Copyright (c) 2014 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+/*
+ * Compares the FEC packet mask types by sending frames through the loss
+ * models of test::PacketManipulatorImpl and decoding what arrives.
+ *
+ * Each RTP packet, media or FEC, is passed to the manipulator as a one byte
+ * frame, so a packet is either delivered or lost, and bursts continue across
+ * frames as they would on the wire. The residual loss is the fraction of media
+ * packets that are neither received nor recovered; the overhead is the number
+ * of FEC packets per media packet. The same seed is used for every mask type,
+ * so they see the same loss pattern.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <iterator>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/modules/rtp_rtcp/source/forward_error_correction.h"
+#include "webrtc/modules/rtp_rtcp/source/rtp_utility.h"
+#include "webrtc/modules/video_coding/codecs/interface/video_codec_interface.h"
+#include "webrtc/modules/video_coding/codecs/test/packet_manipulator.h"
+#include "webrtc/test/testsupport/packet_reader.h"
+
+namespace webrtc {
+
+namespace {
+
+const uint32_t kSsrc = 0x12345678;
+const unsigned int kRandomSeed = 7;
+
+const char* MaskTypeToStr(FecMaskType fec_mask_type) {
+  switch (fec_mask_type) {
+    case kFecMaskRandom:
+      return "random";
+    case kFecMaskBursty:
+      return "bursty";
+    case kFecMaskInterleaved:
+      return "interleaved";
+  }
+  return "unknown";
+}
+
+struct LossResult {
+  LossResult()
+      : media_packets(0), fec_packets(0), lost_packets(0), sent_packets(0),
+        unrecovered_packets(0) {}
+
+  double loss() const {
+    return static_cast<double>(lost_packets) / sent_packets;
+  }
+  double overhead() const {
+    return static_cast<double>(fec_packets) / media_packets;
+  }
+  double residual_loss() const {
+    return static_cast<double>(unrecovered_packets) / media_packets;
+  }
+
+  int media_packets;
+  int fec_packets;
+  int lost_packets;
+  int sent_packets;
+  int unrecovered_packets;
+};
+
+}  // namespace
+
+class FecLossPatternTest : public ::testing::Test {
+ protected:
+  // Sends |num_frames| frames of |num_media_packets| packets, protected with
+  // |fec_mask_type| masks, through a manipulator using |config|.
+  LossResult Run(FecMaskType fec_mask_type, int num_media_packets,
+                 uint8_t protection_factor,
+                 const test::NetworkingConfig& config, int num_frames);
+
+  // Returns true if the manipulator drops the next packet.
+  bool Lost(test::PacketManipulatorImpl* manipulator);
+
+  // Prints the results of all mask types for one loss model.
+  void Compare(const test::NetworkingConfig& config, int num_media_packets,
+               uint8_t protection_factor, int num_frames);
+};
+
+bool FecLossPatternTest::Lost(test::PacketManipulatorImpl* manipulator) {
+  uint8_t data = 0;
+  EncodedImage image(&data, 1, 1);
+  return manipulator->ManipulatePackets(&image) > 0;
+}
+
+LossResult FecLossPatternTest::Run(FecMaskType fec_mask_type,
+                                   int num_media_packets,
+                                   uint8_t protection_factor,
+                                   const test::NetworkingConfig& config,
+                                   int num_frames) {
+  test::PacketReader packet_reader;
+  test::PacketManipulatorImpl manipulator(&packet_reader, config, false);
+  manipulator.InitializeRandomSeed(kRandomSeed);
+  srand(kRandomSeed);
+
+  ForwardErrorCorrection encoder;
+  ForwardErrorCorrection decoder;
+  ForwardErrorCorrection::PacketList media_packets;
+  ForwardErrorCorrection::ReceivedPacketList received_packets;
+  ForwardErrorCorrection::RecoveredPacketList recovered_packets;
+  LossResult result;
+  uint16_t seq_num = 0;
+  for (int frame = 0; frame < num_frames; ++frame) {
+    const uint16_t first_seq_num = seq_num;
+    for (int i = 0; i < num_media_packets; ++i) {
+      ForwardErrorCorrection::Packet* packet =
+          new ForwardErrorCorrection::Packet;
+      packet->length = kRtpHeaderSize + 100 + rand() % 1000;
+      for (int j = kRtpHeaderSize; j < packet->length; ++j)
+        packet->data[j] = static_cast<uint8_t>(rand());
+      packet->data[0] = 0x80;
+      packet->data[1] = (i == num_media_packets - 1) ? 0x80 : 0;
+      RtpUtility::AssignUWord16ToBuffer(&packet->data[2], seq_num++);
+      RtpUtility::AssignUWord32ToBuffer(&packet->data[4], frame * 3000);
+      RtpUtility::AssignUWord32ToBuffer(&packet->data[8], kSsrc);
+      media_packets.push_back(packet);
+    }
+    ForwardErrorCorrection::PacketList fec_packets;
+    EXPECT_EQ(0, encoder.GenerateFEC(media_packets, protection_factor, 0,
+                                     false, fec_mask_type, &fec_packets));
+
+    // Media packets go out first, followed by the FEC packets.
+    ForwardErrorCorrection::PacketList::iterator it = media_packets.begin();
+    for (uint16_t media_seq_num = first_seq_num; it != media_packets.end();
+         ++it, ++media_seq_num) {
+      if (Lost(&manipulator)) {
+        ++result.lost_packets;
+        continue;
+      }
+      ForwardErrorCorrection::ReceivedPacket* received_packet =
+          new ForwardErrorCorrection::ReceivedPacket;
+      received_packet->pkt = decoder.AllocatePacket();
+      received_packet->pkt->length = (*it)->length;
+      memcpy(received_packet->pkt->data, (*it)->data, (*it)->length);
+      received_packet->seq_num = media_seq_num;
+      received_packet->is_fec = false;
+      received_packets.push_back(received_packet);
+    }
+    for (it = fec_packets.begin(); it != fec_packets.end(); ++it) {
+      const uint16_t fec_seq_num = seq_num++;
+      if (Lost(&manipulator)) {
+        ++result.lost_packets;
+        continue;
+      }
+      ForwardErrorCorrection::ReceivedPacket* received_packet =
+          new ForwardErrorCorrection::ReceivedPacket;
+      received_packet->pkt = decoder.AllocatePacket();
+      received_packet->pkt->length = (*it)->length;
+      memcpy(received_packet->pkt->data, (*it)->data, (*it)->length);
+      received_packet->seq_num = fec_seq_num;
+      received_packet->ssrc = kSsrc;
+      received_packet->is_fec = true;
+      received_packets.push_back(received_packet);
+    }
+    result.media_packets += num_media_packets;
+    result.fec_packets += static_cast<int>(fec_packets.size());
+    result.sent_packets +=
+        num_media_packets + static_cast<int>(fec_packets.size());
+
+    if (!received_packets.empty()) {
+      EXPECT_EQ(0, decoder.DecodeFEC(&received_packets, &recovered_packets));
+    }
+
+    // Every packet of the frame that is in the recovered list must match
+    // what was sent.
+    int delivered = 0;
+    for (ForwardErrorCorrection::RecoveredPacketList::iterator rec_it =
+             recovered_packets.begin();
+         rec_it != recovered_packets.end(); ++rec_it) {
+      const uint16_t offset =
+          static_cast<uint16_t>((*rec_it)->seq_num - first_seq_num);
+      if (offset >= num_media_packets) {
+        ADD_FAILURE() << "Packet " << (*rec_it)->seq_num << " not in frame.";
+        continue;
+      }
+      ForwardErrorCorrection::PacketList::iterator media_it =
+          media_packets.begin();
+      std::advance(media_it, offset);
+      EXPECT_EQ((*media_it)->length, (*rec_it)->pkt->length);
+      EXPECT_EQ(0, memcmp((*media_it)->data, (*rec_it)->pkt->data,
+                          (*media_it)->length));
+      ++delivered;
+    }
+    result.unrecovered_packets += num_media_packets - delivered;
+
+    // Frames are decoded independently.
+    decoder.ResetState(&recovered_packets);
+    while (!media_packets.empty()) {
+      delete media_packets.front();
+      media_packets.pop_front();
+    }
+  }
+  return result;
+}
+
+void FecLossPatternTest::Compare(const test::NetworkingConfig& config,
+                                 int num_media_packets,
+                                 uint8_t protection_factor, int num_frames) {
+  const FecMaskType kMaskTypes[] = {kFecMaskRandom, kFecMaskBursty,
+                                    kFecMaskInterleaved};
+  for (size_t i = 0; i < sizeof(kMaskTypes) / sizeof(*kMaskTypes); ++i) {
+    LossResult result = Run(kMaskTypes[i], num_media_packets,
+                            protection_factor, config, num_frames);
+    printf("%-11s %2d media %-7s loss %5.2f%% (burst %d)  "
+           "overhead %5.1f%%  residual loss %6.3f%%\n",
+           MaskTypeToStr(kMaskTypes[i]), num_media_packets,
+           test::PacketLossModeToStr(config.packet_loss_mode),
+           100.0 * result.loss(), config.packet_loss_burst_length,
+           100.0 * result.overhead(), 100.0 * result.residual_loss());
+  }
+}
+
+// Bursts no longer than the number of columns are always recovered by the
+// interleaved masks, which the table masks can't guarantee.
+TEST_F(FecLossPatternTest, InterleavedMasksRecoverBursts) {
+  const int kNumMediaPackets = 24;
+  const uint8_t kProtectionFactor = 85;  // 8 FEC packets.
+  const int kNumFrames = 300;
+  test::NetworkingConfig config;
+  config.packet_size_in_bytes = 1;
+  config.packet_loss_mode = test::kBurst;
+  config.packet_loss_probability = 0.01;
+  config.packet_loss_burst_length = 6;
+
+  LossResult random = Run(kFecMaskRandom, kNumMediaPackets, kProtectionFactor,
+                          config, kNumFrames);
+  LossResult interleaved = Run(kFecMaskInterleaved, kNumMediaPackets,
+                               kProtectionFactor, config, kNumFrames);
+  EXPECT_EQ(random.lost_packets, interleaved.lost_packets);
+  EXPECT_EQ(random.overhead(), interleaved.overhead());
+  EXPECT_GT(random.lost_packets, 0);
+  EXPECT_LT(interleaved.residual_loss(), random.residual_loss());
+}
+
+// Prints the residual loss and overhead of every mask type for a range of
+// loss models, frame sizes and protection factors.
+TEST_F(FecLossPatternTest, DISABLED_CompareMaskTypes) {
+  const int kNumFrames = 1000;
+  const int kNumMediaPackets[] = {8, 12, 24, 48};
+  const uint8_t kProtectionFactors[] = {64, 128};
+  const struct {
+    test::PacketLossMode mode;
+    double probability;
+    int burst_length;
+  } kLossModels[] = {
+    {test::kUniform, 0.05, 1},
+    {test::kUniform, 0.10, 1},
+    {test::kBurst, 0.02, 3},
+    {test::kBurst, 0.02, 6},
+    {test::kBurst, 0.02, 12},
+  };
+  for (size_t p = 0; p < sizeof(kProtectionFactors); ++p) {
+    printf("Protection factor %d\n", kProtectionFactors[p]);
+    for (size_t n = 0; n < sizeof(kNumMediaPackets) / sizeof(int); ++n) {
+      for (size_t l = 0; l < sizeof(kLossModels) / sizeof(*kLossModels);
+           ++l) {
+        test::NetworkingConfig config;
+        config.packet_size_in_bytes = 1;
+        config.packet_loss_mode = kLossModels[l].mode;
+        config.packet_loss_probability = kLossModels[l].probability;
+        config.packet_loss_burst_length = kLossModels[l].burst_length;
+        Compare(config, kNumMediaPackets[n], kProtectionFactors[p],
+                kNumFrames);
+      }
+    }
+  }
+}
+
+}  // namespace webrtc
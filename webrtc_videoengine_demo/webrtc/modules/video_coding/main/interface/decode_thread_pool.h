@@ -0,0 +1,55 @@
+/*
+ *  Copyright (c) 2014 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_VIDEO_CODING_MAIN_INTERFACE_DECODE_THREAD_POOL_H_
+#define WEBRTC_MODULES_VIDEO_CODING_MAIN_INTERFACE_DECODE_THREAD_POOL_H_
+
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+
+class VideoCodingModule;
+
+// Decodes the frames of many video coding modules on a shared pool of
+// threads, instead of one thread per module blocked in
+// VideoCodingModule::Decode().
+//
+// Modules tell the pool when a frame becomes decodable, and the frame which
+// is to be rendered first is decoded first. A module is decoded by one
+// thread at a time, so its frames are still decoded in order. Frames which
+// aren't signaled, such as incomplete frames decoded with errors, are picked
+// up by polling each module every kPollIntervalMs.
+class DecodeThreadPool {
+ public:
+  enum { kPollIntervalMs = 10 };
+
+  // Creates a pool of |max_threads| threads, at most one per core. Zero
+  // means one per core.
+  static DecodeThreadPool* Create(int max_threads);
+  static void Destroy(DecodeThreadPool* pool);
+
+  virtual int32_t Start() = 0;
+  virtual int32_t Stop() = 0;
+
+  virtual int NumThreads() const = 0;
+
+  // Registers the frame ready callback of |module| and decodes it from the
+  // pool. The module must not be decoded from elsewhere while registered.
+  virtual int32_t RegisterModule(VideoCodingModule* module) = 0;
+  // Returns once |module| is no longer being decoded.
+  virtual int32_t DeRegisterModule(VideoCodingModule* module) = 0;
+
+ protected:
+  virtual ~DecodeThreadPool() {}
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_VIDEO_CODING_MAIN_INTERFACE_DECODE_THREAD_POOL_H_
@@ -604,6 +604,33 @@ public:
         EncodedImageCallback* observer) = 0;
     virtual void RegisterPostEncodeImageCallback(
         EncodedImageCallback* post_encode_callback) = 0;
+
+    // Registers a callback which is called whenever a frame becomes
+    // decodable, so that Decode() can be called without waiting instead of
+    // blocking a thread per module in it. See DecodeThreadPool.
+    // De-register with a NULL pointer; no call is in progress once this
+    // returns. Declared after the existing methods so that their vtable slots
+    // don't move for callers built against the previous interface.
+    virtual int RegisterFrameReadyCallback(
+        VCMFrameReadyCallback* callback) = 0;
+
+    // Register a late frame callback which will be called along with the
+    // receive statistics callback, with the number of frames which were
+    // decoded or skipped too late to be rendered in time.
+    //
+    // Input:
+    //      - lateFrames  : The callback object to register.
+    //
+    // Return value      : VCM_OK, on success.
+    //                     < 0,         on error.
+    virtual int32_t RegisterLateFrameCallback(
+        VCMLateFrameCallback* lateFrames) = 0;
+
+    // Enables dropping of frames which can no longer be decoded and rendered
+    // in time instead of decoding them. Only frames marked as non-reference
+    // are dropped, since no later frame depends on them; late reference
+    // frames are still decoded. Disabled by default.
+    virtual void SetSkipLateFrames(bool enable) = 0;
 };
 
 }  // namespace webrtc
@@ -63,6 +63,22 @@ struct VCMFrameCount {
   uint32_t numDeltaFrames;
 };
 
+// Frames which were extracted for decoding after they could be decoded and
+// rendered in time.
+struct VCMLateFrameCount {
+  VCMLateFrameCount()
+      : num_skipped_frames(0),
+        num_late_decoded_frames(0),
+        decode_time_saved_ms(0) {}
+
+  // Non-reference frames which were dropped instead of decoded.
+  uint32_t num_skipped_frames;
+  // Frames which were decoded anyway, since later frames depend on them.
+  uint32_t num_late_decoded_frames;
+  // The estimated decode time of the skipped frames.
+  uint32_t decode_time_saved_ms;
+};
+
 // Callback class used for sending data ready to be packetized
 class VCMPacketizationCallback {
  public:
@@ -200,6 +216,30 @@ class VCMRenderBufferSizeCallback {
   }
 };
 
+// Callback class used for informing the user of the frames which the
+// receiver got too late to render, which can be fed back to the sender as a
+// sign that the receiver can't keep up with the frame rate.
+class VCMLateFrameCallback {
+ public:
+  virtual void OnLateFrameCount(const VCMLateFrameCount& late_frames) = 0;
+
+ protected:
+  virtual ~VCMLateFrameCallback() {
+  }
+};
+
+// Callback class used for telling the user that a frame has become
+// decodable, and when it is to be rendered. Called on the thread inserting
+// packets.
+class VCMFrameReadyCallback {
+ public:
+  virtual void FrameReady(int64_t render_time_ms) = 0;
+
+ protected:
+  virtual ~VCMFrameReadyCallback() {
+  }
+};
+
 }  // namespace webrtc
 
 #endif // WEBRTC_MODULES_INTERFACE_VIDEO_CODING_DEFINES_H_
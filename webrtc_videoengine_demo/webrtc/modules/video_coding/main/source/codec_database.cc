@@ -119,6 +119,7 @@ bool VCMCodecDataBase::Codec(int list_id,
       settings->codecSpecific.H264.profile = kProfileBase;
       settings->codecSpecific.H264.frameDroppingOn = true;
       settings->codecSpecific.H264.keyFrameInterval = 3000;
+      settings->codecSpecific.H264.complexity = kComplexityNormal;
       settings->codecSpecific.H264.spsData = NULL;
       settings->codecSpecific.H264.spsLen = 0;
       settings->codecSpecific.H264.ppsData = NULL;
@@ -0,0 +1,223 @@
+/*
+ *  Copyright (c) 2014 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/video_coding/main/source/decode_thread_pool_impl.h"
+
+#include <algorithm>
+
+#include "webrtc/modules/video_coding/main/interface/video_coding.h"
+#include "webrtc/system_wrappers/interface/cpu_info.h"
+#include "webrtc/system_wrappers/interface/logging.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+#include "webrtc/system_wrappers/interface/trace_event.h"
+
+namespace webrtc {
+
+DecodeThreadPool* DecodeThreadPool::Create(int max_threads) {
+  const int num_cores = static_cast<int>(CpuInfo::DetectNumberOfCores());
+  int num_threads = num_cores;
+  if (max_threads > 0)
+    num_threads = std::min(max_threads, num_cores);
+  return new DecodeThreadPoolImpl(std::max(num_threads, 1));
+}
+
+void DecodeThreadPool::Destroy(DecodeThreadPool* pool) {
+  delete pool;
+}
+
+DecodeThreadPoolImpl::Channel::Channel(DecodeThreadPoolImpl* pool,
+                                       VideoCodingModule* module)
+    : pool(pool),
+      module(module),
+      ready(false),
+      render_time_ms(0),
+      decoding(false),
+      next_poll_ms(0) {}
+
+void DecodeThreadPoolImpl::Channel::FrameReady(int64_t render_time_ms) {
+  pool->FrameReady(this, render_time_ms);
+}
+
+DecodeThreadPoolImpl::DecodeThreadPoolImpl(int num_threads)
+    : num_threads_(num_threads),
+      crit_sect_(CriticalSectionWrapper::CreateCriticalSection()),
+      wake_up_(ConditionVariableWrapper::CreateConditionVariable()),
+      running_(false) {}
+
+DecodeThreadPoolImpl::~DecodeThreadPoolImpl() {
+  Stop();
+  for (size_t i = 0; i < channels_.size(); ++i) {
+    channels_[i]->module->RegisterFrameReadyCallback(NULL);
+    delete channels_[i];
+  }
+}
+
+int32_t DecodeThreadPoolImpl::Start() {
+  {
+    CriticalSectionScoped cs(crit_sect_.get());
+    if (running_)
+      return -1;
+    running_ = true;
+  }
+  for (int i = 0; i < num_threads_; ++i) {
+    ThreadWrapper* thread = ThreadWrapper::CreateThread(
+        Run, this, kHighestPriority, "DecodingThread");
+    unsigned int id;
+    if (thread == NULL || !thread->Start(id)) {
+      LOG(LS_ERROR) << "Failed to start decode thread " << i << ".";
+      delete thread;
+      Stop();
+      return -1;
+    }
+    threads_.push_back(thread);
+  }
+  return 0;
+}
+
+int32_t DecodeThreadPoolImpl::Stop() {
+  {
+    CriticalSectionScoped cs(crit_sect_.get());
+    running_ = false;
+  }
+  wake_up_->WakeAll();
+  int32_t ret = 0;
+  for (size_t i = 0; i < threads_.size(); ++i) {
+    threads_[i]->SetNotAlive();
+    if (!threads_[i]->Stop())
+      ret = -1;
+  }
+  threads_.clear();
+  return ret;
+}
+
+int32_t DecodeThreadPoolImpl::RegisterModule(VideoCodingModule* module) {
+  Channel* channel = NULL;
+  {
+    CriticalSectionScoped cs(crit_sect_.get());
+    for (size_t i = 0; i < channels_.size(); ++i) {
+      if (channels_[i]->module == module)
+        return -1;
+    }
+    channel = new Channel(this, module);
+    channels_.push_back(channel);
+  }
+  // Not under |crit_sect_|, which the callback takes with the lock of the
+  // module held.
+  module->RegisterFrameReadyCallback(channel);
+  wake_up_->Wake();
+  return 0;
+}
+
+int32_t DecodeThreadPoolImpl::DeRegisterModule(VideoCodingModule* module) {
+  Channel* channel = NULL;
+  {
+    CriticalSectionScoped cs(crit_sect_.get());
+    for (size_t i = 0; i < channels_.size(); ++i) {
+      if (channels_[i]->module == module)
+        channel = channels_[i];
+    }
+    if (channel == NULL)
+      return -1;
+  }
+  module->RegisterFrameReadyCallback(NULL);
+
+  CriticalSectionScoped cs(crit_sect_.get());
+  while (channel->decoding)
+    wake_up_->SleepCS(*crit_sect_);
+  channels_.erase(std::find(channels_.begin(), channels_.end(), channel));
+  delete channel;
+  return 0;
+}
+
+bool DecodeThreadPoolImpl::Run(void* obj) {
+  return static_cast<DecodeThreadPoolImpl*>(obj)->Process();
+}
+
+bool DecodeThreadPoolImpl::Process() {
+  Channel* channel = NULL;
+  {
+    CriticalSectionScoped cs(crit_sect_.get());
+    while (running_) {
+      int wait_ms = 0;
+      channel = NextChannel(TickTime::MillisecondTimestamp(), &wait_ms);
+      if (channel != NULL)
+        break;
+      wake_up_->SleepCS(*crit_sect_, wait_ms);
+    }
+    if (!running_)
+      return false;
+    channel->decoding = true;
+    channel->ready = false;
+  }
+
+  const int32_t ret = channel->module->Decode(0);
+
+  {
+    CriticalSectionScoped cs(crit_sect_.get());
+    channel->decoding = false;
+    if (ret == VCM_OK) {
+      // There may be more frames ready, which are at least as late as this
+      // one was.
+      channel->ready = true;
+    } else {
+      channel->next_poll_ms =
+          TickTime::MillisecondTimestamp() + kPollIntervalMs;
+    }
+  }
+  // Wakes another thread for the channel, and DeRegisterModule().
+  wake_up_->WakeAll();
+  return true;
+}
+
+void DecodeThreadPoolImpl::FrameReady(Channel* channel,
+                                      int64_t render_time_ms) {
+  {
+    CriticalSectionScoped cs(crit_sect_.get());
+    if (!channel->ready || render_time_ms < channel->render_time_ms)
+      channel->render_time_ms = render_time_ms;
+    channel->ready = true;
+    if (channel->decoding)
+      return;
+  }
+  wake_up_->Wake();
+}
+
+DecodeThreadPoolImpl::Channel* DecodeThreadPoolImpl::NextChannel(
+    int64_t now_ms, int* wait_ms) {
+  Channel* next_ready = NULL;
+  Channel* next_poll = NULL;
+  for (size_t i = 0; i < channels_.size(); ++i) {
+    Channel* channel = channels_[i];
+    if (channel->decoding)
+      continue;
+    if (channel->ready) {
+      if (next_ready == NULL ||
+          channel->render_time_ms < next_ready->render_time_ms) {
+        next_ready = channel;
+      }
+    } else if (next_poll == NULL ||
+               channel->next_poll_ms < next_poll->next_poll_ms) {
+      next_poll = channel;
+    }
+  }
+  if (next_ready != NULL) {
+    TRACE_EVENT_INSTANT1("webrtc", "DecodeThreadPool::NextChannel",
+                         "render_time_ms", next_ready->render_time_ms);
+    return next_ready;
+  }
+  if (next_poll != NULL && next_poll->next_poll_ms <= now_ms)
+    return next_poll;
+  *wait_ms = kPollIntervalMs;
+  if (next_poll != NULL)
+    *wait_ms = static_cast<int>(next_poll->next_poll_ms - now_ms);
+  return NULL;
+}
+
+}  // namespace webrtc
@@ -0,0 +1,81 @@
+/*
+ *  Copyright (c) 2014 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_VIDEO_CODING_MAIN_SOURCE_DECODE_THREAD_POOL_IMPL_H_
+#define WEBRTC_MODULES_VIDEO_CODING_MAIN_SOURCE_DECODE_THREAD_POOL_IMPL_H_
+
+#include <vector>
+
+#include "webrtc/modules/video_coding/main/interface/decode_thread_pool.h"
+#include "webrtc/modules/video_coding/main/interface/video_coding_defines.h"
+#include "webrtc/system_wrappers/interface/condition_variable_wrapper.h"
+#include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/system_wrappers/interface/scoped_vector.h"
+#include "webrtc/system_wrappers/interface/thread_annotations.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
+
+namespace webrtc {
+
+class DecodeThreadPoolImpl : public DecodeThreadPool {
+ public:
+  explicit DecodeThreadPoolImpl(int num_threads);
+  virtual ~DecodeThreadPoolImpl();
+
+  virtual int32_t Start() OVERRIDE;
+  virtual int32_t Stop() OVERRIDE;
+
+  virtual int NumThreads() const OVERRIDE { return num_threads_; }
+
+  virtual int32_t RegisterModule(VideoCodingModule* module) OVERRIDE;
+  virtual int32_t DeRegisterModule(VideoCodingModule* module) OVERRIDE;
+
+ private:
+  // A registered module, which tells the pool through this callback that it
+  // has a frame ready.
+  class Channel : public VCMFrameReadyCallback {
+   public:
+    Channel(DecodeThreadPoolImpl* pool, VideoCodingModule* module);
+
+    virtual void FrameReady(int64_t render_time_ms) OVERRIDE;
+
+    DecodeThreadPoolImpl* const pool;
+    VideoCodingModule* const module;
+    // Set when a frame is ready, until the module is decoded. The earliest
+    // render time signaled since is kept in |render_time_ms|.
+    bool ready;
+    int64_t render_time_ms;
+    bool decoding;
+    int64_t next_poll_ms;
+  };
+
+  static bool Run(void* obj);
+  bool Process();
+
+  void FrameReady(Channel* channel, int64_t render_time_ms);
+
+  // Returns the channel to decode next: the ready one with the earliest
+  // render time, else one due to be polled. Returns NULL and sets |wait_ms|
+  // to the time until the next poll if there is none.
+  Channel* NextChannel(int64_t now_ms, int* wait_ms)
+      EXCLUSIVE_LOCKS_REQUIRED(crit_sect_);
+
+  const int num_threads_;
+  scoped_ptr<CriticalSectionWrapper> crit_sect_;
+  // Signaled when a channel becomes ready or is done being decoded.
+  scoped_ptr<ConditionVariableWrapper> wake_up_;
+  std::vector<Channel*> channels_ GUARDED_BY(crit_sect_);
+  ScopedVector<ThreadWrapper> threads_;
+  bool running_ GUARDED_BY(crit_sect_);
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_VIDEO_CODING_MAIN_SOURCE_DECODE_THREAD_POOL_IMPL_H_
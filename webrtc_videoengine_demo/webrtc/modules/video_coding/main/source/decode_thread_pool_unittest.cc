@@ -0,0 +1,330 @@
+/*
+ *  Copyright (c) 2014 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/modules/video_coding/codecs/interface/video_codec_interface.h"
+#include "webrtc/modules/video_coding/main/interface/decode_thread_pool.h"
+#include "webrtc/modules/video_coding/main/interface/video_coding.h"
+#include "webrtc/system_wrappers/interface/clock.h"
+#include "webrtc/system_wrappers/interface/cpu_info.h"
+#include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/system_wrappers/interface/scoped_vector.h"
+#include "webrtc/system_wrappers/interface/sleep.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+
+namespace webrtc {
+
+namespace {
+
+const int kFrameIntervalMs = 33;
+
+// Spends |decode_time_ms| of CPU time on each frame, and counts the frames
+// decoded after their render time.
+class FakeDecoder : public VideoDecoder {
+ public:
+  FakeDecoder(int decode_time_ms, CriticalSectionWrapper* crit_sect,
+              std::vector<FakeDecoder*>* decode_order)
+      : decode_time_ms_(decode_time_ms),
+        crit_sect_(crit_sect),
+        decode_order_(decode_order),
+        callback_(NULL),
+        num_decoded_(0),
+        num_late_(0),
+        last_timestamp_(0),
+        in_order_(true) {
+    frame_.CreateEmptyFrame(16, 16, 16, 8, 8);
+  }
+
+  virtual int32_t InitDecode(const VideoCodec* codec_settings,
+                             int32_t number_of_cores) OVERRIDE {
+    return WEBRTC_VIDEO_CODEC_OK;
+  }
+
+  virtual int32_t Decode(const EncodedImage& input_image,
+                         bool missing_frames,
+                         const RTPFragmentationHeader* fragmentation,
+                         const CodecSpecificInfo* codec_specific_info,
+                         int64_t render_time_ms) OVERRIDE {
+    const int64_t end_ms = TickTime::MillisecondTimestamp() + decode_time_ms_;
+    while (TickTime::MillisecondTimestamp() < end_ms) {
+    }
+    {
+      CriticalSectionScoped cs(crit_sect_);
+      if (num_decoded_ > 0 && input_image._timeStamp <= last_timestamp_)
+        in_order_ = false;
+      last_timestamp_ = input_image._timeStamp;
+      ++num_decoded_;
+      if (TickTime::MillisecondTimestamp() > render_time_ms)
+        ++num_late_;
+      if (decode_order_ != NULL)
+        decode_order_->push_back(this);
+    }
+    frame_.set_timestamp(input_image._timeStamp);
+    callback_->Decoded(frame_);
+    return WEBRTC_VIDEO_CODEC_OK;
+  }
+
+  virtual int32_t RegisterDecodeCompleteCallback(
+      DecodedImageCallback* callback) OVERRIDE {
+    callback_ = callback;
+    return WEBRTC_VIDEO_CODEC_OK;
+  }
+
+  virtual int32_t Release() OVERRIDE { return WEBRTC_VIDEO_CODEC_OK; }
+  virtual int32_t Reset() OVERRIDE { return WEBRTC_VIDEO_CODEC_OK; }
+
+  int num_decoded() const {
+    CriticalSectionScoped cs(crit_sect_);
+    return num_decoded_;
+  }
+  int num_late() const {
+    CriticalSectionScoped cs(crit_sect_);
+    return num_late_;
+  }
+  bool in_order() const {
+    CriticalSectionScoped cs(crit_sect_);
+    return in_order_;
+  }
+
+ private:
+  const int decode_time_ms_;
+  CriticalSectionWrapper* const crit_sect_;
+  std::vector<FakeDecoder*>* const decode_order_;
+  DecodedImageCallback* callback_;
+  I420VideoFrame frame_;
+  int num_decoded_;
+  int num_late_;
+  uint32_t last_timestamp_;
+  bool in_order_;
+};
+
+// A receive stream: a video coding module decoding with a FakeDecoder, fed
+// one packet per frame.
+class Stream {
+ public:
+  Stream(int decode_time_ms, CriticalSectionWrapper* crit_sect,
+         std::vector<FakeDecoder*>* decode_order)
+      : decoder_(decode_time_ms, crit_sect, decode_order),
+        vcm_(VideoCodingModule::Create(Clock::GetRealTimeClock(),
+                                       &event_factory_)),
+        timestamp_(0),
+        sequence_number_(0),
+        num_inserted_(0) {
+    EXPECT_EQ(VCM_OK, vcm_->InitializeReceiver());
+    EXPECT_EQ(VCM_OK, VideoCodingModule::Codec(kVideoCodecVP8, &codec_));
+    EXPECT_EQ(VCM_OK, vcm_->RegisterReceiveCodec(&codec_, 1));
+    EXPECT_EQ(VCM_OK,
+              vcm_->RegisterExternalDecoder(&decoder_, codec_.plType, true));
+  }
+  ~Stream() { VideoCodingModule::Destroy(vcm_); }
+
+  void InsertFrame() {
+    const uint8_t payload[10] = {0};
+    WebRtcRTPHeader rtp_info;
+    memset(&rtp_info, 0, sizeof(rtp_info));
+    rtp_info.frameType = timestamp_ == 0 ? kVideoFrameKey : kVideoFrameDelta;
+    rtp_info.header.timestamp = timestamp_;
+    rtp_info.header.sequenceNumber = sequence_number_++;
+    rtp_info.header.markerBit = true;
+    rtp_info.header.payloadType = codec_.plType;
+    rtp_info.type.Video.codec = kRtpVideoVp8;
+    rtp_info.type.Video.codecHeader.VP8.InitRTPVideoHeaderVP8();
+    rtp_info.type.Video.isFirstPacket = true;
+    EXPECT_EQ(VCM_OK,
+              vcm_->IncomingPacket(payload, sizeof(payload), rtp_info));
+    timestamp_ += 90 * kFrameIntervalMs;
+    ++num_inserted_;
+  }
+
+  VideoCodingModule* vcm() { return vcm_; }
+  const FakeDecoder& decoder() const { return decoder_; }
+  int num_inserted() const { return num_inserted_; }
+
+ private:
+  FakeDecoder decoder_;
+  EventFactoryImpl event_factory_;
+  VideoCodec codec_;
+  VideoCodingModule* vcm_;
+  uint32_t timestamp_;
+  uint16_t sequence_number_;
+  int num_inserted_;
+};
+
+bool WaitForDecoded(const ScopedVector<Stream>& streams, int num_frames) {
+  for (int i = 0; i < 200; ++i) {
+    bool done = true;
+    for (size_t j = 0; j < streams.size(); ++j)
+      done = done && streams[j]->decoder().num_decoded() >= num_frames;
+    if (done)
+      return true;
+    SleepMs(10);
+  }
+  return false;
+}
+
+// Decodes |stream| from a thread of its own, the way it's done without a
+// pool.
+bool DecodeThreadFunction(void* obj) {
+  static_cast<Stream*>(obj)->vcm()->Decode(50);
+  return true;
+}
+
+}  // namespace
+
+class TestDecodeThreadPool : public ::testing::Test {
+ protected:
+  TestDecodeThreadPool()
+      : crit_sect_(CriticalSectionWrapper::CreateCriticalSection()) {}
+
+  scoped_ptr<CriticalSectionWrapper> crit_sect_;
+};
+
+TEST_F(TestDecodeThreadPool, NumThreadsIsCappedAtNumberOfCores) {
+  const int num_cores = static_cast<int>(CpuInfo::DetectNumberOfCores());
+  DecodeThreadPool* pool = DecodeThreadPool::Create(0);
+  EXPECT_EQ(num_cores, pool->NumThreads());
+  DecodeThreadPool::Destroy(pool);
+  pool = DecodeThreadPool::Create(num_cores + 1);
+  EXPECT_EQ(num_cores, pool->NumThreads());
+  DecodeThreadPool::Destroy(pool);
+  pool = DecodeThreadPool::Create(1);
+  EXPECT_EQ(1, pool->NumThreads());
+  DecodeThreadPool::Destroy(pool);
+}
+
+TEST_F(TestDecodeThreadPool, DecodesAllModulesInOrder) {
+  const int kNumStreams = 4;
+  const int kNumFrames = 10;
+  ScopedVector<Stream> streams;
+  DecodeThreadPool* pool = DecodeThreadPool::Create(2);
+  for (int i = 0; i < kNumStreams; ++i) {
+    streams.push_back(new Stream(1, crit_sect_.get(), NULL));
+    EXPECT_EQ(0, pool->RegisterModule(streams[i]->vcm()));
+  }
+  EXPECT_EQ(-1, pool->RegisterModule(streams[0]->vcm()));
+  EXPECT_EQ(0, pool->Start());
+  for (int n = 0; n < kNumFrames; ++n) {
+    for (int i = 0; i < kNumStreams; ++i)
+      streams[i]->InsertFrame();
+  }
+  EXPECT_TRUE(WaitForDecoded(streams, kNumFrames));
+  for (int i = 0; i < kNumStreams; ++i) {
+    EXPECT_EQ(kNumFrames, streams[i]->decoder().num_decoded());
+    EXPECT_TRUE(streams[i]->decoder().in_order());
+    EXPECT_EQ(0, pool->DeRegisterModule(streams[i]->vcm()));
+  }
+  EXPECT_EQ(-1, pool->DeRegisterModule(streams[0]->vcm()));
+
+  // Nothing is decoded once de-registered.
+  streams[0]->InsertFrame();
+  SleepMs(3 * DecodeThreadPool::kPollIntervalMs);
+  EXPECT_EQ(kNumFrames, streams[0]->decoder().num_decoded());
+  EXPECT_EQ(0, pool->Stop());
+  DecodeThreadPool::Destroy(pool);
+}
+
+TEST_F(TestDecodeThreadPool, DecodesEarliestRenderTimeFirst) {
+  std::vector<FakeDecoder*> decode_order;
+  ScopedVector<Stream> streams;
+  for (int i = 0; i < 2; ++i)
+    streams.push_back(new Stream(1, crit_sect_.get(), &decode_order));
+  // The frames of the first stream are to be rendered later.
+  EXPECT_EQ(VCM_OK, streams[0]->vcm()->SetMinimumPlayoutDelay(200));
+  DecodeThreadPool* pool = DecodeThreadPool::Create(1);
+  for (size_t i = 0; i < streams.size(); ++i) {
+    EXPECT_EQ(0, pool->RegisterModule(streams[i]->vcm()));
+    streams[i]->InsertFrame();
+  }
+  EXPECT_EQ(0, pool->Start());
+  EXPECT_TRUE(WaitForDecoded(streams, 1));
+  ASSERT_EQ(2u, decode_order.size());
+  EXPECT_EQ(&streams[1]->decoder(), decode_order[0]);
+  EXPECT_EQ(&streams[0]->decoder(), decode_order[1]);
+  DecodeThreadPool::Destroy(pool);
+}
+
+// Prints how many simulated 720p receive streams, at 30 fps and taking
+// kDecodeTimeMs of CPU time per frame, can be decoded before frames are
+// decoded after their render time: by the pool, and by a thread per stream.
+TEST_F(TestDecodeThreadPool, DISABLED_StreamsDecodedInTime) {
+  const int kDecodeTimeMs = 5;
+  const int kDurationMs = 3000;
+  const double kMaxLateFraction = 0.01;
+  printf("%d cores, %d ms per frame\n", CpuInfo::DetectNumberOfCores(),
+         kDecodeTimeMs);
+  bool pool_in_time = true;
+  bool threads_in_time = true;
+  for (int num_streams = 1; pool_in_time || threads_in_time; ++num_streams) {
+    double late_fraction[2];
+    for (int use_pool = 0; use_pool < 2; ++use_pool) {
+      ScopedVector<Stream> streams;
+      ScopedVector<ThreadWrapper> threads;
+      DecodeThreadPool* pool = DecodeThreadPool::Create(0);
+      for (int i = 0; i < num_streams; ++i) {
+        streams.push_back(new Stream(kDecodeTimeMs, crit_sect_.get(), NULL));
+        if (use_pool) {
+          pool->RegisterModule(streams[i]->vcm());
+        } else {
+          threads.push_back(ThreadWrapper::CreateThread(
+              DecodeThreadFunction, streams[i], kHighestPriority,
+              "DecodingThread"));
+          unsigned int id;
+          threads[i]->Start(id);
+        }
+      }
+      if (use_pool)
+        pool->Start();
+      // The streams send their frames evenly spread over the frame interval.
+      const int64_t start_ms = TickTime::MillisecondTimestamp();
+      std::vector<int64_t> next_frame_ms(num_streams);
+      for (int i = 0; i < num_streams; ++i)
+        next_frame_ms[i] = start_ms + i * kFrameIntervalMs / num_streams;
+      int64_t now_ms = start_ms;
+      while (now_ms < start_ms + kDurationMs) {
+        for (int i = 0; i < num_streams; ++i) {
+          if (next_frame_ms[i] <= now_ms) {
+            streams[i]->InsertFrame();
+            next_frame_ms[i] += kFrameIntervalMs;
+          }
+        }
+        SleepMs(1);
+        now_ms = TickTime::MillisecondTimestamp();
+      }
+      DecodeThreadPool::Destroy(pool);
+      for (size_t i = 0; i < threads.size(); ++i) {
+        threads[i]->SetNotAlive();
+        threads[i]->Stop();
+      }
+      int num_frames = 0;
+      int num_in_time = 0;
+      for (int i = 0; i < num_streams; ++i) {
+        num_frames += streams[i]->num_inserted();
+        num_in_time += streams[i]->decoder().num_decoded() -
+            streams[i]->decoder().num_late();
+      }
+      late_fraction[use_pool] = 1.0 - static_cast<double>(num_in_time) /
+          num_frames;
+    }
+    printf("%2d streams: %5.1f%% late with a pool, %5.1f%% with a thread "
+           "per stream\n", num_streams, 100 * late_fraction[1],
+           100 * late_fraction[0]);
+    pool_in_time = late_fraction[1] <= kMaxLateFraction;
+    threads_in_time = late_fraction[0] <= kMaxLateFraction;
+  }
+}
+
+}  // namespace webrtc
@@ -10,6 +10,7 @@
 #include "webrtc/modules/video_coding/main/source/jitter_buffer.h"
 
 #include <assert.h>
+#include <string.h>
 
 #include <algorithm>
 #include <utility>
@@ -32,56 +33,145 @@ namespace webrtc {
 // Use this rtt if no value has been reported.
 static const uint32_t kDefaultRtt = 200;
 
-typedef std::pair<uint32_t, VCMFrameBuffer*> FrameListPair;
+bool IsKeyFrame(VCMFrameBuffer* frame) {
+  return frame->FrameType() == kVideoFrameKey;
+}
+
+bool HasNonEmptyState(VCMFrameBuffer* frame) {
+  return frame->GetState() != kStateEmpty;
+}
+
+FrameList::FrameList() : first_(0), size_(0) {
+  memset(index_, 0, sizeof(index_));
+}
+
+const FrameList::Slot& FrameList::At(int position) const {
+  int slot = first_ + position;
+  if (slot >= kMaxNumberOfFrames)
+    slot -= kMaxNumberOfFrames;
+  return ring_[slot];
+}
 
-bool IsKeyFrame(FrameListPair pair) {
-  return pair.second->FrameType() == kVideoFrameKey;
+FrameList::Slot& FrameList::At(int position) {
+  int slot = first_ + position;
+  if (slot >= kMaxNumberOfFrames)
+    slot -= kMaxNumberOfFrames;
+  return ring_[slot];
 }
 
-bool HasNonEmptyState(FrameListPair pair) {
-  return pair.second->GetState() != kStateEmpty;
+// Frame timestamps advance in steps of the frame period; Fibonacci hashing
+// spreads them over the index.
+int FrameList::IndexHome(uint32_t timestamp) const {
+  return static_cast<int>((timestamp * 0x9E3779B1u) >> 23) & (kIndexSize - 1);
+}
+
+void FrameList::AddToIndex(uint32_t timestamp, VCMFrameBuffer* frame) {
+  int slot = IndexHome(timestamp);
+  while (index_[slot].frame != NULL)
+    slot = (slot + 1) & (kIndexSize - 1);
+  index_[slot].timestamp = timestamp;
+  index_[slot].frame = frame;
+}
+
+void FrameList::RemoveFromIndex(uint32_t timestamp) {
+  int hole = IndexHome(timestamp);
+  while (index_[hole].timestamp != timestamp)
+    hole = (hole + 1) & (kIndexSize - 1);
+  // Move back the following entries that would otherwise become unreachable.
+  for (int next = (hole + 1) & (kIndexSize - 1); index_[next].frame != NULL;
+       next = (next + 1) & (kIndexSize - 1)) {
+    int home = IndexHome(index_[next].timestamp);
+    if (((next - home) & (kIndexSize - 1)) >=
+        ((next - hole) & (kIndexSize - 1))) {
+      index_[hole] = index_[next];
+      hole = next;
+    }
+  }
+  index_[hole].frame = NULL;
 }
 
 void FrameList::InsertFrame(VCMFrameBuffer* frame) {
-  insert(rbegin().base(), FrameListPair(frame->TimeStamp(), frame));
+  const uint32_t timestamp = frame->TimeStamp();
+  if (FindFrame(timestamp) != NULL)
+    return;
+  if (size_ == kMaxNumberOfFrames) {
+    assert(false);
+    return;
+  }
+  // Frames are almost always inserted last; otherwise make room by moving
+  // the newer frames one slot towards the end.
+  int position = size_;
+  while (position > 0 &&
+         IsNewerTimestamp(At(position - 1).timestamp, timestamp)) {
+    At(position) = At(position - 1);
+    --position;
+  }
+  At(position).timestamp = timestamp;
+  At(position).frame = frame;
+  ++size_;
+  AddToIndex(timestamp, frame);
 }
 
 VCMFrameBuffer* FrameList::FindFrame(uint32_t timestamp) const {
-  FrameList::const_iterator it = find(timestamp);
-  if (it == end())
-    return NULL;
-  return it->second;
+  for (int slot = IndexHome(timestamp); index_[slot].frame != NULL;
+       slot = (slot + 1) & (kIndexSize - 1)) {
+    if (index_[slot].timestamp == timestamp)
+      return index_[slot].frame;
+  }
+  return NULL;
 }
 
 VCMFrameBuffer* FrameList::PopFrame(uint32_t timestamp) {
-  FrameList::iterator it = find(timestamp);
-  if (it == end())
+  if (FindFrame(timestamp) == NULL)
     return NULL;
-  VCMFrameBuffer* frame = it->second;
-  erase(it);
+  // Frames are mostly popped for decoding, from the front.
+  int position = 0;
+  while (At(position).timestamp != timestamp)
+    ++position;
+  VCMFrameBuffer* frame = At(position).frame;
+  erase(iterator(this, position));
   return frame;
 }
 
 VCMFrameBuffer* FrameList::Front() const {
-  return begin()->second;
+  return At(0).frame;
 }
 
 VCMFrameBuffer* FrameList::Back() const {
-  return rbegin()->second;
+  return At(size_ - 1).frame;
+}
+
+FrameList::iterator FrameList::erase(iterator it) {
+  const int position = it.position_;
+  RemoveFromIndex(At(position).timestamp);
+  if (position == 0) {
+    if (++first_ == kMaxNumberOfFrames)
+      first_ = 0;
+  } else {
+    for (int i = position; i < size_ - 1; ++i)
+      At(i) = At(i + 1);
+  }
+  --size_;
+  return iterator(this, position);
+}
+
+void FrameList::clear() {
+  while (!empty())
+    erase(begin());
+  first_ = 0;
 }
 
 int FrameList::RecycleFramesUntilKeyFrame(FrameList::iterator* key_frame_it,
                                           UnorderedFrameList* free_frames) {
   int drop_count = 0;
-  FrameList::iterator it = begin();
   while (!empty()) {
     // Throw at least one frame.
-    it->second->Reset();
-    free_frames->push_back(it->second);
-    erase(it++);
+    Front()->Reset();
+    free_frames->push_back(Front());
+    erase(begin());
     ++drop_count;
-    if (it != end() && it->second->FrameType() == kVideoFrameKey) {
-      *key_frame_it = it;
+    if (!empty() && Front()->FrameType() == kVideoFrameKey) {
+      *key_frame_it = begin();
       return drop_count;
     }
   }
@@ -116,8 +206,8 @@ int FrameList::CleanUpOldOrEmptyFrames(VCMDecodingState* decoding_state,
 
 void FrameList::Reset(UnorderedFrameList* free_frames) {
   while (!empty()) {
-    begin()->second->Reset();
-    free_frames->push_back(begin()->second);
+    Front()->Reset();
+    free_frames->push_back(Front());
     erase(begin());
   }
 }
@@ -151,7 +241,7 @@ VCMJitterBuffer::VCMJitterBuffer(Clock* clock,
       nack_mode_(kNoNack),
       low_rtt_nack_threshold_ms_(-1),
       high_rtt_nack_threshold_ms_(-1),
-      missing_sequence_numbers_(SequenceNumberLessThan()),
+      missing_sequence_numbers_(),
       nack_seq_nums_(),
       max_nack_list_size_(0),
       max_packet_age_to_nack_(0),
@@ -160,6 +250,7 @@ VCMJitterBuffer::VCMJitterBuffer(Clock* clock,
       average_packets_per_frame_(0.0f),
       frame_counter_(0) {
   memset(frame_buffers_, 0, sizeof(frame_buffers_));
+  free_frames_.reserve(kMaxNumberOfFrames);
 
   for (int i = 0; i < kStartNumberOfFrames; i++) {
     frame_buffers_[i] = new VCMFrameBuffer();
@@ -234,7 +325,7 @@ void VCMJitterBuffer::CopyFrames(FrameList* to_list,
   to_list->clear();
   for (FrameList::const_iterator it = from_list.begin();
        it != from_list.end(); ++it, ++*index) {
-    frame_buffers_[*index] = new VCMFrameBuffer(*it->second);
+    frame_buffers_[*index] = new VCMFrameBuffer(**it);
     to_list->InsertFrame(frame_buffers_[*index]);
   }
 }
@@ -305,7 +396,7 @@ void VCMJitterBuffer::Flush() {
   waiting_for_completion_.timestamp = 0;
   waiting_for_completion_.latest_packet_time = -1;
   first_packet_since_reset_ = true;
-  missing_sequence_numbers_.clear();
+  missing_sequence_numbers_.Clear();
 }
 
 // Get received key and delta frames
@@ -692,7 +783,12 @@ VCMFrameBufferEnum VCMJitterBuffer::InsertPacket(const VCMPacket& packet,
   // Is the frame already in the decodable list?
   bool update_decodable_list = (previous_state != kStateDecodable &&
       previous_state != kStateComplete);
-  bool continuous = IsContinuous(*frame);
+  // Only frames which become complete or decodable are moved between the
+  // lists, so don't walk the decodable frames for the other packets.
+  bool continuous = update_decodable_list &&
+      (buffer_return == kCompleteSession ||
+       buffer_return == kDecodableSession) &&
+      IsContinuous(*frame);
   switch (buffer_return) {
     case kGeneralError:
     case kTimeStampError:
@@ -784,7 +880,7 @@ bool VCMJitterBuffer::IsContinuous(const VCMFrameBuffer& frame) const {
   decoding_state.CopyFrom(last_decoded_state_);
   for (FrameList::const_iterator it = decodable_frames_.begin();
        it != decodable_frames_.end(); ++it)  {
-    VCMFrameBuffer* decodable_frame = it->second;
+    VCMFrameBuffer* decodable_frame = *it;
     if (IsNewerTimestamp(decodable_frame->TimeStamp(), frame.TimeStamp())) {
       break;
     }
@@ -807,14 +903,14 @@ void VCMJitterBuffer::FindAndInsertContinuousFrames(
   // 2. The end of the list was reached.
   for (FrameList::iterator it = incomplete_frames_.begin();
        it != incomplete_frames_.end();)  {
-    VCMFrameBuffer* frame = it->second;
+    VCMFrameBuffer* frame = *it;
     if (IsNewerTimestamp(new_frame.TimeStamp(), frame->TimeStamp())) {
       ++it;
       continue;
     }
     if (IsContinuousInState(*frame, decoding_state)) {
       decodable_frames_.InsertFrame(frame);
-      incomplete_frames_.erase(it++);
+      it = incomplete_frames_.erase(it);
       decoding_state.SetState(frame);
     } else if (frame->TemporalId() <= 0) {
       break;
@@ -850,7 +946,7 @@ void VCMJitterBuffer::SetNackMode(VCMNackMode mode,
   CriticalSectionScoped cs(crit_sect_);
   nack_mode_ = mode;
   if (mode == kNoNack) {
-    missing_sequence_numbers_.clear();
+    missing_sequence_numbers_.Clear();
   }
   assert(low_rtt_nack_threshold_ms >= -1 && high_rtt_nack_threshold_ms >= -1);
   assert(high_rtt_nack_threshold_ms == -1 ||
@@ -921,11 +1017,11 @@ uint16_t* VCMJitterBuffer::GetNackList(uint16_t* nack_list_size,
         next_frame->FrameType() == kVideoFrameKey &&
         next_frame->HaveFirstPacket();
     if (!first_frame_is_key) {
-      bool have_non_empty_frame = decodable_frames_.end() != find_if(
+      bool have_non_empty_frame = decodable_frames_.end() != std::find_if(
           decodable_frames_.begin(), decodable_frames_.end(),
           HasNonEmptyState);
       if (!have_non_empty_frame) {
-        have_non_empty_frame = incomplete_frames_.end() != find_if(
+        have_non_empty_frame = incomplete_frames_.end() != std::find_if(
             incomplete_frames_.begin(), incomplete_frames_.end(),
             HasNonEmptyState);
       }
@@ -947,7 +1043,7 @@ uint16_t* VCMJitterBuffer::GetNackList(uint16_t* nack_list_size,
       LOG_F(LS_WARNING) << "Too long non-decodable duration: "
                         << non_continuous_incomplete_duration << " > "
                         << 90 * max_incomplete_time_ms_;
-      FrameList::reverse_iterator rit = find_if(incomplete_frames_.rbegin(),
+      FrameList::reverse_iterator rit = std::find_if(incomplete_frames_.rbegin(),
           incomplete_frames_.rend(), IsKeyFrame);
       if (rit == incomplete_frames_.rend()) {
         // Request a key frame if we don't have one already.
@@ -960,16 +1056,12 @@ uint16_t* VCMJitterBuffer::GetNackList(uint16_t* nack_list_size,
         // Note that the estimated low sequence number is correct for VP8
         // streams because only the first packet of a key frame is marked.
         last_decoded_state_.Reset();
-        DropPacketsFromNackList(EstimatedLowSequenceNumber(*rit->second));
+        DropPacketsFromNackList(EstimatedLowSequenceNumber(**rit));
       }
     }
   }
-  unsigned int i = 0;
-  SequenceNumberSet::iterator it = missing_sequence_numbers_.begin();
-  for (; it != missing_sequence_numbers_.end(); ++it, ++i) {
-    nack_seq_nums_[i] = *it;
-  }
-  *nack_list_size = i;
+  *nack_list_size = missing_sequence_numbers_.BuildNackList(
+      &nack_seq_nums_[0], static_cast<int>(nack_seq_nums_.size()));
   return &nack_seq_nums_[0];
 }
 
@@ -999,10 +1091,12 @@ bool VCMJitterBuffer::UpdateNackList(uint16_t sequence_number) {
   if (IsNewerSequenceNumber(sequence_number,
                             latest_received_sequence_number_)) {
     // Push any missing sequence numbers to the NACK list.
-    for (uint16_t i = latest_received_sequence_number_ + 1;
-         IsNewerSequenceNumber(sequence_number, i); ++i) {
-      missing_sequence_numbers_.insert(missing_sequence_numbers_.end(), i);
-      TRACE_EVENT_INSTANT1("webrtc", "AddNack", "seqnum", i);
+    const uint16_t first_missing = latest_received_sequence_number_ + 1;
+    const uint16_t num_missing = sequence_number - first_missing;
+    if (num_missing > 0) {
+      missing_sequence_numbers_.AddMissing(first_missing, num_missing);
+      TRACE_EVENT_INSTANT2("webrtc", "AddNack", "seqnum", first_missing,
+                           "count", num_missing);
     }
     if (TooLargeNackList() && !HandleTooLargeNackList()) {
       LOG(LS_WARNING) << "Requesting key frame due to too large NACK list.";
@@ -1014,7 +1108,7 @@ bool VCMJitterBuffer::UpdateNackList(uint16_t sequence_number) {
       return false;
     }
   } else {
-    missing_sequence_numbers_.erase(sequence_number);
+    missing_sequence_numbers_.Remove(sequence_number);
     TRACE_EVENT_INSTANT1("webrtc", "RemoveNack", "seqnum", sequence_number);
   }
   return true;
@@ -1043,7 +1137,7 @@ bool VCMJitterBuffer::MissingTooOldPacket(
     return false;
   }
   const uint16_t age_of_oldest_missing_packet = latest_sequence_number -
-      *missing_sequence_numbers_.begin();
+      missing_sequence_numbers_.Oldest();
   // Recycle frames if the NACK list contains too old sequence numbers as
   // the packets may have already been dropped by the sender.
   return age_of_oldest_missing_packet > max_packet_age_to_nack_;
@@ -1052,7 +1146,7 @@ bool VCMJitterBuffer::MissingTooOldPacket(
 bool VCMJitterBuffer::HandleTooOldPackets(uint16_t latest_sequence_number) {
   bool key_frame_found = false;
   const uint16_t age_of_oldest_missing_packet = latest_sequence_number -
-      *missing_sequence_numbers_.begin();
+      missing_sequence_numbers_.Oldest();
   LOG_F(LS_WARNING) << "NACK list contains too old sequence numbers: "
                     << age_of_oldest_missing_packet << " > "
                     << max_packet_age_to_nack_;
@@ -1066,9 +1160,7 @@ void VCMJitterBuffer::DropPacketsFromNackList(
     uint16_t last_decoded_sequence_number) {
   // Erase all sequence numbers from the NACK list which we won't need any
   // longer.
-  missing_sequence_numbers_.erase(missing_sequence_numbers_.begin(),
-                                  missing_sequence_numbers_.upper_bound(
-                                      last_decoded_sequence_number));
+  missing_sequence_numbers_.RemoveUpTo(last_decoded_sequence_number);
 }
 
 int64_t VCMJitterBuffer::LastDecodedTimestamp() const {
@@ -1095,8 +1187,9 @@ VCMFrameBuffer* VCMJitterBuffer::GetEmptyFrame() {
       return NULL;
     }
   }
-  VCMFrameBuffer* frame = free_frames_.front();
-  free_frames_.pop_front();
+  // Reuse the most recently released frame, whose buffer is likely cached.
+  VCMFrameBuffer* frame = free_frames_.back();
+  free_frames_.pop_back();
   return frame;
 }
 
@@ -1134,12 +1227,12 @@ bool VCMJitterBuffer::RecycleFramesUntilKeyFrame() {
     // Reset last decoded state to make sure the next frame decoded is a key
     // frame, and start NACKing from here.
     last_decoded_state_.Reset();
-    DropPacketsFromNackList(EstimatedLowSequenceNumber(*key_frame_it->second));
+    DropPacketsFromNackList(EstimatedLowSequenceNumber(**key_frame_it));
   } else if (decodable_frames_.empty()) {
     // All frames dropped. Reset the decoding state and clear missing sequence
     // numbers as we're starting fresh.
     last_decoded_state_.Reset();
-    missing_sequence_numbers_.clear();
+    missing_sequence_numbers_.Clear();
   }
   return key_frame_found;
 }
@@ -1197,8 +1290,7 @@ void VCMJitterBuffer::CleanUpOldOrEmptyFrames() {
 
 // Must be called from within |crit_sect_|.
 bool VCMJitterBuffer::IsPacketRetransmitted(const VCMPacket& packet) const {
-  return missing_sequence_numbers_.find(packet.seqNum) !=
-      missing_sequence_numbers_.end();
+  return missing_sequence_numbers_.Contains(packet.seqNum);
 }
 
 // Must be called under the critical section |crit_sect_|. Should never be
@@ -11,9 +11,8 @@
 #ifndef WEBRTC_MODULES_VIDEO_CODING_MAIN_SOURCE_JITTER_BUFFER_H_
 #define WEBRTC_MODULES_VIDEO_CODING_MAIN_SOURCE_JITTER_BUFFER_H_
 
-#include <list>
+#include <iterator>
 #include <map>
-#include <set>
 #include <vector>
 
 #include "webrtc/base/constructormagic.h"
@@ -24,6 +23,7 @@
 #include "webrtc/modules/video_coding/main/source/inter_frame_delay.h"
 #include "webrtc/modules/video_coding/main/source/jitter_buffer_common.h"
 #include "webrtc/modules/video_coding/main/source/jitter_estimator.h"
+#include "webrtc/modules/video_coding/main/source/nack_tracker.h"
 #include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
 #include "webrtc/typedefs.h"
 
@@ -42,7 +42,7 @@ class VCMFrameBuffer;
 class VCMPacket;
 class VCMEncodedFrame;
 
-typedef std::list<VCMFrameBuffer*> UnorderedFrameList;
+typedef std::vector<VCMFrameBuffer*> UnorderedFrameList;
 
 struct VCMJitterSample {
   VCMJitterSample() : timestamp(0), frame_size(0), latest_packet_time(-1) {}
@@ -51,27 +51,99 @@ struct VCMJitterSample {
   int64_t latest_packet_time;
 };
 
-class TimestampLessThan {
+// Frames ordered by timestamp, held in a preallocated ring of
+// kMaxNumberOfFrames slots so that adding the newest frame and removing the
+// oldest never allocate or move other frames. The frames are also indexed by
+// timestamp, which makes finding the frame of an incoming packet constant
+// time. Inserting or erasing a frame invalidates all iterators.
+class FrameList {
  public:
-  bool operator() (const uint32_t& timestamp1,
-                   const uint32_t& timestamp2) const {
-    return IsNewerTimestamp(timestamp2, timestamp1);
-  }
-};
+  class iterator {
+   public:
+    typedef std::bidirectional_iterator_tag iterator_category;
+    typedef VCMFrameBuffer* value_type;
+    typedef int difference_type;
+    typedef VCMFrameBuffer* const* pointer;
+    typedef VCMFrameBuffer* reference;
+
+    iterator() : list_(NULL), position_(0) {}
+    iterator(const FrameList* list, int position)
+        : list_(list), position_(position) {}
+
+    VCMFrameBuffer* operator*() const { return list_->At(position_).frame; }
+    iterator& operator++() {
+      ++position_;
+      return *this;
+    }
+    iterator operator++(int) {
+      iterator it = *this;
+      ++position_;
+      return it;
+    }
+    iterator& operator--() {
+      --position_;
+      return *this;
+    }
+    bool operator==(const iterator& other) const {
+      return position_ == other.position_;
+    }
+    bool operator!=(const iterator& other) const {
+      return position_ != other.position_;
+    }
 
-class FrameList
-    : public std::map<uint32_t, VCMFrameBuffer*, TimestampLessThan> {
- public:
+   private:
+    friend class FrameList;
+    const FrameList* list_;
+    int position_;
+  };
+  typedef iterator const_iterator;
+  typedef std::reverse_iterator<iterator> reverse_iterator;
+
+  FrameList();
+
+  iterator begin() const { return iterator(this, 0); }
+  iterator end() const { return iterator(this, size_); }
+  reverse_iterator rbegin() const { return reverse_iterator(end()); }
+  reverse_iterator rend() const { return reverse_iterator(begin()); }
+  bool empty() const { return size_ == 0; }
+  size_t size() const { return size_; }
+
+  // Inserts |frame| in timestamp order, unless there already is a frame with
+  // its timestamp.
   void InsertFrame(VCMFrameBuffer* frame);
   VCMFrameBuffer* FindFrame(uint32_t timestamp) const;
   VCMFrameBuffer* PopFrame(uint32_t timestamp);
   VCMFrameBuffer* Front() const;
   VCMFrameBuffer* Back() const;
+  // Removes the frame at |it|. Returns an iterator to the frame after it.
+  iterator erase(iterator it);
+  void clear();
   int RecycleFramesUntilKeyFrame(FrameList::iterator* key_frame_it,
       UnorderedFrameList* free_frames);
   int CleanUpOldOrEmptyFrames(VCMDecodingState* decoding_state,
       UnorderedFrameList* free_frames);
   void Reset(UnorderedFrameList* free_frames);
+
+ private:
+  // A frame and the timestamp it was inserted with, which the frame itself
+  // loses if it is reset while in the list.
+  struct Slot {
+    uint32_t timestamp;
+    VCMFrameBuffer* frame;
+  };
+  // Slots of the timestamp index; at most kMaxNumberOfFrames are used.
+  enum { kIndexSize = 512 };
+
+  const Slot& At(int position) const;
+  Slot& At(int position);
+  int IndexHome(uint32_t timestamp) const;
+  void AddToIndex(uint32_t timestamp, VCMFrameBuffer* frame);
+  void RemoveFromIndex(uint32_t timestamp);
+
+  Slot ring_[kMaxNumberOfFrames];
+  int first_;
+  int size_;
+  Slot index_[kIndexSize];
 };
 
 class VCMJitterBuffer {
@@ -182,15 +254,6 @@ class VCMJitterBuffer {
   void RenderBufferSize(uint32_t* timestamp_start, uint32_t* timestamp_end);
 
  private:
-  class SequenceNumberLessThan {
-   public:
-    bool operator() (const uint16_t& sequence_number1,
-                     const uint16_t& sequence_number2) const {
-      return IsNewerSequenceNumber(sequence_number2, sequence_number1);
-    }
-  };
-  typedef std::set<uint16_t, SequenceNumberLessThan> SequenceNumberSet;
-
   // Gets the frame assigned to the timestamp of the packet. May recycle
   // existing frames if no free frames are available. Returns an error code if
   // failing, or kNoError on success.
@@ -319,7 +382,7 @@ class VCMJitterBuffer {
   int low_rtt_nack_threshold_ms_;
   int high_rtt_nack_threshold_ms_;
   // Holds the internal NACK list (the missing sequence numbers).
-  SequenceNumberSet missing_sequence_numbers_;
+  VCMNackTracker missing_sequence_numbers_;
   uint16_t latest_received_sequence_number_;
   std::vector<uint16_t> nack_seq_nums_;
   size_t max_nack_list_size_;
@@ -0,0 +1,181 @@
+/*
+ *  Copyright (c) 2014 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/modules/video_coding/main/source/nack_tracker.h"
+
+#include <assert.h>
+
+#include <algorithm>
+
+#include "webrtc/modules/interface/module_common_types.h"
+
+namespace webrtc {
+
+namespace {
+
+int CountBits(uint32_t word) {
+  int count = 0;
+  for (; word != 0; word &= word - 1)
+    ++count;
+  return count;
+}
+
+int CountTrailingZeros(uint32_t word) {
+  assert(word != 0);
+  int count = 0;
+  for (; (word & 1) == 0; word >>= 1)
+    ++count;
+  return count;
+}
+
+}  // namespace
+
+VCMNackTracker::VCMNackTracker()
+    : bitmap_(kInitialWindowSize / 32),
+      window_size_(kInitialWindowSize),
+      size_(0),
+      oldest_(0),
+      newest_(0) {}
+
+void VCMNackTracker::Clear() {
+  std::fill(bitmap_.begin(), bitmap_.end(), 0);
+  size_ = 0;
+  oldest_ = 0;
+  newest_ = 0;
+}
+
+void VCMNackTracker::AddMissing(uint16_t first, int count) {
+  if (count <= 0)
+    return;
+  uint16_t newest = first + count - 1;
+  if (size_ > 0 && IsNewerSequenceNumber(newest_, newest))
+    newest = newest_;
+  // Forget what falls out of the largest window.
+  const uint16_t limit = newest - (kMaxWindowSize - 1);
+  if (size_ > 0 && IsNewerSequenceNumber(limit, oldest_))
+    RemoveUpTo(limit - 1);
+  if (IsNewerSequenceNumber(limit, first)) {
+    count -= static_cast<uint16_t>(limit - first);
+    first = limit;
+    if (count <= 0)
+      return;
+  }
+  uint16_t oldest = first;
+  if (size_ > 0 && IsNewerSequenceNumber(first, oldest_))
+    oldest = oldest_;
+  const int window = static_cast<uint16_t>(newest - oldest) + 1;
+  if (window > window_size_)
+    Grow(window);
+
+  for (uint16_t sequence_number = first; count > 0;
+       ++sequence_number, --count) {
+    const int slot = Slot(sequence_number);
+    if (IsSet(slot))
+      continue;
+    bitmap_[slot >> 5] |= 1u << (slot & 31);
+    ++size_;
+  }
+  oldest_ = oldest;
+  newest_ = newest;
+}
+
+bool VCMNackTracker::Remove(uint16_t sequence_number) {
+  if (!Contains(sequence_number))
+    return false;
+  const int slot = Slot(sequence_number);
+  bitmap_[slot >> 5] &= ~(1u << (slot & 31));
+  if (--size_ == 0) {
+    Clear();
+  } else if (sequence_number == oldest_) {
+    oldest_ = NextMissing(sequence_number + 1);
+  }
+  return true;
+}
+
+void VCMNackTracker::RemoveUpTo(uint16_t sequence_number) {
+  if (size_ == 0 || IsNewerSequenceNumber(oldest_, sequence_number))
+    return;
+  if (!IsNewerSequenceNumber(newest_, sequence_number)) {
+    Clear();
+    return;
+  }
+  // Clear a word at a time; a run never crosses a word since the window is a
+  // multiple of 32.
+  uint16_t first = oldest_;
+  int count = static_cast<uint16_t>(sequence_number - oldest_) + 1;
+  while (count > 0) {
+    const int slot = Slot(first);
+    const int bit = slot & 31;
+    const int bits = std::min(32 - bit, count);
+    const uint32_t mask =
+        (bits == 32 ? 0xffffffffu : ((1u << bits) - 1)) << bit;
+    size_ -= CountBits(bitmap_[slot >> 5] & mask);
+    bitmap_[slot >> 5] &= ~mask;
+    first += bits;
+    count -= bits;
+  }
+  if (size_ == 0) {
+    Clear();
+  } else {
+    oldest_ = NextMissing(sequence_number + 1);
+  }
+}
+
+bool VCMNackTracker::Contains(uint16_t sequence_number) const {
+  if (size_ == 0 ||
+      static_cast<uint16_t>(sequence_number - oldest_) >
+          static_cast<uint16_t>(newest_ - oldest_)) {
+    return false;
+  }
+  return IsSet(Slot(sequence_number));
+}
+
+int VCMNackTracker::BuildNackList(uint16_t* nack_list, int max_size) const {
+  int length = 0;
+  uint16_t sequence_number = oldest_;
+  for (size_t i = 0; i < size_ && length < max_size; ++i) {
+    sequence_number = NextMissing(sequence_number);
+    nack_list[length++] = sequence_number;
+    ++sequence_number;
+  }
+  return length;
+}
+
+uint16_t VCMNackTracker::NextMissing(uint16_t sequence_number) const {
+  assert(size_ > 0);
+  while (true) {
+    const int slot = Slot(sequence_number);
+    const uint32_t word = bitmap_[slot >> 5] >> (slot & 31);
+    if (word != 0)
+      return sequence_number + CountTrailingZeros(word);
+    sequence_number += 32 - (slot & 31);
+  }
+}
+
+void VCMNackTracker::Grow(int window) {
+  int window_size = window_size_;
+  while (window_size < window)
+    window_size *= 2;
+  assert(window_size <= kMaxWindowSize);
+  VCMNackTracker grown;
+  grown.bitmap_.resize(window_size / 32);
+  grown.window_size_ = window_size;
+  uint16_t sequence_number = oldest_;
+  for (size_t i = 0; i < size_; ++i) {
+    sequence_number = NextMissing(sequence_number);
+    const int new_slot = grown.Slot(sequence_number);
+    grown.bitmap_[new_slot >> 5] |= 1u << (new_slot & 31);
+    ++sequence_number;
+  }
+  bitmap_.swap(grown.bitmap_);
+  window_size_ = window_size;
+}
+
+}  // namespace webrtc
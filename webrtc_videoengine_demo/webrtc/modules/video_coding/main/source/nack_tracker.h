@@ -0,0 +1,86 @@
+/*
+ *  Copyright (c) 2014 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_MODULES_VIDEO_CODING_MAIN_SOURCE_NACK_TRACKER_H_
+#define WEBRTC_MODULES_VIDEO_CODING_MAIN_SOURCE_NACK_TRACKER_H_
+
+#include <stddef.h>
+
+#include <vector>
+
+#include "webrtc/typedefs.h"
+
+namespace webrtc {
+
+// Keeps the sequence numbers of missing packets as a bitmap over a sliding
+// window, from the oldest to the newest missing sequence number. Sequence
+// numbers wrap around. When to NACK them again is left to the RTP/RTCP
+// module, which throttles the list it is given.
+//
+// The window starts out covering kInitialWindowSize sequence numbers and
+// doubles when a loss doesn't fit, up to kMaxWindowSize, beyond which the
+// oldest sequence numbers are forgotten. Marking packets missing or received
+// doesn't allocate otherwise.
+class VCMNackTracker {
+ public:
+  enum { kInitialWindowSize = 512 };
+  enum { kMaxWindowSize = 1 << 14 };
+
+  VCMNackTracker();
+
+  void Clear();
+
+  bool empty() const { return size_ == 0; }
+  // The number of missing sequence numbers.
+  size_t size() const { return size_; }
+  // The oldest missing sequence number. Must not be called when empty.
+  uint16_t Oldest() const { return oldest_; }
+
+  // Marks the |count| sequence numbers starting at |first| as missing.
+  void AddMissing(uint16_t first, int count);
+
+  // Marks |sequence_number| as received. Returns false if it wasn't missing.
+  bool Remove(uint16_t sequence_number);
+
+  // Forgets the missing sequence numbers up to and including
+  // |sequence_number|.
+  void RemoveUpTo(uint16_t sequence_number);
+
+  bool Contains(uint16_t sequence_number) const;
+
+  // Writes the missing sequence numbers to |nack_list|, oldest first.
+  // Returns the number written, at most |max_size|.
+  int BuildNackList(uint16_t* nack_list, int max_size) const;
+
+ private:
+  int Slot(uint16_t sequence_number) const {
+    return sequence_number & (window_size_ - 1);
+  }
+  bool IsSet(int slot) const {
+    return (bitmap_[slot >> 5] & (1u << (slot & 31))) != 0;
+  }
+  // Returns the first missing sequence number from |sequence_number| on.
+  // There must be one.
+  uint16_t NextMissing(uint16_t sequence_number) const;
+  // Doubles the window until it covers |window| sequence numbers.
+  void Grow(int window);
+
+  std::vector<uint32_t> bitmap_;
+  int window_size_;
+  size_t size_;
+  uint16_t oldest_;
+  // The newest sequence number marked missing since the tracker was last
+  // empty; it may have been received since.
+  uint16_t newest_;
+};
+
+}  // namespace webrtc
+
+#endif  // WEBRTC_MODULES_VIDEO_CODING_MAIN_SOURCE_NACK_TRACKER_H_
@@ -0,0 +1,212 @@
+/*
+ *  Copyright (c) 2014 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <set>
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/modules/interface/module_common_types.h"
+#include "webrtc/modules/video_coding/main/source/nack_tracker.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+
+namespace webrtc {
+
+namespace {
+
+class SequenceNumberLessThan {
+ public:
+  bool operator()(uint16_t sequence_number1, uint16_t sequence_number2) const {
+    return IsNewerSequenceNumber(sequence_number2, sequence_number1);
+  }
+};
+typedef std::set<uint16_t, SequenceNumberLessThan> SequenceNumberSet;
+
+const int kMaxNackListSize = 1000;
+
+std::vector<uint16_t> NackList(const VCMNackTracker& tracker) {
+  std::vector<uint16_t> nack_list(kMaxNackListSize);
+  nack_list.resize(tracker.BuildNackList(&nack_list[0], kMaxNackListSize));
+  return nack_list;
+}
+
+}  // namespace
+
+TEST(NackTrackerTest, Empty) {
+  VCMNackTracker tracker;
+  EXPECT_TRUE(tracker.empty());
+  EXPECT_EQ(0u, tracker.size());
+  EXPECT_FALSE(tracker.Contains(0));
+  EXPECT_FALSE(tracker.Remove(0));
+  tracker.RemoveUpTo(100);
+  EXPECT_TRUE(NackList(tracker).empty());
+}
+
+TEST(NackTrackerTest, AddAndRemoveAcrossWrap) {
+  VCMNackTracker tracker;
+  tracker.AddMissing(65530, 10);
+  EXPECT_EQ(10u, tracker.size());
+  EXPECT_EQ(65530, tracker.Oldest());
+  EXPECT_FALSE(tracker.Contains(65529));
+  EXPECT_TRUE(tracker.Contains(65535));
+  EXPECT_TRUE(tracker.Contains(3));
+  EXPECT_FALSE(tracker.Contains(4));
+
+  EXPECT_TRUE(tracker.Remove(65530));
+  EXPECT_FALSE(tracker.Remove(65530));
+  EXPECT_EQ(65531, tracker.Oldest());
+  EXPECT_TRUE(tracker.Remove(0));
+  EXPECT_EQ(8u, tracker.size());
+
+  // Removes 65531 to 65535 and 1.
+  tracker.RemoveUpTo(1);
+  EXPECT_EQ(2u, tracker.size());
+  EXPECT_EQ(2, tracker.Oldest());
+  tracker.RemoveUpTo(3);
+  EXPECT_TRUE(tracker.empty());
+}
+
+TEST(NackTrackerTest, NacksAllMissingOldestFirst) {
+  VCMNackTracker tracker;
+  tracker.AddMissing(65534, 3);
+  tracker.AddMissing(10, 1);
+  std::vector<uint16_t> nack_list = NackList(tracker);
+  ASSERT_EQ(4u, nack_list.size());
+  EXPECT_EQ(65534, nack_list[0]);
+  EXPECT_EQ(65535, nack_list[1]);
+  EXPECT_EQ(0, nack_list[2]);
+  EXPECT_EQ(10, nack_list[3]);
+  // Building the list doesn't change what is missing.
+  EXPECT_EQ(nack_list, NackList(tracker));
+}
+
+TEST(NackTrackerTest, BuildNackListRespectsMaxSize) {
+  VCMNackTracker tracker;
+  tracker.AddMissing(0, 10);
+  uint16_t nack_list[4];
+  EXPECT_EQ(4, tracker.BuildNackList(nack_list, 4));
+  EXPECT_EQ(0, nack_list[0]);
+  EXPECT_EQ(3, nack_list[3]);
+}
+
+TEST(NackTrackerTest, Grows) {
+  VCMNackTracker tracker;
+  tracker.AddMissing(65000, 1);
+  // A loss far larger than the initial window.
+  tracker.AddMissing(65001 + 100, 4 * VCMNackTracker::kInitialWindowSize);
+  EXPECT_EQ(1u + 4 * VCMNackTracker::kInitialWindowSize, tracker.size());
+  EXPECT_EQ(65000, tracker.Oldest());
+  EXPECT_FALSE(tracker.Contains(65001));
+  EXPECT_TRUE(tracker.Contains(65101));
+}
+
+TEST(NackTrackerTest, ForgetsWhatFallsOutOfTheMaxWindow) {
+  VCMNackTracker tracker;
+  tracker.AddMissing(0, 1);
+  tracker.AddMissing(VCMNackTracker::kMaxWindowSize, 1);
+  EXPECT_EQ(1u, tracker.size());
+  EXPECT_FALSE(tracker.Contains(0));
+  EXPECT_EQ(VCMNackTracker::kMaxWindowSize, tracker.Oldest());
+}
+
+// Applies the operations of the jitter buffer at random and compares the
+// tracker with the std::set it replaces.
+TEST(NackTrackerTest, MatchesSequenceNumberSet) {
+  VCMNackTracker tracker;
+  SequenceNumberSet reference;
+  uint16_t latest = 65000;
+  srand(3);
+  for (int i = 0; i < 200000; ++i) {
+    switch (rand() % 4) {
+      case 0: {
+        // Skip up to 20 packets.
+        const int count = rand() % 20;
+        tracker.AddMissing(latest + 1, count);
+        for (int j = 1; j <= count; ++j)
+          reference.insert(static_cast<uint16_t>(latest + j));
+        latest += count + 1;
+        break;
+      }
+      case 1: {
+        const uint16_t sequence_number = latest - rand() % 100;
+        ASSERT_EQ(reference.erase(sequence_number) == 1,
+                  tracker.Remove(sequence_number));
+        break;
+      }
+      case 2: {
+        const uint16_t sequence_number = latest - 50 - rand() % 100;
+        reference.erase(reference.begin(),
+                        reference.upper_bound(sequence_number));
+        tracker.RemoveUpTo(sequence_number);
+        break;
+      }
+      case 3: {
+        const uint16_t sequence_number = latest - rand() % 200;
+        ASSERT_EQ(reference.count(sequence_number) == 1,
+                  tracker.Contains(sequence_number));
+        break;
+      }
+    }
+    ASSERT_EQ(reference.size(), tracker.size());
+    if (!reference.empty()) {
+      ASSERT_EQ(*reference.begin(), tracker.Oldest());
+    }
+  }
+  std::vector<uint16_t> nack_list = NackList(tracker);
+  ASSERT_EQ(reference.size(), nack_list.size());
+  SequenceNumberSet::const_iterator it = reference.begin();
+  for (size_t i = 0; i < nack_list.size(); ++i, ++it)
+    EXPECT_EQ(*it, nack_list[i]);
+}
+
+// Prints the time it takes to track a burst loss, build the NACK list and
+// receive the retransmissions, compared with a std::set.
+TEST(NackTrackerTest, DISABLED_Benchmark) {
+  const int kBurstLengths[] = {10, 100, 400};
+  const int kIterations = 20000;
+  std::vector<uint16_t> nack_list(kMaxNackListSize);
+  for (size_t b = 0; b < sizeof(kBurstLengths) / sizeof(int); ++b) {
+    const int burst_length = kBurstLengths[b];
+    uint16_t first = 0;
+    VCMNackTracker tracker;
+    TickTime start = TickTime::Now();
+    for (int i = 0; i < kIterations; ++i) {
+      tracker.AddMissing(first, burst_length);
+      tracker.BuildNackList(&nack_list[0], kMaxNackListSize);
+      for (int j = 0; j < burst_length; ++j)
+        tracker.Remove(first + j);
+      first += burst_length + 1;
+    }
+    const int64_t tracker_us = (TickTime::Now() - start).Microseconds();
+
+    SequenceNumberSet set;
+    start = TickTime::Now();
+    for (int i = 0; i < kIterations; ++i) {
+      for (int j = 0; j < burst_length; ++j)
+        set.insert(set.end(), static_cast<uint16_t>(first + j));
+      int length = 0;
+      for (SequenceNumberSet::const_iterator it = set.begin();
+           it != set.end(); ++it) {
+        nack_list[length++] = *it;
+      }
+      for (int j = 0; j < burst_length; ++j)
+        set.erase(static_cast<uint16_t>(first + j));
+      first += burst_length + 1;
+    }
+    const int64_t set_us = (TickTime::Now() - start).Microseconds();
+    printf("Burst of %3d: %6.1f ns/packet, std::set %6.1f ns/packet\n",
+           burst_length, 1000.0 * tracker_us / (kIterations * burst_length),
+           1000.0 * set_us / (kIterations * burst_length));
+  }
+}
+
+}  // namespace webrtc
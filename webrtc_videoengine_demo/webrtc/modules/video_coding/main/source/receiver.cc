@@ -25,6 +25,18 @@ namespace webrtc {
 
 enum { kMaxReceiverDelayMs = 10000 };
 
+namespace {
+
+// Returns true if no later frame refers to |frame|, so that it can be dropped
+// without breaking the decoding of the frames which follow.
+bool IsNonReference(const VCMEncodedFrame& frame) {
+  const CodecSpecificInfo* codec_specific = frame.CodecSpecific();
+  return codec_specific->codecType == kVideoCodecVP8 &&
+      codec_specific->codecSpecific.VP8.nonReference;
+}
+
+}  // namespace
+
 VCMReceiver::VCMReceiver(VCMTiming* timing,
                          Clock* clock,
                          EventFactory* event_factory,
@@ -36,7 +48,9 @@ VCMReceiver::VCMReceiver(VCMTiming* timing,
       timing_(timing),
       render_wait_event_(event_factory->CreateEvent()),
       state_(kPassive),
-      max_video_delay_ms_(kMaxVideoDelayMs) {}
+      max_video_delay_ms_(kMaxVideoDelayMs),
+      frame_ready_callback_(NULL),
+      skip_late_frames_(false) {}
 
 VCMReceiver::~VCMReceiver() {
   render_wait_event_->Set();
@@ -92,6 +106,15 @@ int32_t VCMReceiver::InsertPacket(const VCMPacket& packet,
     // delay within the jitter estimate.
     timing_->IncomingTimestamp(packet.timestamp, clock_->TimeInMilliseconds());
   }
+  if (ret == kCompleteSession || ret == kDecodableSession) {
+    // Called with the lock held so that the callback can't be de-registered
+    // while it's running.
+    CriticalSectionScoped cs(crit_sect_);
+    if (frame_ready_callback_ != NULL) {
+      frame_ready_callback_->FrameReady(timing_->RenderTimeMs(
+          packet.timestamp, clock_->TimeInMilliseconds()));
+    }
+  }
   return VCM_OK;
 }
 
@@ -129,6 +152,7 @@ VCMEncodedFrame* VCMReceiver::FrameForDecoding(
   const int64_t now_ms = clock_->TimeInMilliseconds();
   timing_->UpdateCurrentDelay(frame_timestamp);
   next_render_time_ms = timing_->RenderTimeMs(frame_timestamp, now_ms);
+  const bool late = timing_->PastDecodeDeadline(next_render_time_ms, now_ms);
   // Check render timing.
   bool timing_error = false;
   // Assume that render timing errors are due to changes in the video stream.
@@ -197,6 +221,29 @@ VCMEncodedFrame* VCMReceiver::FrameForDecoding(
       timing_->IncomingTimestamp(frame_timestamp, last_packet_time_ms);
     }
   }
+  if (late) {
+    bool skip = false;
+    {
+      CriticalSectionScoped cs(crit_sect_);
+      skip = skip_late_frames_ && IsNonReference(*frame);
+      if (skip) {
+        ++late_frames_.num_skipped_frames;
+        late_frames_.decode_time_saved_ms +=
+            timing_->RequiredDecodeTimeMs(frame->FrameType());
+      } else {
+        ++late_frames_.num_late_decoded_frames;
+      }
+    }
+    if (skip) {
+      TRACE_EVENT_ASYNC_STEP0("webrtc", "Video", frame->TimeStamp(),
+                              "SkipLateFrame");
+      jitter_buffer_.ReleaseFrame(frame);
+      // The frame is marked as decoded, so the next one can be returned
+      // instead if it is ready.
+      return FrameForDecoding(0, next_render_time_ms, render_timing,
+                              dual_receiver);
+    }
+  }
   return frame;
 }
 
@@ -204,6 +251,22 @@ void VCMReceiver::ReleaseFrame(VCMEncodedFrame* frame) {
   jitter_buffer_.ReleaseFrame(frame);
 }
 
+void VCMReceiver::RegisterFrameReadyCallback(VCMFrameReadyCallback* callback) {
+  CriticalSectionScoped cs(crit_sect_);
+  frame_ready_callback_ = callback;
+}
+
+void VCMReceiver::SetSkipLateFrames(bool enable) {
+  CriticalSectionScoped cs(crit_sect_);
+  skip_late_frames_ = enable;
+}
+
+void VCMReceiver::LateFrameCount(VCMLateFrameCount* late_frames) const {
+  assert(late_frames);
+  CriticalSectionScoped cs(crit_sect_);
+  *late_frames = late_frames_;
+}
+
 void VCMReceiver::ReceiveStatistics(uint32_t* bitrate,
                                     uint32_t* framerate) {
   assert(bitrate);
@@ -53,6 +53,12 @@ class VCMReceiver {
                                     bool render_timing = true,
                                     VCMReceiver* dual_receiver = NULL);
   void ReleaseFrame(VCMEncodedFrame* frame);
+  // Called with the render time of a frame when it becomes decodable.
+  void RegisterFrameReadyCallback(VCMFrameReadyCallback* callback);
+  // Drops late non-reference frames in FrameForDecoding() instead of
+  // returning them.
+  void SetSkipLateFrames(bool enable);
+  void LateFrameCount(VCMLateFrameCount* late_frames) const;
   void ReceiveStatistics(uint32_t* bitrate, uint32_t* framerate);
   void ReceivedFrameCount(VCMFrameCount* frame_count) const;
   uint32_t DiscardedPackets() const;
@@ -99,6 +105,9 @@ class VCMReceiver {
   scoped_ptr<EventWrapper> render_wait_event_;
   VCMReceiverState state_;
   int max_video_delay_ms_;
+  VCMFrameReadyCallback* frame_ready_callback_;
+  bool skip_late_frames_;
+  VCMLateFrameCount late_frames_;
 
   static int32_t receiver_id_counter_;
 };
@@ -12,6 +12,7 @@
 #include <list>
 
 #include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/modules/video_coding/main/source/encoded_frame.h"
 #include "webrtc/modules/video_coding/main/source/packet.h"
 #include "webrtc/modules/video_coding/main/source/receiver.h"
 #include "webrtc/modules/video_coding/main/source/test/stream_generator.h"
@@ -79,6 +80,31 @@ class TestVCMReceiver : public ::testing::Test {
     return ret;
   }
 
+  // Inserts a single packet VP8 frame, without advancing the clock.
+  int32_t InsertVp8Frame(FrameType frame_type, bool non_reference) {
+    stream_generator_->GenerateFrame(frame_type, 1, 0,
+                                     clock_->TimeInMilliseconds());
+    VCMPacket packet;
+    EXPECT_TRUE(stream_generator_->PopPacket(&packet, 0));
+    packet.codecSpecificHeader.codec = kRtpVideoVp8;
+    packet.codecSpecificHeader.codecHeader.VP8.InitRTPVideoHeaderVP8();
+    packet.codecSpecificHeader.codecHeader.VP8.nonReference = non_reference;
+    return receiver_.InsertPacket(packet, kWidth, kHeight);
+  }
+
+  // Returns the timestamp of the next frame, decoded without waiting for its
+  // render time, or -1 if there is none.
+  int64_t DecodeNextTimestamp() {
+    int64_t render_time_ms = 0;
+    VCMEncodedFrame* frame = receiver_.FrameForDecoding(0, render_time_ms,
+                                                        true, NULL);
+    if (!frame)
+      return -1;
+    const int64_t timestamp = frame->TimeStamp();
+    receiver_.ReleaseFrame(frame);
+    return timestamp;
+  }
+
   bool DecodeNextFrame() {
     int64_t render_time_ms = 0;
     VCMEncodedFrame* frame = receiver_.FrameForDecoding(0, render_time_ms,
@@ -332,4 +358,54 @@ TEST_F(TestVCMReceiver, NonDecodableDuration_KeyFrameAfterIncompleteFrames) {
                                          &nack_list_length);
   EXPECT_EQ(kNackOk, ret);
 }
+
+TEST_F(TestVCMReceiver, SkipLateFrames_OnlyNonReference) {
+  receiver_.SetSkipLateFrames(true);
+  uint32_t timestamps[4];
+  const bool kNonReference[4] = {false, false, true, false};
+  for (int i = 0; i < 4; ++i) {
+    timestamps[i] = 90 * clock_->TimeInMilliseconds();
+    EXPECT_GE(InsertVp8Frame(i == 0 ? kVideoFrameKey : kVideoFrameDelta,
+                             kNonReference[i]), kNoError);
+    clock_->AdvanceTimeMilliseconds(kDefaultFramePeriodMs);
+  }
+  // All frames are late by now. The reference frames are still decoded.
+  EXPECT_EQ(timestamps[0], DecodeNextTimestamp());
+  EXPECT_EQ(timestamps[1], DecodeNextTimestamp());
+  EXPECT_EQ(timestamps[3], DecodeNextTimestamp());
+  EXPECT_EQ(-1, DecodeNextTimestamp());
+
+  VCMLateFrameCount late_frames;
+  receiver_.LateFrameCount(&late_frames);
+  EXPECT_EQ(1u, late_frames.num_skipped_frames);
+  EXPECT_EQ(3u, late_frames.num_late_decoded_frames);
+}
+
+TEST_F(TestVCMReceiver, SkipLateFrames_InTime) {
+  receiver_.SetSkipLateFrames(true);
+  EXPECT_GE(InsertVp8Frame(kVideoFrameKey, false), kNoError);
+  EXPECT_NE(-1, DecodeNextTimestamp());
+  clock_->AdvanceTimeMilliseconds(kDefaultFramePeriodMs);
+  EXPECT_GE(InsertVp8Frame(kVideoFrameDelta, true), kNoError);
+  EXPECT_NE(-1, DecodeNextTimestamp());
+
+  VCMLateFrameCount late_frames;
+  receiver_.LateFrameCount(&late_frames);
+  EXPECT_EQ(0u, late_frames.num_skipped_frames);
+  EXPECT_EQ(0u, late_frames.num_late_decoded_frames);
+}
+
+TEST_F(TestVCMReceiver, SkipLateFrames_Disabled) {
+  EXPECT_GE(InsertVp8Frame(kVideoFrameKey, false), kNoError);
+  clock_->AdvanceTimeMilliseconds(kDefaultFramePeriodMs);
+  EXPECT_GE(InsertVp8Frame(kVideoFrameDelta, true), kNoError);
+  clock_->AdvanceTimeMilliseconds(kDefaultFramePeriodMs);
+  EXPECT_NE(-1, DecodeNextTimestamp());
+  EXPECT_NE(-1, DecodeNextTimestamp());
+
+  VCMLateFrameCount late_frames;
+  receiver_.LateFrameCount(&late_frames);
+  EXPECT_EQ(0u, late_frames.num_skipped_frames);
+  EXPECT_EQ(2u, late_frames.num_late_decoded_frames);
+}
 }  // namespace webrtc
@@ -10,6 +10,9 @@
 
 #include "webrtc/modules/video_coding/main/source/session_info.h"
 
+#include <assert.h>
+#include <string.h>
+
 #include "webrtc/modules/video_coding/main/source/packet.h"
 #include "webrtc/system_wrappers/interface/logging.h"
 
@@ -37,7 +40,9 @@ VCMSessionInfo::VCMSessionInfo()
       empty_seq_num_low_(-1),
       empty_seq_num_high_(-1),
       first_packet_seq_num_(-1),
-      last_packet_seq_num_(-1) {
+      last_packet_seq_num_(-1),
+      frame_buffer_(NULL),
+      frame_buffer_length_(0) {
 }
 
 void VCMSessionInfo::UpdateDataPointers(const uint8_t* old_base_ptr,
@@ -47,6 +52,8 @@ void VCMSessionInfo::UpdateDataPointers(const uint8_t* old_base_ptr,
       assert(old_base_ptr != NULL && new_base_ptr != NULL);
       (*it).dataPtr = new_base_ptr + ((*it).dataPtr - old_base_ptr);
     }
+  if (frame_buffer_ != NULL)
+    frame_buffer_ = const_cast<uint8_t*>(new_base_ptr);
 }
 
 int VCMSessionInfo::LowSequenceNumber() const {
@@ -108,6 +115,8 @@ void VCMSessionInfo::Reset() {
   empty_seq_num_high_ = -1;
   first_packet_seq_num_ = -1;
   last_packet_seq_num_ = -1;
+  frame_buffer_ = NULL;
+  frame_buffer_length_ = 0;
 }
 
 int VCMSessionInfo::SessionLength() const {
@@ -124,17 +133,14 @@ int VCMSessionInfo::NumPackets() const {
 int VCMSessionInfo::InsertBuffer(uint8_t* frame_buffer,
                                  PacketIterator packet_it) {
   VCMPacket& packet = *packet_it;
-  PacketIterator it;
-
-  // Calculate the offset into the frame buffer for this packet.
-  int offset = 0;
-  for (it = packets_.begin(); it != packet_it; ++it)
-    offset += (*it).sizeBytes;
+  assert(frame_buffer_ == NULL || frame_buffer_ == frame_buffer);
+  frame_buffer_ = frame_buffer;
 
-  // Set the data pointer to pointing to the start of this packet in the
-  // frame buffer.
+  // Append the payload to what has been received so far, whatever the
+  // position of the packet in the frame.
   const uint8_t* packet_buffer = packet.dataPtr;
-  packet.dataPtr = frame_buffer + offset;
+  uint8_t* frame_buffer_ptr = frame_buffer + frame_buffer_length_;
+  packet.dataPtr = frame_buffer_ptr;
 
   // We handle H.264 STAP-A packets in a special way as we need to remove the
   // two length bytes between each NAL unit, and potentially add start codes.
@@ -144,36 +150,25 @@ int VCMSessionInfo::InsertBuffer(uint8_t* frame_buffer,
       packet.codecSpecificHeader.codecHeader.H264.stap_a) {
     size_t required_length = 0;
     const uint8_t* nalu_ptr = packet_buffer + kH264NALHeaderLengthInBytes;
-    while (nalu_ptr < packet_buffer + packet.sizeBytes) {
-      uint32_t length = BufferToUWord16(nalu_ptr);
-      required_length +=
-          length + (packet.insertStartCode ? kH264StartCodeLengthBytes : 0);
-      nalu_ptr += kLengthFieldLength + length;
-    }
-    ShiftSubsequentPackets(packet_it, required_length);
-    nalu_ptr = packet_buffer + kH264NALHeaderLengthInBytes;
-    uint8_t* frame_buffer_ptr = frame_buffer + offset;
     while (nalu_ptr < packet_buffer + packet.sizeBytes) {
       uint32_t length = BufferToUWord16(nalu_ptr);
       nalu_ptr += kLengthFieldLength;
       frame_buffer_ptr += Insert(nalu_ptr,
                                  length,
                                  packet.insertStartCode,
-                                 const_cast<uint8_t*>(frame_buffer_ptr));
+                                 frame_buffer_ptr);
+      required_length +=
+          length + (packet.insertStartCode ? kH264StartCodeLengthBytes : 0);
       nalu_ptr += length;
     }
     packet.sizeBytes = required_length;
-    return packet.sizeBytes;
+  } else {
+    packet.sizeBytes = Insert(packet_buffer,
+                              packet.sizeBytes,
+                              packet.insertStartCode,
+                              frame_buffer_ptr);
   }
-  ShiftSubsequentPackets(
-      packet_it,
-      packet.sizeBytes +
-          (packet.insertStartCode ? kH264StartCodeLengthBytes : 0));
-
-  packet.sizeBytes = Insert(packet_buffer,
-                            packet.sizeBytes,
-                            packet.insertStartCode,
-                            const_cast<uint8_t*>(packet.dataPtr));
+  frame_buffer_length_ += packet.sizeBytes;
   return packet.sizeBytes;
 }
 
@@ -193,20 +188,38 @@ size_t VCMSessionInfo::Insert(const uint8_t* buffer,
   return length;
 }
 
-void VCMSessionInfo::ShiftSubsequentPackets(PacketIterator it,
-                                            int steps_to_shift) {
-  ++it;
-  if (it == packets_.end())
-    return;
-  uint8_t* first_packet_ptr = const_cast<uint8_t*>((*it).dataPtr);
-  int shift_length = 0;
-  // Calculate the total move length and move the data pointers in advance.
-  for (; it != packets_.end(); ++it) {
-    shift_length += (*it).sizeBytes;
-    if ((*it).dataPtr != NULL)
-      (*it).dataPtr += steps_to_shift;
+void VCMSessionInfo::Linearize() {
+  // In the common case the packets arrived in order and at most the data of
+  // some has been deleted, which is closed up in place. Otherwise the
+  // payloads are gathered in a separate buffer first.
+  bool in_order = true;
+  const uint8_t* prev_ptr = NULL;
+  size_t length = 0;
+  for (PacketIteratorConst it = packets_.begin(); it != packets_.end(); ++it) {
+    if ((*it).sizeBytes == 0)
+      continue;
+    if ((*it).dataPtr < prev_ptr)
+      in_order = false;
+    prev_ptr = (*it).dataPtr;
+    length += (*it).sizeBytes;
+  }
+  uint8_t* destination = frame_buffer_;
+  if (!in_order) {
+    linearize_buffer_.resize(length);
+    destination = &linearize_buffer_[0];
+  }
+  size_t offset = 0;
+  for (PacketIterator it = packets_.begin(); it != packets_.end(); ++it) {
+    if ((*it).dataPtr == NULL)
+      continue;
+    if ((*it).sizeBytes > 0 && destination + offset != (*it).dataPtr)
+      memmove(destination + offset, (*it).dataPtr, (*it).sizeBytes);
+    (*it).dataPtr = frame_buffer_ + offset;
+    offset += (*it).sizeBytes;
   }
-  memmove(first_packet_ptr + steps_to_shift, first_packet_ptr, shift_length);
+  if (!in_order)
+    memcpy(frame_buffer_, destination, length);
+  frame_buffer_length_ = length;
 }
 
 void VCMSessionInfo::UpdateCompleteSession() {
@@ -289,8 +302,6 @@ int VCMSessionInfo::DeletePacketData(PacketIterator start,
     (*it).sizeBytes = 0;
     (*it).dataPtr = NULL;
   }
-  if (bytes_to_delete > 0)
-    ShiftSubsequentPackets(end, -bytes_to_delete);
   return bytes_to_delete;
 }
 
@@ -306,6 +317,8 @@ int VCMSessionInfo::BuildVP8FragmentationHeader(
          kMaxVP8Partitions * sizeof(uint32_t));
   if (packets_.empty())
       return new_length;
+  assert(frame_buffer == frame_buffer_);
+  Linearize();
   PacketIterator it = FindNextPartitionBeginning(packets_.begin());
   while (it != packets_.end()) {
     const int partition_id =
@@ -411,6 +424,7 @@ int VCMSessionInfo::MakeDecodable() {
     }
     prev_it = it;
   }
+  Linearize();
   return return_length;
 }
 
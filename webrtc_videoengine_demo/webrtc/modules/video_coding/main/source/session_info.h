@@ -12,6 +12,7 @@
 #define WEBRTC_MODULES_VIDEO_CODING_MAIN_SOURCE_SESSION_INFO_H_
 
 #include <list>
+#include <vector>
 
 #include "webrtc/modules/interface/module_common_types.h"
 #include "webrtc/modules/video_coding/main/interface/video_coding.h"
@@ -26,6 +27,10 @@ struct FrameData {
   float rolling_average_packets_per_frame;
 };
 
+// Assembles the packets of a frame. The payloads are appended to the frame
+// buffer in the order they arrive, so that a reordered packet doesn't move
+// the bytes of those after it, and are put in sequence number order once,
+// when the frame is made decodable.
 class VCMSessionInfo {
  public:
   VCMSessionInfo();
@@ -55,14 +60,15 @@ class VCMSessionInfo {
 
   // Builds fragmentation headers for VP8, each fragment being a decodable
   // VP8 partition. Returns the total number of bytes which are decodable. Is
-  // used instead of MakeDecodable for VP8.
+  // used instead of MakeDecodable for VP8. Puts the payloads in |frame_buffer|
+  // in sequence number order first.
   int BuildVP8FragmentationHeader(uint8_t* frame_buffer,
                                   int frame_buffer_length,
                                   RTPFragmentationHeader* fragmentation);
 
   // Makes the frame decodable. I.e., only contain decodable NALUs. All
-  // non-decodable NALUs will be deleted and packets will be moved to in
-  // memory to remove any empty space.
+  // non-decodable NALUs will be deleted and the remaining packets are moved
+  // in memory, in sequence number order and without any empty space.
   // Returns the number of bytes deleted from the session.
   int MakeDecodable();
 
@@ -114,16 +120,21 @@ class VCMSessionInfo {
   PacketIterator FindPartitionEnd(PacketIterator it) const;
   static bool InSequence(const PacketIterator& it,
                          const PacketIterator& prev_it);
+  // Appends the payload of the packet pointed to by |packetIterator| to the
+  // data already in |frame_buffer|.
   int InsertBuffer(uint8_t* frame_buffer,
                    PacketIterator packetIterator);
   size_t Insert(const uint8_t* buffer,
                 size_t length,
                 bool insert_start_code,
                 uint8_t* frame_buffer);
-  void ShiftSubsequentPackets(PacketIterator it, int steps_to_shift);
+  // Moves the payloads to the beginning of the frame buffer in sequence
+  // number order, leaving out those of deleted packets.
+  void Linearize();
   PacketIterator FindNaluEnd(PacketIterator packet_iter) const;
   // Deletes the data of all packets between |start| and |end|, inclusively.
-  // Note that this function doesn't delete the actual packets.
+  // Note that this function doesn't delete the actual packets, nor moves the
+  // data of other packets; Linearize() does.
   int DeletePacketData(PacketIterator start,
                        PacketIterator end);
   void UpdateCompleteSession();
@@ -163,6 +174,13 @@ class VCMSessionInfo {
   // TODO(mikhal): Refactor the list to use a map.
   int first_packet_seq_num_;
   int last_packet_seq_num_;
+
+  // The frame buffer the payloads are written to and the number of bytes
+  // written, including those of deleted packets until the next Linearize().
+  uint8_t* frame_buffer_;
+  size_t frame_buffer_length_;
+  // Used by Linearize() when the payloads arrived out of order.
+  std::vector<uint8_t> linearize_buffer_;
 };
 
 }  // namespace webrtc
@@ -193,6 +193,17 @@ uint32_t VCMTiming::MaxWaitingTime(int64_t render_time_ms, int64_t now_ms)
   return static_cast<uint32_t>(max_wait_time_ms);
 }
 
+bool VCMTiming::PastDecodeDeadline(int64_t render_time_ms, int64_t now_ms)
+    const {
+  CriticalSectionScoped cs(crit_sect_);
+  return render_time_ms - MaxDecodeTimeMs() - render_delay_ms_ < now_ms;
+}
+
+int32_t VCMTiming::RequiredDecodeTimeMs(FrameType frame_type) const {
+  CriticalSectionScoped cs(crit_sect_);
+  return MaxDecodeTimeMs(frame_type);
+}
+
 bool VCMTiming::EnoughTimeToDecode(uint32_t available_processing_time_ms)
     const {
   CriticalSectionScoped cs(crit_sect_);
@@ -73,6 +73,14 @@ class VCMTiming {
   // complete before we must pass it to the decoder.
   uint32_t MaxWaitingTime(int64_t render_time_ms, int64_t now_ms) const;
 
+  // Returns true if a frame which is to be rendered at render_time_ms can no
+  // longer be decoded and rendered in time at now_ms.
+  bool PastDecodeDeadline(int64_t render_time_ms, int64_t now_ms) const;
+
+  // Returns the time in ms a frame of frame_type is expected to take to
+  // decode.
+  int32_t RequiredDecodeTimeMs(FrameType frame_type) const;
+
   // Returns the current target delay which is required delay + decode time +
   // render delay.
   uint32_t TargetVideoDelay() const;
@@ -143,4 +143,26 @@ TEST(ReceiverTiming, WrapAround) {
   }
 }
 
+TEST(ReceiverTiming, PastDecodeDeadline) {
+  const int kDecodeTimeMs = 10;
+  const int kRenderDelayMs = 10;
+  SimulatedClock clock(0);
+  VCMTiming timing(&clock);
+  timing.set_render_delay(kRenderDelayMs);
+  // The first decode times aren't used for the estimate.
+  for (int i = 0; i < 10; ++i) {
+    int64_t start_time_ms = clock.TimeInMilliseconds();
+    clock.AdvanceTimeMilliseconds(kDecodeTimeMs);
+    timing.StopDecodeTimer(0, start_time_ms, clock.TimeInMilliseconds());
+  }
+  EXPECT_EQ(kDecodeTimeMs, timing.RequiredDecodeTimeMs(kVideoFrameDelta));
+
+  const int64_t render_time_ms = 1000;
+  const int64_t deadline_ms = render_time_ms - kDecodeTimeMs - kRenderDelayMs;
+  EXPECT_FALSE(timing.PastDecodeDeadline(render_time_ms, deadline_ms - 1));
+  EXPECT_FALSE(timing.PastDecodeDeadline(render_time_ms, deadline_ms));
+  EXPECT_TRUE(timing.PastDecodeDeadline(render_time_ms, deadline_ms + 1));
+  EXPECT_EQ(0u, timing.MaxWaitingTime(render_time_ms, deadline_ms + 1));
+}
+
 }  // namespace webrtc
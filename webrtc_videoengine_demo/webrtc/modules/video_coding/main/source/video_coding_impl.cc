@@ -267,6 +267,11 @@ class VideoCodingModuleImpl : public VideoCodingModule {
     return receiver_->RegisterDecoderTimingCallback(decoderTiming);
   }
 
+  virtual int32_t RegisterLateFrameCallback(
+      VCMLateFrameCallback* lateFrames) OVERRIDE {
+    return receiver_->RegisterLateFrameCallback(lateFrames);
+  }
+
   virtual int32_t RegisterFrameTypeCallback(
       VCMFrameTypeCallback* frameTypeCallback) OVERRIDE {
     return receiver_->RegisterFrameTypeCallback(frameTypeCallback);
@@ -282,6 +287,11 @@ class VideoCodingModuleImpl : public VideoCodingModule {
     return receiver_->RegisterRenderBufferSizeCallback(callback);
   }
 
+  virtual int RegisterFrameReadyCallback(
+      VCMFrameReadyCallback* callback) OVERRIDE {
+    return receiver_->RegisterFrameReadyCallback(callback);
+  }
+
   virtual int32_t Decode(uint16_t maxWaitTimeMs) OVERRIDE {
     return receiver_->Decode(maxWaitTimeMs);
   }
@@ -340,6 +350,10 @@ class VideoCodingModuleImpl : public VideoCodingModule {
     return receiver_->SetDecodeErrorMode(decode_error_mode);
   }
 
+  virtual void SetSkipLateFrames(bool enable) OVERRIDE {
+    receiver_->SetSkipLateFrames(enable);
+  }
+
   virtual int SetMinReceiverDelay(int desired_delay_ms) OVERRIDE {
     return receiver_->SetMinReceiverDelay(desired_delay_ms);
   }
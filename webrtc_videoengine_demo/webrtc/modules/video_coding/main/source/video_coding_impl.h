@@ -148,9 +148,11 @@ class VideoReceiver {
       VCMReceiveStatisticsCallback* receiveStats);
   int32_t RegisterDecoderTimingCallback(
       VCMDecoderTimingCallback* decoderTiming);
+  int32_t RegisterLateFrameCallback(VCMLateFrameCallback* lateFrames);
   int32_t RegisterFrameTypeCallback(VCMFrameTypeCallback* frameTypeCallback);
   int32_t RegisterPacketRequestCallback(VCMPacketRequestCallback* callback);
   int RegisterRenderBufferSizeCallback(VCMRenderBufferSizeCallback* callback);
+  int RegisterFrameReadyCallback(VCMFrameReadyCallback* callback);
 
   int32_t Decode(uint16_t maxWaitTimeMs);
   int32_t DecodeDualFrame(uint16_t maxWaitTimeMs);
@@ -175,6 +177,7 @@ class VideoReceiver {
                        int max_incomplete_time_ms);
 
   void SetDecodeErrorMode(VCMDecodeErrorMode decode_error_mode);
+  void SetSkipLateFrames(bool enable);
   int SetMinReceiverDelay(int desired_delay_ms);
 
   int32_t SetReceiveChannelParameters(uint32_t rtt);
@@ -215,6 +218,7 @@ class VideoReceiver {
       GUARDED_BY(process_crit_sect_);
   VCMDecoderTimingCallback* _decoderTimingCallback
       GUARDED_BY(process_crit_sect_);
+  VCMLateFrameCallback* late_frame_callback_ GUARDED_BY(process_crit_sect_);
   VCMPacketRequestCallback* _packetRequestCallback
       GUARDED_BY(process_crit_sect_);
   VCMRenderBufferSizeCallback* render_buffer_callback_
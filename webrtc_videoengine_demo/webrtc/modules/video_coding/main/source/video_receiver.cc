@@ -38,6 +38,7 @@ VideoReceiver::VideoReceiver(Clock* clock, EventFactory* event_factory)
       _frameTypeCallback(NULL),
       _receiveStatsCallback(NULL),
       _decoderTimingCallback(NULL),
+      late_frame_callback_(NULL),
       _packetRequestCallback(NULL),
       render_buffer_callback_(NULL),
       _decoder(NULL),
@@ -108,6 +109,12 @@ int32_t VideoReceiver::Process() {
                                               render_delay_ms);
     }
 
+    if (late_frame_callback_ != NULL) {
+      VCMLateFrameCount late_frames;
+      _receiver.LateFrameCount(&late_frames);
+      late_frame_callback_->OnLateFrameCount(late_frames);
+    }
+
     // Size of render buffer.
     if (render_buffer_callback_) {
       int buffer_size_ms = _receiver.RenderBufferSizeMs();
@@ -295,6 +302,7 @@ int32_t VideoReceiver::InitializeReceiver() {
     _frameTypeCallback = NULL;
     _receiveStatsCallback = NULL;
     _decoderTimingCallback = NULL;
+    late_frame_callback_ = NULL;
     _packetRequestCallback = NULL;
     _keyRequestMode = kKeyOnError;
     _scheduleKeyRequest = false;
@@ -326,6 +334,13 @@ int32_t VideoReceiver::RegisterDecoderTimingCallback(
   return VCM_OK;
 }
 
+int32_t VideoReceiver::RegisterLateFrameCallback(
+    VCMLateFrameCallback* lateFrames) {
+  CriticalSectionScoped cs(process_crit_sect_.get());
+  late_frame_callback_ = lateFrames;
+  return VCM_OK;
+}
+
 // Register an externally defined decoder/render object.
 // Can be a decoder only or a decoder coupled with a renderer.
 int32_t VideoReceiver::RegisterExternalDecoder(VideoDecoder* externalDecoder,
@@ -365,6 +380,12 @@ int VideoReceiver::RegisterRenderBufferSizeCallback(
   return VCM_OK;
 }
 
+int VideoReceiver::RegisterFrameReadyCallback(
+    VCMFrameReadyCallback* callback) {
+  _receiver.RegisterFrameReadyCallback(callback);
+  return VCM_OK;
+}
+
 // Decode next frame, blocking.
 // Should be called as often as possible to get the most out of the decoder.
 int32_t VideoReceiver::Decode(uint16_t maxWaitTimeMs) {
@@ -782,6 +803,10 @@ void VideoReceiver::SetDecodeErrorMode(VCMDecodeErrorMode decode_error_mode) {
   _receiver.SetDecodeErrorMode(decode_error_mode);
 }
 
+void VideoReceiver::SetSkipLateFrames(bool enable) {
+  _receiver.SetSkipLateFrames(enable);
+}
+
 void VideoReceiver::SetNackSettings(size_t max_nack_list_size,
                                     int max_packet_age_to_nack,
                                     int max_incomplete_time_ms) {
@@ -11,6 +11,8 @@
 #include <vector>
 
 #include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/modules/rtp_rtcp/interface/rtp_rtcp.h"
+#include "webrtc/modules/rtp_rtcp/source/rtcp_utility.h"
 #include "webrtc/modules/video_coding/codecs/interface/mock/mock_video_codec_interface.h"
 #include "webrtc/modules/video_coding/main/interface/mock/mock_vcm_callbacks.h"
 #include "webrtc/modules/video_coding/main/interface/video_coding.h"
@@ -26,6 +28,56 @@ namespace webrtc {
 namespace vcm {
 namespace {
 
+// Sends the NACK lists of the VCM through an RTP/RTCP module, as a
+// ViEChannel does, and records the sequence numbers in each RTCP NACK.
+class RtcpNackSender : public VCMPacketRequestCallback, public Transport {
+ public:
+  explicit RtcpNackSender(Clock* clock) {
+    RtpRtcp::Configuration configuration;
+    configuration.audio = false;
+    configuration.clock = clock;
+    configuration.outgoing_transport = this;
+    rtp_rtcp_.reset(RtpRtcp::CreateRtpRtcp(configuration));
+    EXPECT_EQ(0, rtp_rtcp_->SetRTCPStatus(kRtcpCompound));
+  }
+
+  virtual int32_t ResendPackets(const uint16_t* sequence_numbers,
+                                uint16_t length) OVERRIDE {
+    return rtp_rtcp_->SendNACK(sequence_numbers, length);
+  }
+
+  virtual int SendPacket(int channel, const void* data, int len) OVERRIDE {
+    return -1;
+  }
+
+  virtual int SendRTCPPacket(int channel, const void* data, int len) OVERRIDE {
+    RTCPUtility::RTCPParserV2 parser(static_cast<const uint8_t*>(data), len,
+                                     true);
+    std::vector<uint16_t> nacked;
+    for (RTCPUtility::RTCPPacketTypes type = parser.Begin();
+         type != RTCPUtility::kRtcpNotValidCode; type = parser.Iterate()) {
+      if (type != RTCPUtility::kRtcpRtpfbNackItemCode)
+        continue;
+      const RTCPUtility::RTCPPacketRTPFBNACKItem& item =
+          parser.Packet().NACKItem;
+      nacked.push_back(item.PacketID);
+      for (int i = 0; i < 16; ++i) {
+        if (item.BitMask & (1 << i))
+          nacked.push_back(item.PacketID + i + 1);
+      }
+    }
+    if (!nacked.empty())
+      nacks_.push_back(nacked);
+    return len;
+  }
+
+  // The sequence numbers of each RTCP NACK sent.
+  std::vector<std::vector<uint16_t> > nacks_;
+
+ private:
+  scoped_ptr<RtpRtcp> rtp_rtcp_;
+};
+
 class TestVideoReceiver : public ::testing::Test {
  protected:
   static const int kUnusedPayloadType = 10;
@@ -157,6 +209,58 @@ TEST_F(TestVideoReceiver, PaddingOnlyFramesWithLosses) {
   }
 }
 
+// The VCM returns every missing packet on each process call, and the RTP/RTCP
+// module decides when to NACK them again.
+TEST_F(TestVideoReceiver, NacksThroughRtpRtcpModule) {
+  RtcpNackSender nack_sender(&clock_);
+  EXPECT_EQ(0, receiver_->SetVideoProtection(kProtectionNack, true));
+  EXPECT_EQ(0, receiver_->RegisterPacketRequestCallback(&nack_sender));
+  const unsigned int kFrameSize = 1200;
+  const unsigned int kPaddingSize = 220;
+  const uint8_t payload[kFrameSize] = {0};
+  WebRtcRTPHeader header;
+  memset(&header, 0, sizeof(header));
+  header.header.paddingLength = kPaddingSize;
+  header.header.payloadType = kUnusedPayloadType;
+  header.header.ssrc = 1;
+  header.header.headerLength = 12;
+  header.type.Video.codec = kRtpVideoVp8;
+  header.frameType = kVideoFrameKey;
+  header.type.Video.isFirstPacket = true;
+  header.header.markerBit = true;
+  EXPECT_EQ(0, receiver_->IncomingPacket(payload, kFrameSize, header));
+  ++header.header.sequenceNumber;
+
+  header.frameType = kFrameEmpty;
+  header.type.Video.isFirstPacket = false;
+  header.header.markerBit = false;
+  for (int i = 0; i < 10; ++i) {
+    clock_.AdvanceTimeMilliseconds(33);
+    header.header.timestamp += 3000;
+    // Lose 1 to 5 before the first frame, and 7 before the second one.
+    if (i == 0)
+      header.header.sequenceNumber += 5;
+    if (i == 1)
+      ++header.header.sequenceNumber;
+    EXPECT_EQ(0, receiver_->IncomingPacket(payload, 0, header));
+    ++header.header.sequenceNumber;
+    EXPECT_EQ(0, receiver_->Process());
+  }
+
+  // Each loss is NACKed as soon as it is detected. The full list is sent
+  // again each time the module's resend time (100 ms without an RTT) has
+  // passed, on the 5th and 9th process calls.
+  ASSERT_EQ(4u, nack_sender.nacks_.size());
+  const uint16_t kFirstLosses[] = {1, 2, 3, 4, 5};
+  EXPECT_EQ(std::vector<uint16_t>(kFirstLosses, kFirstLosses + 5),
+            nack_sender.nacks_[0]);
+  EXPECT_EQ(std::vector<uint16_t>(1, 7), nack_sender.nacks_[1]);
+  const uint16_t kAllLosses[] = {1, 2, 3, 4, 5, 7};
+  EXPECT_EQ(std::vector<uint16_t>(kAllLosses, kAllLosses + 6),
+            nack_sender.nacks_[2]);
+  EXPECT_EQ(nack_sender.nacks_[2], nack_sender.nacks_[3]);
+}
+
 TEST_F(TestVideoReceiver, PaddingOnlyAndVideo) {
   EXPECT_EQ(0, receiver_->SetVideoProtection(kProtectionNack, true));
   EXPECT_EQ(
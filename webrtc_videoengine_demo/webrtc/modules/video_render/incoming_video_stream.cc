@@ -100,8 +100,10 @@ int32_t IncomingVideoStream::RenderFrame(const uint32_t stream_id,
     return -1;
   }
 
-  // Mirroring is not supported if the frame is backed by a texture.
-  if (true == mirror_frames_enabled_ && video_frame.native_handle() == NULL) {
+  // Mirroring is not supported if the frame is backed by a texture or wraps
+  // planes it does not own.
+  if (true == mirror_frames_enabled_ && video_frame.native_handle() == NULL &&
+      !video_frame.IsWrapped()) {
     transformed_video_frame_.CreateEmptyFrame(video_frame.width(),
                                               video_frame.height(),
                                               video_frame.stride(kYPlane),
@@ -355,7 +357,12 @@ bool IncomingVideoStream::IncomingVideoStreamProcess() {
     // We're done with this frame, delete it.
     if (frame_to_render) {
       CriticalSectionScoped cs(&buffer_critsect_);
-      last_rendered_frame_.SwapFrame(frame_to_render);
+      // A wrapped frame has no planes of its own to swap; copy it instead.
+      if (frame_to_render->IsWrapped()) {
+        last_rendered_frame_.CopyFrame(*frame_to_render);
+      } else {
+        last_rendered_frame_.SwapFrame(frame_to_render);
+      }
       render_buffers_.ReturnFrame(frame_to_render);
     }
   }
@@ -54,7 +54,9 @@ int32_t VideoRenderFrames::AddFrame(I420VideoFrame* new_frame) {
     return -1;
   }
 
-  if (new_frame->native_handle() != NULL) {
+  // Texture and wrapped frames share their planes through CloneFrame(), which
+  // is cheaper than copying and keeps the owner's reference alive.
+  if (new_frame->native_handle() != NULL || new_frame->IsWrapped()) {
     incoming_frames_.push_back(new_frame->CloneFrame());
     return static_cast<int32_t>(incoming_frames_.size());
   }
@@ -123,8 +125,9 @@ I420VideoFrame* VideoRenderFrames::FrameToRender() {
 }
 
 int32_t VideoRenderFrames::ReturnFrame(I420VideoFrame* old_frame) {
-  // No need to reuse texture frames because they do not allocate memory.
-  if (old_frame->native_handle() == NULL) {
+  // No need to reuse texture or wrapped frames because they do not allocate
+  // memory. Deleting them releases the underlying buffers to their owner.
+  if (old_frame->native_handle() == NULL && !old_frame->IsWrapped()) {
     old_frame->ResetSize();
     old_frame->set_timestamp(0);
     old_frame->set_render_time_ms(0);
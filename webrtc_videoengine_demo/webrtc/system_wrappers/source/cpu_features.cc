@@ -48,6 +48,49 @@ static inline void __cpuid(int cpu_info[4], int info_type) {
 #endif  // WEBRTC_ARCH_X86_FAMILY
 
 #if defined(WEBRTC_ARCH_X86_FAMILY)
+// Returns true if the CPU and the OS support AVX2.
+static int HasAVX2() {
+  int cpu_info[4];
+  __cpuid(cpu_info, 0);
+  if (cpu_info[0] < 7) {
+    return 0;
+  }
+  __cpuid(cpu_info, 1);
+  // The OS must save the YMM registers, which it reports through OSXSAVE and
+  // XCR0.
+  if ((cpu_info[2] & 0x18000000) != 0x18000000) {
+    return 0;
+  }
+#if defined(_MSC_VER)
+  uint64_t xcr0 = _xgetbv(0);
+#else
+  uint32_t xcr0_low;
+  uint32_t xcr0_high;
+  __asm__ volatile("xgetbv" : "=a"(xcr0_low), "=d"(xcr0_high) : "c"(0));
+  uint64_t xcr0 = xcr0_low | (static_cast<uint64_t>(xcr0_high) << 32);
+#endif
+  if ((xcr0 & 0x6) != 0x6) {
+    return 0;
+  }
+  // Leaf 7 needs sub-leaf 0 in ecx.
+#if defined(_MSC_VER)
+  __cpuidex(cpu_info, 7, 0);
+#elif defined(__pic__) && defined(__i386__)
+  __asm__ volatile(
+    "mov %%ebx, %%edi\n"
+    "cpuid\n"
+    "xchg %%edi, %%ebx\n"
+    : "=a"(cpu_info[0]), "=D"(cpu_info[1]), "=c"(cpu_info[2]), "=d"(cpu_info[3])
+    : "a"(7), "c"(0));
+#else
+  __asm__ volatile(
+    "cpuid\n"
+    : "=a"(cpu_info[0]), "=b"(cpu_info[1]), "=c"(cpu_info[2]), "=d"(cpu_info[3])
+    : "a"(7), "c"(0));
+#endif
+  return 0 != (cpu_info[1] & 0x00000020);
+}
+
 // Actual feature detection for x86.
 static int GetCPUInfo(CPUFeature feature) {
   int cpu_info[4];
@@ -58,6 +101,9 @@ static int GetCPUInfo(CPUFeature feature) {
   if (feature == kSSE3) {
     return 0 != (cpu_info[2] & 0x00000001);
   }
+  if (feature == kAVX2) {
+    return HasAVX2();
+  }
   return 0;
 }
 #else
@@ -0,0 +1,465 @@
+/*
+ *  Copyright (c) 2014 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "webrtc/test/channel_transport/udp_socket_manager_epoll.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "webrtc/system_wrappers/interface/sleep.h"
+#include "webrtc/system_wrappers/interface/trace.h"
+#include "webrtc/test/channel_transport/udp_socket_posix.h"
+
+namespace webrtc {
+namespace test {
+
+// Upper bound on how long a reactor sleeps without being woken.
+static const int kWaitTimeoutMs = 100;
+// Batches read from one socket before moving on to the next ready one.
+static const int kMaxReadsPerSocket = 4;
+
+UdpSocketManagerEpoll::UdpSocketManagerEpoll()
+    : UdpSocketManager(),
+      _id(-1),
+      _critSect(CriticalSectionWrapper::CreateCriticalSection()),
+      _numberOfReactors(0),
+      _reactor(),
+      _numberOfSockets()
+{
+}
+
+bool UdpSocketManagerEpoll::Init(int32_t id, uint8_t& numOfWorkThreads) {
+    CriticalSectionScoped cs(_critSect);
+    if ((_id != -1) || (_numOfWorkThreads != 0)) {
+        assert(_id != -1);
+        assert(_numOfWorkThreads != 0);
+        return false;
+    }
+
+    _id = id;
+    _numOfWorkThreads = numOfWorkThreads;
+
+    uint8_t wanted = numOfWorkThreads;
+    if(MAX_NUMBER_OF_EPOLL_REACTORS < wanted)
+    {
+        wanted = MAX_NUMBER_OF_EPOLL_REACTORS;
+    }
+    for(int i = 0; i < wanted; i++)
+    {
+        UdpSocketManagerEpollImpl* reactor = new UdpSocketManagerEpollImpl();
+        if(!reactor->Init())
+        {
+            WEBRTC_TRACE(kTraceError, kTraceTransport, _id,
+                         "UdpSocketManagerEpoll::Init() failed to create "
+                         "reactor %d, errno:%d", i, errno);
+            delete reactor;
+            break;
+        }
+        _reactor[_numberOfReactors++] = reactor;
+    }
+    return true;
+}
+
+UdpSocketManagerEpoll::~UdpSocketManagerEpoll()
+{
+    Stop();
+    WEBRTC_TRACE(kTraceDebug, kTraceTransport, _id,
+                 "UdpSocketManagerEpoll(%d)::~UdpSocketManagerEpoll()",
+                 _numberOfReactors);
+
+    for(int i = 0; i < _numberOfReactors; i++)
+    {
+        delete _reactor[i];
+    }
+    delete _critSect;
+}
+
+int32_t UdpSocketManagerEpoll::ChangeUniqueId(const int32_t id)
+{
+    _id = id;
+    return 0;
+}
+
+bool UdpSocketManagerEpoll::Start()
+{
+    WEBRTC_TRACE(kTraceDebug, kTraceTransport, _id,
+                 "UdpSocketManagerEpoll(%d)::Start()", _numberOfReactors);
+
+    CriticalSectionScoped cs(_critSect);
+    bool retVal = true;
+    for(int i = 0; i < _numberOfReactors && retVal; i++)
+    {
+        retVal = _reactor[i]->Start();
+    }
+    if(!retVal)
+    {
+        WEBRTC_TRACE(kTraceError, kTraceTransport, _id,
+                     "UdpSocketManagerEpoll(%d)::Start() error starting "
+                     "reactors", _numberOfReactors);
+    }
+    return retVal;
+}
+
+bool UdpSocketManagerEpoll::Stop()
+{
+    WEBRTC_TRACE(kTraceDebug, kTraceTransport, _id,
+                 "UdpSocketManagerEpoll(%d)::Stop()", _numberOfReactors);
+
+    CriticalSectionScoped cs(_critSect);
+    bool retVal = true;
+    for(int i = 0; i < _numberOfReactors && retVal; i++)
+    {
+        retVal = _reactor[i]->Stop();
+    }
+    if(!retVal)
+    {
+        WEBRTC_TRACE(kTraceError, kTraceTransport, _id,
+                     "UdpSocketManagerEpoll(%d)::Stop() there are still "
+                     "active reactors", _numberOfReactors);
+    }
+    return retVal;
+}
+
+bool UdpSocketManagerEpoll::AddSocket(UdpSocketWrapper* s)
+{
+    CriticalSectionScoped cs(_critSect);
+    if(_numberOfReactors == 0)
+    {
+        return false;
+    }
+
+    // Balance on the number of sockets rather than round-robin, so that
+    // reactors stay even when sockets come and go.
+    int reactor = 0;
+    for(int i = 1; i < _numberOfReactors; i++)
+    {
+        if(_numberOfSockets[i] < _numberOfSockets[reactor])
+        {
+            reactor = i;
+        }
+    }
+    if(!_reactor[reactor]->AddSocket(s))
+    {
+        WEBRTC_TRACE(kTraceError, kTraceTransport, _id,
+                     "UdpSocketManagerEpoll(%d)::AddSocket() failed to add "
+                     "socket to reactor %d", _numberOfReactors, reactor);
+        return false;
+    }
+    _numberOfSockets[reactor]++;
+    return true;
+}
+
+bool UdpSocketManagerEpoll::RemoveSocket(UdpSocketWrapper* s)
+{
+    CriticalSectionScoped cs(_critSect);
+    for(int i = 0; i < _numberOfReactors; i++)
+    {
+        if(_reactor[i]->RemoveSocket(s))
+        {
+            _numberOfSockets[i]--;
+            return true;
+        }
+    }
+    WEBRTC_TRACE(kTraceError, kTraceTransport, _id,
+                 "UdpSocketManagerEpoll(%d)::RemoveSocket() failed to remove "
+                 "socket from reactors", _numberOfReactors);
+    return false;
+}
+
+
+UdpSocketManagerEpollImpl::UdpSocketManagerEpollImpl()
+    : _thread(NULL),
+      _critSectList(CriticalSectionWrapper::CreateCriticalSection()),
+      _epollFd(-1),
+      _wakeFd(-1)
+{
+    WEBRTC_TRACE(kTraceMemory, kTraceTransport, -1,
+                 "UdpSocketManagerEpoll created");
+}
+
+UdpSocketManagerEpollImpl::~UdpSocketManagerEpollImpl()
+{
+    if(_thread != NULL)
+    {
+        delete _thread;
+    }
+
+    UpdateSocketMap();
+
+    _critSectList->Enter();
+    for (SocketMap::iterator it = _socketMap.begin();
+         it != _socketMap.end(); ++it) {
+        delete it->second.socket;
+    }
+    _socketMap.clear();
+    _critSectList->Leave();
+
+    if(_wakeFd != -1)
+    {
+        close(_wakeFd);
+    }
+    if(_epollFd != -1)
+    {
+        close(_epollFd);
+    }
+    delete _critSectList;
+
+    WEBRTC_TRACE(kTraceMemory, kTraceTransport, -1,
+                 "UdpSocketManagerEpoll deleted");
+}
+
+bool UdpSocketManagerEpollImpl::Init()
+{
+    _epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if(_epollFd == -1)
+    {
+        return false;
+    }
+    _wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(_wakeFd == -1)
+    {
+        return false;
+    }
+    // The wake event is level-triggered; Process() resets it.
+    epoll_event event;
+    event.events = EPOLLIN;
+    event.data.fd = _wakeFd;
+    if(epoll_ctl(_epollFd, EPOLL_CTL_ADD, _wakeFd, &event) == -1)
+    {
+        return false;
+    }
+
+    _thread = ThreadWrapper::CreateThread(UdpSocketManagerEpollImpl::Run,
+                                          this, kRealtimePriority,
+                                          "UdpSocketManagerEpollThread");
+    return _thread != NULL;
+}
+
+bool UdpSocketManagerEpollImpl::Start()
+{
+    unsigned int id = 0;
+    if (_thread == NULL)
+    {
+        return false;
+    }
+
+    WEBRTC_TRACE(kTraceStateInfo, kTraceTransport, -1,
+                 "Start UdpSocketManagerEpoll");
+    return _thread->Start(id);
+}
+
+bool UdpSocketManagerEpollImpl::Stop()
+{
+    if (_thread == NULL)
+    {
+        return true;
+    }
+
+    WEBRTC_TRACE(kTraceStateInfo, kTraceTransport, -1,
+                 "Stop UdpSocketManagerEpoll");
+    _thread->SetNotAlive();
+    Wake();
+    return _thread->Stop();
+}
+
+bool UdpSocketManagerEpollImpl::Run(ThreadObj obj)
+{
+    UdpSocketManagerEpollImpl* mgr =
+        static_cast<UdpSocketManagerEpollImpl*>(obj);
+    return mgr->Process();
+}
+
+bool UdpSocketManagerEpollImpl::Process()
+{
+    UpdateSocketMap();
+
+    // Don't block while sockets that weren't drained still have data.
+    const int timeoutMs = _readyList.empty() ? kWaitTimeoutMs : 0;
+    int num = epoll_wait(_epollFd, _events, kMaxEvents, timeoutMs);
+    if (num == SOCKET_ERROR)
+    {
+        if (errno != EINTR)
+        {
+            SleepMs(10);
+        }
+        return true;
+    }
+
+    for (int i = 0; i < num; ++i)
+    {
+        const SOCKET fd = _events[i].data.fd;
+        if (fd == _wakeFd)
+        {
+            uint64_t count;
+            if (read(_wakeFd, &count, sizeof(count)) < 0)
+            {
+                // Already reset by an earlier wake.
+            }
+            continue;
+        }
+        // Sockets added since the last UpdateSocketMap() may not be in the
+        // map yet; they are marked ready once they are.
+        SocketMap::iterator it = _socketMap.find(fd);
+        if (it != _socketMap.end() && !it->second.ready)
+        {
+            it->second.ready = true;
+            _readyList.push_back(fd);
+        }
+    }
+
+    ReadReadySockets();
+    return true;
+}
+
+void UdpSocketManagerEpollImpl::ReadReadySockets()
+{
+    size_t stillReady = 0;
+    for (size_t i = 0; i < _readyList.size(); ++i)
+    {
+        SocketMap::iterator it = _socketMap.find(_readyList[i]);
+        assert(it != _socketMap.end());
+        bool drained = false;
+        for (int reads = 0; reads < kMaxReadsPerSocket; ++reads)
+        {
+            if (!it->second.socket->HasIncoming(&_receiveBatch))
+            {
+                drained = true;
+                break;
+            }
+        }
+        if (drained)
+        {
+            it->second.ready = false;
+        } else {
+            // Served again after the other ready sockets.
+            _readyList[stillReady++] = _readyList[i];
+        }
+    }
+    _readyList.resize(stillReady);
+}
+
+void UdpSocketManagerEpollImpl::Wake()
+{
+    uint64_t one = 1;
+    if (write(_wakeFd, &one, sizeof(one)) < 0)
+    {
+        // The counter is already non-zero, so the reactor will wake anyway.
+    }
+}
+
+bool UdpSocketManagerEpollImpl::AddSocket(UdpSocketWrapper* s)
+{
+    UdpSocketPosix* sl = static_cast<UdpSocketPosix*>(s);
+    if(sl->GetFd() == INVALID_SOCKET)
+    {
+        return false;
+    }
+
+    // Registering here rather than on the reactor thread lets a failure be
+    // reported to the caller.
+    epoll_event event;
+    event.events = EPOLLIN | EPOLLET;
+    event.data.fd = sl->GetFd();
+    if(epoll_ctl(_epollFd, EPOLL_CTL_ADD, sl->GetFd(), &event) == -1)
+    {
+        return false;
+    }
+
+    _critSectList->Enter();
+    _addList.push_back(s);
+    _critSectList->Leave();
+    Wake();
+    return true;
+}
+
+bool UdpSocketManagerEpollImpl::RemoveSocket(UdpSocketWrapper* s)
+{
+    const SOCKET removeFD = static_cast<UdpSocketPosix*>(s)->GetFd();
+    CriticalSectionScoped cs(_critSectList);
+
+    bool found = _socketMap.find(removeFD) != _socketMap.end();
+    for (SocketList::iterator iter = _addList.begin();
+         !found && iter != _addList.end(); ++iter) {
+        found = static_cast<UdpSocketPosix*>(*iter)->GetFd() == removeFD;
+    }
+    if (!found)
+    {
+        return false;
+    }
+    _removeList.push_back(removeFD);
+    Wake();
+    return true;
+}
+
+void UdpSocketManagerEpollImpl::UpdateSocketMap()
+{
+    CriticalSectionScoped cs(_critSectList);
+
+    // Remove items in remove list.
+    for (FdList::iterator iter = _removeList.begin();
+         iter != _removeList.end(); ++iter) {
+        UdpSocketPosix* deleteSocket = NULL;
+        SOCKET removeFD = *iter;
+
+        // If the socket is in the add list it hasn't been added to the socket
+        // map yet. Just remove the socket from the add list.
+        for (SocketList::iterator addIter = _addList.begin();
+             addIter != _addList.end(); ++addIter) {
+            UdpSocketPosix* addSocket = static_cast<UdpSocketPosix*>(*addIter);
+            if(addSocket->GetFd() == removeFD)
+            {
+                deleteSocket = addSocket;
+                _addList.erase(addIter);
+                break;
+            }
+        }
+
+        SocketMap::iterator it = _socketMap.find(removeFD);
+        if(it != _socketMap.end())
+        {
+            deleteSocket = it->second.socket;
+            if(it->second.ready)
+            {
+                _readyList.erase(std::remove(_readyList.begin(),
+                                             _readyList.end(), removeFD),
+                                 _readyList.end());
+            }
+            _socketMap.erase(it);
+        }
+        if(deleteSocket)
+        {
+            // Unregister before ReadyForDeletion() closes the descriptor.
+            epoll_ctl(_epollFd, EPOLL_CTL_DEL, removeFD, NULL);
+            deleteSocket->ReadyForDeletion();
+            delete deleteSocket;
+        }
+    }
+    _removeList.clear();
+
+    // Add sockets from add list. Data that arrived before the socket made it
+    // into the map had its edge dropped by Process(), so start out ready.
+    for (SocketList::iterator iter = _addList.begin();
+         iter != _addList.end(); ++iter) {
+        UdpSocketPosix* s = static_cast<UdpSocketPosix*>(*iter);
+        SocketState state;
+        state.socket = s;
+        state.ready = true;
+        _socketMap[s->GetFd()] = state;
+        _readyList.push_back(s->GetFd());
+    }
+    _addList.clear();
+}
+
+}  // namespace test
+}  // namespace webrtc
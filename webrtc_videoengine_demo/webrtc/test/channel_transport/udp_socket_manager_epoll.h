@@ -0,0 +1,118 @@
+/*
+ *  Copyright (c) 2014 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef WEBRTC_TEST_CHANNEL_TRANSPORT_UDP_SOCKET_MANAGER_EPOLL_H_
+#define WEBRTC_TEST_CHANNEL_TRANSPORT_UDP_SOCKET_MANAGER_EPOLL_H_
+
+#include <sys/epoll.h>
+
+#include <list>
+#include <map>
+#include <vector>
+
+#include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
+#include "webrtc/system_wrappers/interface/thread_wrapper.h"
+#include "webrtc/test/channel_transport/udp_socket_manager_wrapper.h"
+#include "webrtc/test/channel_transport/udp_socket_posix.h"
+#include "webrtc/test/channel_transport/udp_socket_wrapper.h"
+
+namespace webrtc {
+namespace test {
+
+class UdpSocketManagerEpollImpl;
+#define MAX_NUMBER_OF_EPOLL_REACTORS 8
+
+// Socket manager for Linux that waits on epoll instead of select(). Each work
+// thread is a reactor with its own epoll instance; a new socket goes to the
+// reactor with the fewest sockets. Unlike UdpSocketManagerPosix it has no
+// limit on descriptor values and a wake costs O(ready sockets), not O(all).
+class UdpSocketManagerEpoll : public UdpSocketManager
+{
+public:
+    UdpSocketManagerEpoll();
+    virtual ~UdpSocketManagerEpoll();
+
+    virtual bool Init(int32_t id, uint8_t& numOfWorkThreads) OVERRIDE;
+
+    virtual int32_t ChangeUniqueId(const int32_t id) OVERRIDE;
+
+    virtual bool Start() OVERRIDE;
+    virtual bool Stop() OVERRIDE;
+
+    virtual bool AddSocket(UdpSocketWrapper* s) OVERRIDE;
+    virtual bool RemoveSocket(UdpSocketWrapper* s) OVERRIDE;
+private:
+    int32_t _id;
+    CriticalSectionWrapper* _critSect;
+    uint8_t _numberOfReactors;
+    UdpSocketManagerEpollImpl* _reactor[MAX_NUMBER_OF_EPOLL_REACTORS];
+    // Sockets added to each reactor and not yet removed.
+    int _numberOfSockets[MAX_NUMBER_OF_EPOLL_REACTORS];
+};
+
+class UdpSocketManagerEpollImpl
+{
+public:
+    UdpSocketManagerEpollImpl();
+    virtual ~UdpSocketManagerEpollImpl();
+
+    // Returns false if the epoll instance or the thread couldn't be created.
+    bool Init();
+
+    virtual bool Start();
+    virtual bool Stop();
+
+    virtual bool AddSocket(UdpSocketWrapper* s);
+    virtual bool RemoveSocket(UdpSocketWrapper* s);
+
+protected:
+    static bool Run(ThreadObj obj);
+    bool Process();
+    void UpdateSocketMap();
+    // Interrupts epoll_wait() so that list changes are picked up at once.
+    void Wake();
+    // Reads a bounded number of batches from each ready socket.
+    void ReadReadySockets();
+
+private:
+    struct SocketState
+    {
+        UdpSocketPosix* socket;
+        // True while the socket may have datagrams left to read. Readiness
+        // is edge-triggered, so it's only reported again once new data
+        // arrives after the socket has been drained.
+        bool ready;
+    };
+    typedef std::map<SOCKET, SocketState> SocketMap;
+    typedef std::list<UdpSocketWrapper*> SocketList;
+    typedef std::list<SOCKET> FdList;
+
+    enum { kMaxEvents = 64 };
+
+    ThreadWrapper* _thread;
+    CriticalSectionWrapper* _critSectList;
+
+    int _epollFd;
+    // eventfd used by Wake().
+    int _wakeFd;
+    epoll_event _events[kMaxEvents];
+    UdpReceiveBatch _receiveBatch;
+
+    SocketMap _socketMap;
+    // Sockets not yet drained, in the order they are served.
+    std::vector<SOCKET> _readyList;
+    SocketList _addList;
+    FdList _removeList;
+};
+
+}  // namespace test
+}  // namespace webrtc
+
+#endif  // WEBRTC_TEST_CHANNEL_TRANSPORT_UDP_SOCKET_MANAGER_EPOLL_H_
@@ -299,7 +299,7 @@ bool UdpSocketManagerPosixImpl::Process()
          it != _socketMap.end();
          ++it) {
       if (FD_ISSET(it->first, &_readFds)) {
-        it->second->HasIncoming();
+        it->second->HasIncoming(&_receiveBatch);
         --num;
       }
     }
@@ -20,6 +20,7 @@
 #include "webrtc/system_wrappers/interface/critical_section_wrapper.h"
 #include "webrtc/system_wrappers/interface/thread_wrapper.h"
 #include "webrtc/test/channel_transport/udp_socket_manager_wrapper.h"
+#include "webrtc/test/channel_transport/udp_socket_posix.h"
 #include "webrtc/test/channel_transport/udp_socket_wrapper.h"
 
 namespace webrtc {
@@ -28,7 +29,6 @@ class ConditionVariableWrapper;
 
 namespace test {
 
-class UdpSocketPosix;
 class UdpSocketManagerPosixImpl;
 #define MAX_NUMBER_OF_SOCKET_MANAGERS_LINUX 8
 
@@ -80,6 +80,7 @@ private:
     CriticalSectionWrapper* _critSectList;
 
     fd_set _readFds;
+    UdpReceiveBatch _receiveBatch;
 
     std::map<SOCKET, UdpSocketPosix*> _socketMap;
     SocketList _addList;
@@ -15,10 +15,29 @@
 // It also uses the static UdpSocketManager object.
 // The most important property of these tests is that they do not leak memory.
 
+#if defined(WEBRTC_LINUX)
+#include <arpa/inet.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <vector>
+#endif
+
 #include "testing/gtest/include/gtest/gtest.h"
+#include "webrtc/system_wrappers/interface/atomic32.h"
+#include "webrtc/system_wrappers/interface/scoped_ptr.h"
+#include "webrtc/system_wrappers/interface/sleep.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
 #include "webrtc/system_wrappers/interface/trace.h"
 #include "webrtc/test/channel_transport/udp_socket_manager_wrapper.h"
 #include "webrtc/test/channel_transport/udp_socket_wrapper.h"
+#if defined(WEBRTC_LINUX)
+#include "webrtc/test/channel_transport/udp_socket_posix.h"
+#endif
 
 namespace webrtc {
 namespace test {
@@ -80,5 +99,358 @@ TEST(UdpSocketManager, UnremovedSocketsGetCollectedAtManagerDeletion) {
 #endif
 }
 
+#if defined(WEBRTC_LINUX)
+namespace {
+
+// Counts the datagrams delivered to one socket. Each socket is served by a
+// single work thread, so only |packets| is read while receiving.
+struct PacketReceiver {
+  PacketReceiver()
+      : latency_us_sum(0),
+        max_latency_us(0),
+        last_arrival_us(0) {}
+
+  static void OnPacket(CallbackObj obj, const int8_t* buf, int32_t len,
+                       const SocketAddress* /*from*/) {
+    PacketReceiver* receiver = static_cast<PacketReceiver*>(obj);
+    const int64_t now_us = TickTime::MicrosecondTimestamp();
+    int64_t sent_us = now_us;
+    if (len >= static_cast<int32_t>(sizeof(sent_us)))
+      memcpy(&sent_us, buf, sizeof(sent_us));
+    const int64_t latency_us = now_us - sent_us;
+    receiver->latency_us_sum += latency_us;
+    if (latency_us > receiver->max_latency_us)
+      receiver->max_latency_us = latency_us;
+    receiver->last_arrival_us = now_us;
+    ++receiver->packets;
+  }
+
+  Atomic32 packets;
+  int64_t latency_us_sum;
+  int64_t max_latency_us;
+  int64_t last_arrival_us;
+};
+
+// Creates a socket bound to an ephemeral loopback port. Returns NULL if the
+// manager refused it.
+UdpSocketWrapper* CreateBoundSocket(UdpSocketManager* mgr,
+                                    PacketReceiver* receiver,
+                                    sockaddr_in* bound_address) {
+  UdpSocketWrapper* socket = UdpSocketWrapper::CreateSocket(
+      42, mgr, receiver, &PacketReceiver::OnPacket, false, false);
+  if (socket == NULL)
+    return NULL;
+  SocketAddress address;
+  memset(&address, 0, sizeof(address));
+  address._sockaddr_in.sin_family = AF_INET;
+  address._sockaddr_in.sin_addr = htonl(INADDR_LOOPBACK);
+  EXPECT_TRUE(socket->Bind(address));
+  socklen_t length = sizeof(*bound_address);
+  getsockname(static_cast<UdpSocketPosix*>(socket)->GetFd(),
+              reinterpret_cast<sockaddr*>(bound_address), &length);
+  socket->StartReceiving();
+  return socket;
+}
+
+void SendTimestamp(int fd, const sockaddr_in& to) {
+  const int64_t now_us = TickTime::MicrosecondTimestamp();
+  sendto(fd, &now_us, sizeof(now_us), 0,
+         reinterpret_cast<const sockaddr*>(&to), sizeof(to));
+}
+
+// Waits until |receiver| has seen |packets| datagrams or a second passed.
+void WaitForPackets(PacketReceiver* receiver, int packets) {
+  for (int i = 0; i < 100 && receiver->packets.Value() < packets; ++i)
+    SleepMs(10);
+}
+
+// Makes room for |descriptors| more open files. Returns false if the hard
+// limit is too low.
+bool RaiseFileLimit(int descriptors) {
+  rlimit limit;
+  if (getrlimit(RLIMIT_NOFILE, &limit) != 0)
+    return false;
+  const rlim_t wanted = static_cast<rlim_t>(descriptors) + 64;
+  if (limit.rlim_cur >= wanted)
+    return true;
+  if (limit.rlim_max < wanted)
+    return false;
+  limit.rlim_cur = wanted;
+  return setrlimit(RLIMIT_NOFILE, &limit) == 0;
+}
+
+}  // namespace
+
+// A socket with more datagrams queued than a reactor reads per wake must
+// still be drained; readiness is only reported on new data.
+TEST(UdpSocketManager, EpollDrainsQueuedDatagrams) {
+  uint8_t threads = 1;
+  UdpSocketManager* mgr = UdpSocketManager::Create(
+      42, threads, UdpSocketManager::kEpollImplementation);
+  PacketReceiver receiver;
+  sockaddr_in address;
+  UdpSocketWrapper* socket = CreateBoundSocket(mgr, &receiver, &address);
+  ASSERT_TRUE(socket != NULL);
+
+  const int kPackets = 100;
+  int sender = ::socket(AF_INET, SOCK_DGRAM, 0);
+  for (int i = 0; i < kPackets; ++i)
+    SendTimestamp(sender, address);
+  WaitForPackets(&receiver, kPackets);
+  EXPECT_EQ(kPackets, receiver.packets.Value());
+
+  close(sender);
+  socket->CloseBlocking();
+  UdpSocketManager::Return();
+}
+
+// Counts the batches handed to an IncomingSocketBatchCallback.
+struct BatchReceiver {
+  static void OnBatch(CallbackObj obj, const ReceivedDatagram* datagrams,
+                      int32_t count) {
+    BatchReceiver* receiver = static_cast<BatchReceiver*>(obj);
+    // Hold the work thread on the first batch so that the next ones queue.
+    if (receiver->batches.Value() == 0)
+      SleepMs(50);
+    for (int32_t i = 0; i < count; ++i)
+      EXPECT_EQ(100, datagrams[i].length);
+    if (count > receiver->largest_batch.Value())
+      receiver->largest_batch += count - receiver->largest_batch.Value();
+    ++receiver->batches;
+    receiver->packets += count;
+  }
+
+  Atomic32 packets;
+  Atomic32 batches;
+  Atomic32 largest_batch;
+};
+
+// Datagrams sent with SendBatchTo arrive through the batch callback, several
+// per callback when they queue up.
+TEST(UdpSocketManager, SendBatchToIsReceivedInBatches) {
+  uint8_t threads = 1;
+  UdpSocketManager* mgr = UdpSocketManager::Create(
+      42, threads, UdpSocketManager::kEpollImplementation);
+  BatchReceiver receiver;
+  UdpSocketWrapper* socket = UdpSocketWrapper::CreateSocket(
+      42, mgr, &receiver, NULL, false, false);
+  ASSERT_TRUE(socket != NULL);
+  EXPECT_TRUE(socket->SetBatchCallback(&BatchReceiver::OnBatch));
+  SocketAddress address;
+  memset(&address, 0, sizeof(address));
+  address._sockaddr_in.sin_family = AF_INET;
+  address._sockaddr_in.sin_addr = htonl(INADDR_LOOPBACK);
+  ASSERT_TRUE(socket->Bind(address));
+  socklen_t length = sizeof(address);
+  getsockname(static_cast<UdpSocketPosix*>(socket)->GetFd(),
+              reinterpret_cast<sockaddr*>(&address), &length);
+
+  UdpSocketWrapper* sender =
+      UdpSocketWrapper::CreateSocket(42, mgr, NULL, NULL, false, false);
+  ASSERT_TRUE(sender != NULL);
+  const int kPackets = 100;
+  int8_t payload[kPackets][100];
+  const int8_t* packets[kPackets];
+  int32_t lengths[kPackets];
+  for (int i = 0; i < kPackets; ++i) {
+    memset(payload[i], i, sizeof(payload[i]));
+    packets[i] = payload[i];
+    lengths[i] = sizeof(payload[i]);
+  }
+  socket->StartReceiving();
+  EXPECT_EQ(1, sender->SendBatchTo(packets, lengths, 1, address));
+  SleepMs(10);
+  EXPECT_EQ(kPackets, sender->SendBatchTo(packets, lengths, kPackets,
+                                          address));
+  for (int i = 0; i < 100 && receiver.packets.Value() < kPackets + 1; ++i)
+    SleepMs(10);
+
+  EXPECT_EQ(kPackets + 1, receiver.packets.Value());
+  EXPECT_GT(receiver.largest_batch.Value(), 1);
+  EXPECT_LE(receiver.largest_batch.Value(), 16);
+
+  sender->CloseBlocking();
+  socket->CloseBlocking();
+  UdpSocketManager::Return();
+}
+
+// Time spent sending 1080p keyframe sized bursts one datagram at a time and
+// with SendBatchTo.
+TEST(UdpSocketManager, DISABLED_SendBatchBenchmark) {
+  uint8_t threads = 1;
+  UdpSocketManager* mgr = UdpSocketManager::Create(42, threads);
+  UdpSocketWrapper* sender =
+      UdpSocketWrapper::CreateSocket(42, mgr, NULL, NULL, false, false);
+  ASSERT_TRUE(sender != NULL);
+  // Nobody listens; the datagrams are dropped after the system call.
+  SocketAddress address;
+  memset(&address, 0, sizeof(address));
+  address._sockaddr_in.sin_family = AF_INET;
+  address._sockaddr_in.sin_port = htons(9);
+  address._sockaddr_in.sin_addr = htonl(INADDR_LOOPBACK);
+
+  const int kPacketsPerFrame = 120;
+  const int kFrames = 1000;
+  std::vector<int8_t> payload(1200, 0);
+  const int8_t* packets[kPacketsPerFrame];
+  int32_t lengths[kPacketsPerFrame];
+  for (int i = 0; i < kPacketsPerFrame; ++i) {
+    packets[i] = &payload[0];
+    lengths[i] = static_cast<int32_t>(payload.size());
+  }
+
+  int64_t start_us = TickTime::MicrosecondTimestamp();
+  for (int frame = 0; frame < kFrames; ++frame) {
+    for (int i = 0; i < kPacketsPerFrame; ++i)
+      sender->SendTo(packets[i], lengths[i], address);
+  }
+  const int64_t single_us = TickTime::MicrosecondTimestamp() - start_us;
+
+  start_us = TickTime::MicrosecondTimestamp();
+  for (int frame = 0; frame < kFrames; ++frame)
+    sender->SendBatchTo(packets, lengths, kPacketsPerFrame, address);
+  const int64_t batch_us = TickTime::MicrosecondTimestamp() - start_us;
+
+  printf("%d frames of %d packets: SendTo %.1f us/frame, SendBatchTo %.1f "
+         "us/frame\n", kFrames, kPacketsPerFrame,
+         static_cast<double>(single_us) / kFrames,
+         static_cast<double>(batch_us) / kFrames);
+
+  sender->CloseBlocking();
+  UdpSocketManager::Return();
+}
+
+// select() can't watch descriptors at or above FD_SETSIZE; epoll can.
+TEST(UdpSocketManager, EpollReceivesOnDescriptorAboveFdSetSize) {
+  if (!RaiseFileLimit(FD_SETSIZE + 1)) {
+    printf("Skipped: RLIMIT_NOFILE is below FD_SETSIZE.\n");
+    return;
+  }
+  std::vector<int> filler;
+  int fd;
+  while ((fd = dup(0)) != -1 && fd < FD_SETSIZE)
+    filler.push_back(fd);
+  if (fd != -1)
+    close(fd);
+
+  uint8_t threads = 1;
+  UdpSocketManager* mgr = UdpSocketManager::Create(
+      42, threads, UdpSocketManager::kEpollImplementation);
+  PacketReceiver receiver;
+  sockaddr_in address;
+  UdpSocketWrapper* socket = CreateBoundSocket(mgr, &receiver, &address);
+  ASSERT_TRUE(socket != NULL);
+  EXPECT_GE(static_cast<UdpSocketPosix*>(socket)->GetFd(), FD_SETSIZE);
+
+  int sender = ::socket(AF_INET, SOCK_DGRAM, 0);
+  SendTimestamp(sender, address);
+  WaitForPackets(&receiver, 1);
+  EXPECT_EQ(1, receiver.packets.Value());
+
+  close(sender);
+  socket->CloseBlocking();
+  UdpSocketManager::Return();
+  for (size_t i = 0; i < filler.size(); ++i)
+    close(filler[i]);
+}
+
+// Compares the select() and epoll managers on loopback. Latency is measured
+// on a trickle of packets spread over all sockets, throughput on a burst
+// sent round-robin as fast as the sender can go.
+TEST(UdpSocketManager, DISABLED_ReceiveBenchmark) {
+  const int kSocketCounts[] = { 100, 1000, 5000 };
+  const int kLatencyPackets = 500;
+  const int kBurstPackets = 50000;
+  struct Config {
+    const char* name;
+    UdpSocketManager::Implementation implementation;
+    uint8_t threads;
+  };
+  const Config kConfigs[] = {
+    { "select", UdpSocketManager::kSelectImplementation, 1 },
+    { "epoll", UdpSocketManager::kEpollImplementation, 1 },
+    { "epoll", UdpSocketManager::kEpollImplementation, 4 },
+  };
+
+  printf("%-8s %7s %7s %12s %14s %14s\n", "manager", "threads", "sockets",
+         "packets/s", "mean wake us", "max wake us");
+  for (size_t c = 0; c < sizeof(kConfigs) / sizeof(kConfigs[0]); ++c) {
+    for (size_t n = 0; n < sizeof(kSocketCounts) / sizeof(kSocketCounts[0]);
+         ++n) {
+      const Config& config = kConfigs[c];
+      const int sockets = kSocketCounts[n];
+      if (!RaiseFileLimit(sockets + 1)) {
+        printf("%-8s %7d %7d  RLIMIT_NOFILE too low\n", config.name,
+               config.threads, sockets);
+        continue;
+      }
+      uint8_t threads = config.threads;
+      UdpSocketManager* mgr =
+          UdpSocketManager::Create(42, threads, config.implementation);
+      scoped_ptr<PacketReceiver[]> receivers(new PacketReceiver[sockets]);
+      std::vector<UdpSocketWrapper*> socket_list;
+      std::vector<sockaddr_in> addresses(sockets);
+      for (int i = 0; i < sockets; ++i) {
+        UdpSocketWrapper* socket =
+            CreateBoundSocket(mgr, &receivers[i], &addresses[i]);
+        if (socket == NULL)
+          break;
+        socket_list.push_back(socket);
+      }
+
+      if (static_cast<int>(socket_list.size()) == sockets) {
+        int sender = ::socket(AF_INET, SOCK_DGRAM, 0);
+        // Give the work threads time to pick the sockets up.
+        SleepMs(100);
+
+        for (int i = 0; i < kLatencyPackets; ++i) {
+          SendTimestamp(sender, addresses[(i * 7919) % sockets]);
+          SleepMs(1);
+        }
+        SleepMs(200);
+        int64_t latency_us_sum = 0;
+        int64_t max_latency_us = 0;
+        int latency_packets = 0;
+        for (int i = 0; i < sockets; ++i) {
+          latency_us_sum += receivers[i].latency_us_sum;
+          if (receivers[i].max_latency_us > max_latency_us)
+            max_latency_us = receivers[i].max_latency_us;
+          latency_packets += receivers[i].packets.Value();
+          receivers[i].packets -= receivers[i].packets.Value();
+        }
+
+        const int64_t start_us = TickTime::MicrosecondTimestamp();
+        for (int i = 0; i < kBurstPackets; ++i)
+          SendTimestamp(sender, addresses[i % sockets]);
+        SleepMs(500);
+        int received = 0;
+        int64_t last_arrival_us = start_us;
+        for (int i = 0; i < sockets; ++i) {
+          received += receivers[i].packets.Value();
+          if (receivers[i].last_arrival_us > last_arrival_us)
+            last_arrival_us = receivers[i].last_arrival_us;
+        }
+        close(sender);
+
+        printf("%-8s %7d %7d %12.0f %14.1f %14lld\n", config.name,
+               config.threads, sockets,
+               received * 1e6 / std::max<int64_t>(1,
+                                                  last_arrival_us - start_us),
+               latency_packets > 0 ?
+                   static_cast<double>(latency_us_sum) / latency_packets : 0,
+               static_cast<long long>(max_latency_us));
+      } else {
+        printf("%-8s %7d %7d  unsupported, %d sockets added\n", config.name,
+               config.threads, sockets, static_cast<int>(socket_list.size()));
+      }
+
+      for (size_t i = 0; i < socket_list.size(); ++i)
+        socket_list[i]->CloseBlocking();
+      UdpSocketManager::Return();
+    }
+  }
+}
+#endif  // WEBRTC_LINUX
+
 }  // namespace test
 }  // namespace webrtc
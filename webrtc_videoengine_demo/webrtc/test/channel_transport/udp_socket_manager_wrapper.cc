@@ -18,15 +18,27 @@
 #else
 #include "webrtc/test/channel_transport/udp_socket_manager_posix.h"
 #endif
+#if defined(WEBRTC_LINUX)
+#include "webrtc/test/channel_transport/udp_socket_manager_epoll.h"
+#endif
 
 namespace webrtc {
 namespace test {
 
+UdpSocketManager::Implementation UdpSocketManager::_implementation =
+    UdpSocketManager::kDefaultImplementation;
+
 UdpSocketManager* UdpSocketManager::CreateInstance()
 {
 #if defined(_WIN32)
   return static_cast<UdpSocketManager*>(new UdpSocket2ManagerWindows());
 #else
+#if defined(WEBRTC_LINUX)
+    if (_implementation != kSelectImplementation)
+    {
+        return new UdpSocketManagerEpoll();
+    }
+#endif
     return new UdpSocketManagerPosix();
 #endif
 }
@@ -34,8 +46,10 @@ UdpSocketManager* UdpSocketManager::CreateInstance()
 UdpSocketManager* UdpSocketManager::StaticInstance(
     CountOperation count_operation,
     const int32_t id,
-    uint8_t& numOfWorkThreads)
+    uint8_t& numOfWorkThreads,
+    Implementation implementation)
 {
+    _implementation = implementation;
     UdpSocketManager* impl =
         GetStaticInstance<UdpSocketManager>(count_operation);
     if (count_operation == kAddRef && impl != NULL) {
@@ -47,16 +61,19 @@ UdpSocketManager* UdpSocketManager::StaticInstance(
 }
 
 UdpSocketManager* UdpSocketManager::Create(const int32_t id,
-                                           uint8_t& numOfWorkThreads)
+                                           uint8_t& numOfWorkThreads,
+                                           Implementation implementation)
 {
-    return UdpSocketManager::StaticInstance(kAddRef, id, numOfWorkThreads);
+    return UdpSocketManager::StaticInstance(kAddRef, id, numOfWorkThreads,
+                                            implementation);
 }
 
 void UdpSocketManager::Return()
 {
     uint8_t numOfWorkThreads = 0;
     UdpSocketManager::StaticInstance(kRelease, -1,
-                                     numOfWorkThreads);
+                                     numOfWorkThreads,
+                                     kDefaultImplementation);
 }
 
 UdpSocketManager::UdpSocketManager() : _numOfWorkThreads(0)
@@ -22,8 +22,22 @@ class UdpSocketWrapper;
 class UdpSocketManager
 {
 public:
-    static UdpSocketManager* Create(const int32_t id,
-                                    uint8_t& numOfWorkThreads);
+    enum Implementation
+    {
+        // epoll on Linux, select() on the other Posix platforms.
+        kDefaultImplementation,
+        // select() based. Limited to descriptors below FD_SETSIZE.
+        kSelectImplementation,
+        // Edge-triggered epoll. Linux only.
+        kEpollImplementation
+    };
+
+    // Returns the shared socket manager. |implementation| is only honoured
+    // by the call that creates it; later callers share whatever exists.
+    static UdpSocketManager* Create(
+        const int32_t id,
+        uint8_t& numOfWorkThreads,
+        Implementation implementation = kDefaultImplementation);
     static void Return();
 
     // Initializes the socket manager. Returns true if the manager wasn't
@@ -63,7 +77,11 @@ private:
     static UdpSocketManager* StaticInstance(
         CountOperation count_operation,
         const int32_t id,
-        uint8_t& numOfWorkThreads);
+        uint8_t& numOfWorkThreads,
+        Implementation implementation);
+
+    // The implementation CreateInstance() builds.
+    static Implementation _implementation;
 };
 
 }  // namespace test
@@ -20,12 +20,35 @@
 #include <time.h>
 #include <unistd.h>
 
+#include <algorithm>
+
 #include "webrtc/system_wrappers/interface/trace.h"
 #include "webrtc/test/channel_transport/udp_socket_manager_wrapper.h"
 #include "webrtc/test/channel_transport/udp_socket_wrapper.h"
 
 namespace webrtc {
 namespace test {
+
+#if defined(WEBRTC_LINUX)
+// Datagrams handed to one sendmmsg() call.
+static const int kMaxSendBatch = 64;
+#endif
+
+UdpReceiveBatch::UdpReceiveBatch()
+{
+#if defined(WEBRTC_LINUX)
+    memset(_messages, 0, sizeof(_messages));
+    for (int i = 0; i < kMaxDatagrams; ++i)
+    {
+        _iov[i].iov_base = _buffers[i];
+        _iov[i].iov_len = kMaxDatagramSize;
+        _messages[i].msg_hdr.msg_iov = &_iov[i];
+        _messages[i].msg_hdr.msg_iovlen = 1;
+        _messages[i].msg_hdr.msg_name = &_from[i];
+    }
+#endif
+}
+
 UdpSocketPosix::UdpSocketPosix(const int32_t id, UdpSocketManager* mgr,
                                bool ipV6Enable)
 {
@@ -39,6 +62,7 @@ UdpSocketPosix::UdpSocketPosix(const int32_t id, UdpSocketManager* mgr,
     _id = id;
     _obj = NULL;
     _incomingCb = NULL;
+    _incomingBatchCb = NULL;
     _readyForDeletionCond = ConditionVariableWrapper::CreateConditionVariable();
     _closeBlockingCompletedCond =
         ConditionVariableWrapper::CreateConditionVariable();
@@ -121,6 +145,12 @@ bool UdpSocketPosix::SetCallback(CallbackObj obj, IncomingSocketCallback cb)
     return false;
 }
 
+bool UdpSocketPosix::SetBatchCallback(IncomingSocketBatchCallback cb)
+{
+    _incomingBatchCb = cb;
+    return true;
+}
+
 bool UdpSocketPosix::SetSockopt(int32_t level, int32_t optname,
                                 const int8_t* optval, int32_t optlen)
 {
@@ -173,6 +203,49 @@ int32_t UdpSocketPosix::SendTo(const int8_t* buf, int32_t len,
     return retVal;
 }
 
+int32_t UdpSocketPosix::SendBatchTo(const int8_t* const* bufs,
+                                    const int32_t* lens,
+                                    int32_t count,
+                                    const SocketAddress& to)
+{
+#if defined(WEBRTC_LINUX)
+    iovec iov[kMaxSendBatch];
+    mmsghdr messages[kMaxSendBatch];
+    int32_t sent = 0;
+    while (sent < count)
+    {
+        const int batch = std::min<int32_t>(count - sent, kMaxSendBatch);
+        memset(messages, 0, sizeof(messages[0]) * batch);
+        for (int i = 0; i < batch; ++i)
+        {
+            iov[i].iov_base = const_cast<int8_t*>(bufs[sent + i]);
+            iov[i].iov_len = lens[sent + i];
+            messages[i].msg_hdr.msg_iov = &iov[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+            messages[i].msg_hdr.msg_name = const_cast<SocketAddress*>(&to);
+            messages[i].msg_hdr.msg_namelen = sizeof(sockaddr);
+        }
+        int retVal = sendmmsg(_socket, messages, batch, 0);
+        if (retVal == SOCKET_ERROR)
+        {
+            _error = errno;
+            WEBRTC_TRACE(kTraceError, kTraceTransport, _id,
+                         "UdpSocketPosix::SendBatchTo() error: %d", _error);
+            return sent > 0 ? sent : -1;
+        }
+        sent += retVal;
+        if (retVal < batch)
+        {
+            // The socket buffer is full; leave the rest to the caller.
+            break;
+        }
+    }
+    return sent;
+#else
+    return UdpSocketWrapper::SendBatchTo(bufs, lens, count, to);
+#endif
+}
+
 SOCKET UdpSocketPosix::GetFd() { return _socket; }
 int32_t UdpSocketPosix::GetError() { return _error; }
 
@@ -192,13 +265,32 @@ bool UdpSocketPosix::SetQos(int32_t /*serviceType*/,
   return false;
 }
 
-void UdpSocketPosix::HasIncoming()
+bool UdpSocketPosix::HasIncoming(UdpReceiveBatch* batch)
 {
-    // replace 2048 with a mcro define and figure out
-    // where 2048 comes from
-    int8_t buf[2048];
+    int received = 0;
+#if defined(WEBRTC_LINUX)
+    for (int i = 0; i < UdpReceiveBatch::kMaxDatagrams; ++i)
+    {
+        batch->_messages[i].msg_hdr.msg_namelen = sizeof(SocketAddress);
+    }
+    received = recvmmsg(_socket, batch->_messages,
+                        UdpReceiveBatch::kMaxDatagrams, MSG_DONTWAIT, NULL);
+    if (received == SOCKET_ERROR)
+    {
+        // A pending ICMP error is reported instead of the datagrams behind
+        // it, which are still there to be read.
+        return errno == ECONNREFUSED || errno == EINTR;
+    }
+    for (int i = 0; i < received; ++i)
+    {
+        batch->_datagrams[i].data = batch->_buffers[i];
+        batch->_datagrams[i].length = batch->_messages[i].msg_len;
+        batch->_datagrams[i].from = &batch->_from[i];
+    }
+#else
+    int8_t* buf = batch->_buffers[0];
+    SocketAddress& from = batch->_from[0];
     int retval;
-    SocketAddress from;
 #if defined(WEBRTC_MAC)
     sockaddr sockaddrfrom;
     memset(&from, 0, sizeof(from));
@@ -210,29 +302,50 @@ void UdpSocketPosix::HasIncoming()
 #endif
 
 #if defined(WEBRTC_MAC)
-        retval = recvfrom(_socket,buf, sizeof(buf), 0,
+        retval = recvfrom(_socket,buf, UdpReceiveBatch::kMaxDatagramSize, 0,
                           reinterpret_cast<sockaddr*>(&sockaddrfrom), &fromlen);
         memcpy(&from, &sockaddrfrom, fromlen);
         from._sockaddr_storage.sin_family = sockaddrfrom.sa_family;
 #else
-        retval = recvfrom(_socket,buf, sizeof(buf), 0,
+        retval = recvfrom(_socket,buf, UdpReceiveBatch::kMaxDatagramSize, 0,
                           reinterpret_cast<sockaddr*>(&from), &fromlen);
 #endif
 
-    switch(retval)
+    if (retval == SOCKET_ERROR)
+    {
+        return errno == ECONNREFUSED || errno == EINTR;
+    }
+    batch->_datagrams[0].data = buf;
+    batch->_datagrams[0].length = retval;
+    batch->_datagrams[0].from = &from;
+    received = 1;
+#endif
+
+    if (_wantsIncoming)
     {
-    case 0:
-        // The peer has performed an orderly shutdown.
-        break;
-    case SOCKET_ERROR:
-        break;
-    default:
-        if (_wantsIncoming && _incomingCb)
+        if (_incomingBatchCb)
+        {
+            _incomingBatchCb(_obj, batch->_datagrams, received);
+        } else if (_incomingCb)
         {
-          _incomingCb(_obj, buf, retval, &from);
+            for (int i = 0; i < received; ++i)
+            {
+                // A zero length datagram carries nothing to deliver.
+                if (batch->_datagrams[i].length > 0)
+                {
+                    _incomingCb(_obj, batch->_datagrams[i].data,
+                                batch->_datagrams[i].length,
+                                batch->_datagrams[i].from);
+                }
+            }
         }
-        break;
     }
+#if defined(WEBRTC_LINUX)
+    // A short batch means the socket has been drained.
+    return received == UdpReceiveBatch::kMaxDatagrams;
+#else
+    return true;
+#endif
 }
 
 bool UdpSocketPosix::WantsIncoming() { return _wantsIncoming; }
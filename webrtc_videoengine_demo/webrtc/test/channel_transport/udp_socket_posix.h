@@ -25,6 +25,31 @@ namespace test {
 
 #define SOCKET_ERROR -1
 
+// Scratch space for reading several datagrams with one system call. Owned by
+// the thread that drains the sockets, so that sockets don't each carry one.
+class UdpReceiveBatch
+{
+public:
+    enum
+    {
+        kMaxDatagrams = 16,
+        kMaxDatagramSize = 2048
+    };
+
+    UdpReceiveBatch();
+
+private:
+    friend class UdpSocketPosix;
+
+    int8_t _buffers[kMaxDatagrams][kMaxDatagramSize];
+    SocketAddress _from[kMaxDatagrams];
+    ReceivedDatagram _datagrams[kMaxDatagrams];
+#if defined(WEBRTC_LINUX)
+    iovec _iov[kMaxDatagrams];
+    mmsghdr _messages[kMaxDatagrams];
+#endif
+};
+
 class UdpSocketPosix : public UdpSocketWrapper
 {
 public:
@@ -38,6 +63,8 @@ public:
     virtual bool SetCallback(CallbackObj obj,
                              IncomingSocketCallback cb) OVERRIDE;
 
+    virtual bool SetBatchCallback(IncomingSocketBatchCallback cb) OVERRIDE;
+
     virtual bool Bind(const SocketAddress& name) OVERRIDE;
 
     virtual bool SetSockopt(int32_t level, int32_t optname,
@@ -48,6 +75,11 @@ public:
     virtual int32_t SendTo(const int8_t* buf, int32_t len,
                            const SocketAddress& to) OVERRIDE;
 
+    virtual int32_t SendBatchTo(const int8_t* const* bufs,
+                                const int32_t* lens,
+                                int32_t count,
+                                const SocketAddress& to) OVERRIDE;
+
     // Deletes socket in addition to closing it.
     // TODO (hellner): make destructor protected.
     virtual void CloseBlocking() OVERRIDE;
@@ -67,7 +99,9 @@ public:
                         int32_t /*overrideDSCP*/) OVERRIDE;
 
     bool CleanUp();
-    void HasIncoming();
+    // Reads as many queued datagrams as fit in |batch| and hands them to the
+    // callback. Returns false once the socket has nothing more queued.
+    bool HasIncoming(UdpReceiveBatch* batch);
     bool WantsIncoming();
     void ReadyForDeletion();
 private:
@@ -75,6 +109,7 @@ private:
 
     int32_t _id;
     IncomingSocketCallback _incomingCb;
+    IncomingSocketBatchCallback _incomingBatchCb;
     CallbackObj _obj;
     int32_t _error;
 
@@ -29,13 +29,6 @@ namespace test {
 
 bool UdpSocketWrapper::_initiated = false;
 
-// Temporary Android hack. The value 1024 is taken from
-// <ndk>/build/platforms/android-1.5/arch-arm/usr/include/linux/posix_types.h
-// TODO (tomasl): can we remove this now?
-#ifndef FD_SETSIZE
-#define FD_SETSIZE 1024
-#endif
-
 UdpSocketWrapper::UdpSocketWrapper()
     : _wantsIncoming(false),
       _deleteEvent(NULL)
@@ -104,7 +97,8 @@ UdpSocketWrapper* UdpSocketWrapper::CreateSocket(const int32_t id,
     if (s)
     {
         UdpSocketPosix* sl = static_cast<UdpSocketPosix*>(s);
-        if (sl->GetFd() != INVALID_SOCKET && sl->GetFd() < FD_SETSIZE)
+        // The socket manager rejects descriptors it can't poll.
+        if (sl->GetFd() != INVALID_SOCKET)
         {
             // ok
         } else
@@ -129,6 +123,7 @@ UdpSocketWrapper* UdpSocketWrapper::CreateSocket(const int32_t id,
                 kTraceTransport,
                 id,
                 "UdpSocketWrapper::CreateSocket failed to ser callback");
+            delete s;
             return(NULL);
         }
     }
@@ -153,6 +148,26 @@ bool UdpSocketWrapper::StopReceiving()
 
 int32_t UdpSocketWrapper::SetPCP(const int32_t /*pcp*/) { return -1; }
 
+bool UdpSocketWrapper::SetBatchCallback(IncomingSocketBatchCallback /*cb*/)
+{
+    return false;
+}
+
+int32_t UdpSocketWrapper::SendBatchTo(const int8_t* const* bufs,
+                                      const int32_t* lens,
+                                      int32_t count,
+                                      const SocketAddress& to)
+{
+    for (int32_t i = 0; i < count; ++i)
+    {
+        if (SendTo(bufs[i], lens[i], to) < 0)
+        {
+            return i > 0 ? i : -1;
+        }
+    }
+    return count;
+}
+
 uint32_t UdpSocketWrapper::ReceiveBuffers() { return 0; }
 
 }  // namespace test
@@ -40,6 +40,17 @@ typedef void* CallbackObj;
 typedef void(*IncomingSocketCallback)(CallbackObj obj, const int8_t* buf,
                                       int32_t len, const SocketAddress* from);
 
+// A datagram read as part of a batch. Only valid during the callback.
+struct ReceivedDatagram
+{
+    const int8_t* data;
+    int32_t length;
+    const SocketAddress* from;
+};
+typedef void(*IncomingSocketBatchCallback)(CallbackObj obj,
+                                           const ReceivedDatagram* datagrams,
+                                           int32_t count);
+
 class UdpSocketWrapper
 {
 public:
@@ -102,6 +113,25 @@ protected:
     // Destroying the socket is done via CloseBlocking().
     virtual ~UdpSocketWrapper();
 
+public:
+    // The batch methods follow the destructor so that the vtable slots of the
+    // older methods are unchanged.
+
+    // Register cb to receive every datagram read in one system call with a
+    // single callback instead of one callback per datagram. Must be called
+    // before StartReceiving(). Returns false if the socket can't read
+    // batches, in which case the callback set with SetCallback is used.
+    virtual bool SetBatchCallback(IncomingSocketBatchCallback /*cb*/);
+
+    // Send count datagrams to the address specified by to, with as few system
+    // calls as the platform allows. Returns the number of datagrams sent, or
+    // -1 if the first one failed.
+    virtual int32_t SendBatchTo(const int8_t* const* bufs,
+                                const int32_t* lens,
+                                int32_t count,
+                                const SocketAddress& to);
+
+protected:
     bool _wantsIncoming;
     EventWrapper*  _deleteEvent;
 
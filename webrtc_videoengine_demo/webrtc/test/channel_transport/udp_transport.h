@@ -105,6 +105,20 @@ class UdpTransportData {
                                   const int32_t rtcpPacketLength,
                                   const char* fromIP,
                                   const uint16_t fromPort) = 0;
+
+  // RTP packets read from the socket in one go, all sent from
+  // fromIP:fromPort. The default hands them to IncomingRTPPacket() one at a
+  // time.
+  virtual void IncomingRTPPackets(const int8_t* const* incomingRtpPackets,
+                                  const int32_t* rtpPacketLengths,
+                                  const int32_t numberOfPackets,
+                                  const char* fromIP,
+                                  const uint16_t fromPort) {
+    for (int32_t i = 0; i < numberOfPackets; ++i) {
+      IncomingRTPPacket(incomingRtpPackets[i], rtpPacketLengths[i], fromIP,
+                        fromPort);
+    }
+  }
 };
 
 class UdpTransport : public Transport {
@@ -372,6 +386,14 @@ class UdpTransport : public Transport {
     // If ipV6 is false ipaddr is interpreted as an IPv4 address otherwise it
     // is interptreted as IPv6.
     static bool IsIpAddressValid(const char* ipaddr, const bool ipV6);
+
+    // Send numberOfPackets RTP packets to the address set by
+    // InitializeSendSockets(..) with as few system calls as the platform
+    // allows. Returns the number of packets sent or -1 on error. Declared
+    // last to leave the slots of the older methods where they were.
+    virtual int32_t SendRTPPackets(const int8_t* const* packets,
+                                   const int32_t* lengths,
+                                   int32_t numberOfPackets) = 0;
 };
 
 }  // namespace test
@@ -1553,6 +1553,8 @@ int32_t UdpTransportImpl::StartReceiving(uint32_t /*numberOfSocketBuffers*/)
     }
     if(_ptrRtpSocket)
     {
+        // Sockets that can't read batches keep using IncomingRTPCallback.
+        _ptrRtpSocket->SetBatchCallback(IncomingRTPBatchCallback);
 #ifdef _WIN32
         if(!_ptrRtpSocket->StartReceiving(numberOfSocketBuffers))
 #else
@@ -1931,6 +1933,49 @@ int32_t UdpTransportImpl::SendRTCPPacketTo(const int8_t* data,
     return -1;
 }
 
+int32_t UdpTransportImpl::SendRTPPackets(const int8_t* const* packets,
+                                         const int32_t* lengths,
+                                         int32_t numberOfPackets)
+{
+    CriticalSectionScoped cs(_crit);
+
+    if(_destIP[0] == 0 || _destPort == 0)
+    {
+        return -1;
+    }
+    if(_ptrSendRtpSocket)
+    {
+        return _ptrSendRtpSocket->SendBatchTo(packets, lengths,
+                                              numberOfPackets,
+                                              _remoteRTPAddr);
+    } else if(_ptrRtpSocket)
+    {
+        return _ptrRtpSocket->SendBatchTo(packets, lengths, numberOfPackets,
+                                          _remoteRTPAddr);
+    }
+    return -1;
+}
+
+int UdpTransportImpl::SendPackets(int channel,
+                                  const void* const* data,
+                                  const int* lengths,
+                                  int numberOfPackets)
+{
+    bool socketCreated;
+    {
+        CriticalSectionScoped cs(_crit);
+        socketCreated = _ptrSendRtpSocket != NULL || _ptrRtpSocket != NULL;
+    }
+    if(!socketCreated)
+    {
+        // SendPacket() creates the socket on first use.
+        return Transport::SendPackets(channel, data, lengths,
+                                      numberOfPackets);
+    }
+    return SendRTPPackets(reinterpret_cast<const int8_t* const*>(data),
+                          lengths, numberOfPackets);
+}
+
 int UdpTransportImpl::SendPacket(int /*channel*/, const void* data, int length)
 {
     WEBRTC_TRACE(kTraceStream, kTraceTransport, _id, "%s", __FUNCTION__);
@@ -2104,6 +2149,15 @@ void UdpTransportImpl::IncomingRTPCallback(CallbackObj obj,
     }
 }
 
+void UdpTransportImpl::IncomingRTPBatchCallback(
+    CallbackObj obj,
+    const ReceivedDatagram* datagrams,
+    int32_t count)
+{
+    UdpTransportImpl* socketTransport = (UdpTransportImpl*) obj;
+    socketTransport->IncomingRTPBatchFunction(datagrams, count);
+}
+
 void UdpTransportImpl::IncomingRTCPCallback(CallbackObj obj,
                                             const int8_t* rtcpPacket,
                                             int32_t rtcpPacketLength,
@@ -2117,66 +2171,146 @@ void UdpTransportImpl::IncomingRTCPCallback(CallbackObj obj,
     }
 }
 
+bool UdpTransportImpl::AcceptIncomingRTP(
+    const SocketAddress* fromSocket,
+    char ipAddress[kIpAddressVersion6Length],
+    uint16_t& portNr)
+{
+    uint32_t ipAddressLength = kIpAddressVersion6Length;
+    ipAddress[0] = 0;
+    if (FilterIPAddress(fromSocket) == false)
+    {
+        // Packet should be filtered out. Drop it.
+        WEBRTC_TRACE(kTraceStream, kTraceTransport, _id,
+                     "Incoming RTP packet blocked by IP filter");
+        return false;
+    }
+
+    if (IPAddressCached(*fromSocket, ipAddress, ipAddressLength, portNr) <
+        0)
+    {
+        WEBRTC_TRACE(
+            kTraceError,
+            kTraceTransport,
+            _id,
+            "UdpTransportImpl::IncomingRTPFunction - Cannot get sender\
+ information");
+    }else
+    {
+        // Make sure ipAddress is null terminated.
+        ipAddress[kIpAddressVersion6Length - 1] = 0;
+        strncpy(_fromIP, ipAddress, kIpAddressVersion6Length - 1);
+    }
+
+    // Filter based on port.
+    if (_rtpFilterPort != 0 &&
+        _rtpFilterPort != portNr)
+    {
+        // Drop packet.
+        memset(_fromIP, 0, sizeof(_fromIP));
+        WEBRTC_TRACE(
+            kTraceStream,
+            kTraceTransport,
+            _id,
+            "Incoming RTP packet blocked by filter incoming from port:%d\
+ allowed port:%d",
+            portNr,
+            _rtpFilterPort);
+        return false;
+    }
+    _fromPort = portNr;
+    return true;
+}
+
+void UdpTransportImpl::DeliverIncomingRTP(const int8_t* const* packets,
+                                          const int32_t* lengths,
+                                          int32_t count,
+                                          const char* ipAddress,
+                                          uint16_t portNr)
+{
+    CriticalSectionScoped cs(_critPacketCallback);
+    if (_packetCallback)
+    {
+        WEBRTC_TRACE(kTraceStream, kTraceTransport, _id,
+            "Incoming RTP packets (%d) from ip:%s port:%d", count, ipAddress,
+            portNr);
+        if (count == 1)
+        {
+            _packetCallback->IncomingRTPPacket(packets[0], lengths[0],
+                                               ipAddress, portNr);
+        } else
+        {
+            _packetCallback->IncomingRTPPackets(packets, lengths, count,
+                                                ipAddress, portNr);
+        }
+    }
+}
+
 void UdpTransportImpl::IncomingRTPFunction(const int8_t* rtpPacket,
                                            int32_t rtpPacketLength,
                                            const SocketAddress* fromSocket)
 {
     char ipAddress[kIpAddressVersion6Length];
-    uint32_t ipAddressLength = kIpAddressVersion6Length;
     uint16_t portNr = 0;
 
     {
         CriticalSectionScoped cs(_critFilter);
-        if (FilterIPAddress(fromSocket) == false)
+        if (!AcceptIncomingRTP(fromSocket, ipAddress, portNr))
         {
-            // Packet should be filtered out. Drop it.
-            WEBRTC_TRACE(kTraceStream, kTraceTransport, _id,
-                         "Incoming RTP packet blocked by IP filter");
             return;
         }
+    }
+
+    DeliverIncomingRTP(&rtpPacket, &rtpPacketLength, 1, ipAddress, portNr);
+}
+
+void UdpTransportImpl::IncomingRTPBatchFunction(
+    const ReceivedDatagram* datagrams,
+    int32_t count)
+{
+    enum { kMaxPacketsPerCallback = 16 };
+    const int8_t* packets[kMaxPacketsPerCallback];
+    int32_t lengths[kMaxPacketsPerCallback];
+    int32_t runLength = 0;
+    char runIpAddress[kIpAddressVersion6Length];
+    uint16_t runPort = 0;
 
-        if (IPAddressCached(*fromSocket, ipAddress, ipAddressLength, portNr) <
-            0)
+    for (int32_t i = 0; i < count; ++i)
+    {
+        if (datagrams[i].data == NULL || datagrams[i].length <= 0)
         {
-            WEBRTC_TRACE(
-                kTraceError,
-                kTraceTransport,
-                _id,
-                "UdpTransportImpl::IncomingRTPFunction - Cannot get sender\
- information");
-        }else
+            continue;
+        }
+        char ipAddress[kIpAddressVersion6Length];
+        uint16_t portNr = 0;
         {
-            // Make sure ipAddress is null terminated.
-            ipAddress[kIpAddressVersion6Length - 1] = 0;
-            strncpy(_fromIP, ipAddress, kIpAddressVersion6Length - 1);
+            CriticalSectionScoped cs(_critFilter);
+            if (!AcceptIncomingRTP(datagrams[i].from, ipAddress, portNr))
+            {
+                continue;
+            }
         }
-
-        // Filter based on port.
-        if (_rtpFilterPort != 0 &&
-            _rtpFilterPort != portNr)
+        // A run ends when the sender changes or the arrays are full.
+        if (runLength > 0 &&
+            (runLength == kMaxPacketsPerCallback || portNr != runPort ||
+             strncmp(ipAddress, runIpAddress, kIpAddressVersion6Length) != 0))
         {
-            // Drop packet.
-            memset(_fromIP, 0, sizeof(_fromIP));
-            WEBRTC_TRACE(
-                kTraceStream,
-                kTraceTransport,
-                _id,
-                "Incoming RTP packet blocked by filter incoming from port:%d\
- allowed port:%d",
-                portNr,
-                _rtpFilterPort);
-            return;
+            DeliverIncomingRTP(packets, lengths, runLength, runIpAddress,
+                               runPort);
+            runLength = 0;
         }
-        _fromPort = portNr;
+        if (runLength == 0)
+        {
+            memcpy(runIpAddress, ipAddress, sizeof(runIpAddress));
+            runPort = portNr;
+        }
+        packets[runLength] = datagrams[i].data;
+        lengths[runLength] = datagrams[i].length;
+        ++runLength;
     }
-
-    CriticalSectionScoped cs(_critPacketCallback);
-    if (_packetCallback)
+    if (runLength > 0)
     {
-        WEBRTC_TRACE(kTraceStream, kTraceTransport, _id,
-            "Incoming RTP packet from ip:%s port:%d", ipAddress, portNr);
-        _packetCallback->IncomingRTPPacket(rtpPacket, rtpPacketLength,
-                                           ipAddress, portNr);
+        DeliverIncomingRTP(packets, lengths, runLength, runIpAddress, runPort);
     }
 }
 
@@ -120,11 +120,18 @@ public:
     virtual int32_t SendRTCPPacketTo(const int8_t *data,
                                      uint32_t length,
                                      uint16_t rtcpPort) OVERRIDE;
+    virtual int32_t SendRTPPackets(const int8_t* const* packets,
+                                   const int32_t* lengths,
+                                   int32_t numberOfPackets) OVERRIDE;
     // Transport functions
     virtual int SendPacket(int channel, const void* data, int length) OVERRIDE;
     virtual int SendRTCPPacket(int channel,
                                const void* data,
                                int length) OVERRIDE;
+    virtual int SendPackets(int channel,
+                            const void* const* data,
+                            const int* lengths,
+                            int numberOfPackets) OVERRIDE;
 
     // UdpTransport functions continue.
     virtual int32_t SetSendIP(const char* ipaddr) OVERRIDE;
@@ -150,6 +157,10 @@ protected:
                                      const int8_t* rtcpPacket,
                                      int32_t rtcpPacketLength,
                                      const SocketAddress* from);
+    // IncomingSocketBatchCallback for the RTP socket.
+    static void IncomingRTPBatchCallback(CallbackObj obj,
+                                         const ReceivedDatagram* datagrams,
+                                         int32_t count);
 
     void CloseSendSockets();
     void CloseReceiveSockets();
@@ -174,6 +185,22 @@ protected:
     void IncomingRTCPFunction(const int8_t* rtcpPacket,
                               int32_t rtcpPacketLength,
                               const SocketAddress* from);
+    // Filters the datagrams like IncomingRTPFunction() and delivers each run
+    // of packets from the same sender with one callback.
+    void IncomingRTPBatchFunction(const ReceivedDatagram* datagrams,
+                                  int32_t count);
+
+    // Returns false if an RTP packet from fromSocket should be dropped.
+    // Otherwise fills in the sender and records it as the last one heard
+    // from. Must be called with _critFilter held.
+    bool AcceptIncomingRTP(const SocketAddress* fromSocket,
+                           char ipAddress[kIpAddressVersion6Length],
+                           uint16_t& portNr);
+    void DeliverIncomingRTP(const int8_t* const* packets,
+                            const int32_t* lengths,
+                            int32_t count,
+                            const char* ipAddress,
+                            uint16_t portNr);
 
     bool FilterIPAddress(const SocketAddress* fromAddress);
 
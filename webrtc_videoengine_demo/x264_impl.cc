@@ -0,0 +1,846 @@
+/*
+ *  Copyright (c) 2012 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ *
+ * This file contains the WEBRTC H264 wrapper implementation
+ *
+ */
+
+#include "x264_impl.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+#include "webrtc/common.h"
+#include "webrtc/common_video/interface/wrapped_i420_video_frame.h"
+#include "webrtc/common_video/libyuv/include/webrtc_libyuv.h"
+#include "webrtc/modules/interface/module_common_types.h"
+#include "webrtc/system_wrappers/interface/atomic32.h"
+#include "webrtc/system_wrappers/interface/trace.h"
+#include "webrtc/system_wrappers/interface/tick_util.h"
+#include "webrtc/system_wrappers/interface/trace_event.h"
+
+namespace webrtc {
+
+
+	// VBV buffer relative to the target bit rate. Short enough that a rate
+	// drop from the bandwidth estimator takes effect within a few frames.
+	static const int kVbvBufferMs = 500;
+	// Channels with less loss than this rely on NACK alone.
+	static const int kMinLossPercentForIntraRefresh = 2;
+	// Intra refresh period at the minimum loss rate; shortened with more loss.
+	static const int kMaxIntraRefreshIntervalMs = 4000;
+	static const int kMinIntraRefreshIntervalMs = 500;
+	// Round-trip times above this make retransmissions arrive too late to be
+	// useful, so losses are healed by refreshing more often instead.
+	static const int kHighRttMs = 300;
+
+	// Macroblock rows each sliced thread should have at least.
+	static const int kMinRowsPerThread = 4;
+	static const int kMaxEncoderThreads = 8;
+
+	// Speed presets for the VideoCodecH264::complexity settings.
+	static const char* PresetForComplexity(VideoCodecComplexity complexity) {
+		switch (complexity) {
+		case kComplexityHigh:
+			return "faster";
+		case kComplexityHigher:
+			return "fast";
+		case kComplexityMax:
+			return "medium";
+		default:
+			return "veryfast";
+		}
+	}
+
+	// Sliced threads split every frame, so unlike frame threads they add no
+	// latency; each thread still needs a few macroblock rows to be useful.
+	static int NumberOfThreads(int height, int number_of_cores) {
+		int max_threads = ((height + 15) / 16) / kMinRowsPerThread;
+		int threads = number_of_cores;
+		if (threads > max_threads) {
+			threads = max_threads;
+		}
+		if (threads > kMaxEncoderThreads) {
+			threads = kMaxEncoderThreads;
+		}
+		return threads < 1 ? 1 : threads;
+	}
+
+	// Returns how often intra refresh waves are started for a channel with
+	// |packet_loss| (fraction lost, 0-255) and |rtt|, or 0 for none.
+	static int IntraRefreshIntervalMs(uint32_t packet_loss, int rtt) {
+		int loss_percent = static_cast<int>(100 * packet_loss / 255);
+		if (loss_percent < kMinLossPercentForIntraRefresh) {
+			return 0;
+		}
+		int interval_ms = kMaxIntraRefreshIntervalMs *
+			kMinLossPercentForIntraRefresh / loss_percent;
+		if (rtt > kHighRttMs) {
+			interval_ms /= 2;
+		}
+		return interval_ms < kMinIntraRefreshIntervalMs ?
+			kMinIntraRefreshIntervalMs : interval_ms;
+	}
+
+	// A decoded FFmpeg picture lent to WrappedI420VideoFrame. The decoder's pool
+	// keeps one reference; the picture is reused once every frame borrowing it
+	// has been released by the renderer.
+	class H264DecodedPicture : public I420BufferHandle {
+	public:
+		H264DecodedPicture() : ref_count_(0), frame_(av_frame_alloc()) {}
+		virtual ~H264DecodedPicture() { av_frame_free(&frame_); }
+
+		virtual int32_t AddRef() { return ++ref_count_; }
+		virtual int32_t Release() {
+			int32_t ref_count = --ref_count_;
+			if (ref_count == 0) {
+				delete this;
+			}
+			return ref_count;
+		}
+
+		// True when only the decoder's pool references the picture.
+		bool IsFree() { return ref_count_.Value() == 1; }
+
+		AVFrame* frame() { return frame_; }
+
+	private:
+		Atomic32 ref_count_;
+		AVFrame* frame_;
+	};
+
+	H264Encoder* H264Encoder::CreateX264() {
+		return new X264EncoderImpl();
+	}
+
+	X264EncoderImpl::X264EncoderImpl()
+		: encoded_image_(),
+		fragmentation_capacity_(0),
+		encoded_complete_callback_(NULL),
+		inited_(false)
+		,encoder_(NULL)
+		, nal(NULL)
+		, last_timestamp(0)
+		, last_pts(0)
+		, intra_refresh_interval_ms_(0)
+		, last_intra_refresh_ms_(0)
+	{
+		memset(&codec_, 0, sizeof(codec_));
+	}
+
+	X264EncoderImpl::~X264EncoderImpl() {
+		Release();
+	}
+
+	int X264EncoderImpl::Release() {
+		// |encoded_image_| only ever borrows its buffer.
+		encoded_image_._buffer = NULL;
+		encoded_image_._length = 0;
+		encoded_image_._size = 0;
+			if (encoder_ != NULL) {
+				x264_encoder_close(encoder_);
+				encoder_ = NULL;
+			}
+		inited_ = false;
+		return WEBRTC_VIDEO_CODEC_OK;
+	}
+
+	int X264EncoderImpl::SetRates(uint32_t new_bitrate_kbit,
+		uint32_t new_framerate) {
+		WEBRTC_TRACE(webrtc::kTraceApiCall, webrtc::kTraceVideoCoding, -1,
+			"X264EncoderImpl::SetRates(%d, %d)", new_bitrate_kbit, new_framerate);
+		if (!inited_) {
+			return WEBRTC_VIDEO_CODEC_UNINITIALIZED;
+		}
+		if (new_framerate < 1) {
+			return WEBRTC_VIDEO_CODEC_ERR_PARAMETER;
+		}
+		// update bit rate
+		if (codec_.maxBitrate > 0 && new_bitrate_kbit > codec_.maxBitrate) {
+			new_bitrate_kbit = codec_.maxBitrate;
+		}
+		if (new_bitrate_kbit < codec_.minBitrate) {
+			new_bitrate_kbit = codec_.minBitrate;
+		}
+		if (new_bitrate_kbit < 1) {
+			return WEBRTC_VIDEO_CODEC_ERR_PARAMETER;
+		}
+		// The frame rate reaches the rate control through the input timestamps
+		// (see b_vfr_input); only the bit rate and VBV need reconfiguring.
+		param.rc.i_bitrate = new_bitrate_kbit;
+		param.rc.i_vbv_max_bitrate = new_bitrate_kbit;
+		param.rc.i_vbv_buffer_size = new_bitrate_kbit * kVbvBufferMs / 1000;
+		int ret_val = x264_encoder_reconfig(encoder_, &param);
+		if (ret_val < 0) {
+			WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideoCoding, -1,
+				"X264EncoderImpl::SetRates() fails to reconfigure encoder ret_val %d",
+				ret_val);
+			return WEBRTC_VIDEO_CODEC_ERROR;
+		}
+		codec_.maxFramerate = new_framerate;
+		return WEBRTC_VIDEO_CODEC_OK;
+	}
+
+	int X264EncoderImpl::InitEncode(const VideoCodec* inst,
+		int number_of_cores,
+		uint32_t max_payload_size) {
+		if (inst == NULL) {
+			return WEBRTC_VIDEO_CODEC_ERR_PARAMETER;
+		}
+		if (inst->maxFramerate < 1) {
+			return WEBRTC_VIDEO_CODEC_ERR_PARAMETER;
+		}
+		// allow zero to represent an unspecified maxBitRate
+		if (inst->maxBitrate > 0 && inst->startBitrate > inst->maxBitrate) {
+			return WEBRTC_VIDEO_CODEC_ERR_PARAMETER;
+		}
+		if (inst->width < 1 || inst->height < 1) {
+			return WEBRTC_VIDEO_CODEC_ERR_PARAMETER;
+		}
+		if (number_of_cores < 1) {
+			return WEBRTC_VIDEO_CODEC_ERR_PARAMETER;
+		}
+
+		int ret_val = Release();
+		if (ret_val < 0) {
+			return ret_val;
+		}
+		/* Get default params for preset/tuning */
+		// Encode() stamps the input frame's timestamps on the output, so
+		// every preset is tuned for zero latency: no lookahead, B-frames or
+		// frame threads that would return an earlier picture.
+		ret_val = x264_param_default_preset(&param,
+			PresetForComplexity(inst->codecSpecific.H264.complexity),
+			"zerolatency");
+		if (ret_val != 0) {
+			WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideoCoding, -1,
+				"X264EncoderImpl::InitEncode() fails to initialize encoder ret_val %d",
+				ret_val);
+			x264_encoder_close(encoder_);
+			encoder_ = NULL;
+			return WEBRTC_VIDEO_CODEC_ERROR;
+		}
+		/* Configure non-default params */
+		param.i_csp = X264_CSP_I420;
+		param.i_width = inst->width;
+		param.i_height = inst->height;
+		param.i_threads = NumberOfThreads(inst->height, number_of_cores);
+		param.b_sliced_threads = 1;
+		// Keep every NAL within one RTP packet so none need FU-A fragmenting.
+		if (max_payload_size > 0) {
+			param.i_slice_max_size = static_cast<int>(max_payload_size);
+		}
+		// Time stamps are the 90 kHz RTP timestamps, so the rate control
+		// follows the actual input frame rate.
+		param.b_vfr_input = 1;
+		param.i_timebase_num = 1;
+		param.i_timebase_den = 90000;
+		param.b_repeat_headers = 1;
+		param.b_annexb = 0;
+		param.i_fps_num = inst->maxFramerate;
+		param.i_fps_den = 1;
+		// Average bit rate bounded by a VBV, which x264_encoder_reconfig()
+		// can then move around as the bandwidth estimate changes.
+		param.rc.i_rc_method = X264_RC_ABR;
+		param.rc.i_bitrate = inst->startBitrate;
+		param.rc.i_vbv_max_bitrate = inst->startBitrate;
+		param.rc.i_vbv_buffer_size = inst->startBitrate * kVbvBufferMs / 1000;
+		// Key frames only on request; losses are healed with intra refresh
+		// waves started from SetChannelParameters() instead.
+		param.i_keyint_max = X264_KEYINT_MAX_INFINITE;
+		param.b_intra_refresh = 1;
+		/* Apply profile restrictions. */
+		ret_val = x264_param_apply_profile(&param, "high");
+		if (ret_val != 0) {
+			WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideoCoding, -1,
+				"X264EncoderImpl::InitEncode() fails to initialize encoder ret_val %d",
+				ret_val);
+			x264_encoder_close(encoder_);
+			encoder_ = NULL;
+			return WEBRTC_VIDEO_CODEC_ERROR;
+		}
+
+		ret_val = x264_picture_alloc(&pic, param.i_csp, param.i_width, param.i_height);
+		if (ret_val != 0) {
+			WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideoCoding, -1,
+				"X264EncoderImpl::InitEncode() fails to initialize encoder ret_val %d",
+				ret_val);
+			x264_encoder_close(encoder_);
+			encoder_ = NULL;
+			return WEBRTC_VIDEO_CODEC_ERROR;
+		}
+
+		encoder_ = x264_encoder_open(&param);
+		if (!encoder_){
+			WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideoCoding, -1,
+				"X264EncoderImpl::InitEncode() fails to initialize encoder ret_val %d",
+				ret_val);
+			x264_encoder_close(encoder_);
+			x264_picture_clean(&pic);
+			encoder_ = NULL;
+			return WEBRTC_VIDEO_CODEC_ERROR;
+		}
+		i_frame = 0;
+		last_intra_refresh_ms_ = 0;
+
+		if (&codec_ != inst) {
+			codec_ = *inst;
+		}
+
+		encoded_image_._completeFrame = true;
+
+		inited_ = true;
+		WEBRTC_TRACE(webrtc::kTraceApiCall, webrtc::kTraceVideoCoding, -1,
+			"X264EncoderImpl::InitEncode(width:%d, height:%d, framerate:%d, start_bitrate:%d, max_bitrate:%d)",
+			inst->width, inst->height, inst->maxFramerate, inst->startBitrate, inst->maxBitrate);
+
+		return WEBRTC_VIDEO_CODEC_OK;
+	}
+
+	int X264EncoderImpl::Encode(const I420VideoFrame& input_image,
+		const CodecSpecificInfo* codec_specific_info,
+		const std::vector<VideoFrameType>* frame_types) {
+		if (!inited_) {
+			return WEBRTC_VIDEO_CODEC_UNINITIALIZED;
+		}
+		if (input_image.IsZeroSize()) {
+			return WEBRTC_VIDEO_CODEC_ERR_PARAMETER;
+		}
+		if (encoded_complete_callback_ == NULL) {
+			return WEBRTC_VIDEO_CODEC_UNINITIALIZED;
+		}
+
+		VideoFrameType frame_type = kDeltaFrame;
+		// We only support one stream at the moment.
+		if (frame_types && frame_types->size() > 0) {
+			frame_type = (*frame_types)[0];
+		}
+
+		bool send_keyframe = (frame_type == kKeyFrame);
+		pic.i_type = send_keyframe ? X264_TYPE_IDR : X264_TYPE_AUTO;
+		if (send_keyframe) {
+			WEBRTC_TRACE(webrtc::kTraceApiCall, webrtc::kTraceVideoCoding, -1,
+				"X264EncoderImpl::EncodeKeyFrame(width:%d, height:%d)",
+				input_image.width(), input_image.height());
+		}
+
+		// Check for change in frame size.
+		if (input_image.width() != codec_.width ||
+			input_image.height() != codec_.height) {
+			int ret = UpdateCodecFrameSize(input_image);
+			if (ret < 0) {
+				return ret;
+			}
+		}
+
+		/* Read input frame */
+		pic.img.plane[0] = const_cast<uint8_t*>(input_image.buffer(kYPlane));
+		pic.img.plane[1] = const_cast<uint8_t*>(input_image.buffer(kUPlane));
+		pic.img.plane[2] = const_cast<uint8_t*>(input_image.buffer(kVPlane));
+		// Unwrap the RTP timestamp; x264 needs strictly increasing pts.
+		if (i_frame == 0) {
+			last_pts = 0;
+		} else {
+			uint32_t diff = input_image.timestamp() - last_timestamp;
+			last_pts += (diff > 0 && diff < 0x80000000u) ? diff : 1;
+		}
+		last_timestamp = input_image.timestamp();
+		pic.i_pts = last_pts;
+
+		if (!send_keyframe) {
+			MaybeStartIntraRefresh();
+		}
+
+		int i_nal = 0;
+		int i_frame_size = x264_encoder_encode(encoder_, &nal, &i_nal, &pic, &pic_out);
+		if (i_frame_size < 0)
+		{
+			WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideoCoding, -1,
+				"X264EncoderImpl::Encode() fails to encode %d",
+				i_frame_size);
+			x264_encoder_close(encoder_);
+			x264_picture_clean(&pic);
+			encoder_ = NULL;
+			return WEBRTC_VIDEO_CODEC_ERROR;
+		}
+
+		encoded_image_._length = 0;
+		
+		if (i_frame_size > 0)
+		{
+			if (i_nal == 0) {
+				return WEBRTC_VIDEO_CODEC_OK;
+			}
+			PrepareFragmentationHeader(i_nal);
+
+			// x264 keeps the payloads of a frame's NAL units sequential in its
+			// own buffer, valid until the next x264_encoder_encode() call, so
+			// they are referenced in place. Each starts with a four byte length
+			// prefix (b_annexb = 0) that the fragmentation header leaves out.
+			uint8_t* base = nal[0].p_payload;
+			encoded_image_._buffer = base;
+			encoded_image_._length = i_frame_size;
+			encoded_image_._size = i_frame_size;
+
+			for (int nal_index = 0; nal_index < i_nal; nal_index++)
+			{
+				uint32_t currentNaluSize = nal[nal_index].i_payload - 4;
+
+				WEBRTC_TRACE(webrtc::kTraceApiCall, webrtc::kTraceVideoCoding, -1,
+					"X264EncoderImpl::Encode() nal_type %d, length:%d",
+					nal[nal_index].i_type, currentNaluSize);
+
+				frag_info_.fragmentationOffset[nal_index] =
+					static_cast<uint32_t>(nal[nal_index].p_payload + 4 - base);
+				frag_info_.fragmentationLength[nal_index] = currentNaluSize;
+				frag_info_.fragmentationPlType[nal_index] = nal[nal_index].i_type;
+				frag_info_.fragmentationTimeDiff[nal_index] = 0;
+			}
+		}
+		i_frame++;
+		if (pic_out.b_keyframe) {
+			frame_type = kKeyFrame;
+		}
+		if (encoded_image_._length > 0) {
+			encoded_image_._timeStamp = input_image.timestamp();
+			encoded_image_.capture_time_ms_ = input_image.render_time_ms();
+			encoded_image_._encodedHeight = codec_.height;
+			encoded_image_._encodedWidth = codec_.width;
+			encoded_image_._frameType = frame_type;
+			// call back
+			encoded_complete_callback_->Encoded(encoded_image_, NULL, &frag_info_);
+		}
+		return WEBRTC_VIDEO_CODEC_OK;
+	}
+
+	int X264EncoderImpl::RegisterEncodeCompleteCallback(
+		EncodedImageCallback* callback) {
+		encoded_complete_callback_ = callback;
+		return WEBRTC_VIDEO_CODEC_OK;
+	}
+
+	int X264EncoderImpl::SetChannelParameters(uint32_t packet_loss, int rtt) {
+		intra_refresh_interval_ms_ = IntraRefreshIntervalMs(packet_loss, rtt);
+		return WEBRTC_VIDEO_CODEC_OK;
+	}
+
+	void X264EncoderImpl::MaybeStartIntraRefresh() {
+		if (intra_refresh_interval_ms_ <= 0) {
+			return;
+		}
+		int64_t now_ms = TickTime::MillisecondTimestamp();
+		if (now_ms - last_intra_refresh_ms_ < intra_refresh_interval_ms_) {
+			return;
+		}
+		x264_encoder_intra_refresh(encoder_);
+		last_intra_refresh_ms_ = now_ms;
+	}
+
+	void X264EncoderImpl::PrepareFragmentationHeader(uint16_t count) {
+		// VerifyAndAllocateFragmentationHeader() only grows the arrays and
+		// copies |fragmentationVectorSize| entries, so track the capacity here.
+		frag_info_.fragmentationVectorSize = fragmentation_capacity_;
+		frag_info_.VerifyAndAllocateFragmentationHeader(count);
+		if (count > fragmentation_capacity_) {
+			fragmentation_capacity_ = count;
+		}
+		frag_info_.fragmentationVectorSize = count;
+	}
+
+	int X264EncoderImpl::UpdateCodecFrameSize(const I420VideoFrame& input_image) {
+		codec_.width = input_image.width();
+		codec_.height = input_image.height();
+		return WEBRTC_VIDEO_CODEC_OK;
+	}
+
+
+	H264Decoder* H264Decoder::CreateFFmpeg() {
+		return new FFmpegH264DecoderImpl();
+	}
+
+	FFmpegH264DecoderImpl::FFmpegH264DecoderImpl()
+		: decode_complete_callback_(NULL),
+		inited_(false),
+		key_frame_required_(true),
+		has_decoded_frame_(false)
+		, pCodecCtx(NULL)
+		, pCodec(NULL)
+		, pFrame(NULL)
+		, out_index(0)
+		, out_width(0)
+		, out_height(0)
+		, img_convert_ctx(NULL)
+		, decode_buffer(NULL)
+		, decode_buffer_size(0)
+	{
+		memset(&codec_, 0, sizeof(codec_));
+		memset(pFrameYUV, 0, sizeof(pFrameYUV));
+		memset(out_buffer, 0, sizeof(out_buffer));
+		av_init_packet(&packet);
+		av_register_all();
+		avformat_network_init();
+	}
+
+	FFmpegH264DecoderImpl::~FFmpegH264DecoderImpl() {
+		inited_ = true;  // in order to do the actual release
+		Release();
+		av_freep(&decode_buffer);
+		decode_buffer_size = 0;
+	}
+
+	int FFmpegH264DecoderImpl::Reset() {
+		if (!inited_) {
+			return WEBRTC_VIDEO_CODEC_UNINITIALIZED;
+		}
+		InitDecode(&codec_, 1);
+		return WEBRTC_VIDEO_CODEC_OK;
+	}
+
+	int FFmpegH264DecoderImpl::InitDecode(const VideoCodec* inst, int number_of_cores) {
+		if (inst == NULL) {
+			return WEBRTC_VIDEO_CODEC_ERR_PARAMETER;
+		}
+		int ret_val = Release();
+		if (ret_val < 0) {
+			return ret_val;
+		}
+
+		if (&codec_ != inst) {
+			// Save VideoCodec instance for later; mainly for duplicating the decoder.
+			codec_ = *inst;
+		}
+		pCodec = avcodec_find_decoder(AV_CODEC_ID_H264);
+		if (pCodec == NULL){
+			WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideoCoding, -1,
+				"FFmpegH264DecoderImpl::InitDecode, Codec not found.");
+			return WEBRTC_VIDEO_CODEC_ERROR;
+		}
+		pCodecCtx = avcodec_alloc_context3(pCodec);
+		if (pCodecCtx == NULL) {
+			return WEBRTC_VIDEO_CODEC_MEMORY;
+		}
+		pCodecCtx->pix_fmt = PIX_FMT_YUV420P;
+		pCodecCtx->width = codec_.width;
+		pCodecCtx->height = codec_.height;
+		//pCodecCtx->bit_rate = codec_.targetBitrate*1000;
+		pCodecCtx->time_base.num = 1;
+		pCodecCtx->time_base.den = codec_.maxFramerate;
+		// Decoded pictures are reference counted so they can be handed to the
+		// renderer without a copy.
+		pCodecCtx->refcounted_frames = 1;
+
+		if (avcodec_open2(pCodecCtx, pCodec, NULL) < 0){
+			WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideoCoding, -1,
+				"FFmpegH264DecoderImpl::InitDecode, Could not open codec.");
+			Release();
+			return WEBRTC_VIDEO_CODEC_ERROR;
+		}
+
+		// Everything the decode loop needs is allocated here, once, so that
+		// steady-state Decode() calls do not touch the heap.
+		pFrame = av_frame_alloc();
+		if (pFrame == NULL) {
+			Release();
+			return WEBRTC_VIDEO_CODEC_MEMORY;
+		}
+		for (int i = 0; i < kPicturePoolSize; i++) {
+			decoded_pictures[i] = new H264DecodedPicture();
+			if (decoded_pictures[i]->frame() == NULL) {
+				Release();
+				return WEBRTC_VIDEO_CODEC_MEMORY;
+			}
+		}
+		ret_val = EnsureDecodeBufferSize(MAX_ENCODED_IMAGE_SIZE);
+		if (ret_val < 0) {
+			Release();
+			return ret_val;
+		}
+		framecnt = 0;
+		encoded_length = 0;
+		inited_ = true;
+
+		// Always start with a complete key frame.
+		key_frame_required_ = true;
+		WEBRTC_TRACE(webrtc::kTraceApiCall, webrtc::kTraceVideoCoding, -1,
+			"FFmpegH264DecoderImpl::InitDecode(width:%d, height:%d, framerate:%d, start_bitrate:%d, max_bitrate:%d)",
+			inst->width, inst->height, inst->maxFramerate, inst->startBitrate, inst->maxBitrate);
+		return WEBRTC_VIDEO_CODEC_OK;
+	}
+
+	int FFmpegH264DecoderImpl::Decode(const EncodedImage& input_image,
+		bool missing_frames,
+		const RTPFragmentationHeader* fragmentation,
+		const CodecSpecificInfo* codec_specific_info,
+		int64_t /*render_time_ms*/) {
+		if (!inited_) {
+			WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideoCoding, -1,
+				"FFmpegH264DecoderImpl::Decode, decoder is not initialized");
+			return WEBRTC_VIDEO_CODEC_UNINITIALIZED;
+		}
+
+		if (decode_complete_callback_ == NULL) {
+			WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideoCoding, -1,
+				"FFmpegH264DecoderImpl::Decode, decode complete call back is not set");
+			return WEBRTC_VIDEO_CODEC_UNINITIALIZED;
+		}
+
+		if (input_image._buffer == NULL) {
+			WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideoCoding, -1,
+				"FFmpegH264DecoderImpl::Decode, null buffer");
+			return WEBRTC_VIDEO_CODEC_ERR_PARAMETER;
+		}
+		if (!codec_specific_info) {
+			WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideoCoding, -1,
+				"FFmpegH264DecoderImpl::Decode, no codec info");
+			return WEBRTC_VIDEO_CODEC_ERROR;
+		}
+		if (codec_specific_info->codecType != kVideoCodecH264) {
+			WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideoCoding, -1,
+				"FFmpegH264DecoderImpl::Decode, non h264 codec %d", codec_specific_info->codecType);
+			return WEBRTC_VIDEO_CODEC_ERROR;
+		}
+
+		WEBRTC_TRACE(webrtc::kTraceApiCall, webrtc::kTraceVideoCoding, -1,
+			"FFmpegH264DecoderImpl::Decode(frame_type:%d, length:%d",
+			input_image._frameType, input_image._length);
+
+#if 0
+		// Always start with a complete key frame.
+		if (key_frame_required_) {
+			if (input_image._frameType != kKeyFrame)
+				return WEBRTC_VIDEO_CODEC_ERROR;
+			// We have a key frame - is it complete?
+			if (input_image._completeFrame) {
+				key_frame_required_ = false;
+			}
+			else {
+				return WEBRTC_VIDEO_CODEC_ERROR;
+			}
+		}
+#endif
+		if (framecnt < 2)
+		{
+			if (EnsureDecodeBufferSize(encoded_length + input_image._length) < 0) {
+				return WEBRTC_VIDEO_CODEC_MEMORY;
+			}
+			memcpy(decode_buffer + encoded_length, input_image._buffer, input_image._length);
+			encoded_length += input_image._length;
+			framecnt++;
+		}
+		else
+		{
+			// |packet| only points into |decode_buffer|, which is kept across
+			// calls and grows on demand, so no per-frame packet is allocated.
+			if (framecnt == 2)
+			{
+				packet.data = decode_buffer;
+				packet.size = encoded_length;
+				framecnt++;
+				printf("\n\nLoading");
+			}
+			else
+			{
+				if (EnsureDecodeBufferSize(input_image._length) < 0) {
+					return WEBRTC_VIDEO_CODEC_MEMORY;
+				}
+				memcpy(decode_buffer, input_image._buffer, input_image._length);
+				packet.data = decode_buffer;
+				packet.size = input_image._length;
+			}
+			
+			int got_picture = 0;
+			int ret = avcodec_decode_video2(pCodecCtx, pFrame, &got_picture, &packet);
+			if (ret < 0){
+				WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideoCoding, -1,
+					"FFmpegH264DecoderImpl::Decode, Decode Error.");
+				return WEBRTC_VIDEO_CODEC_ERROR;
+			}
+			if (got_picture){
+				ret = DeliverDecodedPicture(input_image._timeStamp);
+				av_frame_unref(pFrame);
+				return ret;
+			}
+			else
+				printf(".");
+		}
+		return WEBRTC_VIDEO_CODEC_OK;
+	}
+
+	int FFmpegH264DecoderImpl::RegisterDecodeCompleteCallback(
+		DecodedImageCallback* callback) {
+		decode_complete_callback_ = callback;
+		return WEBRTC_VIDEO_CODEC_OK;
+	}
+
+	int FFmpegH264DecoderImpl::Release() {
+		FreeOutputFrames();
+		// Pictures still held by the renderer stay alive until it lets go.
+		for (int i = 0; i < kPicturePoolSize; i++) {
+			decoded_pictures[i] = NULL;
+		}
+		if (img_convert_ctx != NULL) {
+			sws_freeContext(img_convert_ctx);
+			img_convert_ctx = NULL;
+		}
+		av_frame_free(&pFrame);
+		if (pCodecCtx != NULL) {
+			avcodec_close(pCodecCtx);
+			av_freep(&pCodecCtx);
+		}
+		inited_ = false;
+		return WEBRTC_VIDEO_CODEC_OK;
+	}
+
+	int FFmpegH264DecoderImpl::DeliverDecodedPicture(uint32_t timestamp) {
+		AVPixelFormat format = static_cast<AVPixelFormat>(pFrame->format);
+		bool is_i420 = (format == PIX_FMT_YUV420P || format == PIX_FMT_YUVJ420P);
+		H264DecodedPicture* picture = is_i420 ? FindFreePicture() : NULL;
+		if (picture != NULL) {
+			// Lend the decoder's own picture to the renderer; it is recycled once
+			// the last WrappedI420VideoFrame referencing it is gone.
+			AVFrame* frame = picture->frame();
+			av_frame_unref(frame);
+			av_frame_move_ref(frame, pFrame);
+			WrappedI420VideoFrame wrapped_image(picture, frame->width, frame->height,
+				frame->data[0], frame->linesize[0],
+				frame->data[1], frame->linesize[1],
+				frame->data[2], frame->linesize[2],
+				timestamp, 0);
+			has_decoded_frame_ = true;
+			decode_complete_callback_->Decoded(wrapped_image);
+			return WEBRTC_VIDEO_CODEC_OK;
+		}
+
+		const AVFrame* pFrameOut = pFrame;
+		int width = pFrame->width;
+		int height = pFrame->height;
+		if (!is_i420) {
+			// Output pictures and the scaling context are only rebuilt when
+			// the stream changes resolution.
+			if (width != out_width || height != out_height) {
+				int ret = AllocateOutputFrames(width, height);
+				if (ret < 0) {
+					return ret;
+				}
+			}
+			img_convert_ctx = sws_getCachedContext(img_convert_ctx,
+				width, height, format,
+				out_width, out_height, PIX_FMT_YUV420P, SWS_BICUBIC, NULL, NULL, NULL);
+			if (img_convert_ctx == NULL) {
+				WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideoCoding, -1,
+					"FFmpegH264DecoderImpl::Decode, Could not create scaling context.");
+				return WEBRTC_VIDEO_CODEC_ERROR;
+			}
+			AVFrame* pFrameYUVOut = pFrameYUV[out_index];
+			out_index = (out_index + 1) % kOutputPoolSize;
+			sws_scale(img_convert_ctx, (const uint8_t* const*)pFrame->data, pFrame->linesize, 0, height,
+				pFrameYUVOut->data, pFrameYUVOut->linesize);
+			pFrameOut = pFrameYUVOut;
+		}
+
+		// Every pooled picture is still held downstream, or the picture had to
+		// be converted; copy it into |decoded_image_|.
+		int size_y = pFrameOut->linesize[0] * height;
+		int size_u = pFrameOut->linesize[1] * ((height + 1) / 2);
+		int size_v = pFrameOut->linesize[2] * ((height + 1) / 2);
+
+		decoded_image_.CreateFrame(size_y, pFrameOut->data[0],
+			size_u, pFrameOut->data[1],
+			size_v, pFrameOut->data[2],
+			width,
+			height,
+			pFrameOut->linesize[0],
+			pFrameOut->linesize[1],
+			pFrameOut->linesize[2]);
+
+		decoded_image_.set_timestamp(timestamp);
+		has_decoded_frame_ = true;
+		decode_complete_callback_->Decoded(decoded_image_);
+		return WEBRTC_VIDEO_CODEC_OK;
+	}
+
+	H264DecodedPicture* FFmpegH264DecoderImpl::FindFreePicture() {
+		for (int i = 0; i < kPicturePoolSize; i++) {
+			if (decoded_pictures[i].get() != NULL && decoded_pictures[i]->IsFree()) {
+				return decoded_pictures[i].get();
+			}
+		}
+		return NULL;
+	}
+
+	int FFmpegH264DecoderImpl::AllocateOutputFrames(int width, int height) {
+		FreeOutputFrames();
+		if (width < 1 || height < 1) {
+			// Resolution not known yet; allocate on the first decoded picture.
+			return WEBRTC_VIDEO_CODEC_OK;
+		}
+		int size = avpicture_get_size(PIX_FMT_YUV420P, width, height);
+		for (int i = 0; i < kOutputPoolSize; i++) {
+			pFrameYUV[i] = av_frame_alloc();
+			out_buffer[i] = static_cast<uint8_t*>(av_malloc(size));
+			if (pFrameYUV[i] == NULL || out_buffer[i] == NULL) {
+				FreeOutputFrames();
+				return WEBRTC_VIDEO_CODEC_MEMORY;
+			}
+			avpicture_fill((AVPicture *)pFrameYUV[i], out_buffer[i], PIX_FMT_YUV420P, width, height);
+		}
+		out_width = width;
+		out_height = height;
+		out_index = 0;
+		return WEBRTC_VIDEO_CODEC_OK;
+	}
+
+	void FFmpegH264DecoderImpl::FreeOutputFrames() {
+		for (int i = 0; i < kOutputPoolSize; i++) {
+			av_frame_free(&pFrameYUV[i]);
+			av_freep(&out_buffer[i]);
+		}
+		out_width = 0;
+		out_height = 0;
+		out_index = 0;
+	}
+
+	int FFmpegH264DecoderImpl::EnsureDecodeBufferSize(int size) {
+		void* buffer = av_fast_realloc(decode_buffer, &decode_buffer_size,
+			size + FF_INPUT_BUFFER_PADDING_SIZE);
+		if (buffer == NULL) {
+			WEBRTC_TRACE(webrtc::kTraceError, webrtc::kTraceVideoCoding, -1,
+				"FFmpegH264DecoderImpl::Decode, failed to grow decode buffer to %d bytes", size);
+			return WEBRTC_VIDEO_CODEC_MEMORY;
+		}
+		decode_buffer = static_cast<uint8_t*>(buffer);
+		memset(decode_buffer + size, 0, FF_INPUT_BUFFER_PADDING_SIZE);
+		return WEBRTC_VIDEO_CODEC_OK;
+	}
+
+	VideoDecoder* FFmpegH264DecoderImpl::Copy() {
+		// Sanity checks.
+		if (!inited_) {
+			// Not initialized.
+			assert(false);
+			return NULL;
+		}
+		if (!has_decoded_frame_) {
+			// Nothing has been decoded before; cannot clone.
+			return NULL;
+		}
+		// Create a new VideoDecoder object
+		FFmpegH264DecoderImpl *copy = new FFmpegH264DecoderImpl;
+
+		// Initialize the new decoder
+		if (copy->InitDecode(&codec_, 1) != WEBRTC_VIDEO_CODEC_OK) {
+			delete copy;
+			return NULL;
+		}
+
+		return static_cast<VideoDecoder*>(copy);
+	}
+}  // namespace webrtc